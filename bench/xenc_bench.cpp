@@ -0,0 +1,439 @@
+/**
+ *  @file xenc_bench.cpp
+ *  @brief Micro-benchmarks of the XenC hot paths
+ *  @author Anthony Rousseau
+ *  @version 2.0.0
+ *  @date 19 October 2026
+ */
+
+/*  This file is part of the cross-entropy tool for data selection (XenC)
+ *  aimed at speech recognition and statistical machine translation.
+ *
+ *  Copyright 2013-2016, Anthony Rousseau, LIUM, University of Le Mans, France
+ *
+ *  Development of the XenC tool has been partially funded by the
+ *  European Commission under the MateCat project.
+ *
+ *  The XenC tool is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation
+ *
+ *  This library is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <algorithm>
+#include <iomanip>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <boost/program_options.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/device/file.hpp>
+
+#include "../include/utils/common.h"
+#include "../include/utils/xenio.h"
+#include "../include/utils/StaticData.h"
+#include "../include/similarity.h"
+#include "../include/xenoption.h"
+#include "../include/kenlm/util/usage.hh"
+
+namespace po = boost::program_options;
+
+/**
+ *  @class SynthRand
+ *  @brief Tiny deterministic generator, so synthetic data is the same on every platform
+ */
+class SynthRand {
+public:
+    SynthRand(uint64_t seed) : state(seed * 6364136223846793005ULL + 1442695040888963407ULL) { }
+
+    /**
+     *  @fn double next ()
+     *  @brief Draws a uniform value in [0, 1)
+     */
+    double next() {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return (double)(state >> 11) / 9007199254740992.0;
+    }
+
+private:
+    uint64_t state;     //!< Current generator state
+};
+
+/**
+ *  @fn std::string makeSentence (SynthRand &rnd, int vocab)
+ *  @brief Draws a sentence with a skewed (Zipf-like) word distribution
+ *
+ *  @param rnd :    the random generator
+ *  @param vocab :  the vocabulary size
+ *  @return the sentence
+ */
+std::string makeSentence(SynthRand &rnd, int vocab) {
+    int len = 5 + (int)(rnd.next() * 25);
+    std::string res = "";
+
+    for (int i = 0; i < len; i++) {
+        double u = rnd.next();
+        int w = (int)(vocab * u * u * u);
+        res += (i == 0 ? "" : " ") + ("w" + XenCommon::toString(w));
+    }
+
+    return res;
+}
+
+/**
+ *  @fn void makeCorpus (std::string path, int lines, int vocab, uint64_t seed, bool gz)
+ *  @brief Writes a synthetic corpus
+ *
+ *  @param path :   the file to write
+ *  @param lines :  the number of lines
+ *  @param vocab :  the vocabulary size
+ *  @param seed :   the generator seed
+ *  @param gz :     true to gzip the corpus
+ */
+void makeCorpus(std::string path, int lines, int vocab, uint64_t seed, bool gz) {
+    SynthRand rnd(seed);
+
+    boost::iostreams::filtering_ostream out;
+    if (gz)
+        out.push(boost::iostreams::gzip_compressor());
+    out.push(boost::iostreams::file_sink(path.c_str(), std::ios_base::out | std::ios_base::binary));
+
+    for (int i = 0; i < lines; i++)
+        out << makeSentence(rnd, vocab) << '\n';
+
+    out.flush();
+    out.reset();
+}
+
+/**
+ *  @struct BenchResult
+ *  @brief Timings of a benchmark
+ */
+struct BenchResult {
+    std::string name;   //!< Benchmark name
+    int reps;           //!< Number of timed repetitions
+    double min;         //!< Fastest repetition (seconds)
+    double median;      //!< Median repetition (seconds)
+    uint64_t items;     //!< Items processed by one repetition
+};
+
+/**
+ *  @fn BenchResult runBench (std::string name, int reps, uint64_t items, boost::function<void ()> fn)
+ *  @brief Times a function: one untimed warm-up, then reps timed repetitions
+ *
+ *  The minimum is the figure to compare between commits,
+ *  the median shows how noisy the machine was.
+ *
+ *  @param name :   the benchmark name
+ *  @param reps :   the number of timed repetitions
+ *  @param items :  the number of items processed by one call
+ *  @param fn :     the function to time
+ *  @return the timings
+ */
+BenchResult runBench(std::string name, int reps, uint64_t items, boost::function<void ()> fn) {
+    std::vector<double> times;
+
+    fn();
+
+    for (int i = 0; i < reps; i++) {
+        double start = util::WallTime();
+        fn();
+        times.push_back(util::WallTime() - start);
+    }
+
+    std::sort(times.begin(), times.end());
+
+    BenchResult r;
+    r.name = name;
+    r.reps = reps;
+    r.min = times.front();
+    r.median = times[times.size() / 2];
+    r.items = items;
+
+    std::cerr << "Benchmark " << name << " done." << std::endl;
+
+    return r;
+}
+
+void benchRead(boost::shared_ptr<XenFile> ptrFile) {
+    std::vector<std::string> vec = XenIO::read(ptrFile);
+}
+
+void benchIngest(boost::shared_ptr<XenFile> ptrFile, std::string lang) {
+    Corpus c;
+    c.initialize(ptrFile, lang, true);
+}
+
+void benchSentenceStats(boost::shared_ptr<Corpus> ptrCorp, boost::shared_ptr<XenLMken> ptrLM) {
+    for (unsigned int i = 0; i < ptrCorp->getSize(); i++)
+        ptrLM->getSentenceStats(ptrCorp->getLine(i));
+}
+
+void benchBatchStats(const std::vector<std::string> &lines, boost::shared_ptr<XenLMken> ptrLM) {
+    std::vector<TxtStats> stats;
+
+    ptrLM->getBatchStats(lines, stats);
+}
+
+void benchCalcPPL(LPOptions opt, int threads, boost::shared_ptr<Corpus> ptrCorp, boost::shared_ptr<XenLMken> ptrLM) {
+    opt->threads = threads;
+    Scheduler::getInstance()->resize(threads);
+
+    PPL p;
+    p.initialize(ptrCorp, ptrLM);
+    p.calcPPLCorpus();
+}
+
+void benchSimilarity(boost::shared_ptr<Corpus> ptrInCorp, boost::shared_ptr<Corpus> ptrOutCorp, boost::shared_ptr<XenVocab> ptrVoc) {
+    Similarity s;
+    s.initialize(ptrInCorp, ptrOutCorp, ptrVoc);
+}
+
+void benchBoostSplit(boost::shared_ptr<Corpus> ptrCorp) {
+    std::vector<std::string> words;
+
+    for (unsigned int i = 0; i < ptrCorp->getSize(); i++)
+        boost::split(words, ptrCorp->getLine(i), boost::is_any_of(" "));
+}
+
+static volatile uint64_t benchSink;     // Keeps benchmarked results from being optimized away
+
+void benchTokenizer(boost::shared_ptr<Corpus> ptrCorp) {
+    Tokenizer words;
+    Token tok;
+    uint64_t h = 0;
+
+    for (unsigned int i = 0; i < ptrCorp->getSize(); i++) {
+        std::string line = ptrCorp->getLine(i);
+        words.reset(line);
+        while (words.next(tok))
+            h ^= tok.hash;
+    }
+
+    benchSink = h;
+}
+
+void benchSplitter(const std::vector<std::string> &lines) {
+    XenCommon::Splitter split;
+
+    for (unsigned int i = 0; i < lines.size(); i++)
+        split.reset(lines[i], " ||| ");
+}
+
+void benchSortWrite(boost::shared_ptr<Corpus> ptrCorp, boost::shared_ptr<Score> ptrScore) {
+    XenIO::writeMonoOutput(ptrCorp, ptrScore);
+}
+
+void benchCalibrate(boost::shared_ptr<Score> ptrScore) {
+    ptrScore->calibrate();
+}
+
+int main(int argc, char* argv[]) {
+    po::options_description desc("xenc_bench options", 200);
+    Options opt;
+
+    int lines = 0;
+    int vocab = 0;
+    int reps = 0;
+    uint64_t seed = 0;
+    std::string threadList = "";
+    bool verbose = false;
+    int order = 0;
+    std::string temp = "";
+    int vecSize = 0;
+
+    desc.add_options()
+    ("lines", po::value<int>(&lines)->default_value(200000), "number of out-of-domain synthetic lines (in-domain has a tenth). Default is 200000")
+    ("vocab", po::value<int>(&vocab)->default_value(20000), "synthetic vocabulary size. Default is 20000")
+    ("reps", po::value<int>(&reps)->default_value(5), "timed repetitions of each benchmark (after one warm-up). Default is 5")
+    ("seed", po::value<uint64_t>(&seed)->default_value(1), "synthetic data seed. Default is 1")
+    ("threads", po::value<std::string>(&threadList)->default_value("1,2,4,8"), "comma-separated thread counts for the perplexity benchmark")
+    ("order", po::value<int>(&order)->default_value(4), "order of the synthetic LM. Default is 4")
+    ("temp", po::value<std::string>(&temp)->default_value("."), "directory for the synthetic data and outputs")
+    ("vector-size", po::value<int>(&vecSize)->default_value(150), "size of vector for the similarity benchmark")
+    ("verbose", po::value<bool>(&verbose)->zero_tokens()->default_value(false), "keep XenC progress messages")
+    ("help,h", "displays this help message");
+
+    try {
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+
+        if (vm.count("help")) {
+            std::cout << desc << std::endl;
+            return 0;
+        }
+
+        po::notify(vm);
+    } catch (po::error &e) {
+        std::cerr << desc << std::endl;
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    if (lines <= 0 || vocab <= 0 || reps <= 0) {
+        std::cerr << "Lines, vocab and reps should be greater than 0." << std::endl;
+        return 1;
+    }
+
+    std::vector<std::string> threadStr;
+    boost::split(threadStr, threadList, boost::is_any_of(","));
+
+    // Results on stdout, XenC progress messages on stderr (or nowhere)
+    std::ostream res(std::cout.rdbuf());
+    std::ofstream devNull("/dev/null");
+    std::cout.rdbuf(verbose ? std::cerr.rdbuf() : devNull.rdbuf());
+
+    if (!boost::filesystem::exists(temp))
+        boost::filesystem::create_directories(temp);
+    std::string dir = boost::filesystem::canonical(temp).string();
+
+    std::string inName = dir + "/in.bn";
+    std::string outName = dir + "/out.bn";
+    std::string outGzName = dir + "/outgz.bn.gz";
+
+    std::cerr << "Generating synthetic corpora in " << dir << std::endl;
+
+    makeCorpus(inName, lines / 10 + 1, vocab, seed, false);
+    makeCorpus(outName, lines, vocab, seed + 1, false);
+    makeCorpus(outGzName, lines, vocab, seed + 1, true);
+
+    // XenC defaults for everything the bench does not set
+    std::vector<std::string> args;
+    args.push_back("--source=bn");
+    args.push_back("--in-stext=" + inName);
+    args.push_back("--out-stext=" + outName);
+    args.push_back("--mode=2");
+    args.push_back("--mono");
+    args.push_back("--order=" + XenCommon::toString(order));
+    args.push_back("--temp=" + dir);
+    args.push_back("--vector-size=" + XenCommon::toString(vecSize));
+    args.push_back("--mem=10%");
+    args.push_back("--threads=1");
+
+    try {
+        po::options_description xencDesc;
+        po::variables_map vm;
+
+        XenOption::describe(xencDesc, opt);
+        po::store(po::command_line_parser(args).options(xencDesc).run(), vm);
+        po::notify(vm);
+    } catch (po::error &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    opt.outName = outName + ".bench";
+
+    XenOption* xOpt = XenOption::getInstance(&opt);
+    StaticData* sD = StaticData::getInstance();
+
+    std::vector<BenchResult> results;
+
+    try {
+        boost::shared_ptr<Corpus> ptrInCorp = sD->getSourceCorps()->getPtrInCorp();
+        boost::shared_ptr<Corpus> ptrOutCorp = sD->getSourceCorps()->getPtrOutCorp();
+        boost::shared_ptr<XenVocab> ptrVoc = sD->getVocabs()->getPtrSourceVoc();
+        boost::shared_ptr<XenLMken> ptrLM = sD->getSourceLMs()->getPtrInLM();
+
+        ptrInCorp->initialize(xOpt->getInSData(), opt.sLang, true);
+        ptrOutCorp->initialize(xOpt->getOutSData(), opt.sLang);
+
+        // Vocab and LM left by a previous run may come from other parameters
+        boost::filesystem::remove(dir + "/in" + opt.sLang + ".vocab");
+        ptrVoc->initialize(ptrInCorp);
+
+        std::cerr << "Estimating synthetic LM" << std::endl;
+
+        ptrLM->initialize(ptrInCorp, ptrVoc);
+        boost::filesystem::remove(ptrLM->getFileName());
+        ptrLM->createLM();
+        ptrLM->loadLM();
+
+        uint64_t outLines = ptrOutCorp->getSize();
+        uint64_t outToks = ptrOutCorp->getWC();
+
+        // I/O
+        boost::shared_ptr<XenFile> ptrGzFile = boost::make_shared<XenFile>();
+        ptrGzFile->initialize(outGzName);
+
+        results.push_back(runBench("XenIO::read(plain)", reps, outLines, boost::bind(benchRead, xOpt->getOutSData())));
+        results.push_back(runBench("XenIO::read(gz)", reps, outLines, boost::bind(benchRead, ptrGzFile)));
+        results.push_back(runBench("Corpus::initialize(plain)", reps, outLines, boost::bind(benchIngest, xOpt->getOutSData(), opt.sLang)));
+        results.push_back(runBench("Corpus::initialize(gz)", reps, outLines, boost::bind(benchIngest, ptrGzFile, opt.sLang)));
+
+        // Tokenization
+        results.push_back(runBench("boost::split", reps, outToks, boost::bind(benchBoostSplit, ptrOutCorp)));
+        results.push_back(runBench("Tokenizer(+hash)", reps, outToks, boost::bind(benchTokenizer, ptrOutCorp)));
+
+        // Language model queries
+        results.push_back(runBench("XenLMken::getSentenceStats", reps, outToks, boost::bind(benchSentenceStats, ptrOutCorp, ptrLM)));
+
+        std::vector<std::string> outLinesVec;
+        for (unsigned int i = 0; i < ptrOutCorp->getSize(); i++)
+            outLinesVec.push_back(ptrOutCorp->getLine(i));
+
+        results.push_back(runBench("XenLMken::getBatchStats", reps, outToks, boost::bind(benchBatchStats, boost::cref(outLinesVec), ptrLM)));
+
+        for (unsigned int i = 0; i < threadStr.size(); i++) {
+            int t = XenCommon::toInt(threadStr[i]);
+            if (t <= 0)
+                continue;
+            results.push_back(runBench("PPL::calcPPLCorpus(threads=" + threadStr[i] + ")", reps, outToks, boost::bind(benchCalcPPL, &opt, t, ptrOutCorp, ptrLM)));
+        }
+
+        // Similarity
+        results.push_back(runBench("Similarity::computeSimilarity", reps, outLines, boost::bind(benchSimilarity, ptrInCorp, ptrOutCorp, ptrVoc)));
+
+        // Phrase-table like splitting
+        std::vector<std::string> ptLines;
+        for (unsigned int i = 0; i < ptrOutCorp->getSize(); i++)
+            ptLines.push_back(ptrOutCorp->getLine(i) + " ||| " + ptrInCorp->getLine(i % ptrInCorp->getSize()) + " ||| 0.1 0.2 0.3 0.4 ||| 0-0 1-1 ||| 1 1 1");
+
+        results.push_back(runBench("XenCommon::Splitter", reps, outLines, boost::bind(benchSplitter, boost::cref(ptLines))));
+
+        // Scores, sort and output
+        SynthRand rnd(seed + 2);
+        boost::shared_ptr<Score> ptrScore = boost::make_shared<Score>();
+        for (unsigned int i = 0; i < ptrOutCorp->getSize(); i++)
+            ptrScore->addScore(rnd.next() * 20.0 - 10.0);
+
+        results.push_back(runBench("Score::calibrate", reps, outLines, boost::bind(benchCalibrate, ptrScore)));
+        results.push_back(runBench("XenIO::writeMonoOutput(sort+write)", reps, outLines, boost::bind(benchSortWrite, ptrOutCorp, ptrScore)));
+    } catch (XenCommon::XenCEption &e) {
+        std::cout.rdbuf(res.rdbuf());
+        std::cerr << e.what() << std::endl;
+        Scheduler::deleteInstance();
+        sD->deleteInstance();
+        xOpt->deleteInstance();
+        return 1;
+    }
+
+    std::cout.rdbuf(res.rdbuf());
+
+    res << "# xenc_bench lines=" << lines << " vocab=" << vocab << " reps=" << reps << " seed=" << seed << " order=" << opt.order << std::endl;
+    res << "benchmark\treps\tmin_ms\tmedian_ms\titems\titems_per_sec" << std::endl;
+    res << std::fixed;
+
+    for (unsigned int i = 0; i < results.size(); i++) {
+        const BenchResult &r = results[i];
+
+        res << r.name << '\t' << r.reps << '\t' << std::setprecision(3) << r.min * 1000.0 << '\t' << r.median * 1000.0 << '\t'
+            << r.items << '\t' << std::setprecision(0) << (r.min > 0.0 ? (double)r.items / r.min : 0.0) << std::endl;
+    }
+
+    Scheduler::deleteInstance();
+    sD->deleteInstance();
+    xOpt->deleteInstance();
+
+    return 0;
+}
@@ -41,6 +41,7 @@
 #include "modes/monoXEntropy.h"
 #include "modes/biXEntropy.h"
 #include "modes/ptScoring.h"
+#include "modes/scoringServer.h"
 #include "eval.h"
 #include "mode.h"
 #include "xenoption.h"
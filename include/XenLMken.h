@@ -38,6 +38,9 @@
 #include <boost/shared_ptr.hpp>
 #include <boost/make_shared.hpp>
 #include <boost/lexical_cast.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
 
 #include "kenlm/lm/config.hh"
 #include "kenlm/lm/model.hh"
@@ -53,6 +56,8 @@
 #include "xenvocab.h"
 #include "xenoption.h"
 #include "xenresult.h"
+#include "utils/xennuma.h"
+#include "utils/scheduler.h"
 
 
 using namespace boost;
@@ -69,6 +74,20 @@ struct TxtStats {
     uint64_t numsentences;
 };
 
+/**
+ *  @struct BuildPlan
+ *  @brief Settings of a KenLM estimation, derived from the statistics of its corpus
+ */
+struct BuildPlan {
+    std::size_t memory;         //!< Memory given to the estimation sorts
+    std::size_t need;           //!< Memory the estimation needs to sort without spilling
+    std::size_t sortBlock;      //!< Size of the sort blocks
+    std::size_t minBlock;       //!< Minimum size of the chain blocks
+    std::size_t blockCount;     //!< Number of blocks of each chain
+    std::size_t vocabEstimate;  //!< Number of words the vocabulary hash table is sized for
+    std::size_t adderMemory;    //!< Memory of each adder chain of the initial probabilities
+};
+
 /**
  *  @class XenLMken
  *  @brief Class handling KenLM estimation, loading, querying...
@@ -141,6 +160,20 @@ public:
      *  @return the language model file name
      */
     std::string getFileName() const;
+
+    /**
+     *  @fn void setMemory (std::size_t bytes)
+     *  @brief Sets the memory given to the LM estimation (the --mem option by default)
+     *
+     *  @param bytes :  the memory for the estimation sorts
+     */
+    void setMemory(std::size_t bytes);
+    
+    /**
+     *  @fn void releaseCorpus ()
+     *  @brief Drops the Corpus the LM has been estimated from, once it is no longer needed
+     */
+    void releaseCorpus();
     
     /**
      *  @fn TextStats getSentenceStats (std::string sent)
@@ -151,10 +184,74 @@ public:
      */
     TxtStats getSentenceStats(std::string sent);
     
+    /**
+     *  @fn void getBatchStats (const std::vector<std::string> &sents, std::vector<TxtStats> &stats)
+     *  @brief Computes the KenLM stats of several sentences, queried in lockstep
+     *
+     *  Words are mapped to LM ids with their vocabulary buckets prefetched ahead,
+     *  then the sentences are scored by getIdStats. Stats are the same as getSentenceStats ones.
+     *
+     *  @param sents :  the sentences to compute the stats from
+     *  @param stats :  the computed KenLM stats, one per sentence
+     */
+    void getBatchStats(const std::vector<std::string> &sents, std::vector<TxtStats> &stats);
+
+    /**
+     *  @fn void getHashStats (const std::vector<uint64_t> &hashes, const std::vector<uint64_t> &starts, std::vector<TxtStats> &stats)
+     *  @brief Computes the KenLM stats of sentences already tokenized by tokenize
+     *
+     *  Lets several LMs score the same batch without tokenizing it again.
+     *
+     *  @param hashes : the vocabulary hashes of the words, sentence after sentence
+     *  @param starts : the position of the first word of each sentence (plus the word count)
+     *  @param stats :  the computed KenLM stats, one per sentence
+     */
+    void getHashStats(const std::vector<uint64_t> &hashes, const std::vector<uint64_t> &starts, std::vector<TxtStats> &stats);
+
+    /**
+     *  @fn static void tokenize (const std::vector<std::string> &sents, std::vector<uint64_t> &hashes, std::vector<uint64_t> &starts)
+     *  @brief Splits sentences into the vocabulary hashes of their words
+     *
+     *  @param sents :  the sentences to tokenize
+     *  @param hashes : the vocabulary hashes of the words, sentence after sentence
+     *  @param starts : the position of the first word of each sentence (plus the word count)
+     */
+    static void tokenize(const std::vector<std::string> &sents, std::vector<uint64_t> &hashes, std::vector<uint64_t> &starts);
+
+    /**
+     *  @fn static std::size_t buildMemory (boost::shared_ptr<Corpus> ptrCorp, std::size_t budget)
+     *  @brief Estimates the memory an LM estimation needs to sort its n-grams in memory
+     *
+     *  @param ptrCorp :    the Corpus the LM is estimated on
+     *  @param budget :     the whole estimation budget
+     *  @return the memory to give to the estimation, within the budget
+     */
+    static std::size_t buildMemory(boost::shared_ptr<Corpus> ptrCorp, std::size_t budget);
+    
+    /**
+     *  @fn static BuildPlan planBuild (uint64_t tokens, uint64_t lines, uint64_t types, unsigned int order, std::size_t budget)
+     *  @brief Derives the estimation settings from the statistics of the corpus
+     *
+     *  The memory is the one the n-gram sorts of each step and the vocabulary need,
+     *  within the budget: a small corpus does not reserve the whole budget and a large
+     *  one gets all of it before spilling. Blocks and buffers are sized from that memory.
+     *
+     *  @param tokens : the number of tokens of the corpus, 0 if unknown
+     *  @param lines :  the number of lines of the corpus
+     *  @param types :  the number of distinct words of the corpus, 0 if unknown
+     *  @param order :  the LM order
+     *  @param budget : the memory the estimation may use
+     *  @return the estimation settings
+     */
+    static BuildPlan planBuild(uint64_t tokens, uint64_t lines, uint64_t types, unsigned int order, std::size_t budget);
+    
     /**
      *  @fn TextStats getDocumentStats (boost::shared_ptr<Corpus> ptrCorp)
      *  @brief Computes the KenLM stats of a Corpus at a document level
      *
+     *  The Corpus is tokenized once for all LMs and its distinct words are mapped to this LM ids,
+     *  then ranges of lines are scored in parallel and reduced in line order.
+     *
      *  @param ptrCorp :    the Corpus to compute the stats from
      *  @return the computed document-level KenLM stats
      */
@@ -165,11 +262,13 @@ private:
     boost::shared_ptr<XenVocab> ptrVoc;             //!< Shared pointer on the LM Vocabulary (XenVocab)
     boost::shared_ptr<XenResult> ptrXR;             //!< Shared pointer on the LM XenResult file
     lm::ngram::Config config;
-    boost::shared_ptr<lm::ngram::ProbingModel> ptrMdl;
+    std::vector<boost::shared_ptr<lm::ngram::ProbingModel> > models;  //!< The loaded LM, one copy per NUMA node when replicated
+    std::string loadError;                          //!< Error raised by a NUMA node copy loader
+    boost::mutex loadMtx;                           //!< Protects the loader error
     char* textFile;                                 //!< The Corpus file name on disk
     char* lmFile;                                   //!< The LM file name on disk
     unsigned order;                                 //!< The LM order
-    std::string mempc;
+    std::size_t memory;                             //!< The memory given to LM estimation
     std::string temp;
     int pc;                                         //!< The XenResult percentage to take
 
@@ -181,6 +280,65 @@ private:
      *  @return the output name of the language model
      */
     std::string makeLMname(XenOption* opt);
+
+    static const unsigned int vocabAhead = 4;      //!< Number of words the vocabulary buckets are prefetched ahead
+    static const unsigned int docGrain = 1024;     //!< Number of lines per document stats task
+    static const std::size_t minBuildMemory = 64 << 20;    //!< Memory given to the smallest estimation
+    static const std::size_t defaultVocab = 1000000;        //!< Vocabulary estimate when the corpus is unknown
+    static const std::size_t minAdder = 32768;              //!< Smallest adder chain of the initial probabilities
+    static const std::size_t maxAdder = 16 << 20;           //!< Largest adder chain of the initial probabilities
+
+    /**
+     *  @fn void getIdStats (const std::vector<lm::WordIndex> &words, const std::vector<uint64_t> &starts, std::vector<TxtStats> &stats)
+     *  @brief Computes the KenLM stats of sentences given as LM ids, queried in lockstep
+     *
+     *  Groups of sentences advance one word at a time together: the hash buckets
+     *  of each query are prefetched before any of them is probed, so the memory
+     *  stalls of the group overlap.
+     *
+     *  @param words :  the LM ids of the words, sentence after sentence
+     *  @param starts : the position of the first word of each sentence (plus the word count)
+     *  @param stats :  the computed KenLM stats, one per sentence
+     */
+    void getIdStats(const std::vector<lm::WordIndex> &words, const std::vector<uint64_t> &starts, std::vector<TxtStats> &stats);
+
+    /**
+     *  @fn TxtStats getRangeStats (boost::shared_ptr<TokenizedText> ptrTok, const std::vector<lm::WordIndex> &ids, unsigned int first, unsigned int last)
+     *  @brief Computes the summed KenLM stats of a range of tokenized lines
+     *
+     *  @param ptrTok : the tokenized lines
+     *  @param ids :    the LM id of each distinct word of the lines
+     *  @param first :  the first line of the range
+     *  @param last :   the line after the last one
+     *  @return the summed KenLM stats of the range
+     */
+    TxtStats getRangeStats(boost::shared_ptr<TokenizedText> ptrTok, const std::vector<lm::WordIndex> &ids, unsigned int first, unsigned int last);
+
+    /**
+     *  @fn static TxtStats sumStats (const TxtStats &a, const TxtStats &b)
+     *  @brief Sums two KenLM stats
+     *
+     *  @param a :  the first stats
+     *  @param b :  the second stats
+     *  @return the summed stats
+     */
+    static TxtStats sumStats(const TxtStats &a, const TxtStats &b);
+
+    /**
+     *  @fn void loadCopy (int node)
+     *  @brief Loads the copy of the LM placed on a NUMA node, from a thread bound to it
+     *
+     *  @param node :   the NUMA node
+     */
+    void loadCopy(int node);
+
+    /**
+     *  @fn const lm::ngram::ProbingModel& getModel ()
+     *  @brief Accessor to the copy of the LM local to the calling thread
+     *
+     *  @return the node-local LM
+     */
+    const lm::ngram::ProbingModel& getModel();
 };
 
 #endif
@@ -0,0 +1,153 @@
+/**
+ *  @file bitext.h
+ *  @brief Class handling the two sides of a parallel corpus in lockstep
+ *  @author Anthony Rousseau
+ *  @version 2.0.0
+ *  @date 19 October 2026
+ */
+
+
+/*  This file is part of the cross-entropy tool for data selection (XenC)
+ *  aimed at speech recognition and statistical machine translation.
+ *
+ *  Copyright 2013-2016, Anthony Rousseau, LIUM, University of Le Mans, France
+ *
+ *  Development of the XenC tool has been partially funded by the
+ *  European Commission under the MateCat project.
+ *
+ *  The XenC tool is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation
+ *
+ *  This library is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef BITEXT_H_
+#define BITEXT_H_
+
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+
+#include "corpus.h"
+#include "score.h"
+
+/**
+ *  @class Bitext
+ *  @brief Source and target sides of a parallel corpus
+ *
+ *  Both sides are loaded once, on the same slice of their files, and checked
+ *  to hold the same number of lines. Line i of the bitext is then served as
+ *  views on the buffers of both sides, and both sides are cleaned in lockstep.
+ *  The Bitext shares its Corpus objects, it never copies their text.
+ */
+class Bitext {
+public:
+    /**
+     *  @fn Bitext ()
+     *  @brief Default constructor
+     */
+    Bitext();
+    
+    /**
+     *  @fn void initialize (boost::shared_ptr<Corpus> ptrSrc, boost::shared_ptr<Corpus> ptrTrg)
+     *  @brief Initialization function from two already loaded sides
+     *
+     *  @param ptrSrc :     the source side
+     *  @param ptrTrg :     the target side
+     */
+    void initialize(boost::shared_ptr<Corpus> ptrSrc, boost::shared_ptr<Corpus> ptrTrg);
+    
+    /**
+     *  @fn void initialize (boost::shared_ptr<Corpus> ptrSrc, boost::shared_ptr<XenFile> ptrTrgData, std::string lg)
+     *  @brief Initialization function from a loaded source side, loading the target side on the same slice
+     *
+     *  @param ptrSrc :     the source side
+     *  @param ptrTrgData : the target side file
+     *  @param lg :         language of the target side
+     */
+    void initialize(boost::shared_ptr<Corpus> ptrSrc, boost::shared_ptr<XenFile> ptrTrgData, std::string lg);
+    
+    /**
+     *  @fn ~Bitext ()
+     *  @brief Default destructor
+     */
+    ~Bitext();
+    
+    /**
+     *  @fn unsigned int getSize () const
+     *  @brief Accessor to the number of line pairs
+     *
+     *  @return the size of the bitext
+     */
+    unsigned int getSize() const;
+    
+    /**
+     *  @fn StringPiece getSource (int line) const
+     *  @brief Accessor to the source side of a line pair
+     *
+     *  @param line :   the line number
+     *  @return view on the source line
+     */
+    StringPiece getSource(int line) const;
+    
+    /**
+     *  @fn StringPiece getTarget (int line) const
+     *  @brief Accessor to the target side of a line pair
+     *
+     *  @param line :   the line number
+     *  @return view on the target line
+     */
+    StringPiece getTarget(int line) const;
+    
+    /**
+     *  @fn bool isValid (int line) const
+     *  @brief Tells if both sides of a line pair are non-blank
+     *
+     *  @param line :   the line number
+     *  @return true if the line pair is valid
+     */
+    bool isValid(int line) const;
+    
+    /**
+     *  @fn void removeLine (int line)
+     *  @brief Removes a line pair from the output
+     *
+     *  @param line :   the line number
+     */
+    void removeLine(int line);
+    
+    /**
+     *  @fn boost::shared_ptr<Corpus> getPtrSource () const
+     *  @brief Accessor to the source side
+     *
+     *  @return the source Corpus
+     */
+    boost::shared_ptr<Corpus> getPtrSource() const;
+    
+    /**
+     *  @fn boost::shared_ptr<Corpus> getPtrTarget () const
+     *  @brief Accessor to the target side
+     *
+     *  @return the target Corpus
+     */
+    boost::shared_ptr<Corpus> getPtrTarget() const;
+    
+private:
+    boost::shared_ptr<Corpus> ptrSource;    //!< Shared pointer on the source side
+    boost::shared_ptr<Corpus> ptrTarget;    //!< Shared pointer on the target side
+    
+    /**
+     *  @fn void check ()
+     *  @brief Checks that both sides hold the same lines of files of the same length
+     */
+    void check();
+};
+
+#endif
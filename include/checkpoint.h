@@ -0,0 +1,173 @@
+/**
+ *  @file checkpoint.h
+ *  @brief Class handling the durable checkpoints of long scoring runs
+ *  @author Anthony Rousseau
+ *  @version 2.0.0
+ *  @date 19 October 2026
+ */
+
+/*  This file is part of the cross-entropy tool for data selection (XenC)
+ *  aimed at speech recognition and statistical machine translation.
+ *
+ *  Copyright 2013-2016, Anthony Rousseau, LIUM, University of Le Mans, France
+ *
+ *  Development of the XenC tool has been partially funded by the
+ *  European Commission under the MateCat project.
+ *
+ *  The XenC tool is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation
+ *
+ *  This library is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef CHECKPOINT_H_
+#define CHECKPOINT_H_
+
+#include <stdint.h>
+#include <map>
+
+#include <boost/thread/mutex.hpp>
+
+#include "utils/common.h"
+
+/**
+ *  @struct CkptEntry
+ *  @brief A completed stage: the fingerprint of its inputs and the file it produced
+ */
+struct CkptEntry {
+    uint64_t fingerprint;   //!< Fingerprint of the stage inputs and options
+    uint64_t size;          //!< Size of the produced file
+    std::string path;       //!< The file produced by the stage
+};
+
+/**
+ *  @class Checkpoint
+ *  @brief Class handling the durable checkpoints of long scoring runs
+ *
+ *  Heavy stages (vocabularies, language model estimations, perplexity vectors)
+ *  are recorded in a manifest next to the outputs once their file is complete.
+ *  Each entry carries a fingerprint of the stage inputs and options, so a
+ *  restarted run only reuses the stages whose inputs did not change.
+ *  Files left over by an interrupted stage are never trusted.
+ */
+class Checkpoint {
+public:
+    /**
+     *  @fn Checkpoint ()
+     *  @brief Default constructor
+     */
+    Checkpoint();
+
+    /**
+     *  @fn ~Checkpoint ()
+     *  @brief Default destructor
+     */
+    ~Checkpoint();
+
+    /**
+     *  @fn bool isDone (std::string stage, uint64_t fp)
+     *  @brief Tells if a stage has been completed with the same inputs
+     *
+     *  @param stage :  the stage name
+     *  @param fp :     the fingerprint of the stage inputs
+     *  @return true if the stage can be skipped
+     */
+    bool isDone(std::string stage, uint64_t fp);
+
+    /**
+     *  @fn void markDone (std::string stage, uint64_t fp, std::string path)
+     *  @brief Records a completed stage in the manifest
+     *
+     *  @param stage :  the stage name
+     *  @param fp :     the fingerprint of the stage inputs
+     *  @param path :   the file produced by the stage
+     */
+    void markDone(std::string stage, uint64_t fp, std::string path);
+
+    /**
+     *  @fn uint64_t fileFingerprint (std::string path)
+     *  @brief Computes (once per run) the content fingerprint of a file
+     *
+     *  @param path :   the file to fingerprint
+     *  @return the fingerprint
+     */
+    uint64_t fileFingerprint(std::string path);
+
+    /**
+     *  @fn std::string getPath (std::string name) const
+     *  @brief Computes the path of a checkpoint data file
+     *
+     *  @param name :   the data file name suffix
+     *  @return the path of the checkpoint data file
+     */
+    std::string getPath(std::string name) const;
+
+    /**
+     *  @fn static uint64_t hashString (std::string str, uint64_t seed)
+     *  @brief Chains a string into a fingerprint
+     *
+     *  @param str :    the string to hash
+     *  @param seed :   the fingerprint to chain with
+     *  @return the chained fingerprint
+     */
+    static uint64_t hashString(std::string str, uint64_t seed);
+
+    /**
+     *  @fn static uint64_t hashFile (std::string path, uint64_t seed)
+     *  @brief Chains the content of a file into a fingerprint
+     *
+     *  @param path :   the file to hash
+     *  @param seed :   the fingerprint to chain with
+     *  @return the chained fingerprint
+     */
+    static uint64_t hashFile(std::string path, uint64_t seed);
+
+    /**
+     *  @fn static void dumpScores (const std::vector<double> &vec, std::string path)
+     *  @brief Writes a vector of scores to a binary file, atomically
+     *
+     *  @param vec :    the scores to write
+     *  @param path :   the file to write to
+     */
+    static void dumpScores(const std::vector<double> &vec, std::string path);
+
+    /**
+     *  @fn static bool loadScores (std::vector<double> &vec, std::string path)
+     *  @brief Reads a vector of scores from a binary file
+     *
+     *  @param vec :    the vector to fill, its size must match the file
+     *  @param path :   the file to read from
+     *  @return true if the file has been fully read
+     */
+    static bool loadScores(std::vector<double> &vec, std::string path);
+
+private:
+    bool loaded;                                    //!< Indicates the manifest has been read
+    std::string fileName;                           //!< The manifest file name
+    std::map<std::string, CkptEntry> stages;        //!< Completed stages
+    std::map<std::string, uint64_t> fileFps;        //!< Content fingerprints computed in this run
+    uint64_t written;                               //!< Number of stage outputs written, invalidating fingerprints being computed
+    boost::mutex mtx;                               //!< Protects the manifest and fingerprint cache
+
+    /**
+     *  @fn void load ()
+     *  @brief Reads the manifest if needed
+     */
+    void load();
+
+    /**
+     *  @fn void save ()
+     *  @brief Writes the manifest atomically
+     */
+    void save();
+};
+
+#endif
@@ -33,13 +33,18 @@
 
 #include <boost/shared_ptr.hpp>
 #include <boost/make_shared.hpp>
+#include <boost/thread/mutex.hpp>
+#include <deque>
+#include <stdint.h>
 
 #include "utils/common.h"
+#include "utils/tokenizer.h"
 #include "xenfile.h"
 
 using namespace boost;
 
 class XenIO;    // Forward declaration
+struct IngestShard;     // Forward declaration
 
 /**
  *  @class Corpus
@@ -47,6 +52,11 @@ class XenIO;    // Forward declaration
  *
  *  This class handles the corpus used in XenC, providing means to get lines of text,
  *  size, language, token counts...
+ *
+ *  The text is ingested in a single parallel sweep: the file is kept as one buffer
+ *  with line offsets, and each thread computes the token counts, blank lines
+ *  and (if requested) word counts of its part of the buffer.
+ *  Compressed files are ingested block by block while they are being decompressed.
  */
 class Corpus {
 public:
@@ -65,6 +75,31 @@ public:
      */
     void initialize(boost::shared_ptr<XenFile> ptrData, std::string lg);
     
+    /**
+     *  @fn void initialize (boost::shared_ptr<XenFile> ptrData, std::string lg, bool countWords)
+     *  @brief Initialization function from an already instanciated XenFile
+     *
+     *  @param ptrData :    shared pointer on a XenFile representing the corpus on disk
+     *  @param lg :         language of the corpus
+     *  @param countWords : true to also count words during ingestion (the corpus feeds a vocabulary)
+     */
+    void initialize(boost::shared_ptr<XenFile> ptrData, std::string lg, bool countWords);
+    
+    /**
+     *  @fn void initialize (boost::shared_ptr<XenFile> ptrData, std::string lg, bool countWords, int shard, int shards)
+     *  @brief Initialization function loading only one slice of the file
+     *
+     *  The whole file is streamed once for its token counts, so that the sample
+     *  statistics stay those of the file, then only the lines of the slice are loaded.
+     *
+     *  @param ptrData :    shared pointer on a XenFile representing the corpus on disk
+     *  @param lg :         language of the corpus
+     *  @param countWords : true to also count words during ingestion (the corpus feeds a vocabulary)
+     *  @param shard :      index (from 1) of the slice to load
+     *  @param shards :     number of slices of the file, 0 or 1 to load it whole
+     */
+    void initialize(boost::shared_ptr<XenFile> ptrData, std::string lg, bool countWords, int shard, int shards);
+    
     /**
      *  @fn void initialize (std::string filePath, std::string lg)
      *  @brief Initialization function from a string containing a valid path/file name
@@ -97,6 +132,15 @@ public:
      */
     std::string getLine(int line);
     
+    /**
+     *  @fn StringPiece getView (int line) const
+     *  @brief Accessor to a line of text from the Corpus, without copying it
+     *
+     *  @param line : integer representing the line number
+     *  @return view on the text line, valid as long as the Corpus
+     */
+    StringPiece getView(int line) const;
+    
     /**
      *  @fn unsigned int getSize () const
      *  @brief Accessor to the size of the Corpus
@@ -130,6 +174,40 @@ public:
      */
     int getWC() const;
     
+    /**
+     *  @fn int getTokens (int line) const
+     *  @brief Accessor to the number of tokens of a line
+     *
+     *  @param line : integer representing the line number
+     *  @return the token count of the line
+     */
+    int getTokens(int line) const;
+    
+    /**
+     *  @fn bool isValid (int line) const
+     *  @brief Tells if a line holds any non-blank character
+     *
+     *  @param line : integer representing the line number
+     *  @return false if the line is empty or blank
+     */
+    bool isValid(int line) const;
+    
+    /**
+     *  @fn boost::shared_ptr<WordCounts> getWordCounts () const
+     *  @brief Accessor to the word counts computed during ingestion
+     *
+     *  @return the word counts, null if they have not been requested
+     */
+    boost::shared_ptr<WordCounts> getWordCounts() const;
+    
+    /**
+     *  @fn boost::shared_ptr<TokenizedText> getTokenized ()
+     *  @brief Accessor to the tokenized Corpus, tokenized on first call
+     *
+     *  @return the tokenized lines
+     */
+    boost::shared_ptr<TokenizedText> getTokenized();
+    
     /**
      *  @fn void removeLine (int line)
      *  @brief Put the printing status of a line to false
@@ -138,27 +216,136 @@ public:
      */
     void removeLine(int line);
     
+    /**
+     *  @fn bool isSlice () const
+     *  @brief Tells if only a slice of the file is loaded
+     *
+     *  @return true if the Corpus is a slice of its file
+     */
+    bool isSlice() const;
+    
+    /**
+     *  @fn int getShard () const
+     *  @brief Accessor to the index of the loaded slice of the file
+     *
+     *  @return the index (from 1) of the slice
+     */
+    int getShard() const;
+    
+    /**
+     *  @fn int getShards () const
+     *  @brief Accessor to the number of slices of the file
+     *
+     *  @return the number of slices, 0 when loaded whole
+     */
+    int getShards() const;
+    
+    /**
+     *  @fn unsigned int getFirstLine () const
+     *  @brief Accessor to the position in the file of the first loaded line
+     *
+     *  @return the file line number of the line 0 of the Corpus
+     */
+    unsigned int getFirstLine() const;
+    
+    /**
+     *  @fn unsigned int getFileSize () const
+     *  @brief Accessor to the number of lines of the whole file
+     *
+     *  @return the number of lines of the file
+     */
+    unsigned int getFileSize() const;
+    
+    /**
+     *  @fn int getFileWC () const
+     *  @brief Accessor to the number of tokens of the whole file
+     *
+     *  @return the token count of the file
+     */
+    int getFileWC() const;
+    
+    /**
+     *  @fn int getFileTokens (int line) const
+     *  @brief Accessor to the number of tokens of a line of the whole file
+     *
+     *  @param line : integer representing the file line number
+     *  @return the token count of the line
+     */
+    int getFileTokens(int line) const;
+    
+    /**
+     *  @fn std::size_t getMemory () const
+     *  @brief Accessor to the memory held by the loaded lines
+     *
+     *  @return the size of the text buffer and of the per-line vectors, in bytes
+     */
+    std::size_t getMemory() const;
+    
 private:
     std::string dir;        //!< String representing the Corpus directory
     std::string lang;       //!< String representing the Corpus language
     boost::shared_ptr<XenFile> ptrFile;     //!< Shared pointer on a XenFile wrapping the reference to the XenFile of the Corpus
-    boost::shared_ptr<std::vector<std::string> > ptrText;     //!< Shared pointer on a vector of strings holding the Corpus text
+    boost::shared_ptr<std::vector<char> > ptrText;          //!< Shared pointer on the Corpus text buffer (every line ends with a newline)
+    boost::shared_ptr<std::vector<uint64_t> > ptrOffsets;   //!< Shared pointer on the line start offsets (plus the buffer size)
+    boost::shared_ptr<std::vector<int> > ptrToks;           //!< Shared pointer on the token count of each line
+    boost::shared_ptr<std::vector<bool> > ptrValid;         //!< Shared pointer on the validity (non-blank) bitmap of the lines
+    boost::shared_ptr<WordCounts> ptrCounts;                //!< Shared pointer on the word counts (null if not requested)
+    boost::shared_ptr<TokenizedText> ptrTokenized;          //!< Shared pointer on the tokenized lines (null until requested)
+    boost::shared_ptr<boost::mutex> ptrTokMtx;              //!< Shared pointer on the mutex protecting the tokenization
     boost::shared_ptr<std::vector<int> > ptrPrint;      //!< Shared pointer on a vector of integers holding the printing status of the text
     int wc;                 //!< Integer representing the tokens count
+    int shard;              //!< Index (from 1) of the loaded slice of the file
+    int shards;             //!< Number of slices of the file (0 when loaded whole)
+    unsigned int firstLine; //!< File line number of the first loaded line
+    boost::shared_ptr<std::vector<int> > ptrFileToks;       //!< Shared pointer on the token count of each line of the whole file
+    int fileWC;             //!< Integer representing the tokens count of the whole file
     
     /**
-     *  @fn int wordCount ()
-     *  @brief Counts the tokens in the Corpus text
+     *  @fn void load (bool countWords)
+     *  @brief Checks the Corpus file and ingests it
      *
-     *  @return integer representing the token count
+     *  @param countWords : true to also count words
      */
-    int wordCount();
+    void load(bool countWords);
     
     /**
-     *  @fn void loadText ()
-     *  @brief Loads the Corpus text into the vector
+     *  @fn void loadText (bool countWords)
+     *  @brief Reads the Corpus text and ingests it in one parallel sweep
+     *
+     *  @param countWords : true to also count words
+     */
+    void loadText(bool countWords);
+    
+    /**
+     *  @fn void loadSlice ()
+     *  @brief Streams the file for its token counts and reads the lines of the slice
+     */
+    void loadSlice();
+    
+    /**
+     *  @fn void loadStream (bool countWords)
+     *  @brief Reads a compressed Corpus from a background thread and ingests its blocks as they arrive
+     *
+     *  @param countWords : true to also count words
+     */
+    void loadStream(bool countWords);
+    
+    /**
+     *  @fn void ingest (bool countWords)
+     *  @brief Ingests the text buffer in one parallel sweep
+     *
+     *  @param countWords : true to also count words
+     */
+    void ingest(bool countWords);
+    
+    /**
+     *  @fn void gather (std::deque<IngestShard> &shards, bool countWords)
+     *  @brief Gathers the ingested parts of the text, in line order
+     *
+     *  @param shards :     the ingested parts of the text
+     *  @param countWords : true to also gather the word counts
      */
-    void loadText();
+    void gather(std::deque<IngestShard> &shards, bool countWords);
 };
 
 #endif
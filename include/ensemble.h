@@ -0,0 +1,166 @@
+/**
+ *  @file ensemble.h
+ *  @brief Class handling the ensemble of out-of-domain sample LMs used by mean scoring
+ *  @author Anthony Rousseau
+ *  @version 2.0.0
+ *  @date 19 October 2026
+ */
+
+/*  This file is part of the cross-entropy tool for data selection (XenC)
+ *  aimed at speech recognition and statistical machine translation.
+ *
+ *  Copyright 2013-2016, Anthony Rousseau, LIUM, University of Le Mans, France
+ *
+ *  Development of the XenC tool has been partially funded by the
+ *  European Commission under the MateCat project.
+ *
+ *  The XenC tool is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation
+ *
+ *  This library is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef ENSEMBLE_H_
+#define ENSEMBLE_H_
+
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+
+#include "utils/scheduler.h"
+#include "corpus.h"
+#include "xenvocab.h"
+#include "XenLMken.h"
+#include "ppl.h"
+
+using namespace boost;
+
+/**
+ *  @fn void taskCalcXEBatch (boost::shared_ptr<std::vector<int> > ptrLines, boost::shared_ptr<std::vector<std::string> > ptrSents, boost::shared_ptr<std::vector<double> > ptrXE, const std::vector<boost::shared_ptr<XenLMken> > *members)
+ *  @brief Thread-safe mean cross-entropy computation function for a batch of lines
+ *
+ *  The batch is tokenized once, then scored in lockstep by every member of the ensemble.
+ *
+ *  @param ptrLines :       shared pointer on the line numbers to compute cross-entropy for
+ *  @param ptrSents :       shared pointer on the text lines to compute cross-entropy for
+ *  @param ptrXE :          shared pointer on the vector of doubles containing the mean cross-entropy scores
+ *  @param members :        the language models of the ensemble
+ */
+void taskCalcXEBatch(boost::shared_ptr<std::vector<int> > ptrLines, boost::shared_ptr<std::vector<std::string> > ptrSents, boost::shared_ptr<std::vector<double> > ptrXE, const std::vector<boost::shared_ptr<XenLMken> > *members);
+
+/**
+ *  @class LMEnsemble
+ *  @brief Class handling the ensemble of out-of-domain sample LMs used by mean scoring
+ *
+ *  The first member is the out-of-domain LM of the mode, the others are estimated
+ *  on further random samples of the out-of-domain corpus with the same vocabulary.
+ *  Members are estimated concurrently, each holding a share of the --mem budget,
+ *  and the corpus is scored by all of them in a single pass which averages their cross-entropies.
+ */
+class LMEnsemble {
+public:
+    /**
+     *  @fn LMEnsemble ()
+     *  @brief Default constructor
+     */
+    LMEnsemble();
+
+    /**
+     *  @fn ~LMEnsemble ()
+     *  @brief Default destructor
+     */
+    ~LMEnsemble();
+
+    /**
+     *  @fn void initialize (boost::shared_ptr<XenLMken> ptrFirst, boost::shared_ptr<Corpus> ptrSample)
+     *  @brief Initialization function from the out-of-domain LM of the mode
+     *
+     *  @param ptrFirst :   the out-of-domain LM, already initialized
+     *  @param ptrSample :  the sample it is estimated on (null if it is loaded from a file)
+     */
+    void initialize(boost::shared_ptr<XenLMken> ptrFirst, boost::shared_ptr<Corpus> ptrSample);
+
+    /**
+     *  @fn void addMember (boost::shared_ptr<Corpus> ptrSample, boost::shared_ptr<XenVocab> ptrVoc)
+     *  @brief Adds a member to estimate on a sample of the out-of-domain corpus
+     *
+     *  @param ptrSample :  the out-of-domain corpus sample
+     *  @param ptrVoc :     the vocabulary shared by all members
+     */
+    void addMember(boost::shared_ptr<Corpus> ptrSample, boost::shared_ptr<XenVocab> ptrVoc);
+
+    /**
+     *  @fn void createLMs ()
+     *  @brief Estimates the members concurrently within the --mem budget
+     */
+    void createLMs();
+
+    /**
+     *  @fn void calcXECorpus (boost::shared_ptr<Corpus> ptrCorp, boost::shared_ptr<ScoreStore> ptrStore)
+     *  @brief Computes the mean cross-entropy of a Corpus sentence by sentence, in a single pass
+     *
+     *  @param ptrCorp :    the Corpus to score
+     *  @param ptrStore :   the score store indexing the Corpus, whose lines are not scored again (null to score all lines)
+     */
+    void calcXECorpus(boost::shared_ptr<Corpus> ptrCorp, boost::shared_ptr<ScoreStore> ptrStore);
+
+    /**
+     *  @fn double getXE (int n)
+     *  @brief Accessor to the nth mean cross-entropy score
+     *
+     *  @param n :      integer indicating the position of the score to return
+     *  @return double representing the nth mean cross-entropy score
+     */
+    double getXE(int n);
+
+    /**
+     *  @fn unsigned int getSize () const
+     *  @brief Accessor to the number of members
+     *
+     *  @return the number of language models of the ensemble
+     */
+    unsigned int getSize() const;
+
+    /**
+     *  @fn std::string getFileName (unsigned int m) const
+     *  @brief Accessor to the file name of a member
+     *
+     *  @param m :      the member position
+     *  @return the language model file name
+     */
+    std::string getFileName(unsigned int m) const;
+
+    /**
+     *  @fn boost::shared_ptr<XenLMken> getLM (unsigned int m) const
+     *  @brief Accessor to a member
+     *
+     *  @param m :      the member position
+     *  @return the language model
+     */
+    boost::shared_ptr<XenLMken> getLM(unsigned int m) const;
+
+private:
+    std::vector<boost::shared_ptr<XenLMken> > members;  //!< The language models of the ensemble
+    std::vector<boost::shared_ptr<Corpus> > samples;    //!< The corpus each member is estimated on (null if not estimated)
+    std::vector<std::string> errors;                    //!< The error raised by each member estimation, if any
+    boost::shared_ptr<std::vector<double> > ptrXE;      //!< Shared pointer on the mean cross-entropy scores
+
+    /**
+     *  @fn void buildMember (unsigned int m, std::size_t memory, MemoryBudget* budget)
+     *  @brief Estimates a member on its own thread, then gives back its memory to the budget
+     *
+     *  @param m :          the member position
+     *  @param memory :     the memory held in the budget by the estimation
+     *  @param budget :     the estimation memory budget
+     */
+    void buildMember(unsigned int m, std::size_t memory, MemoryBudget* budget);
+};
+
+#endif
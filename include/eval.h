@@ -35,32 +35,61 @@
 #include <boost/make_shared.hpp>
 
 #include "utils/common.h"
-#include "utils/threadpool.hpp"
+#include "utils/scheduler.h"
 #include "corpus.h"
 #include "xenoption.h"
 #include "XenLMken.h"
 #include "ppl.h"
 #include "xenresult.h"
 #include "xenvocab.h"
+#include "evalcache.h"
 
 class StaticData;   /// Forward declaration
 
-using namespace boost::threadpool;
 using namespace boost;
 
 typedef std::map<int, double, std::greater<int> > EvalMap;  //!< descending ordered map on integers as keys and doubles as values
 
 /**
- *  @fn void taskEval(int pc, boost::shared_ptr<Corpus> ptrCorp, boost::shared_ptr<XenVocab> ptrVoc, boost::shared_ptr<Corpus> ptrDevCorp, boost::shared_ptr<EvalMap> ptrDist)
- *  @brief Thread-safe evaluation function
+ *  @struct EvalJob
+ *  @brief One evaluated part of the selection result, carried through the eval pipeline
+ */
+struct EvalJob {
+    int pc;                                 //!< The percentage of the scored out-of-domain corpus taken
+    std::string partName;                   //!< The part file
+    boost::shared_ptr<Corpus> ptrCorp;      //!< The part Corpus
+    boost::shared_ptr<XenLMken> ptrLM;      //!< The language model estimated on the part
+    std::size_t memory;                     //!< The memory held in the budget by the part lines and the estimation
+    double ppl;                             //!< The development set perplexity
+    std::string error;                      //!< The error raised by the estimation, if any
+};
+
+/**
+ *  @fn void taskEvalBuild (boost::shared_ptr<EvalJob> ptrJob, boost::shared_ptr<XenVocab> ptrVoc, boost::shared_ptr<Corpus> ptrDevCorp, MemoryBudget* budget, TaskGroup* scoring)
+ *  @brief Estimation stage of the eval pipeline, run on its own thread
+ *
+ *  Drops the part lines and gives back its memory to the budget once the language model is estimated,
+ *  then hands the development set scoring over to the scheduler.
+ *  Failures are stored in ptrJob->error instead of being thrown.
  *
- *  @param pc :         integer representing the percentage of the scored out-of-domain corpus to take
- *  @param ptrCorp :      shared pointer on the Corpus object representing the part of selection result file
+ *  @param ptrJob :     shared pointer on the evaluated part
  *  @param ptrVoc :     shared pointer on the XenVocab object representing the vocabulary to use for eval
  *  @param ptrDevCorp : shared pointer on the Corpus object representing the development set
- *  @param ptrDist :    shared pointer on the EvalMap type containing the evaluation scores
+ *  @param budget :     the estimation memory budget, already holding ptrJob->memory
+ *  @param scoring :    the group of the scoring tasks
+ */
+void taskEvalBuild(boost::shared_ptr<EvalJob> ptrJob, boost::shared_ptr<XenVocab> ptrVoc, boost::shared_ptr<Corpus> ptrDevCorp, MemoryBudget* budget, TaskGroup* scoring);
+
+/**
+ *  @fn void taskEvalScore (boost::shared_ptr<EvalJob> ptrJob, boost::shared_ptr<Corpus> ptrDevCorp)
+ *  @brief Scoring stage of the eval pipeline, run on the scheduler
+ *
+ *  Failures are stored in ptrJob->error, the language model is removed either way.
+ *
+ *  @param ptrJob :     shared pointer on the evaluated part
+ *  @param ptrDevCorp : shared pointer on the Corpus object representing the development set
  */
-void taskEval(int pc, boost::shared_ptr<Corpus> ptrCorp, boost::shared_ptr<XenVocab> ptrVoc, boost::shared_ptr<Corpus> ptrDevCorp, boost::shared_ptr<EvalMap> ptrDist);
+void taskEvalScore(boost::shared_ptr<EvalJob> ptrJob, boost::shared_ptr<Corpus> ptrDevCorp);
 
 /**
  *  @class Eval
@@ -68,8 +97,10 @@ void taskEval(int pc, boost::shared_ptr<Corpus> ptrCorp, boost::shared_ptr<XenVo
  *
  *  This class handles the evaluation procedure in XenC, providing mean to perform eval, best point,
  *  and getting the results.
- *  It uses threads extensively, so please watch your memory usage since there is some memory leaks
- *  in SRILM.
+ *  Evaluation is a pipeline: the main thread writes and loads the next part
+ *  while the previous ones are estimated, estimations run on their own threads
+ *  within the --mem budget, and development set scoring runs on the scheduler.
+ *  Parts already evaluated by any run are taken from the EvalCache.
  */
 class Eval {
 public:
@@ -126,6 +157,7 @@ public:
     
 private:
     boost::shared_ptr<EvalMap> ptrDist;     //!< Shared pointer on a EvalMap wrapping the reference to the map containing the evaluation results */
+    boost::shared_ptr<EvalCache> ptrCache;  //!< Shared pointer on the EvalCache of the sorted output, set up by the first doEval() */
 };
 
 #endif
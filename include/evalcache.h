@@ -0,0 +1,137 @@
+/**
+ *  @file evalcache.h
+ *  @brief Class handling the content-addressed cache of evaluation perplexities
+ *  @author Anthony Rousseau
+ *  @version 2.0.0
+ *  @date 19 October 2026
+ */
+
+
+/*  This file is part of the cross-entropy tool for data selection (XenC)
+ *  aimed at speech recognition and statistical machine translation.
+ *
+ *  Copyright 2013-2016, Anthony Rousseau, LIUM, University of Le Mans, France
+ *
+ *  Development of the XenC tool has been partially funded by the
+ *  European Commission under the MateCat project.
+ *
+ *  The XenC tool is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation
+ *
+ *  This library is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef EVALCACHE_H_
+#define EVALCACHE_H_
+
+#include <stdint.h>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/unordered_map.hpp>
+
+#include "corpus.h"
+#include "xenvocab.h"
+
+using namespace boost;
+
+/**
+ *  @struct EvalPoint
+ *  @brief A cached development set perplexity and the key of the evaluation it belongs to
+ */
+struct EvalPoint {
+    uint64_t key;       //!< The evaluation key (sorted output, percentage, dev set, vocab and order)
+    double ppl;         //!< The development set perplexity
+};
+
+/**
+ *  @class EvalCache
+ *  @brief Class handling the content-addressed cache of evaluation perplexities
+ *
+ *  This class keeps the development set perplexity of every evaluated part in a
+ *  binary file shared by all runs, keyed by the contents of the sorted output,
+ *  the percentage, the contents of the development set and vocabulary, and the LM order.
+ *  Any later evaluation or best point refinement, whatever its output name, step
+ *  or maximum percentage, reuses the points already computed instead of estimating them again.
+ */
+class EvalCache {
+public:
+    /**
+     *  @fn EvalCache ()
+     *  @brief Default constructor
+     */
+    EvalCache();
+
+    /**
+     *  @fn ~EvalCache ()
+     *  @brief Default destructor
+     */
+    ~EvalCache();
+
+    /**
+     *  @fn void initialize (boost::shared_ptr<XenFile> ptrSorted, boost::shared_ptr<Corpus> ptrDevCorp, boost::shared_ptr<XenVocab> ptrVoc)
+     *  @brief Computes the key of the evaluation and loads the cache
+     *
+     *  @param ptrSorted :  shared pointer on the XenFile object representing the sorted output
+     *  @param ptrDevCorp : shared pointer on the Corpus object representing the development set
+     *  @param ptrVoc :     shared pointer on the XenVocab object representing the vocabulary to use for eval
+     */
+    void initialize(boost::shared_ptr<XenFile> ptrSorted, boost::shared_ptr<Corpus> ptrDevCorp, boost::shared_ptr<XenVocab> ptrVoc);
+
+    /**
+     *  @fn bool find (int pc, double &ppl) const
+     *  @brief Looks up an already evaluated percentage
+     *
+     *  @param pc :     the percentage of the sorted output
+     *  @param ppl :    set to the cached perplexity if found
+     *  @return true if the percentage has already been evaluated
+     */
+    bool find(int pc, double &ppl) const;
+
+    /**
+     *  @fn void add (int pc, double ppl)
+     *  @brief Adds an evaluated percentage to the cache (written by save())
+     *
+     *  @param pc :     the percentage of the sorted output
+     *  @param ppl :    the development set perplexity
+     */
+    void add(int pc, double ppl);
+
+    /**
+     *  @fn void save ()
+     *  @brief Writes the cache, merged with the points other runs have written since it was loaded
+     *
+     *  The merge and rename are serialized between runs by a lock on the cache file name plus ".lock".
+     */
+    void save();
+
+private:
+    std::string fileName;                                   //!< The eval cache file name
+    uint64_t fingerprint;                                   //!< Fingerprint of the sorted output, dev set, vocabulary and order
+    boost::unordered_map<uint64_t, double> points;          //!< Cached perplexities by evaluation key
+
+    /**
+     *  @fn uint64_t getKey (int pc) const
+     *  @brief Computes the key of a percentage of the current evaluation
+     *
+     *  @param pc :     the percentage of the sorted output
+     *  @return the key
+     */
+    uint64_t getKey(int pc) const;
+
+    /**
+     *  @fn void load ()
+     *  @brief Merges the points of the cache file into the cache, if the file exists
+     */
+    void load();
+};
+
+#endif
@@ -0,0 +1,148 @@
+/**
+ *  @file factoredppl.h
+ *  @brief Class handling the joint surface and stem cross-entropy computations
+ *  @author Anthony Rousseau
+ *  @version 2.0.0
+ *  @date 19 October 2026
+ */
+
+/*  This file is part of the cross-entropy tool for data selection (XenC)
+ *  aimed at speech recognition and statistical machine translation.
+ *
+ *  Copyright 2013-2016, Anthony Rousseau, LIUM, University of Le Mans, France
+ *
+ *  Development of the XenC tool has been partially funded by the
+ *  European Commission under the MateCat project.
+ *
+ *  The XenC tool is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation
+ *
+ *  This library is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef FACTOREDPPL_H_
+#define FACTOREDPPL_H_
+
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+
+#include "utils/scheduler.h"
+#include "utils/linereader.h"
+#include "corpus.h"
+#include "xenfile.h"
+#include "XenLMken.h"
+#include "ppl.h"
+
+using namespace boost;
+
+/**
+ *  @struct FactoredLMs
+ *  @brief The language models a factored corpus is scored with
+ */
+struct FactoredLMs {
+    boost::shared_ptr<XenLMken> ptrInLM;                    //!< The in-domain surface LM
+    std::vector<boost::shared_ptr<XenLMken> > outLMs;       //!< The out-of-domain surface LMs (averaged, several with --mean)
+    boost::shared_ptr<XenLMken> ptrInStemLM;                //!< The in-domain stem LM
+    boost::shared_ptr<XenLMken> ptrOutStemLM;               //!< The out-of-domain stem LM
+};
+
+/**
+ *  @fn void taskCalcFactoredBatch (boost::shared_ptr<std::vector<int> > ptrLines, boost::shared_ptr<std::vector<std::string> > ptrSents, boost::shared_ptr<std::vector<std::string> > ptrStems, boost::shared_ptr<std::vector<double> > ptrXE, const FactoredLMs* lms)
+ *  @brief Thread-safe joint cross-entropy computation function for a batch of lines and their stems
+ *
+ *  @param ptrLines :       shared pointer on the line numbers to compute cross-entropy for
+ *  @param ptrSents :       shared pointer on the surface lines
+ *  @param ptrStems :       shared pointer on the stem lines
+ *  @param ptrXE :          shared pointer on the vector of doubles containing the cross-entropy differences
+ *  @param lms :            the language models to score with
+ */
+void taskCalcFactoredBatch(boost::shared_ptr<std::vector<int> > ptrLines, boost::shared_ptr<std::vector<std::string> > ptrSents, boost::shared_ptr<std::vector<std::string> > ptrStems, boost::shared_ptr<std::vector<double> > ptrXE, const FactoredLMs* lms);
+
+/**
+ *  @class FactoredPPL
+ *  @brief Class handling the joint surface and stem cross-entropy computations
+ *
+ *  The out-of-domain stem file is streamed in lockstep with the surface Corpus
+ *  instead of being loaded, and its alignment with the surface lines is checked on the way.
+ *  Each line is scored by the surface and stem language models in the same sweep,
+ *  giving its in-domain minus out-of-domain cross-entropy, surface and stem summed.
+ */
+class FactoredPPL {
+public:
+    /**
+     *  @fn FactoredPPL ()
+     *  @brief Default constructor
+     */
+    FactoredPPL();
+
+    /**
+     *  @fn ~FactoredPPL ()
+     *  @brief Default destructor
+     */
+    ~FactoredPPL();
+
+    /**
+     *  @fn void initialize (boost::shared_ptr<Corpus> ptrCorp, boost::shared_ptr<XenFile> ptrStemFile, const FactoredLMs &lms)
+     *  @brief Initialization function from a surface Corpus, its stem file and the language models
+     *
+     *  @param ptrCorp :        the surface Corpus to score
+     *  @param ptrStemFile :    the stem file aligned with the Corpus
+     *  @param lms :            the language models to score with
+     */
+    void initialize(boost::shared_ptr<Corpus> ptrCorp, boost::shared_ptr<XenFile> ptrStemFile, const FactoredLMs &lms);
+
+    /**
+     *  @fn void calcXECorpus (boost::shared_ptr<ScoreStore> ptrStore)
+     *  @brief Computes the cross-entropy differences of the Corpus sentence by sentence, in a single pass
+     *
+     *  @param ptrStore :   the score store indexing the Corpus, whose lines are not scored again (null to score all lines)
+     */
+    void calcXECorpus(boost::shared_ptr<ScoreStore> ptrStore);
+
+    /**
+     *  @fn double getXE (int n)
+     *  @brief Accessor to the nth cross-entropy difference (surface plus stem)
+     *
+     *  @param n :      integer indicating the position of the score to return
+     *  @return double representing the nth cross-entropy difference
+     */
+    double getXE(int n);
+
+private:
+    boost::shared_ptr<Corpus> ptrCorp;                  //!< Shared pointer on the surface Corpus
+    boost::shared_ptr<XenFile> ptrStemFile;             //!< Shared pointer on the stem file
+    FactoredLMs lms;                                    //!< The language models to score with
+    boost::shared_ptr<std::vector<double> > ptrXE;      //!< Shared pointer on the cross-entropy differences
+    LineReader stems;                                   //!< The reader of the stem file, during a pass
+    unsigned int misaligned;                            //!< Number of stem lines without as many words as their surface line
+    unsigned int firstMisaligned;                       //!< The first misaligned line (1-based)
+
+    static const std::size_t readAhead = 64 << 20;      //!< Memory of the batches read ahead of the scoring
+
+    /**
+     *  @fn std::vector<std::string> getFileNames () const
+     *  @brief Accessor to the file names of all the language models
+     *
+     *  @return the language model file names
+     */
+    std::vector<std::string> getFileNames() const;
+
+    /**
+     *  @fn void readStem (unsigned int i, std::string &stem)
+     *  @brief Reads the stem line of the ith surface line and checks their alignment
+     *
+     *  @param i :      position of the surface line in the Corpus
+     *  @param stem :   the read stem line
+     */
+    void readStem(unsigned int i, std::string &stem);
+};
+
+#endif
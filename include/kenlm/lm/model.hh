@@ -65,6 +65,13 @@ template <class Search, class VocabularyT> class GenericModel : public base::Mod
      */
     FullScoreReturn FullScoreForgotState(const WordIndex *context_rbegin, const WordIndex *context_rend, const WordIndex new_word, State &out_state) const;
 
+    /* Prefetch the memory FullScore(in_state, new_word, ...) will read, without
+     * waiting for it.  Meant for callers interleaving several queries.
+     */
+    void Prefetch(const State &in_state, const WordIndex new_word) const {
+      search_.Prefetch(in_state.words, in_state.words + in_state.length, new_word);
+    }
+
     /* Get the state for a context.  Don't use this if you can avoid it.  Use
      * BeginSentenceState or NullContextState and extend from those.  If
      * you're only going to use this state to call FullScore once, use
@@ -136,6 +136,22 @@ template <class Value> class HashedSearch {
       return true;
     }
 
+    // Prefetch every entry a query of word after context [context_rbegin, context_rend) may probe.
+    // Node hashes only depend on word indices, so nothing waits on memory here.
+    void Prefetch(const WordIndex *context_rbegin, const WordIndex *context_rend, WordIndex word) const {
+      UTIL_PREFETCH(&unigram_.Lookup(word));
+      Node node = static_cast<Node>(word);
+      unsigned char order_minus_2 = 0;
+      for (const WordIndex *i = context_rbegin; i != context_rend; ++i, ++order_minus_2) {
+        node = CombineWordHash(node, *i);
+        if (order_minus_2 == middle_.size()) {
+          UTIL_PREFETCH(&*longest_.Ideal(node));
+          return;
+        }
+        UTIL_PREFETCH(&*middle_[order_minus_2].Ideal(node));
+      }
+    }
+
   private:
     // Interpret config's rest cost build policy and pass the right template argument to ApplyBuild.
     void DispatchBuild(util::FilePiece &f, const std::vector<uint64_t> &counts, const Config &config, const ProbingVocabulary &vocab, PositiveProbWarn &warn);
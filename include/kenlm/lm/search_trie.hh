@@ -88,6 +88,9 @@ template <class Quant, class Bhiksha> class TrieSearch {
       return LongestPointer(quant_, longest_.Find(word, node));
     }
 
+    // Trie lookups are a chain of dependent searches, nothing to prefetch ahead.
+    void Prefetch(const WordIndex * /*context_rbegin*/, const WordIndex * /*context_rend*/, WordIndex /*word*/) const {}
+
     bool FastMakeNode(const WordIndex *begin, const WordIndex *end, Node &node) const {
       assert(begin != end);
       bool independent_left;
@@ -162,6 +162,17 @@ class ProbingVocabulary : public base::Vocabulary {
       return lookup_.Find(detail::HashForVocab(str), i) ? i->value : 0;
     }
 
+    // Same as Index for a word already hashed with detail::HashForVocab.
+    WordIndex IndexHash(uint64_t hash) const {
+      Lookup::ConstIterator i;
+      return lookup_.Find(hash, i) ? i->value : 0;
+    }
+
+    // Prefetch the bucket IndexHash(hash) will probe first.
+    void Prefetch(uint64_t hash) const {
+      UTIL_PREFETCH(&*lookup_.Ideal(hash));
+    }
+
     static uint64_t Size(uint64_t entries, float probing_multiplier);
     // This just unwraps Config to get the probing_multiplier.
     static uint64_t Size(uint64_t entries, const Config &config);
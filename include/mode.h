@@ -33,6 +33,8 @@
 
 #include "corpus.h"
 #include "utils/common.h"
+#include "utils/linereader.h"
+#include "xenoption.h"
 
 #include <boost/filesystem.hpp>
 
@@ -75,10 +77,28 @@ protected:
      *
      *  @param ptrCorp :    Corpus from which the sample should be extracted
      *  @param sSize :      size of the sample to extract
-     *  @param mean :       true if we are in "mean" mode (not the same Corpus filename)
+     *  @param mean :       true if we are in "mean" mode (a new random Corpus filename)
      *  @return extracted Corpus sample
      */
     static Corpus extractSample(boost::shared_ptr<Corpus> ptrCorp, int sSize, bool mean);
+    
+    /**
+     *  @fn static Corpus extractFactorSample (boost::shared_ptr<Corpus> ptrCorp, boost::shared_ptr<XenFile> ptrFactor, std::string lg, int sSize)
+     *  @brief Extracts a random sample from a factor file (stems) aligned with a given Corpus
+     *
+     *  Lines are drawn from the Corpus as extractSample does, then their factors
+     *  are picked while streaming the factor file, which is never loaded.
+     *
+     *  @param ptrCorp :    Corpus the factor file is aligned with
+     *  @param ptrFactor :  factor file from which the sample should be extracted
+     *  @param lg :         language of the factor file
+     *  @param sSize :      size of the sample to extract
+     *  @return extracted factor Corpus sample
+     */
+    static Corpus extractFactorSample(boost::shared_ptr<Corpus> ptrCorp, boost::shared_ptr<XenFile> ptrFactor, std::string lg, int sSize);
+    
+private:
+    static bool seeded;     //!< Indicates the sampling random generator is seeded
 };
 
 #endif
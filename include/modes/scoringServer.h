@@ -0,0 +1,130 @@
+/**
+ *  @file scoringServer.h
+ *  @brief Derived class to handle the long-running scoring server
+ *  @author Anthony Rousseau
+ *  @version 2.0.0
+ *  @date 19 October 2026
+ */
+
+/*  This file is part of the cross-entropy tool for data selection (XenC)
+ *  aimed at speech recognition and statistical machine translation.
+ *
+ *  Copyright 2013-2016, Anthony Rousseau, LIUM, University of Le Mans, France
+ *
+ *  Development of the XenC tool has been partially funded by the
+ *  European Commission under the MateCat project.
+ *
+ *  The XenC tool is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation
+ *
+ *  This library is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef SCORINGSERVER_H_
+#define SCORINGSERVER_H_
+
+#include <boost/make_shared.hpp>
+
+#include "../mode.h"       //!< Inherit boost::filesystem from here
+#include "../utils/StaticData.h"    //!< Inherit boost::shared_ptr from here
+
+using namespace boost;
+
+/**
+ *  @class ScoringServer
+ *  @brief Long-running scoring server with resident language models
+ *
+ *  This class derived from Mode loads the in-domain and out-of-domain
+ *  language models of filtering modes 1, 2 or 3 once, then scores
+ *  batches of sentences (or tab-separated sentence pairs in mode 3)
+ *  read from stdin or from a local Unix socket.
+ *  Each input line gets one output line holding its raw (uncalibrated) score:
+ *  perplexity for mode 1, cross-entropy difference for modes 2 and 3.
+ *  In mode 3, a line without a tab gets an "ERROR: ..." line instead of a score.
+ *  A batch is scored when it is full, when an empty line is read
+ *  (the empty line is echoed back as a batch terminator) or at end of input.
+ */
+class ScoringServer : public Mode {
+public:
+    /**
+     *  @fn ScoringServer (std::streambuf* out)
+     *  @brief Constructor
+     *
+     *  @param out :    the stream buffer to write the scores to when serving on stdin
+     */
+    ScoringServer(std::streambuf* out);
+
+    /**
+     *  @fn ~ScoringServer ()
+     *  @brief Default destructor
+     */
+    ~ScoringServer();
+
+    /**
+     *  @fn int launch ()
+     *  @brief Function in charge of loading the language models and serving requests
+     *
+     *  @return 0 if the server ended well
+     */
+    int launch();
+
+private:
+    std::streambuf* outBuf;     //!< The stream buffer receiving the scores when serving on stdin
+
+    /**
+     *  @fn void prepareSide (bool source)
+     *  @brief Makes the language models of one language side resident
+     *
+     *  Corpora and vocabularies are only loaded when a language model has to be estimated.
+     *
+     *  @param source :     true for the source language side, false for the target one
+     */
+    void prepareSide(bool source);
+
+    /**
+     *  @fn void prepareLM (boost::shared_ptr<XenLMken> ptrLM, boost::shared_ptr<XenFile> ptrLMFile, boost::shared_ptr<Corpus> ptrCorp, boost::shared_ptr<XenVocab> ptrVoc)
+     *  @brief Loads a language model, estimating it first if no file has been given
+     *
+     *  @param ptrLM :      the language model to make resident
+     *  @param ptrLMFile :  the language model file given in options (may be empty)
+     *  @param ptrCorp :    the Corpus to estimate the language model from if needed
+     *  @param ptrVoc :     the vocabulary used to estimate the language model
+     */
+    void prepareLM(boost::shared_ptr<XenLMken> ptrLM, boost::shared_ptr<XenFile> ptrLMFile, boost::shared_ptr<Corpus> ptrCorp, boost::shared_ptr<XenVocab> ptrVoc);
+
+    /**
+     *  @fn void serve (std::istream &in, std::ostream &out)
+     *  @brief Reads, scores and answers batches until end of input
+     *
+     *  @param in :     the stream to read sentences from
+     *  @param out :    the stream to write scores to
+     */
+    void serve(std::istream &in, std::ostream &out);
+
+    /**
+     *  @fn void scoreBatch (std::vector<std::string> &batch, std::ostream &out)
+     *  @brief Scores a batch of lines with the resident language models and writes the results
+     *
+     *  @param batch :  the lines to score
+     *  @param out :    the stream to write scores to
+     */
+    void scoreBatch(std::vector<std::string> &batch, std::ostream &out);
+
+    /**
+     *  @fn void serveSocket (std::string path)
+     *  @brief Accepts connections on a local Unix socket and serves them one after the other
+     *
+     *  @param path :   the Unix socket path
+     */
+    void serveSocket(std::string path);
+};
+
+#endif
@@ -34,7 +34,6 @@
 #include "utils/common.h"
 
 #include "xenoption.h"
-#include "sourcephrase.h"
 
 class XenIO;    // Forward declaration
 
@@ -121,20 +120,12 @@ public:
     std::string getCounts(int ph);
     
     /**
-     *  @fn std::vector<SourcePhrase> getSrcPhrases ()
-     *  @brief Accessor to the vector of merged source phrases
+     *  @fn const std::vector<unsigned int>& getGroupStarts ()
+     *  @brief Accessor to the groups of phrase pairs sharing their source phrase
      *
-     *  @return vector of merged SourcePhrase
+     *  @return positions of the first pair of each group, then the size of the PhraseTable
      */
-    std::vector<SourcePhrase> getSrcPhrases();
-    
-    /**
-     *  @fn void setSrcPhrases (std::vector<SourcePhrase> vSP)
-     *  @brief Mutator to the vector of merged source phrases
-     *
-     *  @param vSP :    vector of SourcePhrase
-     */
-    void setSrcPhrases(std::vector<SourcePhrase> vSP);
+    const std::vector<unsigned int>& getGroupStarts();
     
     /**
      *  @fn unsigned int getSize ()
@@ -150,7 +141,7 @@ private:
     std::string dlm;    //!< Delimitor for the phrase table (usually "|||")
     XenCommon::Splitter lineSpl;    //!< Multi-character splitter object
     unsigned int size;  //!< Size of the PhraseTable
-    boost::shared_ptr<std::vector<SourcePhrase> > ptrSrcPhrases;    //!< Shared pointer on a vector of SourcePhrase containing all the merged source phrases
+    boost::shared_ptr<std::vector<unsigned int> > ptrGroupStarts;   //!< Shared pointer on the positions of the first pair of each source phrase group
     
     /**
      *  @fn void loadTable ()
@@ -160,7 +151,7 @@ private:
     
     /**
      *  @fn void mergePhrasesBySource ()
-     *  @brief Merges all the phrase pairs by source phrase
+     *  @brief Groups the consecutive phrase pairs sharing their source phrase
      */
     void mergePhrasesBySource();
 };
@@ -33,17 +33,17 @@
 
 #include <math.h>
 
-#include "utils/threadpool.hpp"
+#include "utils/scheduler.h"
 #include "corpus.h"
 #include "phrasetable.h"
 #include "XenLMken.h"
+#include "scorestore.h"
+#include "scoringpass.h"
 
 #ifndef M_LN10
 #define M_LN10	2.30258509299404568402
 #endif
 
-using namespace boost::threadpool;
-
 /**
  *  @fn void taskCalcPPL (int numLine, std::string line, boost::shared_ptr<std::vector<double> > ptrPPL, boost::shared_ptr<XenLMken> ptrLM)
  *  @brief Thread-safe perplexity computation function
@@ -55,6 +55,17 @@ using namespace boost::threadpool;
  */
 void taskCalcPPL(int numLine, std::string line, boost::shared_ptr<std::vector<double> > ptrPPL, boost::shared_ptr<XenLMken> ptrLM);
 
+/**
+ *  @fn void taskCalcPPLBatch (boost::shared_ptr<std::vector<int> > ptrLines, boost::shared_ptr<std::vector<std::string> > ptrSents, boost::shared_ptr<std::vector<double> > ptrPPL, boost::shared_ptr<XenLMken> ptrLM)
+ *  @brief Thread-safe perplexity computation function for a batch of lines, queried in lockstep
+ *
+ *  @param ptrLines :       shared pointer on the line numbers to compute perplexity for
+ *  @param ptrSents :       shared pointer on the text lines to compute perplexity for
+ *  @param ptrPPL :         shared pointer on the vector of doubles containing the perplexity scores
+ *  @param ptrLM :          shared pointer on the language model to compute perplexity and cross-entropy from
+ */
+void taskCalcPPLBatch(boost::shared_ptr<std::vector<int> > ptrLines, boost::shared_ptr<std::vector<std::string> > ptrSents, boost::shared_ptr<std::vector<double> > ptrPPL, boost::shared_ptr<XenLMken> ptrLM);
+
 /**
  *  @class PPL
  *  @brief Perplexity/Cross-entropy computations
@@ -134,19 +145,20 @@ public:
      */
     void calcPPLCorpus();
     
+    /**
+     *  @fn void calcPPLCorpus (boost::shared_ptr<ScoreStore> ptrStore)
+     *  @brief Computes the perplexity of the Corpus lines the score store does not hold yet
+     *
+     *  @param ptrStore :   the score store indexing the Corpus (null to score all lines)
+     */
+    void calcPPLCorpus(boost::shared_ptr<ScoreStore> ptrStore);
+    
     /**
      *  @fn void calcPPLPhraseTable ()
      *  @brief Computes the perplexity of a PhraseTable phrase by phrase
      */
     void calcPPLPhraseTable();
 
-private:
-    boost::shared_ptr<XenLMken> ptrLM;                  //!< Shared pointer on the XenLMsri object figuring the language model
-    boost::shared_ptr<Corpus> ptrCorp;                  //!< Shared pointer on the Corpus object to compute perplexity for
-    boost::shared_ptr<PhraseTable> ptrPT;               //!< Shared pointer on the PhraseTable object to compute perplexity for
-    bool source;                                        //!< Boolean indicating if we are working on source or target side (for the PhraseTable)
-    boost::shared_ptr<std::vector<double> > ptrPPL;     //!< Shared pointer on a vector of doubles holding the computed perplexity scores
-
     /**
      *  @fn static double crossEntropy (double ppl)
      *  @brief Compute the cross-entropy score from a perplexity score: log(ppl)/log(2)
@@ -155,6 +167,22 @@ private:
      *  @return the computed cross-entropy
      */
     static double crossEntropy(double ppl);
+    
+    /**
+     *  @fn static double statsPPL (const TxtStats &tstats)
+     *  @brief Computes the perplexity from KenLM stats
+     *
+     *  @param tstats : the KenLM stats
+     *  @return the perplexity (OOVs excluded or not, following the options)
+     */
+    static double statsPPL(const TxtStats &tstats);
+
+private:
+    boost::shared_ptr<XenLMken> ptrLM;                  //!< Shared pointer on the XenLMsri object figuring the language model
+    boost::shared_ptr<Corpus> ptrCorp;                  //!< Shared pointer on the Corpus object to compute perplexity for
+    boost::shared_ptr<PhraseTable> ptrPT;               //!< Shared pointer on the PhraseTable object to compute perplexity for
+    bool source;                                        //!< Boolean indicating if we are working on source or target side (for the PhraseTable)
+    boost::shared_ptr<std::vector<double> > ptrPPL;     //!< Shared pointer on a vector of doubles holding the computed perplexity scores
 };
 
 #endif
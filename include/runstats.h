@@ -0,0 +1,134 @@
+/**
+ *  @file runstats.h
+ *  @brief Class collecting per-stage timing, throughput and memory statistics
+ *  @author Anthony Rousseau
+ *  @version 2.0.0
+ *  @date 19 October 2026
+ */
+
+/*  This file is part of the cross-entropy tool for data selection (XenC)
+ *  aimed at speech recognition and statistical machine translation.
+ *
+ *  Copyright 2013-2016, Anthony Rousseau, LIUM, University of Le Mans, France
+ *
+ *  Development of the XenC tool has been partially funded by the
+ *  European Commission under the MateCat project.
+ *
+ *  The XenC tool is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation
+ *
+ *  This library is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+
+#ifndef RUNSTATS_H_
+#define RUNSTATS_H_
+
+#include <stdint.h>
+
+#include <boost/thread/mutex.hpp>
+
+#include "utils/common.h"
+
+/**
+ *  @struct StageStats
+ *  @brief Measures of a single run stage
+ */
+struct StageStats {
+    std::string name;       //!< Stage name (kind and input)
+    double startWall;       //!< Wall time at stage start
+    double startCPU;        //!< Process CPU time at stage start
+    double wall;            //!< Wall time spent in the stage (seconds)
+    double cpu;             //!< Process CPU time spent during the stage (seconds)
+    uint64_t rss;           //!< Peak resident set size at stage end (bytes)
+    uint64_t lines;         //!< Lines processed by the stage
+    uint64_t tokens;        //!< Tokens processed by the stage
+    bool done;              //!< Indicates the stage has ended
+};
+
+/**
+ *  @class RunStats
+ *  @brief Class collecting per-stage timing, throughput and memory statistics
+ *
+ *  Each heavy stage (corpus loading, vocabulary, LM estimation and loading,
+ *  perplexity computation, scoring, sorted output) records its wall and CPU times,
+ *  the peak RSS and the amount of lines and tokens it processed.
+ *  A machine-readable JSON report is written at the end of the run.
+ */
+class RunStats {
+public:
+    /**
+     *  @fn RunStats ()
+     *  @brief Default constructor
+     */
+    RunStats();
+
+    /**
+     *  @fn ~RunStats ()
+     *  @brief Default destructor
+     */
+    ~RunStats();
+
+    /**
+     *  @fn int startStage (std::string name)
+     *  @brief Starts measuring a stage
+     *
+     *  @param name :   the stage name
+     *  @return the stage id to end it with
+     */
+    int startStage(std::string name);
+
+    /**
+     *  @fn void endStage (int id, uint64_t lines, uint64_t tokens)
+     *  @brief Ends measuring a stage
+     *
+     *  @param id :     the stage id returned by startStage
+     *  @param lines :  number of lines processed by the stage
+     *  @param tokens : number of tokens processed by the stage
+     */
+    void endStage(int id, uint64_t lines, uint64_t tokens);
+
+    /**
+     *  @fn void writeReport (std::string fileName, std::string version)
+     *  @brief Writes the JSON report of the run
+     *
+     *  @param fileName :   the report file name
+     *  @param version :    the XenC version
+     */
+    void writeReport(std::string fileName, std::string version);
+
+private:
+    double startWall;                   //!< Wall time at run start
+    double startCPU;                    //!< Process CPU time at run start
+    std::vector<StageStats> stages;     //!< Measured stages, in start order
+    boost::mutex mtx;                   //!< Protects the stages
+
+    /**
+     *  @fn static std::string escape (std::string str)
+     *  @brief Escapes a string for a JSON document
+     *
+     *  @param str :    the string to escape
+     *  @return the quoted and escaped string
+     */
+    static std::string escape(std::string str);
+
+    /**
+     *  @fn static std::string rate (uint64_t count, double seconds)
+     *  @brief Formats a throughput for a JSON document
+     *
+     *  @param count :      the processed amount
+     *  @param seconds :    the time spent
+     *  @return the throughput, or null if it can't be computed
+     */
+    static std::string rate(uint64_t count, double seconds);
+};
+
+#endif
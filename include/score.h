@@ -35,15 +35,20 @@
 
 #include <boost/shared_ptr.hpp>
 #include <boost/make_shared.hpp>
+#include <boost/dynamic_bitset.hpp>
 
 using namespace boost;
 
+typedef std::pair<double, double> MinMax;      //!< Bounds of a range of scores
+
 /**
  *  @class Score
  *  @brief Class holding the XenC scores representation
  *
- *  This class holds the representation of XenC scores.
+ *  This class holds the representation of XenC scores, as one column
+ *  of contiguous doubles with a bitmap of the scores to output.
  *  Can add/remove scores and provides access to them.
+ *  Calibration runs vectorized kernels over sub-ranges of the column, in parallel.
  */
 class Score {
 public:
@@ -59,6 +64,15 @@ public:
      */
     ~Score();
     
+    /**
+     *  @fn void resize (unsigned int size, double sc)
+     *  @brief Pre-sizes the column, all scores being outputted
+     *
+     *  @param size :   number of scores
+     *  @param sc :     value of the new scores
+     */
+    void resize(unsigned int size, double sc);
+    
     /**
      *  @fn void addScore (double sc)
      *  @brief Adds a score to the vector of doubles
@@ -67,6 +81,15 @@ public:
      */
     void addScore(double sc);
     
+    /**
+     *  @fn void setScore (int n, double sc)
+     *  @brief Sets the nth score of a pre-sized column
+     *
+     *  @param n :      position of the score to set
+     *  @param sc :     the score
+     */
+    void setScore(int n, double sc);
+    
     /**
      *  @fn void removeScore (int n)
      *  @brief Removes the nth score from the vector of doubles
@@ -100,6 +123,14 @@ public:
      *  @return unsigned int representing the size
      */
     unsigned int getSize() const;
+    
+    /**
+     *  @fn double* getData ()
+     *  @brief Accessor to the contiguous scores, for the column kernels
+     *
+     *  @return pointer on the first score
+     */
+    double* getData();
 
     /**
      *  @fn void calibrate ()
@@ -113,9 +144,66 @@ public:
      */
     void inverse();
     
+    /**
+     *  @fn void calibrateGroups (const std::vector<unsigned int> &starts)
+     *  @brief Calibrates each group of consecutive scores on its own bounds, groups in parallel
+     *
+     *  The scores of a group holding a single entry are set to 0, as such a group
+     *  has no distribution to calibrate.
+     *
+     *  @param starts : positions of the first score of each group, then the size of the column
+     */
+    void calibrateGroups(const std::vector<unsigned int> &starts);
+    
+    /**
+     *  @fn static void minMax (const double* v, unsigned int size, double &min, double &max)
+     *  @brief Vectorized kernel widening [min, max] to the values of a range
+     *
+     *  @param v :      the values
+     *  @param size :   number of values
+     *  @param min :    the minimum, updated
+     *  @param max :    the maximum, updated
+     */
+    static void minMax(const double* v, unsigned int size, double &min, double &max);
+    
+    /**
+     *  @fn static void normalize (double* v, unsigned int size, double min, double max)
+     *  @brief Vectorized kernel mapping a range to (v - min) / (max - min)
+     *
+     *  @param v :      the values, updated
+     *  @param size :   number of values
+     *  @param min :    the value mapped to 0
+     *  @param max :    the value mapped to 1
+     */
+    static void normalize(double* v, unsigned int size, double min, double max);
+    
+    /**
+     *  @fn static void affine (double* v, unsigned int size, double a, double b)
+     *  @brief Vectorized kernel mapping a range to a * v + b
+     *
+     *  @param v :      the values, updated
+     *  @param size :   number of values
+     *  @param a :      the factor
+     *  @param b :      the offset
+     */
+    static void affine(double* v, unsigned int size, double a, double b);
+    
+    /**
+     *  @fn static MinMax mergeBounds (const MinMax &a, const MinMax &b)
+     *  @brief Bounds of two ranges, to reduce the bounds of sub-ranges
+     *
+     *  @param a :      bounds of the first range
+     *  @param b :      bounds of the second range
+     *  @return the bounds of both ranges
+     */
+    static MinMax mergeBounds(const MinMax &a, const MinMax &b);
+    
+    static const unsigned int grain = 1 << 16;              //!< Size of the column sub-ranges run in parallel
+    static const unsigned int groupGrain = 1 << 12;         //!< Number of groups calibrated per task
+    
 private:
-    boost::shared_ptr<std::vector<double> > ptrScores;      //!< Shared pointer on a vector of doubles holding the scores
-    boost::shared_ptr<std::vector<int> > ptrPrint;          //!< Shared pointer on a vector of integers holding the printing status
+    std::vector<double> scores;                             //!< Contiguous scores
+    boost::dynamic_bitset<> print;                          //!< Printing status of each score
 };
 
 #endif
@@ -0,0 +1,187 @@
+/**
+ *  @file scorestore.h
+ *  @brief Class handling the persistent per-line score store for incremental re-scoring
+ *  @author Anthony Rousseau
+ *  @version 2.0.0
+ *  @date 19 October 2026
+ */
+
+/*  This file is part of the cross-entropy tool for data selection (XenC)
+ *  aimed at speech recognition and statistical machine translation.
+ *
+ *  Copyright 2013-2016, Anthony Rousseau, LIUM, University of Le Mans, France
+ *
+ *  Development of the XenC tool has been partially funded by the
+ *  European Commission under the MateCat project.
+ *
+ *  The XenC tool is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation
+ *
+ *  This library is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef SCORESTORE_H_
+#define SCORESTORE_H_
+
+#include <stdint.h>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/unordered_map.hpp>
+
+#include "corpus.h"
+#include "score.h"
+
+using namespace boost;
+
+/**
+ *  @struct StoreEntry
+ *  @brief A stored raw score and the hash of the line it belongs to
+ */
+struct StoreEntry {
+    uint64_t hash;      //!< The line content hash
+    double raw;         //!< The raw (uncalibrated) score of the line
+};
+
+/**
+ *  @class ScoreStore
+ *  @brief Class handling the persistent per-line score store
+ *
+ *  This class keeps the raw scores of every out-of-domain line in a binary file
+ *  next to the outputs, keyed by line content hash and sorted by raw score.
+ *  The store is only valid for the language models it has been computed with:
+ *  a fingerprint of the language model files and scoring options is saved along.
+ *  On the next run, only new or changed lines are scored and their scores
+ *  are merged into the stored order, so the sorted output does not need a full sort.
+ */
+class ScoreStore {
+public:
+    /**
+     *  @fn ScoreStore ()
+     *  @brief Default constructor
+     */
+    ScoreStore();
+
+    /**
+     *  @fn ~ScoreStore ()
+     *  @brief Default destructor
+     */
+    ~ScoreStore();
+
+    /**
+     *  @fn void initialize (boost::shared_ptr<Corpus> ptrSource, boost::shared_ptr<Corpus> ptrTarget)
+     *  @brief Loads the store and finds which out-of-domain lines are already scored
+     *
+     *  Must be called once the language models are estimated or loaded.
+     *
+     *  @param ptrSource :  the source out-of-domain Corpus
+     *  @param ptrTarget :  the target out-of-domain Corpus (null if scores do not depend on it)
+     */
+    void initialize(boost::shared_ptr<Corpus> ptrSource, boost::shared_ptr<Corpus> ptrTarget);
+
+    /**
+     *  @fn bool isKnown (unsigned int n) const
+     *  @brief Tells if the nth line already has a stored score
+     *
+     *  @param n :      position of the line in the corpus
+     *  @return true if the line does not need to be scored
+     */
+    bool isKnown(unsigned int n) const;
+
+    /**
+     *  @fn double getRaw (unsigned int n) const
+     *  @brief Accessor to the raw score of the nth line
+     *
+     *  @param n :      position of the line in the corpus
+     *  @return the raw score of the line
+     */
+    double getRaw(unsigned int n) const;
+
+    /**
+     *  @fn void setRaw (unsigned int n, double raw)
+     *  @brief Sets the raw score of a newly scored line
+     *
+     *  @param n :      position of the line in the corpus
+     *  @param raw :    the raw score of the line
+     */
+    void setRaw(unsigned int n, double raw);
+
+    /**
+     *  @fn unsigned int getSize () const
+     *  @brief Accessor to the number of corpus lines handled by the store
+     *
+     *  @return the number of lines
+     */
+    unsigned int getSize() const;
+
+    /**
+     *  @fn bool indexes (boost::shared_ptr<Corpus> ptrCorp) const
+     *  @brief Tells if the store has been initialized with a Corpus (as source or target side)
+     *
+     *  @param ptrCorp :    the Corpus to check
+     *  @return true if the store lines are the lines of this Corpus
+     */
+    bool indexes(boost::shared_ptr<Corpus> ptrCorp) const;
+
+    /**
+     *  @fn void update ()
+     *  @brief Merges the newly scored lines into the stored order and saves the store
+     */
+    void update();
+
+    /**
+     *  @fn std::vector<unsigned int> getOrder (boost::shared_ptr<Score> ptrScore, bool inv, bool rev) const
+     *  @brief Accessor to the corpus line positions in sorted output order
+     *
+     *  Calibration keeps the raw score order and inversion reverses it,
+     *  so the merged order only needs a linear fix-up pass for equal final scores,
+     *  which are kept in corpus order (reversed with rev) as a multimap would.
+     *
+     *  @param ptrScore :   the final (calibrated) scores
+     *  @param inv :        true if the calibrated scores are inversed
+     *  @param rev :        true if the sorted output is in descending order
+     *  @return the sorted line positions
+     */
+    std::vector<unsigned int> getOrder(boost::shared_ptr<Score> ptrScore, bool inv, bool rev) const;
+
+private:
+    std::string fileName;                                   //!< The score store file name
+    boost::shared_ptr<Corpus> ptrSource;                    //!< The source Corpus the store has been initialized with
+    boost::shared_ptr<Corpus> ptrTarget;                    //!< The target Corpus the store has been initialized with (null if none)
+    uint64_t fingerprint;                                   //!< Fingerprint of the language models and scoring options
+    std::vector<StoreEntry> entries;                        //!< Stored entries, sorted by raw score
+    std::vector<uint64_t> lineHash;                         //!< Content hash of each corpus line
+    std::vector<int> lineRank;                              //!< Rank of each corpus line in the stored entries (-1 if new)
+    std::vector<double> lineRaw;                            //!< Raw score of each corpus line
+    std::vector<unsigned int> order;                        //!< Corpus line positions sorted by raw score
+
+    /**
+     *  @fn uint64_t computeFingerprint ()
+     *  @brief Computes the fingerprint of the language model files contents and scoring options
+     *
+     *  @return the fingerprint
+     */
+    uint64_t computeFingerprint();
+
+    /**
+     *  @fn void load ()
+     *  @brief Loads the stored entries if the store exists and matches the fingerprint
+     */
+    void load();
+
+    /**
+     *  @fn void save ()
+     *  @brief Writes the store entries to disk
+     */
+    void save();
+};
+
+#endif
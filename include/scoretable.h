@@ -0,0 +1,160 @@
+/**
+ *  @file scoretable.h
+ *  @brief Class holding the named score columns of a run and combining them
+ *  @author Anthony Rousseau
+ *  @version 2.0.0
+ *  @date 19 October 2026
+ */
+
+
+/*  This file is part of the cross-entropy tool for data selection (XenC)
+ *  aimed at speech recognition and statistical machine translation.
+ *
+ *  Copyright 2013-2016, Anthony Rousseau, LIUM, University of Le Mans, France
+ *
+ *  Development of the XenC tool has been partially funded by the
+ *  European Commission under the MateCat project.
+ *
+ *  The XenC tool is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation
+ *
+ *  This library is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef SCORETABLE_H_
+#define SCORETABLE_H_
+
+#include "score.h"
+
+/**
+ *  @enum ScoreColumn
+ *  @brief Names of the columns of the score table
+ */
+enum ScoreColumn {
+    SC_FINAL = 0,       //!< Global scores, written to the outputs
+    SC_SIMIL,           //!< Similarity measures
+    SC_XENC,            //!< Cross-entropy scores (raw, as kept in the score store)
+    SC_WEIGHT,          //!< Calibrated weights, empty without weights file
+    SC_COLUMNS          //!< Number of columns
+};
+
+/**
+ *  @class ScoreTable
+ *  @brief Class holding the named score columns of a run and combining them
+ *
+ *  Each column is a Score, pre-sized to the corpus once it is known, and the
+ *  modes fill them by line position. The global scores are then derived in
+ *  one parallel pass over sub-ranges, weighting, combining and bounding each
+ *  sub-range while it is in cache, before the calibration pass.
+ */
+class ScoreTable {
+public:
+    /**
+     *  @fn ScoreTable ()
+     *  @brief Default constructor
+     */
+    ScoreTable();
+    
+    /**
+     *  @fn ~ScoreTable ()
+     *  @brief Default destructor
+     */
+    ~ScoreTable();
+    
+    /**
+     *  @fn void initialize (unsigned int size)
+     *  @brief Pre-sizes the score columns (but the weights)
+     *
+     *  @param size :   number of lines to score
+     */
+    void initialize(unsigned int size);
+    
+    /**
+     *  @fn boost::shared_ptr<Score> getColumn (ScoreColumn col) const
+     *  @brief Accessor to a named column
+     *
+     *  @param col :    the column name
+     *  @return the column Score object
+     */
+    boost::shared_ptr<Score> getColumn(ScoreColumn col) const;
+    
+    /**
+     *  @fn boost::shared_ptr<Score> getPtrScores () const
+     *  @brief Accessor to the global Score object
+     *
+     *  @return the global Score object
+     */
+    boost::shared_ptr<Score> getPtrScores() const;
+    
+    /**
+     *  @fn boost::shared_ptr<Score> getPtrScSimil () const
+     *  @brief Accessor to the similarity measures Score object
+     *
+     *  @return the similarity measures Score object
+     */
+    boost::shared_ptr<Score> getPtrScSimil() const;
+    
+    /**
+     *  @fn boost::shared_ptr<Score> getPtrScXenC () const
+     *  @brief Accessor to the cross-entropy Score object
+     *
+     *  @return the cross-entropy Score object
+     */
+    boost::shared_ptr<Score> getPtrScXenC() const;
+    
+    /**
+     *  @fn void setPtrScWeight (boost::shared_ptr<Score> ptrWeights)
+     *  @brief Sets the weights column (shared with the weights file)
+     *
+     *  @param ptrWeights :     the calibrated weights
+     */
+    void setPtrScWeight(boost::shared_ptr<Score> ptrWeights);
+    
+    /**
+     *  @fn void combine (bool xenc, bool simil, bool calib)
+     *  @brief Computes the global scores from the other columns
+     *
+     *  Cross-entropy scores are weighted if a weights column is set. When combined
+     *  with similarity, they are calibrated before the similarity measure is added.
+     *
+     *  @param xenc :   true to use the cross-entropy column
+     *  @param simil :  true to use the similarity column
+     *  @param calib :  true to calibrate the global scores between 0 and 1
+     */
+    void combine(bool xenc, bool simil, bool calib);
+    
+private:
+    std::vector<boost::shared_ptr<Score> > columns;     //!< The columns, by name
+    
+    /**
+     *  @fn MinMax weightRange (unsigned int first, unsigned int last)
+     *  @brief Sets the global scores of a sub-range to its weighted cross-entropy scores
+     *
+     *  @param first :  the first line
+     *  @param last :   the line after the last one
+     *  @return the bounds of the sub-range, 0 included
+     */
+    MinMax weightRange(unsigned int first, unsigned int last);
+    
+    /**
+     *  @fn MinMax similRange (bool xenc, MinMax xb, unsigned int first, unsigned int last)
+     *  @brief Adds the similarity measures to the global scores of a sub-range
+     *
+     *  @param xenc :   true if the global scores hold weighted cross-entropy scores, calibrated first
+     *  @param xb :     bounds of the weighted cross-entropy scores
+     *  @param first :  the first line
+     *  @param last :   the line after the last one
+     *  @return the bounds of the sub-range, 0 included
+     */
+    MinMax similRange(bool xenc, MinMax xb, unsigned int first, unsigned int last);
+};
+
+#endif
@@ -0,0 +1,136 @@
+/**
+ *  @file scoringpass.h
+ *  @brief Class handling the scaffolding shared by the sentence scorers of a corpus
+ *  @author Anthony Rousseau
+ *  @version 2.0.0
+ *  @date 19 October 2026
+ */
+
+
+/*  This file is part of the cross-entropy tool for data selection (XenC)
+ *  aimed at speech recognition and statistical machine translation.
+ *
+ *  Copyright 2013-2016, Anthony Rousseau, LIUM, University of Le Mans, France
+ *
+ *  Development of the XenC tool has been partially funded by the
+ *  European Commission under the MateCat project.
+ *
+ *  The XenC tool is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation
+ *
+ *  This library is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef SCORINGPASS_H_
+#define SCORINGPASS_H_
+
+#include <stdint.h>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/function.hpp>
+
+#include "utils/scheduler.h"
+#include "corpus.h"
+#include "scorestore.h"
+
+using namespace boost;
+
+typedef boost::function<void (boost::shared_ptr<std::vector<int> >, boost::shared_ptr<std::vector<std::string> >, boost::shared_ptr<std::vector<std::string> >)> BatchTask;    //!< Scores a batch of line numbers, their sentences and their extra lines
+typedef boost::function<void (unsigned int, std::string &)> ExtraReader;    //!< Reads the extra line going along a corpus line
+
+/**
+ *  @fn void taskRunBatch (BatchTask task, boost::shared_ptr<std::vector<int> > ptrLines, boost::shared_ptr<std::vector<std::string> > ptrSents, boost::shared_ptr<std::vector<std::string> > ptrExtras, MemoryBudget* window, std::size_t bytes)
+ *  @brief Runs a batch scoring task, then gives its read-ahead memory back
+ *
+ *  @param task :       the batch scoring task
+ *  @param ptrLines :   the line numbers of the batch
+ *  @param ptrSents :   the sentences of the batch
+ *  @param ptrExtras :  the extra lines of the batch (empty without an extra reader)
+ *  @param window :     the read-ahead window holding the batch
+ *  @param bytes :      the memory held by the batch in the window
+ */
+void taskRunBatch(BatchTask task, boost::shared_ptr<std::vector<int> > ptrLines, boost::shared_ptr<std::vector<std::string> > ptrSents, boost::shared_ptr<std::vector<std::string> > ptrExtras, MemoryBudget* window, std::size_t bytes);
+
+/**
+ *  @class ScoringPass
+ *  @brief Class handling the scaffolding shared by the sentence scorers of a corpus
+ *
+ *  A pass skips the lines already held by the score store, restores or dumps
+ *  the checkpointed scores, records its run stats stage and hands the lines
+ *  to score over to the scheduler by batches. Each batch only writes the scores
+ *  of its own lines, so the batches never need a lock.
+ */
+class ScoringPass {
+public:
+    /**
+     *  @fn ScoringPass (std::string stage, boost::shared_ptr<Corpus> ptrCorp, boost::shared_ptr<ScoreStore> ptrStore, boost::shared_ptr<std::vector<double> > ptrScores)
+     *  @brief Constructor
+     *
+     *  @param stage :      the checkpoint and run stats stage name
+     *  @param ptrCorp :    the Corpus to score
+     *  @param ptrStore :   the score store indexing the Corpus, whose lines are not scored again (null to score all lines)
+     *  @param ptrScores :  the scores of the Corpus lines, already sized
+     */
+    ScoringPass(std::string stage, boost::shared_ptr<Corpus> ptrCorp, boost::shared_ptr<ScoreStore> ptrStore, boost::shared_ptr<std::vector<double> > ptrScores);
+
+    /**
+     *  @fn ~ScoringPass ()
+     *  @brief Default destructor
+     */
+    ~ScoringPass();
+
+    /**
+     *  @fn bool restore (std::string dumpName, const std::vector<std::string> &files)
+     *  @brief Restores the scores of an interrupted run with checkpointing
+     *
+     *  Nothing is restored (nor dumped later) when lines are skipped through the score store.
+     *
+     *  @param dumpName :   the file name of the scores dump in the checkpoint directory
+     *  @param files :      the files the scores depend on, besides the Corpus
+     *  @return true if the scores have been restored
+     */
+    bool restore(std::string dumpName, const std::vector<std::string> &files);
+
+    /**
+     *  @fn void run (BatchTask task)
+     *  @brief Scores the Corpus lines by batches
+     *
+     *  @param task :   the batch scoring task
+     */
+    void run(BatchTask task);
+
+    /**
+     *  @fn void run (BatchTask task, ExtraReader reader, std::size_t readAhead)
+     *  @brief Scores the Corpus lines by batches, along with an extra line per Corpus line
+     *
+     *  The reader is called for every line, skipped ones included, on the calling thread.
+     *
+     *  @param task :       the batch scoring task
+     *  @param reader :     the extra line reader
+     *  @param readAhead :  the memory of the batches read ahead of the scoring
+     */
+    void run(BatchTask task, ExtraReader reader, std::size_t readAhead);
+
+private:
+    std::string stage;                                  //!< The checkpoint and run stats stage name
+    boost::shared_ptr<Corpus> ptrCorp;                  //!< Shared pointer on the Corpus to score
+    boost::shared_ptr<ScoreStore> ptrStore;             //!< Shared pointer on the score store (null to score all lines)
+    boost::shared_ptr<std::vector<double> > ptrScores;  //!< Shared pointer on the scores of the Corpus lines
+    bool skip;                                          //!< Whether lines held by the score store are skipped
+    bool ckpt;                                          //!< Whether the scores are checkpointed
+    std::string dump;                                   //!< The path of the scores dump
+    uint64_t fp;                                        //!< The fingerprint of the scored files and options
+
+    static const unsigned int batchSize = 256;          //!< Lines per scoring task
+};
+
+#endif
@@ -31,7 +31,7 @@
 #ifndef SIMILARITY_H
 #define SIMILARITY_H
 
-#include <boost/algorithm/string.hpp>   //!< For boost::split
+#include <boost/unordered_map.hpp>
 
 #include "utils/common.h"
 
@@ -141,6 +141,15 @@ private:
      *  @brief Computes the final out-of-domain similarity measures
      */
     void computeSimilarity();
+    
+    /**
+     *  @fn void mapVecWords (boost::unordered_map<uint64_t, unsigned int> &slots, std::vector<unsigned int> &slotOf)
+     *  @brief Maps the similarity vector words to counting slots, by word hash
+     *
+     *  @param slots :  the counting slot of each distinct word hash
+     *  @param slotOf : the counting slot of each similarity vector word
+     */
+    void mapVecWords(boost::unordered_map<uint64_t, unsigned int> &slots, std::vector<unsigned int> &slotOf);
 };
 
 #endif
@@ -40,7 +40,13 @@
 
 #include "../corpus.h"
 #include "../ppl.h"
+#include "../ensemble.h"
+#include "../factoredppl.h"
+#include "../scorestore.h"
+#include "../checkpoint.h"
+#include "../runstats.h"
 #include "../wfile.h"
+#include "../scoretable.h"
 
 using namespace boost;
 
@@ -264,149 +270,6 @@ private:
     boost::shared_ptr<PhraseTable> ptrOutPT;       //!< Shared pointer to the out-of-domain phrase-table
 };
 
-/**
- *  @class MeanLMPair
- *  @brief Tiny class holding two additional LMs for mean scoring feature
- */
-class MeanLMPair {
-public:
-    /**
-     *  @fn MeanLMPair ()
-     *  @brief Default constructor
-     */
-    MeanLMPair() {
-        ptrOutLM2 = boost::make_shared<XenLMken>();
-        ptrOutLM3 = boost::make_shared<XenLMken>();
-    }
-    
-    /**
-     *  @fn ~MeanLMPair ()
-     *  @brief Default Destructor
-     */
-    ~MeanLMPair() {
-    
-    }
-    
-    /**
-     *  @fn boost::shared_ptr<XenLMsri> getPtrOutLM2 () const
-     *  @brief Accessor to the second out-of-domain language model
-     *
-     *  @return the second out-of-domain language model
-     */
-    boost::shared_ptr<XenLMken> getPtrOutLM2() const { return ptrOutLM2; }
-    
-    /**
-     *  @fn boost::shared_ptr<XenLMsri> getPtrOutLM3 () const
-     *  @brief Accessor to the third out-of-domain language model
-     *
-     *  @return the third out-of-domain language model
-     */
-    boost::shared_ptr<XenLMken> getPtrOutLM3() const { return ptrOutLM3; }
-    
-private:
-    boost::shared_ptr<XenLMken> ptrOutLM2;      //!< Shared pointer to the second out-of-domain language model
-    boost::shared_ptr<XenLMken> ptrOutLM3;      //!< Shared pointer to the third out-of-domain language model
-    
-};
-
-/**
- *  @class MeanPPLPair
- *  @brief Tiny class holding two additional PPL objects for mean scoring feature
- */
-class MeanPPLPair {
-public:
-    /**
-     *  @fn MeanPPLPair ()
-     *  @brief Default constructor
-     */
-    MeanPPLPair() {
-        ptrOutPPL2 = boost::make_shared<PPL>();
-        ptrOutPPL3 = boost::make_shared<PPL>();
-    }
-    
-    /**
-     *  @fn ~MeanPPLPair ()
-     *  @brief Default Destructor
-     */
-    ~MeanPPLPair() {
-    
-    }
-    
-    /**
-     *  @fn boost::shared_ptr<PPL> getPtrOutPPL2 () const
-     *  @brief Accessor to the second out-of-domain PPL object
-     *
-     *  @return the second out-of-domain PPL object
-     */
-    boost::shared_ptr<PPL> getPtrOutPPL2() const { return ptrOutPPL2; }
-    
-    /**
-     *  @fn boost::shared_ptr<PPL> getPtrOutPPL3 () const
-     *  @brief Accessor to the third out-of-domain PPL object
-     *
-     *  @return the third out-of-domain PPL object
-     */
-    boost::shared_ptr<PPL> getPtrOutPPL3() const { return ptrOutPPL3; }
-    
-private:
-    boost::shared_ptr<PPL> ptrOutPPL2;      //!< Shared pointer to the second out-of-domain PPL object
-    boost::shared_ptr<PPL> ptrOutPPL3;      //!< Shared pointer to the third out-of-domain PPL object
-};
-
-/**
- *  @class ScoreHolder
- *  @brief Tiny class holding three Score objects (global scores, similarity, cross-entropy)
- */
-class ScoreHolder {
-public:
-    /**
-     *  @fn ScoreHolder ()
-     *  @brief Default constructor
-     */
-    ScoreHolder() {
-        ptrScores = boost::make_shared<Score>();
-        ptrScSimil = boost::make_shared<Score>();
-        ptrScXenC = boost::make_shared<Score>();
-    }
-    
-    /**
-     *  @fn ~ScoreHolder ()
-     *  @brief Default Destructor
-     */
-    ~ScoreHolder() {
-    
-    }
-    
-    /**
-     *  @fn boost::shared_ptr<Score> getPtrScores () const
-     *  @brief Accessor to the global Score object
-     *
-     *  @return the global Score object
-     */
-    boost::shared_ptr<Score> getPtrScores() const { return ptrScores; }
-    
-    /**
-     *  @fn boost::shared_ptr<Score> getPtrScSimil () const
-     *  @brief Accessor to the similarity measures Score object
-     *
-     *  @return the similarity measures Score object
-     */
-    boost::shared_ptr<Score> getPtrScSimil() const { return ptrScSimil; }
-    
-    /**
-     *  @fn boost::shared_ptr<Score> getPtrScXenC () const
-     *  @brief Accessor to the cross-entropy Score object
-     *
-     *  @return the cross-entropy Score object
-     */
-    boost::shared_ptr<Score> getPtrScXenC() const { return ptrScXenC; }
-    
-private:
-    boost::shared_ptr<Score> ptrScores;         //!< Shared pointer to the global Score object
-    boost::shared_ptr<Score> ptrScSimil;        //!< Shared pointer to the similarity measures Score object
-    boost::shared_ptr<Score> ptrScXenC;         //!< Shared pointer to the cross-entropy Score object
-};
-
 /**
  *  @class StaticData
  *  @brief Class gathering all data used and generated by XenC
@@ -492,36 +355,20 @@ public:
     static boost::shared_ptr<PhraseTablePair> getPTPairs();
     
     /**
-     *  @fn static boost::shared_ptr<MeanLMPair> getMeanSourceLMs ()
-     *  @brief Accessor to the mean source language models
-     *
-     *  @return the mean source language models
-     */
-    static boost::shared_ptr<MeanLMPair> getMeanSourceLMs();
-    
-    /**
-     *  @fn static boost::shared_ptr<MeanLMPair> getMeanTargetLMs ()
-     *  @brief Accessor to the mean target language models
-     *
-     *  @return the mean target language models
-     */
-    static boost::shared_ptr<MeanLMPair> getMeanTargetLMs();
-    
-    /**
-     *  @fn static boost::shared_ptr<MeanPPLPair> getMeanSourcePPLs ()
-     *  @brief Accessor to the mean source PPL objects
+     *  @fn static boost::shared_ptr<LMEnsemble> getSourceEnsemble ()
+     *  @brief Accessor to the source language mean LM ensemble
      *
-     *  @return the mean source PPL objects
+     *  @return the source language mean LM ensemble
      */
-    static boost::shared_ptr<MeanPPLPair> getMeanSourcePPLs();
+    static boost::shared_ptr<LMEnsemble> getSourceEnsemble();
     
     /**
-     *  @fn static boost::shared_ptr<MeanPPLPair> getMeanTargetPPLs ()
-     *  @brief Accessor to the mean target PPL objects
+     *  @fn static boost::shared_ptr<LMEnsemble> getTargetEnsemble ()
+     *  @brief Accessor to the target language mean LM ensemble
      *
-     *  @return the mean target PPL objects
+     *  @return the target language mean LM ensemble
      */
-    static boost::shared_ptr<MeanPPLPair> getMeanTargetPPLs();
+    static boost::shared_ptr<LMEnsemble> getTargetEnsemble();
     
     /**
      *  @fn static boost::shared_ptr<CorpusPair> getStemSourceCorps ()
@@ -564,20 +411,20 @@ public:
     static boost::shared_ptr<VocabPair> getStemVocabs();
     
     /**
-     *  @fn static boost::shared_ptr<PPLPair> getStemSourcePPLs ()
-     *  @brief Accessor to the source language stem PPL objects
+     *  @fn static boost::shared_ptr<FactoredPPL> getFactoredSourcePPL ()
+     *  @brief Accessor to the source language joint surface and stem cross-entropies
      *
-     *  @return the source language stem PPL objects
+     *  @return the source language joint surface and stem cross-entropies
      */
-    static boost::shared_ptr<PPLPair> getStemSourcePPLs();
+    static boost::shared_ptr<FactoredPPL> getFactoredSourcePPL();
     
     /**
-     *  @fn static boost::shared_ptr<PPLPair> getStemTargetPPLs ()
-     *  @brief Accessor to the target language stem PPL objects
+     *  @fn static boost::shared_ptr<FactoredPPL> getFactoredTargetPPL ()
+     *  @brief Accessor to the target language joint surface and stem cross-entropies
      *
-     *  @return the target language stem PPL objects
+     *  @return the target language joint surface and stem cross-entropies
      */
-    static boost::shared_ptr<PPLPair> getStemTargetPPLs();
+    static boost::shared_ptr<FactoredPPL> getFactoredTargetPPL();
     
     /**
      *  @fn static boost::shared_ptr<Similarity> getSim ()
@@ -588,12 +435,12 @@ public:
     static boost::shared_ptr<Similarity> getSim();
     
     /**
-     *  @fn static boost::shared_ptr<ScoreHolder> getScHold ()
-     *  @brief Accessor to the ScoreHolder object
+     *  @fn static boost::shared_ptr<ScoreTable> getScHold ()
+     *  @brief Accessor to the ScoreTable object
      *
-     *  @return the ScoreHolder object
+     *  @return the ScoreTable object
      */
-    static boost::shared_ptr<ScoreHolder> getScHold();
+    static boost::shared_ptr<ScoreTable> getScHold();
     
     /**
      *  @fn static boost::shared_ptr<Wfile> getWeightsFile ()
@@ -619,6 +466,30 @@ public:
      */
     static boost::shared_ptr<Corpus> getDevCorp();
     
+    /**
+     *  @fn static boost::shared_ptr<ScoreStore> getScoreStore ()
+     *  @brief Accessor to the incremental re-scoring score store
+     *
+     *  @return the score store
+     */
+    static boost::shared_ptr<ScoreStore> getScoreStore();
+    
+    /**
+     *  @fn static boost::shared_ptr<Checkpoint> getCheckpoint ()
+     *  @brief Accessor to the checkpoints manifest
+     *
+     *  @return the checkpoints manifest
+     */
+    static boost::shared_ptr<Checkpoint> getCheckpoint();
+    
+    /**
+     *  @fn static boost::shared_ptr<RunStats> getRunStats ()
+     *  @brief Accessor to the per-stage run statistics
+     *
+     *  @return the run statistics
+     */
+    static boost::shared_ptr<RunStats> getRunStats();
+    
 private:
     /**
      *  @fn StaticData ()
@@ -641,22 +512,23 @@ private:
     static boost::shared_ptr<PPLPair> ptrSourcePPL;             //!< Shared pointer on the source language PPL objects
     static boost::shared_ptr<PPLPair> ptrTargetPPL;             //!< Shared pointer on the target language PPL objects
     static boost::shared_ptr<PhraseTablePair> ptrPTPair;        //!< Shared pointer on the phrase-tables
-    static boost::shared_ptr<MeanLMPair> ptrMeanSourceLM;       //!< Shared pointer on the mean source language models
-    static boost::shared_ptr<MeanLMPair> ptrMeanTargetLM;       //!< Shared pointer on the mean target language models
-    static boost::shared_ptr<MeanPPLPair> ptrMeanSourcePPL;     //!< Shared pointer on the mean source PPL objects
-    static boost::shared_ptr<MeanPPLPair> ptrMeanTargetPPL;     //!< Shared pointer on the mean target PPL objects
+    static boost::shared_ptr<LMEnsemble> ptrSourceEnsemble;     //!< Shared pointer on the source mean LM ensemble
+    static boost::shared_ptr<LMEnsemble> ptrTargetEnsemble;     //!< Shared pointer on the target mean LM ensemble
     static boost::shared_ptr<CorpusPair> ptrStemSourceCorp;     //!< Shared pointer on the source language stem Corpus Pair
     static boost::shared_ptr<CorpusPair> ptrStemTargetCorp;     //!< Shared pointer on the target language stem Corpus Pair
     static boost::shared_ptr<LMPair> ptrStemSourceLM;           //!< Shared pointer on the source language stem language models
     static boost::shared_ptr<LMPair> ptrStemTargetLM;           //!< Shared pointer on the target language stem language models
     static boost::shared_ptr<VocabPair> ptrStemVocabs;          //!< Shared pointer on the stem vocabularies
-    static boost::shared_ptr<PPLPair> ptrStemSourcePPL;         //!< Shared pointer on the source language stem PPL objects
-    static boost::shared_ptr<PPLPair> ptrStemTargetPPL;         //!< Shared pointer on the target language stem PPL objects
+    static boost::shared_ptr<FactoredPPL> ptrFactoredSourcePPL; //!< Shared pointer on the source language joint surface and stem cross-entropies
+    static boost::shared_ptr<FactoredPPL> ptrFactoredTargetPPL; //!< Shared pointer on the target language joint surface and stem cross-entropies
     static boost::shared_ptr<Similarity> ptrSim;                //!< Shared pointer on the Similarity measures object
-    static boost::shared_ptr<ScoreHolder> ptrScHold;            //!< Shared pointer on the ScoreHolder object
+    static boost::shared_ptr<ScoreTable> ptrScHold;             //!< Shared pointer on the ScoreTable object
     static boost::shared_ptr<Wfile> ptrWeightsFile;             //!< Shared pointer on the weights file
     static boost::shared_ptr<XenResult> ptrXenResult;           //!< Shared pointer on the filtering result file
     static boost::shared_ptr<Corpus> ptrDevCorp;                //!< Shared pointer on the development Corpus
+    static boost::shared_ptr<ScoreStore> ptrScoreStore;         //!< Shared pointer on the incremental re-scoring score store
+    static boost::shared_ptr<Checkpoint> ptrCheckpoint;         //!< Shared pointer on the checkpoints manifest
+    static boost::shared_ptr<RunStats> ptrRunStats;             //!< Shared pointer on the per-stage run statistics
 };
 
 #endif
@@ -0,0 +1,102 @@
+/**
+ *  @file asyncreader.h
+ *  @brief Class reading a file in blocks of whole lines from a background thread
+ *  @author Anthony Rousseau
+ *  @version 2.0.0
+ *  @date 19 October 2026
+ */
+
+
+/*  This file is part of the cross-entropy tool for data selection (XenC)
+ *  aimed at speech recognition and statistical machine translation.
+ *
+ *  Copyright 2013-2016, Anthony Rousseau, LIUM, University of Le Mans, France
+ *
+ *  Development of the XenC tool has been partially funded by the
+ *  European Commission under the MateCat project.
+ *
+ *  The XenC tool is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation
+ *
+ *  This library is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef ASYNCREADER_H_
+#define ASYNCREADER_H_
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "common.h"
+#include "../xenfile.h"
+#include "../kenlm/util/pcqueue.hh"
+
+typedef boost::shared_ptr<std::vector<char> > TextBlock;    //!< A block of whole lines, each ending with a newline
+
+/**
+ *  @class AsyncReader
+ *  @brief Class reading a file in blocks of whole lines from a background thread
+ *
+ *  The reader thread reads (and decompresses) the file into large blocks cut on
+ *  line boundaries, and hands them over through a bounded queue: the consumer
+ *  processes a block while the next ones are being decompressed.
+ */
+class AsyncReader {
+public:
+    /**
+     *  @fn AsyncReader (std::size_t blockSize, std::size_t depth)
+     *  @brief Constructor
+     *
+     *  @param blockSize :  the size of the blocks read, in bytes
+     *  @param depth :      the number of blocks the queue holds ahead of the consumer
+     */
+    AsyncReader(std::size_t blockSize, std::size_t depth);
+    
+    /**
+     *  @fn ~AsyncReader ()
+     *  @brief Destructor, stopping the reader thread
+     */
+    ~AsyncReader();
+    
+    /**
+     *  @fn void open (boost::shared_ptr<XenFile> ptrFile)
+     *  @brief Starts reading a file
+     *
+     *  @param ptrFile :    the file to read
+     */
+    void open(boost::shared_ptr<XenFile> ptrFile);
+    
+    /**
+     *  @fn TextBlock next ()
+     *  @brief Waits for the next block of lines
+     *
+     *  @return the block, null at the end of the file
+     */
+    TextBlock next();
+    
+private:
+    std::size_t blockSize;                  //!< The size of the blocks read
+    boost::shared_ptr<XenFile> ptrFile;     //!< The file being read
+    util::PCQueue<TextBlock> queue;         //!< The blocks read and not consumed yet
+    boost::thread thread;                   //!< The reader thread
+    std::string error;                      //!< The error met by the reader thread
+    bool done;                              //!< Indicates the end of the file has been consumed
+    
+    /**
+     *  @fn void run ()
+     *  @brief Body of the reader thread
+     */
+    void run();
+};
+
+#endif
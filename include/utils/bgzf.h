@@ -0,0 +1,176 @@
+/**
+ *  @file bgzf.h
+ *  @brief Block gzip (BGZF) writing, parallel reading and line index
+ *  @author Anthony Rousseau
+ *  @version 2.0.0
+ *  @date 19 October 2026
+ */
+
+
+/*  This file is part of the cross-entropy tool for data selection (XenC)
+ *  aimed at speech recognition and statistical machine translation.
+ *
+ *  Copyright 2013-2016, Anthony Rousseau, LIUM, University of Le Mans, France
+ *
+ *  Development of the XenC tool has been partially funded by the
+ *  European Commission under the MateCat project.
+ *
+ *  The XenC tool is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation
+ *
+ *  This library is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef BGZF_H_
+#define BGZF_H_
+
+#include <fstream>
+#include <vector>
+#include <stdint.h>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/iostreams/categories.hpp>
+
+#include "common.h"
+
+/**
+ *  @struct BgzfIndexEntry
+ *  @brief Where a member of a BGZF file starts
+ */
+struct BgzfIndexEntry {
+    uint64_t coff;          //!< Offset of the member in the compressed file
+    uint64_t uoff;          //!< Offset of its data in the uncompressed text
+    uint64_t line;          //!< Number of newlines before its data
+};
+
+/**
+ *  @struct BgzfState
+ *  @brief State of a BGZF file being written, shared by the copies of its sink
+ */
+struct BgzfState {
+    std::string fileName;               //!< The file written
+    std::ofstream out;                  //!< The compressed output
+    std::vector<char> pending;          //!< The data not compressed yet
+    std::vector<BgzfIndexEntry> index;  //!< The members written so far
+    uint64_t coff;                      //!< The compressed size written so far
+    uint64_t uoff;                      //!< The uncompressed size written so far
+    uint64_t lines;                     //!< The newlines written so far
+    bool closed;                        //!< Indicates the file is complete
+};
+
+/**
+ *  @class BgzfSink
+ *  @brief Boost iostreams sink writing block gzip (BGZF) files
+ *
+ *  The text is cut in members of at most 0xff00 bytes, on line boundaries when
+ *  lines are shorter, each compressed as an independent gzip member holding its
+ *  compressed size (BGZF "BC" extra field). Any gzip reader reads the file, and
+ *  XenC decompresses its members in parallel. A line index is written beside it.
+ */
+class BgzfSink {
+public:
+    typedef char char_type;     //!< Character type of the device
+    
+    /**
+     *  @struct category
+     *  @brief Boost iostreams category of the device
+     */
+    struct category : boost::iostreams::sink_tag, boost::iostreams::closable_tag {};
+    
+    /**
+     *  @fn BgzfSink (std::string fileName)
+     *  @brief Constructor, opening the file
+     *
+     *  @param fileName :   the file to write
+     */
+    explicit BgzfSink(std::string fileName);
+    
+    /**
+     *  @fn std::streamsize write (const char* s, std::streamsize n)
+     *  @brief Writes data to the file
+     *
+     *  @param s :  the data
+     *  @param n :  the size of the data
+     *  @return the size written
+     */
+    std::streamsize write(const char* s, std::streamsize n);
+    
+    /**
+     *  @fn void close ()
+     *  @brief Compresses the pending data, ends the file and writes its index
+     */
+    void close();
+    
+private:
+    boost::shared_ptr<BgzfState> ptrState;     //!< The state shared by the copies of the sink
+};
+
+/**
+ *  @class Bgzf
+ *  @brief Reading of block gzip (BGZF) files
+ */
+class Bgzf {
+public:
+    /**
+     *  @fn static bool isBgzf (std::string fileName)
+     *  @brief Tells if a file is a block gzip file
+     *
+     *  @param fileName :   the file
+     *  @return true if its first member holds a BGZF block size
+     */
+    static bool isBgzf(std::string fileName);
+    
+    /**
+     *  @fn static void read (std::string fileName, std::vector<char> &buf)
+     *  @brief Decompresses a block gzip file, its members in parallel
+     *
+     *  @param fileName :   the file
+     *  @param buf :        the uncompressed text
+     */
+    static void read(std::string fileName, std::vector<char> &buf);
+    
+    /**
+     *  @fn static bool readLines (std::string fileName, uint64_t first, uint64_t last, std::vector<char> &buf)
+     *  @brief Reads a range of lines of a block gzip file through its index
+     *
+     *  Only the members holding the range are decompressed.
+     *
+     *  @param fileName :   the file
+     *  @param first :      the first line to read
+     *  @param last :       the line after the last one to read
+     *  @param buf :        the buffer the lines are appended to, each ending with a newline
+     *  @return false if the file has no valid index
+     */
+    static bool readLines(std::string fileName, uint64_t first, uint64_t last, std::vector<char> &buf);
+    
+    /**
+     *  @fn static std::string getIndexName (std::string fileName)
+     *  @brief Builds the name of the line index of a block gzip file
+     *
+     *  @param fileName :   the file
+     *  @return the name of its index
+     */
+    static std::string getIndexName(std::string fileName);
+    
+    /**
+     *  @fn static void writeMember (BgzfState &state, const char* data, std::size_t size)
+     *  @brief Compresses and writes one member
+     *
+     *  @param state :  the file written
+     *  @param data :   the uncompressed data
+     *  @param size :   the size of the data, at most maxMember
+     */
+    static void writeMember(BgzfState &state, const char* data, std::size_t size);
+    
+    static const std::size_t maxMember = 0xff00;    //!< Largest uncompressed size of a member
+};
+
+#endif
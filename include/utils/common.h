@@ -62,6 +62,7 @@ typedef struct _Options {
     std::string oPTable;    //!< The out-of-domain phrase-table
 	int mode;               //!< The filtering mode
     bool mean;              //!< Indicates mean computation
+    int meanK;              //!< The number of out-of-domain sample LMs averaged by mean computation
     bool sim;               //!< Indicates similarity computation
     bool simOnly;           //!< Indicates similarity computation only
     int vecSize;            //!< The vector size for similarity
@@ -77,6 +78,7 @@ typedef struct _Options {
 	int order;              //!< The order for language models estimation
     std::size_t memPC;      //!< The percentage of system memory to use
     std::string temp;       //!< The temporary files location
+    std::size_t sortMem;    //!< The memory of the output sort before it spills to disk
     std::size_t minblk;     //!< The minimum block size
     std::size_t sortblk;    //!< The minimum block size for sort
     bool exclOOVs;          //!< Indicates if the OOVs must be excluded from PPL computation
@@ -99,6 +101,20 @@ typedef struct _Options {
     int threads;            //!< The number of threads
     bool sortOnly;          //!< Indicated outputting only the "sorted" file (not the "scored" one)
     int maxEvalPC;          //!< The maximum eval percentage
+    std::string evalCache;  //!< The eval perplexities cache file shared by all runs (next to the sorted output if empty)
+    bool server;            //!< Indicates long-running scoring server mode
+    std::string socket;     //!< The Unix socket path for server mode (stdin/stdout if empty)
+    int batchSize;          //!< The maximum number of lines scored per server batch
+    bool incremental;       //!< Indicates incremental re-scoring through the score store
+    bool checkpoint;        //!< Indicates durable checkpoints of heavy stages (and resuming from them)
+    int vocCutoff;          //!< The minimum count of a word kept in estimated vocabularies
+    std::string numa;       //!< The NUMA placement of language models (none, replicate or interleave)
+    std::string selectTop;  //!< The number (or percentage, with %) of best lines to select instead of sorting all
+    std::string selectThr;  //!< The score threshold of the lines to select instead of sorting all
+    bool selectSorted;      //!< Indicates the selected lines are written sorted (in corpus order otherwise)
+    std::string shard;      //!< The slice of the out-of-domain corpus scored by this process (i/N)
+    int mergeShards;        //!< The number of sorted shards to merge into the final output
+    int seed;               //!< The seed of the sample extraction (0 for a time based seed)
 } Options, *LPOptions;
 
 /**
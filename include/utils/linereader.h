@@ -0,0 +1,95 @@
+/**
+ *  @file linereader.h
+ *  @brief Class streaming the lines of a plain text or gzipped file
+ *  @author Anthony Rousseau
+ *  @version 2.0.0
+ *  @date 19 October 2026
+ */
+
+/*  This file is part of the cross-entropy tool for data selection (XenC)
+ *  aimed at speech recognition and statistical machine translation.
+ *
+ *  Copyright 2013-2016, Anthony Rousseau, LIUM, University of Le Mans, France
+ *
+ *  Development of the XenC tool has been partially funded by the
+ *  European Commission under the MateCat project.
+ *
+ *  The XenC tool is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation
+ *
+ *  This library is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef LINEREADER_H_
+#define LINEREADER_H_
+
+#include <fstream>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+#include "common.h"
+#include "../xenfile.h"
+
+/**
+ *  @class LineReader
+ *  @brief Class streaming the lines of a plain text or gzipped file
+ *
+ *  Only the current line is held in memory, for files that are read
+ *  once in order and do not need to be loaded as a Corpus.
+ */
+class LineReader {
+public:
+    /**
+     *  @fn LineReader ()
+     *  @brief Default constructor
+     */
+    LineReader();
+
+    /**
+     *  @fn ~LineReader ()
+     *  @brief Default destructor
+     */
+    ~LineReader();
+
+    /**
+     *  @fn void open (boost::shared_ptr<XenFile> ptrFile)
+     *  @brief Opens a file for reading
+     *
+     *  @param ptrFile :    the file to read
+     */
+    void open(boost::shared_ptr<XenFile> ptrFile);
+
+    /**
+     *  @fn bool next (std::string &line)
+     *  @brief Reads the next line of the file
+     *
+     *  @param line :   the line read, without its newline
+     *  @return false at the end of the file
+     */
+    bool next(std::string &line);
+
+    /**
+     *  @fn unsigned int getCount () const
+     *  @brief Accessor to the number of lines read so far
+     *
+     *  @return the number of lines read
+     */
+    unsigned int getCount() const;
+
+private:
+    boost::shared_ptr<XenFile> ptrFile;                     //!< The file being read
+    std::ifstream file;                                     //!< The underlying file stream
+    boost::iostreams::filtering_istream in;                 //!< The (decompressed) line stream
+    unsigned int count;                                     //!< The number of lines read so far
+};
+
+#endif
@@ -0,0 +1,170 @@
+/**
+ *  @file linesorter.h
+ *  @brief Class sorting the output lines on their scores, in memory or on disk
+ *  @author Anthony Rousseau
+ *  @version 2.0.0
+ *  @date 19 October 2026
+ */
+
+
+/*  This file is part of the cross-entropy tool for data selection (XenC)
+ *  aimed at speech recognition and statistical machine translation.
+ *
+ *  Copyright 2013-2016, Anthony Rousseau, LIUM, University of Le Mans, France
+ *
+ *  Development of the XenC tool has been partially funded by the
+ *  European Commission under the MateCat project.
+ *
+ *  The XenC tool is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation
+ *
+ *  This library is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef LINESORTER_H_
+#define LINESORTER_H_
+
+#include <vector>
+#include <stdint.h>
+
+#include <boost/scoped_ptr.hpp>
+
+#include "common.h"
+#include "../kenlm/util/stream/chain.hh"
+#include "../kenlm/util/stream/sort.hh"
+#include "../kenlm/util/stream/stream.hh"
+
+/**
+ *  @struct SortRecord
+ *  @brief A line to sort: its score and its position in the Corpus
+ */
+struct SortRecord {
+    double score;           //!< The score of the line
+    uint64_t pos;           //!< The position of the line
+};
+
+/**
+ *  @struct SortRecordLess
+ *  @brief Orders the records by score, then by position (both descending with --rev)
+ */
+struct SortRecordLess {
+    bool rev;               //!< Descending order (--rev)
+    
+    bool operator()(const SortRecord &a, const SortRecord &b) const {
+        if (a.score != b.score)
+            return rev ? a.score > b.score : a.score < b.score;
+        
+        return rev ? a.pos > b.pos : a.pos < b.pos;
+    }
+    
+    // KenLM SizedSort also instantiates this comparator for the record sizes it
+    // dispatches on but never uses here (a 4 byte record seen as a SortRecord)
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Warray-bounds"
+#endif
+    bool operator()(const void* a, const void* b) const {
+        return (*this)(*static_cast<const SortRecord*>(a), *static_cast<const SortRecord*>(b));
+    }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+};
+
+/**
+ *  @class LineSorter
+ *  @brief Class sorting the output lines on their scores, in memory or on disk
+ *
+ *  Only the (score, position) records are sorted, the text staying in the Corpus.
+ *  Records are kept in memory until they exceed the budget, then they are spilled
+ *  to the KenLM block sorter: sorted runs are written to temporary files and read
+ *  back through a streaming merge.
+ */
+class LineSorter {
+public:
+    /**
+     *  @fn LineSorter (std::size_t budget, std::string temp, bool rev)
+     *  @brief Constructor
+     *
+     *  @param budget :     the memory the records may use, in bytes
+     *  @param temp :       the location of the temporary files
+     *  @param rev :        true to sort in descending order
+     */
+    LineSorter(std::size_t budget, std::string temp, bool rev);
+    
+    /**
+     *  @fn ~LineSorter ()
+     *  @brief Destructor, draining the sort if needed
+     */
+    ~LineSorter();
+    
+    /**
+     *  @fn void add (double score, unsigned int pos)
+     *  @brief Adds a line to sort
+     *
+     *  @param score :  the score of the line
+     *  @param pos :    the position of the line
+     */
+    void add(double score, unsigned int pos);
+    
+    /**
+     *  @fn void finish ()
+     *  @brief Ends the input and sorts the lines
+     */
+    void finish();
+    
+    /**
+     *  @fn bool next (double &score, unsigned int &pos)
+     *  @brief Reads the next line in sorted order
+     *
+     *  @param score :  the score of the line
+     *  @param pos :    the position of the line
+     *  @return false when all lines have been read
+     */
+    bool next(double &score, unsigned int &pos);
+    
+    /**
+     *  @fn uint64_t getSize () const
+     *  @brief Accessor to the number of lines added
+     *
+     *  @return the number of lines
+     */
+    uint64_t getSize() const;
+    
+    /**
+     *  @fn bool isExternal () const
+     *  @brief Tells if the lines have been spilled to disk
+     *
+     *  @return true if the sort is done on disk
+     */
+    bool isExternal() const;
+    
+private:
+    std::size_t budget;                 //!< The memory the records may use
+    std::string temp;                   //!< The prefix of the temporary files
+    SortRecordLess less;                //!< The order of the records
+    std::vector<SortRecord> records;    //!< The records, while they fit in the budget
+    std::size_t cursor;                 //!< The next record read from memory
+    uint64_t size;                      //!< The number of lines added
+    boost::scoped_ptr<util::stream::Chain> ptrChain;                    //!< The chain writing the sorted runs
+    boost::scoped_ptr<util::stream::Stream> ptrIn;                      //!< The input end of the run chain
+    boost::scoped_ptr<util::stream::Sort<SortRecordLess> > ptrSort;     //!< The KenLM block sorter
+    boost::scoped_ptr<util::stream::Chain> ptrOutChain;                 //!< The chain merging the sorted runs
+    boost::scoped_ptr<util::stream::Stream> ptrOut;                     //!< The output end of the merge chain
+    
+    /**
+     *  @fn void spill ()
+     *  @brief Moves the records from memory to the block sorter
+     */
+    void spill();
+};
+
+#endif
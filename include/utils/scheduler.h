@@ -0,0 +1,370 @@
+/**
+ *  @file scheduler.h
+ *  @brief Process-wide work-stealing task scheduler
+ *  @author Anthony Rousseau
+ *  @version 2.0.0
+ *  @date 19 October 2026
+ */
+
+
+/*  This file is part of the cross-entropy tool for data selection (XenC)
+ *  aimed at speech recognition and statistical machine translation.
+ *
+ *  Copyright 2013-2016, Anthony Rousseau, LIUM, University of Le Mans, France
+ *
+ *  Development of the XenC tool has been partially funded by the
+ *  European Commission under the MateCat project.
+ *
+ *  The XenC tool is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation
+ *
+ *  This library is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+#include <deque>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+#include "common.h"
+
+typedef boost::function<void ()> Task;      //!< A unit of work run by the scheduler
+
+/**
+ *  @class TaskGroup
+ *  @brief A set of tasks spawned on the scheduler and waited for together
+ *
+ *  Tasks may spawn and wait for their own groups: a worker waiting for a group
+ *  runs pending tasks instead of blocking, so nested groups never starve the workers.
+ *  The first error raised by a task is rethrown by wait().
+ */
+class TaskGroup {
+public:
+    /**
+     *  @fn TaskGroup ()
+     *  @brief Default constructor
+     */
+    TaskGroup();
+
+    /**
+     *  @fn ~TaskGroup ()
+     *  @brief Default destructor, waits for the remaining tasks
+     */
+    ~TaskGroup();
+
+    /**
+     *  @fn void run (Task task)
+     *  @brief Spawns a task of the group on the scheduler
+     *
+     *  @param task :   the task to run
+     */
+    void run(Task task);
+
+    /**
+     *  @fn void wait ()
+     *  @brief Waits for all the tasks of the group, rethrowing the first task error
+     */
+    void wait();
+
+private:
+    friend class Scheduler;
+
+    unsigned int pending;           //!< Number of spawned tasks not finished yet
+    std::string error;              //!< First error raised by a task of the group
+    boost::mutex mtx;               //!< Protects the pending count and error
+    boost::condition_variable done; //!< Signaled when the last task finishes
+
+    /**
+     *  @fn void finish (const std::string &err)
+     *  @brief Records the end of a task of the group
+     *
+     *  @param err :    the error raised by the task, empty if none
+     */
+    void finish(const std::string &err);
+
+    /**
+     *  @fn bool isDone ()
+     *  @brief Tells if all the tasks of the group are finished
+     *
+     *  @return true if no task of the group is pending
+     */
+    bool isDone();
+};
+
+/**
+ *  @class MemoryBudget
+ *  @brief Counting semaphore on a memory budget, in bytes
+ *
+ *  A request larger than the whole budget is granted once nothing else is held,
+ *  so it waits but never deadlocks.
+ */
+class MemoryBudget {
+public:
+    /**
+     *  @fn MemoryBudget (std::size_t total)
+     *  @brief Constructor from the total budget
+     *
+     *  @param total :  the budget, in bytes
+     */
+    MemoryBudget(std::size_t total);
+
+    /**
+     *  @fn ~MemoryBudget ()
+     *  @brief Default destructor
+     */
+    ~MemoryBudget();
+
+    /**
+     *  @fn void acquire (std::size_t bytes)
+     *  @brief Waits until the requested memory fits in the budget, then holds it
+     *
+     *  @param bytes :  the requested memory
+     */
+    void acquire(std::size_t bytes);
+
+    /**
+     *  @fn void release (std::size_t bytes)
+     *  @brief Gives back memory held with acquire
+     *
+     *  @param bytes :  the memory to give back
+     */
+    void release(std::size_t bytes);
+
+    /**
+     *  @fn std::size_t getTotal () const
+     *  @brief Accessor to the total budget
+     *
+     *  @return the budget, in bytes
+     */
+    std::size_t getTotal() const;
+
+private:
+    std::size_t total;                  //!< The budget
+    std::size_t used;                   //!< The memory currently held
+    boost::mutex mtx;                   //!< Protects the held memory
+    boost::condition_variable freed;    //!< Signaled when memory is given back
+};
+
+/**
+ *  @struct Job
+ *  @brief A task waiting in a scheduler queue, and the group it belongs to
+ */
+struct Job {
+    Task task;          //!< The task to run
+    TaskGroup* group;   //!< The group to notify once the task is done
+};
+
+/**
+ *  @struct WorkerQueue
+ *  @brief The task deque of a worker
+ *
+ *  The owner pushes and pops at the back, idle workers steal from the front.
+ */
+struct WorkerQueue {
+    std::deque<Job> jobs;   //!< The pending jobs
+    boost::mutex mtx;       //!< Protects the deque
+};
+
+/**
+ *  @class Scheduler
+ *  @brief Process-wide work-stealing task scheduler
+ *
+ *  A single set of --threads workers is started on first use and shared by every parallel stage.
+ *  Each worker owns a deque of tasks: tasks spawned by a worker go to its own deque,
+ *  tasks spawned by other threads are injected in a shared queue, and idle workers
+ *  steal the oldest tasks of the others. With --numa replicate, workers are pinned
+ *  to the NUMA nodes round robin.
+ */
+class Scheduler {
+public:
+    /**
+     *  @fn static Scheduler* getInstance ()
+     *  @brief Singleton accessor, workers are started on first use
+     *
+     *  @return the scheduler
+     */
+    static Scheduler* getInstance();
+
+    /**
+     *  @fn static void deleteInstance ()
+     *  @brief Stops the workers and deletes the scheduler
+     */
+    static void deleteInstance();
+
+    /**
+     *  @fn void resize (unsigned int threads)
+     *  @brief Restarts the scheduler with another number of workers, must be called while idle
+     *
+     *  @param threads :    the number of workers
+     */
+    void resize(unsigned int threads);
+
+    /**
+     *  @fn unsigned int getSize () const
+     *  @brief Accessor to the number of workers
+     *
+     *  @return the number of workers
+     */
+    unsigned int getSize() const;
+
+    /**
+     *  @fn int getWorker () const
+     *  @brief Accessor to the index of the calling worker
+     *
+     *  @return the worker index, -1 if the calling thread is not a worker
+     */
+    int getWorker() const;
+
+    /**
+     *  @fn static void parallelFor (unsigned int begin, unsigned int end, unsigned int grain, boost::function<void (unsigned int, unsigned int)> body)
+     *  @brief Runs a function on sub-ranges of [begin, end) in parallel
+     *
+     *  @param begin :  the first index
+     *  @param end :    the index after the last one
+     *  @param grain :  the size of the sub-ranges
+     *  @param body :   the function to run on each sub-range [first, last)
+     */
+    static void parallelFor(unsigned int begin, unsigned int end, unsigned int grain, boost::function<void (unsigned int, unsigned int)> body);
+
+    /**
+     *  @brief Maps sub-ranges of [begin, end) in parallel and reduces their results in range order
+     *
+     *  The result only depends on the grain, not on the number of workers.
+     *
+     *  @tparam T :     the result type
+     *  @param begin :  the first index
+     *  @param end :    the index after the last one
+     *  @param grain :  the size of the sub-ranges
+     *  @param init :   the identity of the reduction
+     *  @param map :    the function computing the result of a sub-range [first, last)
+     *  @param reduce : the function combining two results
+     *  @return the reduced result
+     */
+    template<typename T> static T parallelReduce(unsigned int begin, unsigned int end, unsigned int grain, T init, boost::function<T (unsigned int, unsigned int)> map, boost::function<T (const T&, const T&)> reduce) {
+        grain = std::max(1u, grain);
+
+        unsigned int chunks = (end > begin) ? (end - begin + grain - 1) / grain : 0;
+        std::vector<T> parts(chunks, init);
+        TaskGroup group;
+
+        for (unsigned int c = 0; c < chunks; c++)
+            group.run(boost::bind(&Scheduler::mapChunk<T>, map, begin + c * grain, std::min(end, begin + (c + 1) * grain), &parts[c]));
+
+        group.wait();
+
+        T res = init;
+        for (unsigned int c = 0; c < chunks; c++)
+            res = reduce(res, parts[c]);
+
+        return res;
+    }
+
+private:
+    friend class TaskGroup;
+
+    static Scheduler* _instance;                                //!< The singleton instance
+
+    std::vector<boost::shared_ptr<boost::thread> > workers;     //!< The worker threads, by index
+    std::vector<boost::thread::id> ids;                         //!< The worker thread ids, by index
+    std::vector<boost::shared_ptr<WorkerQueue> > queues;        //!< The worker deques, by index
+    std::deque<Job> injected;                                   //!< Tasks spawned by non-worker threads
+    int queued;                                                 //!< Number of jobs in all queues
+    bool stop;                                                  //!< Tells the workers to exit
+    boost::mutex mtx;                                           //!< Protects the injected queue, counter and stop flag
+    boost::condition_variable wake;                             //!< Signaled when jobs are queued or on stop
+
+    /**
+     *  @fn Scheduler (unsigned int threads)
+     *  @brief Singleton private constructor, starts the workers
+     *
+     *  @param threads :    the number of workers
+     */
+    Scheduler(unsigned int threads);
+
+    /**
+     *  @fn ~Scheduler ()
+     *  @brief Singleton private destructor, stops the workers
+     */
+    ~Scheduler();
+
+    /**
+     *  @fn void start (unsigned int threads)
+     *  @brief Starts the workers
+     *
+     *  @param threads :    the number of workers
+     */
+    void start(unsigned int threads);
+
+    /**
+     *  @fn void shutdown ()
+     *  @brief Stops and joins the workers
+     */
+    void shutdown();
+
+    /**
+     *  @fn void spawn (Task task, TaskGroup* group)
+     *  @brief Queues a task on the deque of the calling worker, or on the shared queue
+     *
+     *  @param task :   the task to run
+     *  @param group :  the group the task belongs to
+     */
+    void spawn(Task task, TaskGroup* group);
+
+    /**
+     *  @fn bool findJob (int self, Job &job)
+     *  @brief Takes a job from the own deque, the shared queue, or another worker deque
+     *
+     *  @param self :   the calling worker index
+     *  @param job :    the job found
+     *  @return true if a job has been found
+     */
+    bool findJob(int self, Job &job);
+
+    /**
+     *  @fn void execute (Job &job)
+     *  @brief Runs a job and notifies its group
+     *
+     *  @param job :    the job to run
+     */
+    void execute(Job &job);
+
+    /**
+     *  @fn void workerLoop (int self)
+     *  @brief Main loop of a worker
+     *
+     *  @param self :   the worker index
+     */
+    void workerLoop(int self);
+
+    /**
+     *  @brief Stores the result of a sub-range for parallelReduce
+     *
+     *  @tparam T :     the result type
+     *  @param map :    the function computing the result of a sub-range
+     *  @param first :  the first index of the sub-range
+     *  @param last :   the index after the last one
+     *  @param out :    where to store the result
+     */
+    template<typename T> static void mapChunk(boost::function<T (unsigned int, unsigned int)> map, unsigned int first, unsigned int last, T* out) {
+        *out = map(first, last);
+    }
+};
+
+#endif
@@ -0,0 +1,169 @@
+/**
+ *  @file tokenizer.h
+ *  @brief Class handling the whitespace tokenization and hashing of text lines
+ *  @author Anthony Rousseau
+ *  @version 2.0.0
+ *  @date 19 October 2026
+ */
+
+/*  This file is part of the cross-entropy tool for data selection (XenC)
+ *  aimed at speech recognition and statistical machine translation.
+ *
+ *  Copyright 2013-2016, Anthony Rousseau, LIUM, University of Le Mans, France
+ *
+ *  Development of the XenC tool has been partially funded by the
+ *  European Commission under the MateCat project.
+ *
+ *  The XenC tool is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation
+ *
+ *  This library is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef TOKENIZER_H_
+#define TOKENIZER_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include <boost/unordered_map.hpp>
+
+#include "../kenlm/util/string_piece.hh"
+
+/**
+ *  @struct Token
+ *  @brief A token of a line and its hash
+ */
+struct Token {
+    StringPiece str;        //!< The token text, pointing into the tokenized line
+    uint64_t hash;          //!< The token hash, the same KenLM uses for its vocabulary
+};
+
+/**
+ *  @struct WordCount
+ *  @brief A word and its number of occurrences
+ */
+struct WordCount {
+    std::string word;       //!< The word
+    uint64_t count;         //!< The word occurrences
+};
+
+typedef boost::unordered_map<uint64_t, WordCount> WordCounts;    //!< Hash map of words and their counts, keyed by word hash
+
+/**
+ *  @struct TokenizedText
+ *  @brief Lines tokenized once, each token stored as the index of its distinct word
+ *
+ *  A language model maps the distinct words to its own ids once,
+ *  then every token id is a plain array lookup.
+ */
+struct TokenizedText {
+    std::vector<uint64_t> types;    //!< Hash of each distinct word
+    std::vector<uint32_t> words;    //!< Distinct word index of each token, line after line
+    std::vector<uint64_t> starts;   //!< Position of the first token of each line in words (plus the token count)
+};
+
+/**
+ *  @class Tokenizer
+ *  @brief Class handling the whitespace tokenization and hashing of text lines
+ *
+ *  Lines are split on single spaces, as boost::split(..., boost::is_any_of(" ")) does,
+ *  empty tokens included. Spaces are located a block at a time with SSE2 or AVX2
+ *  compares when the build targets them, and tokens are handed out as StringPiece
+ *  with their 64-bit hash, so no string is allocated on the tokenization path.
+ *  The hash is the one of KenLM vocabularies, so it can be given to
+ *  ProbingVocabulary::IndexHash as well as used as a key of XenC's own tables.
+ */
+class Tokenizer {
+public:
+    /**
+     *  @fn Tokenizer ()
+     *  @brief Default constructor
+     */
+    Tokenizer();
+
+    /**
+     *  @fn Tokenizer (const std::string &src)
+     *  @brief Constructor tokenizing a string
+     *
+     *  @param src :    the string to tokenize, must outlive the tokenizer
+     */
+    Tokenizer(const std::string &src);
+
+    /**
+     *  @fn ~Tokenizer ()
+     *  @brief Default destructor
+     */
+    ~Tokenizer();
+
+    /**
+     *  @fn void reset (const char* data, std::size_t len)
+     *  @brief Starts the tokenization of a new line
+     *
+     *  @param data :   the line text, must outlive the tokenization
+     *  @param len :    the line length
+     */
+    void reset(const char* data, std::size_t len);
+
+    /**
+     *  @fn void reset (const std::string &src)
+     *  @brief Starts the tokenization of a new line
+     *
+     *  @param src :    the line, must outlive the tokenization
+     */
+    void reset(const std::string &src);
+
+    /**
+     *  @fn bool next (Token &tok)
+     *  @brief Gets the next token of the line
+     *
+     *  @param tok :    the token to fill
+     *  @return false once all the tokens have been handed out
+     */
+    bool next(Token &tok);
+
+    /**
+     *  @fn static uint64_t hash (const StringPiece &str)
+     *  @brief Computes the hash of a word, as found in the tokens
+     *
+     *  @param str :    the word
+     *  @return the word hash
+     */
+    static uint64_t hash(const StringPiece &str);
+
+    /**
+     *  @fn static void countWords (const char* data, std::size_t len, WordCounts &counts)
+     *  @brief Adds the tokens of a line to word counts
+     *
+     *  @param data :   the line text
+     *  @param len :    the line length
+     *  @param counts : the word counts to add to
+     */
+    static void countWords(const char* data, std::size_t len, WordCounts &counts);
+
+private:
+    const char* cur;        //!< Start of the next token
+    const char* end;        //!< End of the line
+    const char* block;      //!< Start of the scanned block
+    uint32_t mask;          //!< Spaces of the scanned block not handed out yet, one bit per byte
+    bool done;              //!< Indicates the last token has been handed out
+
+    /**
+     *  @fn const char* nextSpace ()
+     *  @brief Finds the next space of the line
+     *
+     *  @return a pointer to the next space, or to the end of the line
+     */
+    const char* nextSpace();
+};
+
+#endif
@@ -34,6 +34,7 @@
 #define XENIO_H_
 
 #include "common.h"
+#include "../bitext.h"
 #include "../eval.h"
 #include "../score.h"
 #include "../xenoption.h"
@@ -60,6 +61,18 @@ class XenVocab;     // Forward declaration
 
 typedef std::map<int, double, std::greater<int> > EvalMap;  //!< descending ordered map on integers as keys and doubles as values
 
+/**
+ *  @struct Selection
+ *  @brief The best lines requested by --select-top and --select-threshold
+ */
+struct Selection {
+    bool top;           //!< Indicates a number of lines is requested
+    bool percent;       //!< Indicates the number is a percentage of the valid lines
+    double count;       //!< The number (or percentage) of lines
+    bool threshold;     //!< Indicates a score threshold is requested
+    double thr;         //!< The score threshold
+};
+
 /**
  *  @class XenIO
  *  @brief Class handling all input/output operations of XenC
@@ -79,14 +92,13 @@ public:
     static void cleanCorpusMono(boost::shared_ptr<Corpus> ptrCorp, boost::shared_ptr<Score> ptrScore);
     
     /**
-     *  @fn static void cleanCorpusBi (boost::shared_ptr<Corpus> ptrCorpSource, boost::shared_ptr<Corpus> ptrCorpTarget, boost::shared_ptr<Score> ptrScore)
-     *  @brief Bilingual corpus cleaning (ensures no empty lines)
+     *  @fn static void cleanCorpusBi (boost::shared_ptr<Bitext> ptrBitext, boost::shared_ptr<Score> ptrScore)
+     *  @brief Bilingual corpus cleaning (ensures no empty lines), on both sides in lockstep
      *
-     *  @param ptrCorpSource :  the source language Corpus to clean
-     *  @param ptrCorpTarget :  the target language Corpus to clean
+     *  @param ptrBitext :      the source and target language corpora to clean
      *  @param ptrScore :       the associated Score object to clean
      */
-    static void cleanCorpusBi(boost::shared_ptr<Corpus> ptrCorpSource, boost::shared_ptr<Corpus> ptrCorpTarget, boost::shared_ptr<Score> ptrScore);
+    static void cleanCorpusBi(boost::shared_ptr<Bitext> ptrBitext, boost::shared_ptr<Score> ptrScore);
     
     /**
      *  @fn static void writeMonoOutput (boost::shared_ptr<Corpus> ptrCorp, boost::shared_ptr<Score> ptrScore)
@@ -108,13 +120,84 @@ public:
     static void writeBiOutput(boost::shared_ptr<Corpus> ptrCorpSource, boost::shared_ptr<Corpus> ptrCorpTarget, boost::shared_ptr<Score> ptrScore);
     
     /**
-     *  @fn static void writeNewPT (boost::shared_ptr<PhraseTable> ptrPT, boost::shared_ptr<Score> ptrScore)
+     *  @fn static bool parseSelection (std::string top, std::string thr, Selection &sel)
+     *  @brief Parses the --select-top and --select-threshold values
+     *
+     *  @param top :    the number of lines (or percentage, with a trailing %), may be empty
+     *  @param thr :    the score threshold, may be empty
+     *  @param sel :    the parsed selection
+     *  @return false if a value is not valid
+     */
+    static bool parseSelection(std::string top, std::string thr, Selection &sel);
+    
+    /**
+     *  @fn static std::vector<unsigned int> selectLines (boost::shared_ptr<Score> ptrScore, const boost::dynamic_bitset<> &valid)
+     *  @brief Selects the best valid lines without sorting the whole Score
+     *
+     *  Sub-ranges of the scores are partially selected in parallel (nth_element),
+     *  then their candidates are reduced by a last partial selection. Ties are broken
+     *  by position, so the selected lines are the first ones of the sorted output.
+     *
+     *  @param ptrScore :   the Score object to select from
+     *  @param valid :      the lines which can be selected
+     *  @return the positions of the selected lines, sorted by score or in corpus order (--select-sorted)
+     */
+    static std::vector<unsigned int> selectLines(boost::shared_ptr<Score> ptrScore, const boost::dynamic_bitset<> &valid);
+    
+    /**
+     *  @fn static void writeSelection (boost::shared_ptr<Corpus> ptrCorpSource, boost::shared_ptr<Corpus> ptrCorpTarget, boost::shared_ptr<Score> ptrScore)
+     *  @brief Writes the selected best lines result file, instead of the scored/sorted ones
+     *
+     *  @param ptrCorpSource :  the source language Corpus to write
+     *  @param ptrCorpTarget :  the target language Corpus to write (null if monolingual)
+     *  @param ptrScore :       the associated Score object
+     */
+    static void writeSelection(boost::shared_ptr<Corpus> ptrCorpSource, boost::shared_ptr<Corpus> ptrCorpTarget, boost::shared_ptr<Score> ptrScore);
+    
+    /**
+     *  @fn static std::string getShardName (std::string baseName, int shard, int shards)
+     *  @brief Builds the output name of a shard of a sharded run
+     *
+     *  @param baseName :   the output name of the unsharded run
+     *  @param shard :      index (from 1) of the shard
+     *  @param shards :     number of shards
+     *  @return the output name of the shard
+     */
+    static std::string getShardName(std::string baseName, int shard, int shards);
+    
+    /**
+     *  @fn static void writeShard (boost::shared_ptr<Corpus> ptrCorpSource, boost::shared_ptr<Corpus> ptrCorpTarget, boost::shared_ptr<Score> ptrScore)
+     *  @brief Writes the sorted shard of a sharded run, instead of the scored/sorted files
+     *
+     *  Scores are written raw, with their position in the whole file and the bounds
+     *  of the shard in a header line, so that the merge calibrates them as one run would.
+     *
+     *  @param ptrCorpSource :  the source language Corpus slice to write
+     *  @param ptrCorpTarget :  the target language Corpus slice to write (null if monolingual)
+     *  @param ptrScore :       the associated Score object, for the printing status
+     */
+    static void writeShard(boost::shared_ptr<Corpus> ptrCorpSource, boost::shared_ptr<Corpus> ptrCorpTarget, boost::shared_ptr<Score> ptrScore);
+    
+    /**
+     *  @fn static void mergeShards (int shards)
+     *  @brief Merges the sorted shards of a sharded run into the final sorted file
+     *
+     *  Shards are streamed in a k-way merge, only one run of equal scores per shard
+     *  being held in memory. The output is the one of the unsharded run.
+     *
+     *  @param shards : number of shards to merge
+     */
+    static void mergeShards(int shards);
+    
+    /**
+     *  @fn static void writeNewPT (boost::shared_ptr<PhraseTable> ptrPT, boost::shared_ptr<Score> ptrScore, boost::shared_ptr<Score> ptrLocal)
      *  @brief Writes a new rescored phrase-table
      *
      *  @param ptrPT :      the new phrase-table to write
      *  @param ptrScore :   the associated Score object to write
+     *  @param ptrLocal :   the local scores to append, null without --local
      */
-    static void writeNewPT(boost::shared_ptr<PhraseTable> ptrPT, boost::shared_ptr<Score> ptrScore);
+    static void writeNewPT(boost::shared_ptr<PhraseTable> ptrPT, boost::shared_ptr<Score> ptrScore, boost::shared_ptr<Score> ptrLocal);
     
     /**
      *  @fn static std::string writeSourcePhrases (boost::shared_ptr<PhraseTable> ptrPT)
@@ -144,13 +227,13 @@ public:
     static void writeEval(boost::shared_ptr<EvalMap> ptrEvalMap, std::string distName);
 
     /**
-     *  @fn static void writeVocab (std::map<std::string, int> voc, std::string fileName)
+     *  @fn static void writeVocab (const std::vector<std::string> &words, std::string fileName)
      *  @brief Writes a vocab to file
      *
-     *  @param ptrEvalMap :     the map containing the vocab to write
-     *  @param distName :       the vocab file name
+     *  @param words :          the sorted vocab words to write
+     *  @param fileName :       the vocab file name
      */
-    static void writeVocab(std::map<std::string, int> voc, std::string fileName);
+    static void writeVocab(const std::vector<std::string> &words, std::string fileName);
 
     /**
      *  @fn static void writeXRpart (boost::shared_ptr<XenResult> ptrXR, int pc, std::string fileName = "")
@@ -180,6 +263,17 @@ public:
      */
     static std::vector<std::string> read(boost::shared_ptr<XenFile> ptrFile);
     
+    /**
+     *  @fn static void readBuffer (boost::shared_ptr<XenFile> ptrFile, std::vector<char> &buf)
+     *  @brief Reads a whole file (plain text/gzipped) into a buffer
+     *
+     *  The buffer always ends with a newline if it is not empty.
+     *
+     *  @param ptrFile :    the file to read
+     *  @param buf :        the buffer to fill
+     */
+    static void readBuffer(boost::shared_ptr<XenFile> ptrFile, std::vector<char> &buf);
+    
     /**
      *  @fn static boost::shared_ptr<EvalMap> readDist(std::string distFile)
      *  @brief Reads a evaluation/best point distribution file
@@ -191,7 +285,7 @@ public:
 
     /**
      *  @fn static void delFile(std::string fileName)
-     *  @brief Deletes a file from the filesystem
+     *  @brief Deletes a file from the filesystem, with its BGZF line index if any
      *
      *  @param fileName :   file to delete
      */
@@ -0,0 +1,99 @@
+/**
+ *  @file xennuma.h
+ *  @brief Class handling NUMA placement of language models and scoring threads
+ *  @author Anthony Rousseau
+ *  @version 2.0.0
+ *  @date 19 October 2026
+ */
+
+
+/*  This file is part of the cross-entropy tool for data selection (XenC)
+ *  aimed at speech recognition and statistical machine translation.
+ *
+ *  Copyright 2013-2016, Anthony Rousseau, LIUM, University of Le Mans, France
+ *
+ *  Development of the XenC tool has been partially funded by the
+ *  European Commission under the MateCat project.
+ *
+ *  The XenC tool is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation
+ *
+ *  This library is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef XENNUMA_H_
+#define XENNUMA_H_
+
+#include "common.h"
+
+/**
+ *  @class XenNuma
+ *  @brief Class handling NUMA placement of language models and scoring threads
+ *
+ *  With --numa replicate, every language model is loaded once per node
+ *  and each scheduler worker is pinned to a node, so it only reads its node-local copy.
+ *  With --numa interleave, a single copy has its pages spread over all nodes.
+ *  Without libnuma, or on a single node machine, everything falls back to one copy.
+ */
+class XenNuma {
+public:
+    /**
+     *  @fn static int getNodes ()
+     *  @brief Accessor to the number of nodes language models are placed on
+     *
+     *  @return the number of nodes, 1 if NUMA placement is off or unavailable
+     */
+    static int getNodes();
+
+    /**
+     *  @fn static bool getReplicate ()
+     *  @brief Tells if language models must be replicated on each node
+     *
+     *  @return true if one copy per node must be loaded
+     */
+    static bool getReplicate();
+
+    /**
+     *  @fn static bool getInterleave ()
+     *  @brief Tells if language model pages must be interleaved over the nodes
+     *
+     *  @return true if a single interleaved copy must be loaded
+     */
+    static bool getInterleave();
+
+    /**
+     *  @fn static void bindToNode (int node)
+     *  @brief Pins the calling thread and its allocations to a node
+     *
+     *  @param node :   the node to run on
+     */
+    static void bindToNode(int node);
+
+    /**
+     *  @fn static void setInterleave (bool on)
+     *  @brief Switches the calling thread allocations between interleaved and local
+     *
+     *  @param on :     true to interleave the next allocations over all nodes
+     */
+    static void setInterleave(bool on);
+
+    /**
+     *  @fn static int threadNode ()
+     *  @brief Accessor to the node of the calling scoring thread
+     *
+     *  Scheduler workers are pinned to the nodes round robin when they start.
+     *
+     *  @return the node of the calling worker, 0 if NUMA placement is off or for other threads
+     */
+    static int threadNode();
+};
+
+#endif
@@ -34,6 +34,7 @@
 #include "utils/common.h"
 #include "utils/xenio.h"
 #include "xenfile.h"
+#include "score.h"
 
 /**
  *  @class Wfile
@@ -81,9 +82,17 @@ public:
      */
     unsigned int getSize() const;
     
+    /**
+     *  @fn boost::shared_ptr<Score> getPtrWeights () const
+     *  @brief Accessor to the calibrated weights, as a score column
+     *
+     *  @return the weights Score object
+     */
+    boost::shared_ptr<Score> getPtrWeights() const;
+    
 private:
     boost::shared_ptr<XenFile> ptrFile;                     //!< Shared pointer to the XenFile containing the weights
-    boost::shared_ptr<std::vector<double> > ptrWeights;     //!< Shared pointer to the vector of doubles holding each weight
+    boost::shared_ptr<Score> ptrWeights;                    //!< Shared pointer to the Score column holding each weight
 
     /**
      *  @fn void loadWeights ()
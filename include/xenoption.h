@@ -33,6 +33,7 @@
 
 #include <boost/shared_ptr.hpp>
 #include <boost/make_shared.hpp>
+#include <boost/program_options.hpp>
 
 #include "utils/common.h"
 #include "xenfile.h"
@@ -67,6 +68,18 @@ public:
      *  @brief Deletes the unique instance of the XenOption singleton
      */
     static void deleteInstance();
+    
+    /**
+     *  @fn static void describe (boost::program_options::options_description &desc, Options &opt)
+     *  @brief Declares the XenC command line options, bound to an Options struct
+     *
+     *  Every field of the struct gets its default value: the ones not set on the
+     *  command line right away, the others when the parsed options are notified.
+     *
+     *  @param desc :   the options description to fill
+     *  @param opt :    the Options struct the options are stored in
+     */
+    static void describe(boost::program_options::options_description &desc, Options &opt);
 
     /**
      *  @fn std::string getSLang () const
@@ -184,10 +197,18 @@ public:
      *  @fn bool getMean () const
      *  @brief Accessor to the mean execution state
      *
-     *  @return true if we compute out-of-domain scores with mean of 3 LMs
+     *  @return true if we compute out-of-domain scores with mean of several LMs
      */
     bool getMean() const;
     
+    /**
+     *  @fn int getMeanK () const
+     *  @brief Accessor to the number of out-of-domain LMs averaged by mean computation
+     *
+     *  @return the number of out-of-domain sample LMs
+     */
+    int getMeanK() const;
+    
     /**
      *  @fn bool getSim () const
      *  @brief Accessor to the similarity measures execution state
@@ -307,6 +328,14 @@ public:
      *  @return the temporary files path
      */
     std::string getTemp() const;
+    
+    /**
+     *  @fn std::size_t getSortMem () const
+     *  @brief Accessor to the memory of the output sort
+     *
+     *  @return the memory the sorted lines may use before being sorted on disk, in bytes
+     */
+    std::size_t getSortMem() const;
 
     /**
      *  @fn std::size_t getMinBlk () const
@@ -444,6 +473,142 @@ public:
      */
     int getMaxEvalPC() const;
     
+    /**
+     *  @fn std::string getEvalCache () const
+     *  @brief Accessor to the eval perplexities cache file
+     *
+     *  @return the cache file name (empty for the default one, next to the sorted output)
+     */
+    std::string getEvalCache() const;
+    
+    /**
+     *  @fn bool getServer () const
+     *  @brief Accessor to the scoring server execution state
+     *
+     *  @return true if we run as a long-running scoring server
+     */
+    bool getServer() const;
+    
+    /**
+     *  @fn std::string getSocket () const
+     *  @brief Accessor to the scoring server Unix socket path
+     *
+     *  @return the Unix socket path, empty if serving on stdin/stdout
+     */
+    std::string getSocket() const;
+    
+    /**
+     *  @fn int getBatchSize () const
+     *  @brief Accessor to the maximum number of lines per server batch
+     *
+     *  @return the maximum number of lines per server batch
+     */
+    int getBatchSize() const;
+    
+    /**
+     *  @fn bool getIncremental () const
+     *  @brief Accessor to the incremental re-scoring option
+     *
+     *  @return true if only new out-of-domain lines must be scored
+     */
+    bool getIncremental() const;
+    
+    /**
+     *  @fn bool getCheckpoint () const
+     *  @brief Accessor to the checkpoint option
+     *
+     *  @return true if heavy stages must be checkpointed and resumed
+     */
+    bool getCheckpoint() const;
+    
+    /**
+     *  @fn int getVocCutoff () const
+     *  @brief Accessor to the minimum count of a word kept in estimated vocabularies
+     *
+     *  @return the vocabulary count cut-off
+     */
+    int getVocCutoff() const;
+    
+    /**
+     *  @fn std::string getNuma () const
+     *  @brief Accessor to the NUMA placement of language models
+     *
+     *  @return none, replicate or interleave
+     */
+    std::string getNuma() const;
+    
+    /**
+     *  @fn bool getSelect () const
+     *  @brief Tells if the best lines are selected instead of sorting all
+     *
+     *  @return true if --select-top or --select-threshold is set
+     */
+    bool getSelect() const;
+    
+    /**
+     *  @fn std::string getSelectTop () const
+     *  @brief Accessor to the number (or percentage, with %) of best lines to select
+     *
+     *  @return the selection size, empty if not set
+     */
+    std::string getSelectTop() const;
+    
+    /**
+     *  @fn std::string getSelectThreshold () const
+     *  @brief Accessor to the score threshold of the lines to select
+     *
+     *  @return the selection threshold, empty if not set
+     */
+    std::string getSelectThreshold() const;
+    
+    /**
+     *  @fn bool getSelectSorted () const
+     *  @brief Accessor to the sorted selection option
+     *
+     *  @return true if the selected lines are written sorted
+     */
+    bool getSelectSorted() const;
+    
+    /**
+     *  @fn std::string getShard () const
+     *  @brief Accessor to the out-of-domain corpus slice scored by this process
+     *
+     *  @return the slice as given (i/N), empty if not sharded
+     */
+    std::string getShard() const;
+    
+    /**
+     *  @fn int getShardIndex () const
+     *  @brief Accessor to the index (from 1) of the out-of-domain corpus slice scored by this process
+     *
+     *  @return the shard index, 0 if not sharded or malformed
+     */
+    int getShardIndex() const;
+    
+    /**
+     *  @fn int getShardCount () const
+     *  @brief Accessor to the number of slices of the out-of-domain corpus
+     *
+     *  @return the number of shards, 0 if not sharded or malformed
+     */
+    int getShardCount() const;
+    
+    /**
+     *  @fn int getMergeShards () const
+     *  @brief Accessor to the number of sorted shards to merge
+     *
+     *  @return the number of shards to merge, 0 if not merging
+     */
+    int getMergeShards() const;
+    
+    /**
+     *  @fn int getSeed () const
+     *  @brief Accessor to the seed of the sample extraction
+     *
+     *  @return the seed, 0 for a time based seed
+     */
+    int getSeed() const;
+    
     /**
      *  @fn void setSampleSize (int size)
      *  @brief Mutator to the out-of-domain sample size
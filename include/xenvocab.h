@@ -34,7 +34,10 @@
 #include <boost/algorithm/string.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/make_shared.hpp>
+#include <boost/function.hpp>
+#include <boost/unordered_map.hpp>
 #include <vector>
+#include <stdint.h>
 
 #include "utils/common.h"
 #include "corpus.h"
@@ -47,6 +50,9 @@ using namespace boost::filesystem;
 /**
  *  @class XenVocab
  *  @brief Class handling a XenC vocabulary
+ *
+ *  Words are counted in parallel (one hash map per thread) and kept
+ *  in lexicographic order, so a word ID is its position in the vocabulary file.
  */
 class XenVocab {
 public:
@@ -96,12 +102,39 @@ public:
     ~XenVocab();
 
     /**
-     *  @fn std::map<std::string, int> getXenVocab()
-     *  @brief Accessor to the XenC vocabulary object
+     *  @fn const std::vector<std::string>& getWords () const
+     *  @brief Accessor to the vocabulary words, indexed by word ID
+     *
+     *  @return the vocabulary words
+     */
+    const std::vector<std::string>& getWords() const;
+    
+    /**
+     *  @fn uint64_t getCount (unsigned int id) const
+     *  @brief Accessor to the count of a word in the corpora the vocabulary is made from
+     *
+     *  @param id :     the word ID
+     *  @return the word count (0 if the vocabulary has been read from a file)
+     */
+    uint64_t getCount(unsigned int id) const;
+    
+    /**
+     *  @fn int getID (const std::string &word) const
+     *  @brief Accessor to the ID of a word
      *
-     *  @return the XenC vocabulary object
+     *  @param word :   the word
+     *  @return the word ID, -1 if the word is not in the vocabulary
      */
-    std::map<std::string, int> getXenVocab() const;
+    int getID(const std::string &word) const;
+    
+    /**
+     *  @fn int getID (uint64_t hash) const
+     *  @brief Accessor to the ID of a word from its hash (see Tokenizer)
+     *
+     *  @param hash :   the word hash
+     *  @return the word ID, -1 if the word is not in the vocabulary
+     */
+    int getID(uint64_t hash) const;
     
     /**
      *  @fn boost::shared_ptr<XenFile> getXenFile ()
@@ -120,8 +153,10 @@ public:
     unsigned int getSize() const;
     
 private:
-    boost::shared_ptr<XenFile> ptrFile;     //!< Shared pointer on the vocabulary file
-    std::map<std::string, int> voc;         //!< Map holding the XenC vocabulary
+    boost::shared_ptr<XenFile> ptrFile;                 //!< Shared pointer on the vocabulary file
+    std::vector<std::string> words;                     //!< Vocabulary words, sorted, indexed by ID
+    std::vector<uint64_t> counts;                       //!< Word counts, indexed by ID
+    boost::unordered_map<uint64_t, int> ids;            //!< Word IDs, keyed by word hash
 
     /**
      *  @fn void writeVocab ()
@@ -129,6 +164,23 @@ private:
      */
     void writeVocab();
 
+    /**
+     *  @fn bool resumeVocab (uint64_t fp)
+     *  @brief Reloads the vocabulary file if it has been checkpointed with the same inputs
+     *
+     *  @param fp :     the fingerprint of the vocabulary inputs
+     *  @return true if the vocabulary has been restored
+     */
+    bool resumeVocab(uint64_t fp);
+
+    /**
+     *  @fn void dumpVocab (uint64_t fp)
+     *  @brief Writes the vocabulary on disk if needed and checkpoints it
+     *
+     *  @param fp :     the fingerprint of the vocabulary inputs
+     */
+    void dumpVocab(uint64_t fp);
+
     /**
      *  @fn void makeVocab (boost::shared_ptr<XenFile> ptrFile)
      *  @brief Generates a vocabulary from a file
@@ -160,6 +212,34 @@ private:
      *  @param ptrXenRes :    the sorted result file to generate the vocabulary from
      */
     void makeVocab(boost::shared_ptr<XenResult> ptrXenRes);
+    
+    /**
+     *  @fn void corpusWords (boost::shared_ptr<Corpus> ptrCorp, std::vector<boost::shared_ptr<WordCounts> > &shards)
+     *  @brief Adds the word counts of a Corpus, reusing those of its ingestion if any
+     *
+     *  @param ptrCorp :    the Corpus
+     *  @param shards :     the word counts shards to add to
+     */
+    void corpusWords(boost::shared_ptr<Corpus> ptrCorp, std::vector<boost::shared_ptr<WordCounts> > &shards);
+
+    /**
+     *  @fn void countWords (boost::function<std::string (int)> getLine, unsigned int size, std::vector<boost::shared_ptr<WordCounts> > &shards)
+     *  @brief Counts the words of a text, sharding its lines across threads
+     *
+     *  @param getLine :    accessor to the nth line of the text
+     *  @param size :       the number of lines of the text
+     *  @param shards :     the word counts shards, one more per thread is appended
+     */
+    void countWords(boost::function<std::string (int)> getLine, unsigned int size, std::vector<boost::shared_ptr<WordCounts> > &shards);
+    
+    /**
+     *  @fn void buildVocab (std::vector<boost::shared_ptr<WordCounts> > &shards, uint64_t cutoff)
+     *  @brief Merges the per-thread word counts and sorts the vocabulary
+     *
+     *  @param shards :     the per-thread word counts
+     *  @param cutoff :     the minimum count of a word to be kept
+     */
+    void buildVocab(std::vector<boost::shared_ptr<WordCounts> > &shards, uint64_t cutoff);
 };
 
 #endif
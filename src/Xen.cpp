@@ -32,74 +32,12 @@
 
 const std::string version = "2.0.0";
 
-namespace {
-    class SizeNotify {
-    public:
-        SizeNotify(std::size_t &out) : behind_(out) { }
-
-        void operator()(const std::string &from) {
-            behind_ = util::ParseSize(from);
-        }
-
-    private:
-        std::size_t &behind_;
-    };
-
-    boost::program_options::typed_value <std::string> *SizeOption(std::size_t &to, const char *default_value) {
-        return boost::program_options::value<std::string>()->notifier(SizeNotify(to))->default_value(default_value);
-    }
-}
-
 int main(int argc, char* argv[]) {
     po::options_description desc("XenC options", 200);
     Options opt;
     
     try {
-        desc.add_options()
-        ("source,s", po::value<std::string>(&opt.sLang)->required(), "source language (fr, en, ...)")
-        ("target,t", po::value<std::string>(&opt.tLang)->default_value(""), "target language (if relevant)")
-        ("in-stext,i", po::value<std::string>(&opt.inSData)->required(), "in-domain source text filename (plain text or gzipped file)")
-        ("out-stext,o", po::value<std::string>(&opt.outSData)->required(), "out-of-domain source text filename (plain text or gzipped file)")
-        ("mode,m", po::value<int>(&opt.mode)->required()->default_value(2), "filtering mode (1, 2, 3 or 4). Default is 2 (monolingual cross-entropy)")
-        ("eval,e", po::value<bool>(&opt.eval)->zero_tokens()->default_value(false), "add this switch to evaluate a filtered file after computation. Eval is always done on source language")
-        ("best-point,b", po::value<bool>(&opt.bp)->zero_tokens()->default_value(false), "add this switch to determinate the best point of a filtered file (eval option is implicit)")
-        ("dev,d", po::value<std::string>(&opt.dev)->default_value(""), "source language dev file for eval or best point (all modes), if different from in-domain text")
-        ("in-ttext", po::value<std::string>(&opt.inTData)->default_value(""), "in-domain target text filename, if target language (plain text or gzipped file)")
-        ("out-ttext", po::value<std::string>(&opt.outTData)->default_value(""), "out-of-domain target text filename, if target language (plain text or gzipped file)")
-        ("mono", po::value<bool>(&opt.mono)->zero_tokens()->default_value(false), "switch to force monolingual mode (if no target language)")
-        ("stem", po::value<bool>(&opt.stem)->zero_tokens()->default_value(false), "switch to activate stem models computation and scoring from stem files")
-        ("in-sstem", po::value<std::string>(&opt.inSStem)->default_value(""), "in-domain source stem filename (plain text or gzipped file)")
-        ("in-tstem", po::value<std::string>(&opt.inTStem)->default_value(""), "in-domain target stem filename (plain text or gzipped file)")
-        ("out-sstem", po::value<std::string>(&opt.outSStem)->default_value(""), "out-of-domain source stem filename (plain text or gzipped file)")
-        ("out-tstem", po::value<std::string>(&opt.outTStem)->default_value(""), "out-of-domain target stem filename (plain text or gzipped file)")
-        ("in-ptable", po::value<std::string>(&opt.iPTable)->default_value(""), "in-domain phrase table filename used in mode 4 scoring")
-        ("out-ptable", po::value<std::string>(&opt.oPTable)->default_value(""), "out-of-domain phrase table filename used in mode 4 scoring")
-        ("local", po::value<bool>(&opt.local)->zero_tokens()->default_value(false), "add a 7th score (local cross-entropy regarding the source phrase)")
-        ("mean", po::value<bool>(&opt.mean)->zero_tokens()->default_value(false), "mean score from 3 OOD sample LMs instead of 1 in mode 2 & 3 (3 times slower + EXPERIMENTAL)")
-        ("sim", po::value<bool>(&opt.sim)->zero_tokens()->default_value(false), "add similarity measures to score computing (EXPERIMENTAL, mode 2 only)")
-        ("sim-only", po::value<bool>(&opt.simOnly)->zero_tokens()->default_value(false), "use only similarity measures (no cross-entropy)")
-        ("vector-size", po::value<int>(&opt.vecSize)->default_value(150), "size of vector for similarity scores, default is 150 (WARNING: the more the slower)")
-        ("step", po::value<int>(&opt.step)->default_value(10), "percentage steps for evaluation. Default is 10 (100%, 90%, ...)")
-        ("s-vocab", po::value<std::string>(&opt.sVocab)->default_value(""), "source language vocab filename for LMs estimation. Default is in-domain source text vocab")
-        ("t-vocab", po::value<std::string>(&opt.tVocab)->default_value(""), "target language vocab filename for LMs estimation. Default is in-domain target text vocab")
-        ("full-vocab", po::value<bool>(&opt.fullVoc)->zero_tokens()->default_value(false), "use in-domain + out-of-domain vocabularies instead of in-domain only")
-        ("in-slm", po::value<std::string>(&opt.inSLM)->default_value(""), "in-domain source language model (LM). Will be estimated if not present")
-        ("out-slm", po::value<std::string>(&opt.outSLM)->default_value(""), "out-of-domain source language model (LM). Will be estimated if not present")
-        ("in-tlm", po::value<std::string>(&opt.inTLM)->default_value(""), "in-domain target language model (LM). Will be estimated if not present")
-        ("out-tlm", po::value<std::string>(&opt.outTLM)->default_value(""), "out-of-domain target language model (LM). Will be estimated if not present")
-        ("order", po::value<int>(&opt.order)->default_value(4), "order for LMs. Default is 4")
-        ("mem", SizeOption(opt.memPC, util::GuessPhysicalMemory() ? "70%" : "1G"), "Percentage of memory usage")
-        ("temp", po::value<std::string>(&opt.temp)->default_value("."), "Directory for temporary files")
-        ("exclude-oovs", po::value<bool>(&opt.exclOOVs)->zero_tokens()->default_value(false), "Exclude OOVs from PPL computation")
-        ("w-file", po::value<std::string>(&opt.wFile)->default_value(""), "filename for weighting the final score (one value per line)")
-        ("log", po::value<bool>(&opt.log)->zero_tokens()->default_value(false), "switch to consider weights in w-file as log values")
-        ("rev", po::value<bool>(&opt.rev)->zero_tokens()->default_value(false), "switch to require descending order sorted output")
-        ("inv", po::value<bool>(&opt.inv)->zero_tokens()->default_value(false), "switch to require inversed calibrated scores (1 - score)")
-        ("threads", po::value<int>(&opt.threads)->default_value(2), "number of threads to run for various operations (eval, sim, ...). Default is 2")
-        ("sorted-only", po::value<bool>(&opt.sortOnly)->zero_tokens()->default_value(false), "switch to save space & time by only outputing the sorted scores file")
-        ("max-evalpc", po::value<int>(&opt.maxEvalPC)->default_value(50), "maximum percentage of corpus to evaluate (means it will evaluate between 0 and n, default is 0-50)")
-        ("help,h", "displays this help message")
-        ("version,v", "displays program version");
+        XenOption::describe(desc, opt);
         
         po::variables_map vm;
         
@@ -136,6 +74,10 @@ int main(int argc, char* argv[]) {
                 std::cout << "\tYou must provide:" << std::endl;
                 std::cout << "\t\t- in-domain and out-of-domain phrase tables." << std::endl;
                 std::cout << "\t\t- source and target vocabularies." << std::endl << std::endl;
+                std::cout << "Server mode:" << std::endl << std::endl;
+                std::cout << "\tWith --server, modes 1, 2 and 3 load (or estimate) their language models once," << std::endl;
+                std::cout << "\tthen read sentences (tab-separated pairs for mode 3) on stdin or on --socket" << std::endl;
+                std::cout << "\tand answer one raw score per line. An empty line flushes the current batch." << std::endl << std::endl;
                 
                 return 0;
             }
@@ -155,12 +97,10 @@ int main(int argc, char* argv[]) {
         std::cout << e.what() << std::endl;
     }
 
-    opt.pc = 0;
-    opt.inToks = 0;
-    opt.outToks = 0;
-
-    opt.minblk = 8192;
-    opt.sortblk = 67108864;
+    // Keep stdout for scores only when serving on it
+    std::streambuf* scoreBuf = std::cout.rdbuf();
+    if (opt.server && opt.socket.compare("") == 0)
+        std::cout.rdbuf(std::cerr.rdbuf());
 
     uint64_t mem = util::GuessPhysicalMemory();
     if (mem) {
@@ -191,7 +131,9 @@ int main(int argc, char* argv[]) {
     
     boost::shared_ptr<Mode> mode;
     
-    switch (xOpt->getMode()) {
+    if (xOpt->getServer())
+        mode = boost::make_shared<ScoringServer>(scoreBuf);
+    else switch (xOpt->getMode()) {
         case 1:
             mode = boost::make_shared<SimplePPL>();
             break;
@@ -248,6 +190,7 @@ int main(int argc, char* argv[]) {
 	}
 	else {
         std::cerr << std::endl << sC << std::endl;
+        Scheduler::deleteInstance();
         sD->deleteInstance();
         xOpt->deleteInstance();
 		return 1;
@@ -255,17 +198,33 @@ int main(int argc, char* argv[]) {
     // -----------------------------------------------------
 
     try {
+        // Merge of the sorted shards of a sharded run
+        if (xOpt->getMergeShards() > 0) {
+            XenIO::mergeShards(xOpt->getMergeShards());
+            
+            sD->getRunStats()->writeReport(xOpt->getOutName() + ".stats.json", version);
+            
+            Scheduler::deleteInstance();
+            xOpt->deleteInstance();
+            sD->deleteInstance();
+            return 0;
+        }
+        
         // Normal mode
-        if (!xOpt->getEval()&& !xOpt->getBp()) {
+        if (xOpt->getServer() || (!xOpt->getEval() && !xOpt->getBp())) {
             int ret = mode->launch();
             
+            sD->getRunStats()->writeReport(xOpt->getOutName() + ".stats.json", version);
+            
             if (ret == 0) {
+                Scheduler::deleteInstance();
                 xOpt->deleteInstance();
                 sD->deleteInstance();
                 return 0;
             }
             else {
                 std::cerr << "Something went wrong." << std::endl;
+                Scheduler::deleteInstance();
                 xOpt->deleteInstance();
                 sD->deleteInstance();
                 return 1;
@@ -286,6 +245,8 @@ int main(int argc, char* argv[]) {
                 
                 if (ret != 0) {
                     std::cerr << "Something went wrong." << std::endl;
+                    sD->getRunStats()->writeReport(xOpt->getOutName() + ".stats.json", version);
+                    Scheduler::deleteInstance();
                     xOpt->deleteInstance();
                     sD->deleteInstance();
                     return 1;
@@ -333,22 +294,71 @@ int main(int argc, char* argv[]) {
                 int bp = ptrEval->getBP();
                 XenIO::writeXRpart(sD->getXenResult(), bp);
             }
-            else { return 1; }
+            else {
+                Scheduler::deleteInstance();
+                xOpt->deleteInstance();
+                sD->deleteInstance();
+                return 1;
+            }
+            
+            sD->getRunStats()->writeReport(xOpt->getOutName() + ".stats.json", version);
         }
     } catch (XenCommon::XenCEption &e) {
         throw;
     }
     
+    Scheduler::deleteInstance();
     xOpt->deleteInstance();
     sD->deleteInstance();
 	return 0;
 }
 
 std::string sanityCheck(XenOption* opt) {
-    std::string sortName = getOutName(opt) + ".sorted.gz";
+    std::string sortName = getOutName(opt) + (opt->getSelect() ? ".selected.gz" : ".sorted.gz");
+        
+	if (boost::filesystem::exists(sortName.c_str()) && (!opt->getEval() && !opt->getBp()) && opt->getMode() != 4 && !opt->getServer() && !opt->getIncremental())
+		return "Final " + std::string(opt->getSelect() ? "selected" : "sorted") + " file " + sortName + " already exists, exiting.";
+
+    if (opt->getServer()) {
+        if (opt->getMode() == 4) { return "Server mode only supports modes 1, 2 and 3."; }
+        else if (opt->getBatchSize() <= 0) { return "Server batch size should be greater than 0."; }
+    }
+    
+    if (opt->getVocCutoff() < 1) { return "Vocabulary cut-off should be at least 1."; }
+    
+    if (opt->getMean() && opt->getMeanK() < 2) { return "Mean scoring needs at least 2 out-of-domain LMs."; }
+    
+    if (opt->getNuma().compare("none") != 0 && opt->getNuma().compare("replicate") != 0 && opt->getNuma().compare("interleave") != 0) { return "NUMA policy should be none, replicate or interleave."; }
+    
+    if (opt->getSelect()) {
+        Selection sel;
         
-	if (boost::filesystem::exists(sortName.c_str()) && (!opt->getEval() && !opt->getBp()) && opt->getMode() != 4)
-		return "Final sorted file " + sortName + " already exists, exiting.";
+        if (!XenIO::parseSelection(opt->getSelectTop(), opt->getSelectThreshold(), sel)) { return "Selection size should be a positive number of lines or a percentage up to 100%, and its threshold a number."; }
+        else if (opt->getMode() == 4 || opt->getServer()) { return "Selection only applies to the outputs of modes 1, 2 and 3."; }
+        else if (opt->getEval() || opt->getBp()) { return "Selection can't be used with evaluation, which needs the full sorted output."; }
+    }
+    
+    if (opt->getShard().compare("") != 0) {
+        if (opt->getShardCount() < 2 || opt->getShardIndex() < 1 || opt->getShardIndex() > opt->getShardCount()) { return "Shard should be i/N, with at least 2 shards and i from 1 to N."; }
+        else if (opt->getMode() == 4 || opt->getServer()) { return "Sharding only supports modes 1, 2 and 3."; }
+        else if (opt->getMergeShards() > 0) { return "Shards are scored and merged by different runs."; }
+        else if (opt->getEval() || opt->getBp() || opt->getSelect() || opt->getIncremental()) { return "Sharding can't be used with evaluation, selection or incremental re-scoring, which need the merged output."; }
+        else if (opt->getSim() || opt->getSimOnly() || opt->getWFile()->getFileName().compare("") != 0) { return "Sharding can't be used with similarity measures or a weights file."; }
+        else if (opt->getMean() || opt->getStem() || opt->getFullVocab()) { return "Sharding can't be used with mean, stem or full vocabulary scoring."; }
+        else if (opt->getSeed() == 0 && (opt->getOutSLM()->getFileName().compare("") == 0 || (opt->getMode() == 3 && opt->getOutTLM()->getFileName().compare("") == 0)) && opt->getMode() != 1) { return "Sharding needs a --seed (or out-of-domain LMs), so that every shard uses the same sample."; }
+    }
+    
+    if (opt->getMergeShards() != 0) {
+        if (opt->getMergeShards() < 2) { return "At least 2 shards are needed to merge."; }
+        else if (opt->getMode() == 4 || opt->getServer()) { return "Merging shards only supports modes 1, 2 and 3."; }
+        else if (opt->getEval() || opt->getBp() || opt->getSelect() || opt->getIncremental()) { return "Merging shards can't be used with evaluation, selection or incremental re-scoring."; }
+    }
+    
+    if (opt->getIncremental()) {
+        if (opt->getMode() == 4) { return "Incremental re-scoring only supports modes 1, 2 and 3."; }
+        else if (opt->getSim() || opt->getSimOnly()) { return "Incremental re-scoring can't be used with similarity measures."; }
+        else if (opt->getWFile()->getFileName().compare("") != 0) { return "Incremental re-scoring can't be used with a weights file."; }
+    }
     
     if (opt->getMode() == 4) {
         if (opt->getSLang().compare("") == 0) { return "Please specify a source language."; }
@@ -391,6 +401,7 @@ std::string getOutName(XenOption* opt) {
         baseName = opt->getOutSData()->getPrefix() + "." + opt->getSLang();
         if (opt->getTLang().compare("") != 0) { baseName = baseName + "-" + opt->getTLang(); }
         baseName = baseName + ".mode" + XenCommon::toString(opt->getMode()) + weight + loga + reve + inve + stem;
+        if (opt->getShardCount() > 1) { baseName = XenIO::getShardName(baseName, opt->getShardIndex(), opt->getShardCount()); }
     }
     else {
         baseName = opt->getOutPTable()->getPrefix() + "-new." + opt->getOutPTable()->getExt();
@@ -29,12 +29,30 @@
  */
 
 #include "../include/XenLMken.h"
+#include "../include/utils/StaticData.h"
+
+#include "../include/kenlm/lm/builder/corpus_count.hh"
+#include "../include/kenlm/lm/builder/payload.hh"
+#include "../include/kenlm/lm/common/ngram.hh"
+
+#include <boost/thread/once.hpp>
+
+static boost::once_flag localeFlag = BOOST_ONCE_INIT;
+
+/**
+ *  @fn static void setLocale ()
+ *  @brief Sets the estimation locale, once: setlocale is not safe while other threads run
+ */
+static void setLocale() {
+    setlocale(LC_CTYPE, "");
+    setlocale(LC_COLLATE, "");
+}
 
 XenLMken::XenLMken() {
     XenOption* opt = XenOption::getInstance();
 
     order = (unsigned int) opt->getOrder();
-    mempc = opt->getMemPc();
+    memory = opt->getMemPc();
     temp = opt->getTemp();
 
     textFile = NULL;
@@ -59,8 +77,7 @@ void XenLMken::initialize(boost::shared_ptr<Corpus> ptrCorp, boost::shared_ptr<X
     lmFile = new char[name.length() + 1];
     std::strcpy(lmFile, name.c_str());
     
-    setlocale(LC_CTYPE, "");
-    setlocale(LC_COLLATE, "");
+    boost::call_once(localeFlag, setLocale);
 }
 
 void XenLMken::initialize(boost::shared_ptr<XenFile> ptrFile, boost::shared_ptr<XenVocab> ptrVoc) {
@@ -78,8 +95,7 @@ void XenLMken::initialize(boost::shared_ptr<XenFile> ptrFile, boost::shared_ptr<
     lmFile = new char[ptrFile->getFullPath().length() + 1];
     std::strcpy(lmFile, ptrFile->getFullPath().c_str());
     
-    setlocale(LC_CTYPE, "");
-    setlocale(LC_COLLATE, "");
+    boost::call_once(localeFlag, setLocale);
 }
 
 void XenLMken::initialize(boost::shared_ptr<XenResult> ptrXenRes, boost::shared_ptr<XenVocab> ptrVoc, int pc, std::string name) {
@@ -97,8 +113,7 @@ void XenLMken::initialize(boost::shared_ptr<XenResult> ptrXenRes, boost::shared_
     lmFile = new char[name.length() + 1];
     std::strcpy(lmFile, name.c_str());
     
-    setlocale(LC_CTYPE, "");
-    setlocale(LC_COLLATE, "");
+    boost::call_once(localeFlag, setLocale);
 }
 
 XenLMken::~XenLMken() {
@@ -109,9 +124,34 @@ XenLMken::~XenLMken() {
 int XenLMken::createLM() {
     XenOption* opt = XenOption::getInstance();
 
-    if (boost::filesystem::exists(lmFile))
+    bool reuse = boost::filesystem::exists(lmFile);
+    std::string stage = "lm:" + std::string(lmFile);
+    uint64_t fp = 0;
+
+    // With checkpoints, an existing file is only trusted if its estimation completed with the same inputs
+    if (opt->getCheckpoint()) {
+        boost::shared_ptr<Checkpoint> ptrCkpt = StaticData::getInstance()->getCheckpoint();
+
+        fp = ptrCkpt->fileFingerprint(textFile);
+        fp = Checkpoint::hashString(XenCommon::toString(ptrCkpt->fileFingerprint(ptrVoc->getXenFile()->getFullPath())), fp);
+        fp = Checkpoint::hashString(XenCommon::toString(order), fp);
+
+        reuse = ptrCkpt->isDone(stage, fp);
+    }
+
+    if (reuse)
         std::cout << "LM file already here, reusing..." << std::endl;
     else {
+        boost::shared_ptr<RunStats> ptrStats = StaticData::getInstance()->getRunStats();
+        int statStage = ptrStats->startStage(stage);
+
+        uint64_t types = ptrCorp->getWordCounts() ? ptrCorp->getWordCounts()->size() : 0;
+        BuildPlan plan = planBuild((uint64_t)ptrCorp->getFileWC(), ptrCorp->getFileSize(), types, order, memory);
+
+        std::cout << "Build plan for " << lmFile << ": " << ptrCorp->getFileWC() << " tokens, " << (types ? XenCommon::toString(types) : "unknown") << " types, order " << order << std::endl;
+        std::cout << "  memory " << plan.memory << " (needs " << plan.need << ", budget " << memory << (plan.need > memory ? ", sorts will spill to " + temp : "") << ")" << std::endl;
+        std::cout << "  sort blocks " << plan.sortBlock << ", min blocks " << plan.minBlock << ", " << plan.blockCount << " blocks per chain, vocab estimate " << plan.vocabEstimate << ", adder buffers " << plan.adderMemory << std::endl;
+
         lm::builder::PipelineConfig pipeline;
 
         std::string text, intermediate, arpa;
@@ -124,11 +164,11 @@ int XenLMken::createLM() {
         pipeline.order = (size_t) opt->getOrder();
         pipeline.initial_probs.interpolate_unigrams = true;
         pipeline.sort.temp_prefix = temp;
-        pipeline.sort.total_memory = opt->getMemPc();
-        pipeline.minimum_block = opt->getMinBlk();
-        pipeline.sort.buffer_size = opt->getSortBlk();
-        pipeline.block_count = 2;
-        pipeline.vocab_estimate = 1000000;
+        pipeline.sort.total_memory = plan.memory;
+        pipeline.minimum_block = plan.minBlock;
+        pipeline.sort.buffer_size = plan.sortBlock;
+        pipeline.block_count = plan.blockCount;
+        pipeline.vocab_estimate = plan.vocabEstimate;
         pipeline.prune_vocab_file = ptrVoc->getXenFile()->getFullPath();
         pipeline.prune_vocab = true;
         pipeline.vocab_size_for_unk = 0;
@@ -149,44 +189,124 @@ int XenLMken::createLM() {
         util::NormalizeTempPrefix(pipeline.sort.temp_prefix);
 
         lm::builder::InitialProbabilitiesConfig &initial = pipeline.initial_probs;
-        initial.adder_in.total_memory = 32768;
+        initial.adder_in.total_memory = plan.adderMemory;
         initial.adder_in.block_count = 2;
-        initial.adder_out.total_memory = 32768;
+        initial.adder_out.total_memory = plan.adderMemory;
         initial.adder_out.block_count = 2;
         pipeline.read_backoffs = initial.adder_out;
 
         pipeline.renumber_vocabulary = false;
         pipeline.output_q = false;
 
+        // The ARPA file is written aside then renamed, so that concurrent shards never read a partial LM
         text = textFile;
-        arpa = lmFile;
+        arpa = boost::filesystem::unique_path(std::string(lmFile) + ".%%%%-%%%%.tmp").string();
 
         util::scoped_fd in(util::OpenReadOrThrow(text.c_str()));
-        util::scoped_fd out(util::CreateOrThrow(arpa.c_str()));
 
+        // A failed estimation never leaves its partial ARPA file behind
         try {
-            lm::builder::Output output(pipeline.sort.temp_prefix, false, pipeline.output_q);
-            output.Add(new lm::builder::PrintHook(out.release(), verbose_header));
-            lm::builder::Pipeline(pipeline, in.release(), output);
+            util::scoped_fd out(util::CreateOrThrow(arpa.c_str()));
+
+            {
+                lm::builder::Output output(pipeline.sort.temp_prefix, false, pipeline.output_q);
+                output.Add(new lm::builder::PrintHook(out.release(), verbose_header));
+                lm::builder::Pipeline(pipeline, in.release(), output);
+            }
+
+            boost::filesystem::rename(arpa, lmFile);
         } catch (const util::MallocException &e) {
-            std::cerr << e.what() << std::endl;
-            std::cerr << "Try rerunning with a more conservative -S setting than " << XenCommon::toString(mempc) << std::endl;
+            XenIO::delFile(arpa);
+            throw XenCommon::XenCEption("Estimation of LM " + std::string(lmFile) + " ran out of memory with " + XenCommon::toString(memory) + " bytes, try rerunning with a more conservative --mem setting: " + e.what());
+        } catch (...) {
+            XenIO::delFile(arpa);
+            throw;
         }
 
+        if (opt->getCheckpoint())
+            StaticData::getInstance()->getCheckpoint()->markDone(stage, fp, lmFile);
+
         std::cout << "LM estimation done." << std::endl;
+
+        // Corpus is only loaded when the LM is estimated from it
+        if (ptrCorp->getWC() > 0)
+            ptrStats->endStage(statStage, ptrCorp->getSize(), (uint64_t)ptrCorp->getWC());
+        else
+            ptrStats->endStage(statStage, 0, 0);
     }
     
     return 0;
 }
 
 int XenLMken::loadLM() {
+    boost::shared_ptr<RunStats> ptrStats = StaticData::getInstance()->getRunStats();
+    int stage = ptrStats->startStage("loadlm:" + std::string(lmFile));
+
     config.positive_log_probability = SILENT;
 
-    ptrMdl = boost::make_shared<lm::ngram::ProbingModel>(lmFile, config);
+    int nodes = XenNuma::getNodes();
+
+    if (XenNuma::getReplicate()) {
+        // Binary files are read rather than mapped, so each copy lands in its own node memory
+        config.load_method = util::READ;
+        models.assign(nodes, boost::shared_ptr<lm::ngram::ProbingModel>());
+        loadError = "";
+
+        boost::thread_group loaders;
+        for (int n = 0; n < nodes; n++)
+            loaders.create_thread(boost::bind(&XenLMken::loadCopy, this, n));
+        loaders.join_all();
+
+        if (loadError.compare("") != 0)
+            throw XenCommon::XenCEption(loadError);
+
+        std::cout << "LM " << lmFile << " replicated on " << nodes << " NUMA nodes." << std::endl;
+    }
+    else {
+        bool interleave = XenNuma::getInterleave();
+
+        if (interleave)
+            XenNuma::setInterleave(true);
+
+        models.assign(1, boost::make_shared<lm::ngram::ProbingModel>(lmFile, config));
+
+        if (interleave) {
+            XenNuma::setInterleave(false);
+            std::cout << "LM " << lmFile << " interleaved on " << nodes << " NUMA nodes." << std::endl;
+        }
+    }
+
+    ptrStats->endStage(stage, 0, 0);
 
     return 0;
 }
 
+void XenLMken::loadCopy(int node) {
+    XenNuma::bindToNode(node);
+
+    try {
+        models[node] = boost::make_shared<lm::ngram::ProbingModel>(lmFile, config);
+    } catch (const std::exception &e) {
+        boost::mutex::scoped_lock lock(loadMtx);
+        loadError = "Can't load the copy of " + std::string(lmFile) + " on NUMA node " + XenCommon::toString(node) + ": " + e.what();
+    }
+}
+
+const lm::ngram::ProbingModel& XenLMken::getModel() {
+    if (models.size() == 1)
+        return *models[0];
+
+    return *models[XenNuma::threadNode()];
+}
+
+void XenLMken::setMemory(std::size_t bytes) {
+    memory = bytes;
+}
+
+void XenLMken::releaseCorpus() {
+    ptrCorp = boost::make_shared<Corpus>();
+}
+
 std::string XenLMken::getFileName() const {
     return lmFile;
 }
@@ -196,20 +316,21 @@ TxtStats XenLMken::getSentenceStats(std::string sent) {
     typename lm::ngram::Model::State state, out;
     lm::FullScoreReturn ret;
 
-    std::vector<std::string> words;
-    boost::split(words, sent, boost::is_any_of(" "));
+    const lm::ngram::ProbingModel &mdl = getModel();
+    Tokenizer words(sent);
+    Token tok;
 
-    state = ptrMdl->BeginSentenceState();
+    state = mdl.BeginSentenceState();
 
     float total = 0.0;
     uint64_t oov = 0;
     uint64_t numwords = 0;
     float zeroprob = 0.0;
 
-    for (std::vector<std::string>::iterator it = words.begin(); it != words.end(); ++it) {
-        lm::WordIndex vocab = ptrMdl->GetVocabulary().Index(*it);
-        ret = ptrMdl->FullScore(state, vocab, out);
-        if (vocab == ptrMdl->GetVocabulary().NotFound()) {
+    while (words.next(tok)) {
+        lm::WordIndex vocab = mdl.GetVocabulary().IndexHash(tok.hash);
+        ret = mdl.FullScore(state, vocab, out);
+        if (vocab == mdl.GetVocabulary().NotFound()) {
             ++oov;
             zeroprob += ret.prob;
         }
@@ -218,7 +339,7 @@ TxtStats XenLMken::getSentenceStats(std::string sent) {
         state = out;
     }
 
-    ret = ptrMdl->FullScore(state, ptrMdl->GetVocabulary().EndSentence(), out);
+    ret = mdl.FullScore(state, mdl.GetVocabulary().EndSentence(), out);
     total += ret.prob;
 
     r.prob = total;
@@ -230,24 +351,222 @@ TxtStats XenLMken::getSentenceStats(std::string sent) {
     return r;
 }
 
+void XenLMken::getBatchStats(const std::vector<std::string> &sents, std::vector<TxtStats> &stats) {
+    std::vector<uint64_t> hashes;
+    std::vector<uint64_t> starts;
+
+    tokenize(sents, hashes, starts);
+    getHashStats(hashes, starts, stats);
+}
+
+void XenLMken::getHashStats(const std::vector<uint64_t> &hashes, const std::vector<uint64_t> &starts, std::vector<TxtStats> &stats) {
+    const lm::ngram::ProbingVocabulary &vocab = getModel().GetVocabulary();
+    std::vector<lm::WordIndex> words(hashes.size());
+
+    // Vocabulary buckets are prefetched a few words before they are probed
+    for (std::size_t i = 0; i < hashes.size(); i++) {
+        if (i + vocabAhead < hashes.size())
+            vocab.Prefetch(hashes[i + vocabAhead]);
+
+        words[i] = vocab.IndexHash(hashes[i]);
+    }
+
+    getIdStats(words, starts, stats);
+}
+
+void XenLMken::tokenize(const std::vector<std::string> &sents, std::vector<uint64_t> &hashes, std::vector<uint64_t> &starts) {
+    Tokenizer tokens;
+    Token tok;
+
+    hashes.clear();
+    starts.assign(1, 0);
+
+    for (unsigned int s = 0; s < sents.size(); s++) {
+        tokens.reset(sents[s]);
+        while (tokens.next(tok))
+            hashes.push_back(tok.hash);
+
+        starts.push_back(hashes.size());
+    }
+}
+
+std::size_t XenLMken::buildMemory(boost::shared_ptr<Corpus> ptrCorp, std::size_t budget) {
+    uint64_t types = ptrCorp->getWordCounts() ? ptrCorp->getWordCounts()->size() : 0;
+
+    return planBuild((uint64_t)ptrCorp->getFileWC(), ptrCorp->getFileSize(), types, (unsigned int)XenOption::getInstance()->getOrder(), budget).memory;
+}
+
+BuildPlan XenLMken::planBuild(uint64_t tokens, uint64_t lines, uint64_t types, unsigned int order, std::size_t budget) {
+    XenOption* opt = XenOption::getInstance();
+    BuildPlan plan;
+
+    std::size_t top = NGram<BuildingPayload>::TotalSize(order);
+
+    plan.blockCount = 2;
+    plan.minBlock = std::max(opt->getMinBlk(), top);
+
+    // Unknown corpus: the budget and the historical settings
+    if (tokens == 0) {
+        plan.memory = budget;
+        plan.need = budget;
+        plan.vocabEstimate = defaultVocab;
+    }
+    else {
+        // Every token, and every end of sentence, starts at most one n-gram of each order
+        uint64_t grams = tokens + lines;
+
+        // Distinct words plus <unk>, <s> and </s>, bounded by the tokens when not counted
+        plan.vocabEstimate = (std::size_t)(types ? types + 3 : std::min<uint64_t>(grams, defaultVocab));
+
+        // Counting sorts the top order n-grams with their dedupe table, later steps sort all orders at once
+        uint64_t counting = grams * top + (uint64_t)(CorpusCount::DedupeMultiplier(order) * (float)(grams * top));
+        uint64_t orders = 0;
+        for (unsigned int n = 1; n <= order; n++)
+            orders += grams * NGram<BuildingPayload>::TotalSize(n);
+
+        uint64_t need = CorpusCount::VocabUsage(plan.vocabEstimate) + std::max(counting, orders);
+        need += need / 4;
+
+        plan.need = (std::size_t)need;
+        plan.memory = std::min(budget, std::max(plan.need, minBuildMemory));
+    }
+
+    // The vocabulary table grows on demand, it is not sized past half the memory
+    while (plan.vocabEstimate > 1024 && CorpusCount::VocabUsage(plan.vocabEstimate) > plan.memory / 2)
+        plan.vocabEstimate /= 2;
+
+    // Each chain holds blockCount blocks of at least minBlock for every order
+    if (plan.memory < plan.minBlock * order * plan.blockCount)
+        plan.blockCount = 1;
+
+    plan.sortBlock = std::max(plan.minBlock, std::min(opt->getSortBlk(), plan.memory / 4));
+    plan.adderMemory = std::min(maxAdder, std::max(minAdder, plan.memory / (64 * order)));
+
+    return plan;
+}
+
 TxtStats XenLMken::getDocumentStats(boost::shared_ptr<Corpus> c) {
-    TxtStats r, tmp;
+    boost::shared_ptr<TokenizedText> ptrTok = c->getTokenized();
+    const lm::ngram::ProbingVocabulary &vocab = getModel().GetVocabulary();
+
+    // The distinct words of the Corpus are mapped to this LM ids once
+    std::vector<lm::WordIndex> ids(ptrTok->types.size());
+    for (std::size_t t = 0; t < ptrTok->types.size(); t++)
+        ids[t] = vocab.IndexHash(ptrTok->types[t]);
+
+    TxtStats zero;
+    zero.prob = 0.0;
+    zero.zeroprobs = 0.0;
+    zero.numoov = 0;
+    zero.numwords = 0;
+    zero.numsentences = 0;
+
+    return Scheduler::parallelReduce<TxtStats>(0, c->getSize(), docGrain, zero, boost::bind(&XenLMken::getRangeStats, this, ptrTok, boost::cref(ids), _1, _2), sumStats);
+}
+
+void XenLMken::getIdStats(const std::vector<lm::WordIndex> &words, const std::vector<uint64_t> &starts, std::vector<TxtStats> &stats) {
+    const lm::ngram::ProbingModel &mdl = getModel();
+    const unsigned int width = 16;   // Sentences queried in lockstep
+
+    lm::ngram::State states[width];
+    lm::ngram::State outs[width];
+    lm::WordIndex cur[width];
+    float totals[width];
+    float zeroprobs[width];
+    uint64_t oovs[width];
+
+    unsigned int size = (unsigned int)starts.size() - 1;
+    stats.resize(size);
+
+    for (unsigned int first = 0; first < size; first += width) {
+        unsigned int n = std::min(width, size - first);
+        unsigned int steps = 0;
+
+        for (unsigned int s = 0; s < n; s++) {
+            states[s] = mdl.BeginSentenceState();
+            totals[s] = 0.0;
+            zeroprobs[s] = 0.0;
+            oovs[s] = 0;
+            steps = std::max(steps, (unsigned int)(starts[first + s + 1] - starts[first + s]) + 1);
+        }
+
+        // Each step scores one more word of every sentence, </s> after the last one
+        for (unsigned int t = 0; t < steps; t++) {
+            for (unsigned int s = 0; s < n; s++) {
+                unsigned int len = (unsigned int)(starts[first + s + 1] - starts[first + s]);
+
+                if (t > len)
+                    continue;
+
+                cur[s] = (t < len) ? words[starts[first + s] + t] : mdl.GetVocabulary().EndSentence();
+                mdl.Prefetch(states[s], cur[s]);
+            }
+
+            for (unsigned int s = 0; s < n; s++) {
+                unsigned int len = (unsigned int)(starts[first + s + 1] - starts[first + s]);
+
+                if (t > len)
+                    continue;
+
+                lm::FullScoreReturn ret = mdl.FullScore(states[s], cur[s], outs[s]);
+
+                if (t < len && cur[s] == mdl.GetVocabulary().NotFound()) {
+                    ++oovs[s];
+                    zeroprobs[s] += ret.prob;
+                }
+
+                totals[s] += ret.prob;
+                states[s] = outs[s];
+            }
+        }
+
+        for (unsigned int s = 0; s < n; s++) {
+            TxtStats &r = stats[first + s];
+            r.prob = totals[s];
+            r.zeroprobs = zeroprobs[s];
+            r.numwords = starts[first + s + 1] - starts[first + s];
+            r.numoov = oovs[s];
+            r.numsentences = 1;
+        }
+    }
+}
+
+TxtStats XenLMken::getRangeStats(boost::shared_ptr<TokenizedText> ptrTok, const std::vector<lm::WordIndex> &ids, unsigned int first, unsigned int last) {
+    std::vector<lm::WordIndex> words;
+    std::vector<uint64_t> starts;
+    std::vector<TxtStats> stats;
+    uint64_t base = ptrTok->starts[first];
+
+    words.reserve(ptrTok->starts[last] - base);
+    for (uint64_t k = base; k < ptrTok->starts[last]; k++)
+        words.push_back(ids[ptrTok->words[k]]);
+
+    for (unsigned int i = first; i <= last; i++)
+        starts.push_back(ptrTok->starts[i] - base);
+
+    getIdStats(words, starts, stats);
+
+    TxtStats r;
     r.prob = 0.0;
     r.zeroprobs = 0.0;
     r.numoov = 0;
     r.numwords = 0;
     r.numsentences = 0;
 
-    for (unsigned int i = 0; i < c->getSize(); i++) {
-        tmp = getSentenceStats(c->getLine(i));
+    for (unsigned int i = 0; i < stats.size(); i++)
+        r = sumStats(r, stats[i]);
+
+    return r;
+}
+
+TxtStats XenLMken::sumStats(const TxtStats &a, const TxtStats &b) {
+    TxtStats r;
+    r.prob = a.prob + b.prob;
+    r.zeroprobs = a.zeroprobs + b.zeroprobs;
+    r.numwords = a.numwords + b.numwords;
+    r.numoov = a.numoov + b.numoov;
+    r.numsentences = a.numsentences + b.numsentences;
 
-        r.prob += tmp.prob;
-        r.zeroprobs += tmp.zeroprobs;
-        r.numwords += tmp.numwords;
-        r.numoov += tmp.numoov;
-        r.numsentences += tmp.numsentences;
-    }
-    
     return r;
 }
 
@@ -0,0 +1,100 @@
+/**
+ *  @file bitext.cpp
+ *  @brief Class handling the two sides of a parallel corpus in lockstep
+ *  @author Anthony Rousseau
+ *  @version 2.0.0
+ *  @date 19 October 2026
+ */
+
+
+/*  This file is part of the cross-entropy tool for data selection (XenC)
+ *  aimed at speech recognition and statistical machine translation.
+ *
+ *  Copyright 2013-2016, Anthony Rousseau, LIUM, University of Le Mans, France
+ *
+ *  Development of the XenC tool has been partially funded by the
+ *  European Commission under the MateCat project.
+ *
+ *  The XenC tool is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation
+ *
+ *  This library is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "../include/bitext.h"
+
+Bitext::Bitext() {
+
+}
+
+void Bitext::initialize(boost::shared_ptr<Corpus> ptrSrc, boost::shared_ptr<Corpus> ptrTrg) {
+    ptrSource = ptrSrc;
+    ptrTarget = ptrTrg;
+
+    try {
+        check();
+    } catch (XenCommon::XenCEption &e) {
+        throw;
+    }
+}
+
+void Bitext::initialize(boost::shared_ptr<Corpus> ptrSrc, boost::shared_ptr<XenFile> ptrTrgData, std::string lg) {
+    ptrSource = ptrSrc;
+    ptrTarget = boost::make_shared<Corpus>();
+
+    try {
+        ptrTarget->initialize(ptrTrgData, lg, false, ptrSrc->getShard(), ptrSrc->getShards());
+        check();
+    } catch (XenCommon::XenCEption &e) {
+        throw;
+    }
+}
+
+Bitext::~Bitext() {
+
+}
+
+unsigned int Bitext::getSize() const {
+    return ptrSource->getSize();
+}
+
+StringPiece Bitext::getSource(int line) const {
+    return ptrSource->getView(line);
+}
+
+StringPiece Bitext::getTarget(int line) const {
+    return ptrTarget->getView(line);
+}
+
+bool Bitext::isValid(int line) const {
+    return ptrSource->isValid(line) && ptrTarget->isValid(line);
+}
+
+void Bitext::removeLine(int line) {
+    ptrSource->removeLine(line);
+    ptrTarget->removeLine(line);
+}
+
+boost::shared_ptr<Corpus> Bitext::getPtrSource() const {
+    return ptrSource;
+}
+
+boost::shared_ptr<Corpus> Bitext::getPtrTarget() const {
+    return ptrTarget;
+}
+
+void Bitext::check() {
+    if (ptrSource->getFileSize() != ptrTarget->getFileSize())
+        throw XenCommon::XenCEption("Source corpus " + ptrSource->getXenFile()->getFullPath() + " has " + XenCommon::toString(ptrSource->getFileSize()) + " lines but target corpus " + ptrTarget->getXenFile()->getFullPath() + " has " + XenCommon::toString(ptrTarget->getFileSize()) + " lines! Exiting.");
+
+    if (ptrSource->getSize() != ptrTarget->getSize() || ptrSource->getFirstLine() != ptrTarget->getFirstLine())
+        throw XenCommon::XenCEption("Source corpus " + ptrSource->getXenFile()->getFullPath() + " and target corpus " + ptrTarget->getXenFile()->getFullPath() + " are not loaded on the same lines! Exiting.");
+}
@@ -0,0 +1,241 @@
+/**
+ *  @file checkpoint.cpp
+ *  @brief Class handling the durable checkpoints of long scoring runs
+ *  @author Anthony Rousseau
+ *  @version 2.0.0
+ *  @date 19 October 2026
+ */
+
+/*  This file is part of the cross-entropy tool for data selection (XenC)
+ *  aimed at speech recognition and statistical machine translation.
+ *
+ *  Copyright 2013-2016, Anthony Rousseau, LIUM, University of Le Mans, France
+ *
+ *  Development of the XenC tool has been partially funded by the
+ *  European Commission under the MateCat project.
+ *
+ *  The XenC tool is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation
+ *
+ *  This library is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "../include/checkpoint.h"
+#include "../include/xenoption.h"
+#include "../include/kenlm/util/murmur_hash.hh"
+
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+
+Checkpoint::Checkpoint() {
+    loaded = false;
+    fileName = "";
+    written = 0;
+}
+
+Checkpoint::~Checkpoint() {
+
+}
+
+bool Checkpoint::isDone(std::string stage, uint64_t fp) {
+    boost::mutex::scoped_lock lock(mtx);
+
+    load();
+
+    std::map<std::string, CkptEntry>::iterator it = stages.find(stage);
+
+    if (it == stages.end())
+        return false;
+
+    if (it->second.fingerprint != fp) {
+        std::cout << "Checkpoint of stage " << stage << " is outdated, recomputing." << std::endl;
+        return false;
+    }
+
+    if (!boost::filesystem::exists(it->second.path.c_str()) || boost::filesystem::file_size(it->second.path.c_str()) != it->second.size) {
+        std::cout << "Output of stage " << stage << " is missing or damaged, recomputing." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+void Checkpoint::markDone(std::string stage, uint64_t fp, std::string path) {
+    boost::mutex::scoped_lock lock(mtx);
+
+    load();
+
+    CkptEntry e;
+    e.fingerprint = fp;
+    e.size = boost::filesystem::file_size(path.c_str());
+    e.path = path;
+
+    stages[stage] = e;
+    fileFps.erase(path);
+    written++;
+
+    save();
+
+    std::cout << "Checkpoint: stage " << stage << " done." << std::endl;
+}
+
+uint64_t Checkpoint::fileFingerprint(std::string path) {
+    uint64_t seen = 0;
+
+    {
+        boost::mutex::scoped_lock lock(mtx);
+
+        std::map<std::string, uint64_t>::iterator it = fileFps.find(path);
+        if (it != fileFps.end())
+            return it->second;
+
+        seen = written;
+    }
+
+    // Files are hashed outside the lock, so concurrent estimations are not serialized on their reads
+    uint64_t fp = hashFile(path, 0);
+
+    boost::mutex::scoped_lock lock(mtx);
+
+    // A stage output written meanwhile may be this very file
+    if (written == seen)
+        fileFps[path] = fp;
+
+    return fp;
+}
+
+std::string Checkpoint::getPath(std::string name) const {
+    XenOption* opt = XenOption::getInstance();
+
+    return opt->getOutName() + ".ckpt." + name;
+}
+
+uint64_t Checkpoint::hashString(std::string str, uint64_t seed) {
+    return util::MurmurHash64A(str.c_str(), str.length(), seed);
+}
+
+uint64_t Checkpoint::hashFile(std::string path, uint64_t seed) {
+    std::ifstream in(path.c_str(), std::ios::in | std::ios::binary);
+
+    if (!in.is_open())
+        throw XenCommon::XenCEption("Can't open " + path + " to compute its fingerprint.");
+
+    std::vector<char> buf(1 << 20);
+    uint64_t h = seed;
+
+    while (in) {
+        in.read(&buf[0], buf.size());
+        std::streamsize n = in.gcount();
+        if (n > 0)
+            h = util::MurmurHash64A(&buf[0], (std::size_t)n, h);
+    }
+
+    return h;
+}
+
+void Checkpoint::dumpScores(const std::vector<double> &vec, std::string path) {
+    std::string tmpName = path + ".tmp";
+
+    try {
+        std::ofstream out(tmpName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+
+        if (!out.is_open())
+            throw XenCommon::XenCEption("Can't open " + tmpName + " for writing.");
+
+        uint64_t count = vec.size();
+
+        out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        if (count > 0)
+            out.write(reinterpret_cast<const char*>(&vec[0]), count * sizeof(double));
+
+        if (out.bad())
+            throw XenCommon::XenCEption("Error while writing file " + tmpName);
+
+        out.close();
+
+        boost::filesystem::rename(tmpName, path);
+    } catch (XenCommon::XenCEption &e) {
+        throw;
+    }
+}
+
+bool Checkpoint::loadScores(std::vector<double> &vec, std::string path) {
+    std::ifstream in(path.c_str(), std::ios::in | std::ios::binary);
+
+    if (!in.is_open())
+        return false;
+
+    uint64_t count = 0;
+    in.read(reinterpret_cast<char*>(&count), sizeof(count));
+
+    if (!in.good() || count != vec.size())
+        return false;
+
+    if (count > 0)
+        in.read(reinterpret_cast<char*>(&vec[0]), count * sizeof(double));
+
+    return in.good();
+}
+
+void Checkpoint::load() {
+    if (loaded)
+        return;
+
+    loaded = true;
+    fileName = getPath("manifest");
+
+    if (!boost::filesystem::exists(fileName.c_str()))
+        return;
+
+    std::ifstream in(fileName.c_str());
+    std::string line;
+
+    while (std::getline(in, line)) {
+        std::vector<std::string> fields;
+        boost::split(fields, line, boost::is_any_of("\t"));
+
+        if (fields.size() != 4)
+            continue;
+
+        CkptEntry e;
+        e.fingerprint = boost::lexical_cast<uint64_t>(fields[1]);
+        e.size = boost::lexical_cast<uint64_t>(fields[2]);
+        e.path = fields[3];
+
+        stages[fields[0]] = e;
+    }
+
+    std::cout << "Checkpoint manifest " << fileName << " loaded, " << stages.size() << " completed stages." << std::endl;
+}
+
+void Checkpoint::save() {
+    std::string tmpName = fileName + ".tmp";
+
+    try {
+        std::ofstream out(tmpName.c_str(), std::ios::out | std::ios::trunc);
+
+        if (!out.is_open())
+            throw XenCommon::XenCEption("Can't open " + tmpName + " for writing.");
+
+        for (std::map<std::string, CkptEntry>::iterator it = stages.begin(); it != stages.end(); ++it)
+            out << it->first << '\t' << it->second.fingerprint << '\t' << it->second.size << '\t' << it->second.path << std::endl;
+
+        if (out.bad())
+            throw XenCommon::XenCEption("Error while writing file " + tmpName);
+
+        out.close();
+
+        boost::filesystem::rename(tmpName, fileName);
+    } catch (XenCommon::XenCEption &e) {
+        throw;
+    }
+}
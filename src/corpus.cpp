@@ -30,31 +30,147 @@
 
 #include "../include/corpus.h"
 #include "../include/utils/xenio.h"
+#include "../include/utils/StaticData.h"
+#include "../include/utils/scheduler.h"
+#include "../include/utils/linereader.h"
+#include "../include/utils/asyncreader.h"
+#include "../include/utils/bgzf.h"
+
+#include <algorithm>
+#include <cstring>
+
+static const std::size_t streamBlock = 1 << 23;    //!< Size of the blocks of a compressed Corpus
+static const uint64_t minPart = 1 << 18;            //!< Smallest part of a block worth a task of its own
+
+/**
+ *  @struct IngestShard
+ *  @brief What a thread finds in its part of a Corpus text buffer
+ */
+struct IngestShard {
+    uint64_t base;                          //!< Offset in the Corpus text of the buffer the offsets refer to
+    std::vector<uint64_t> offsets;          //!< Start offset of each line
+    std::vector<int> toks;                  //!< Token count of each line
+    std::vector<bool> valid;                //!< Validity (non-blank) of each line
+    boost::shared_ptr<WordCounts> counts;   //!< Word counts (null if not requested)
+};
+
+/**
+ *  @fn inline bool isBlankChar (char c)
+ *  @brief Tells if a character is a white space (as \\s in the C locale)
+ */
+inline bool isBlankChar(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+/**
+ *  @fn void taskIngest (const std::vector<char>* ptrBuf, uint64_t begin, uint64_t end, IngestShard* ptrShard)
+ *  @brief Ingests the lines of a buffer range
+ *
+ *  @param ptrBuf :     the text buffer
+ *  @param begin :      offset of the first line of the range
+ *  @param end :        offset after the last newline of the range
+ *  @param ptrShard :   the results of the range
+ */
+void taskIngest(const std::vector<char>* ptrBuf, uint64_t begin, uint64_t end, IngestShard* ptrShard) {
+    const char* buf = &ptrBuf->operator[](0);
+    uint64_t start = begin;
+
+    while (start < end) {
+        const char* nl = (const char*)std::memchr(buf + start, '\n', (std::size_t)(end - start));
+        uint64_t stop = (uint64_t)(nl - buf);
+
+        // Tokens as XenCommon::wordCount counts them: space separated fields holding a non-blank character
+        int toks = 0;
+        bool word = false;
+        bool valid = false;
+
+        for (const char* c = buf + start; c < buf + stop; c++) {
+            if (*c == ' ') {
+                toks += word;
+                word = false;
+            }
+            else if (!isBlankChar(*c)) {
+                word = true;
+                valid = true;
+            }
+        }
+        toks += word;
+
+        ptrShard->offsets.push_back(start);
+        ptrShard->toks.push_back(toks);
+        ptrShard->valid.push_back(valid);
+
+        if (ptrShard->counts)
+            Tokenizer::countWords(buf + start, (std::size_t)(stop - start), *ptrShard->counts);
+
+        start = stop + 1;
+    }
+}
+
+/**
+ *  @fn void taskIngestBlock (TextBlock ptrBlock, uint64_t begin, uint64_t end, IngestShard* ptrShard)
+ *  @brief Ingests the lines of a range of a block, keeping the block alive until then
+ */
+void taskIngestBlock(TextBlock ptrBlock, uint64_t begin, uint64_t end, IngestShard* ptrShard) {
+    taskIngest(ptrBlock.get(), begin, end, ptrShard);
+}
+
+/**
+ *  @fn std::vector<uint64_t> cutLines (const std::vector<char> &buf, unsigned int parts)
+ *  @brief Cuts a buffer of lines in ranges of about the same size, on line boundaries
+ *
+ *  @param buf :    the buffer, ending with a newline
+ *  @param parts :  the number of ranges
+ *  @return the parts + 1 bounds of the ranges
+ */
+std::vector<uint64_t> cutLines(const std::vector<char> &buf, unsigned int parts) {
+    uint64_t size = buf.size();
+    std::vector<uint64_t> bounds(1, 0);
+
+    for (unsigned int t = 1; t < parts; t++) {
+        uint64_t b = std::max(bounds.back(), size * t / parts);
+
+        while (b < size && b > 0 && buf[b - 1] != '\n')
+            b++;
+
+        bounds.push_back(b);
+    }
+
+    bounds.push_back(size);
+
+    return bounds;
+}
 
 Corpus::Corpus() {
     wc = 0;
+    shard = 0;
+    shards = 0;
+    firstLine = 0;
+    fileWC = 0;
+    ptrTokMtx = boost::make_shared<boost::mutex>();
 }
 
 void Corpus::initialize(boost::shared_ptr<XenFile> ptrData, std::string lg) {
     ptrFile = ptrData;
     lang = lg;
     
-    try {
-        if (boost::filesystem::exists(ptrFile->getFullPath().c_str())) {
-            if (boost::filesystem::file_size(ptrFile->getFullPath().c_str()) > 0) {
-                std::cout << "Specified corpus " << ptrFile->getFullPath() << " exists! We continue..." << std::endl;
+    load(false);
+}
 
-                loadText();
-                wc = Corpus::wordCount();
-            }
-            else
-                throw XenCommon::XenCEption("Specified corpus " + ptrFile->getFullPath() + " has a null size! Exiting.");
-        }
-        else
-            throw XenCommon::XenCEption("Specified corpus " + ptrFile->getFullPath() + " does not exists! Exiting.");
-    } catch (XenCommon::XenCEption &e) {
-        throw;
-    }
+void Corpus::initialize(boost::shared_ptr<XenFile> ptrData, std::string lg, bool countWords) {
+    ptrFile = ptrData;
+    lang = lg;
+    
+    load(countWords);
+}
+
+void Corpus::initialize(boost::shared_ptr<XenFile> ptrData, std::string lg, bool countWords, int shard, int shards) {
+    ptrFile = ptrData;
+    lang = lg;
+    this->shard = shard;
+    this->shards = shards > 1 ? shards : 0;
+    
+    load(countWords);
 }
 
 void Corpus::initialize(std::string filePath, std::string lg) {
@@ -62,22 +178,7 @@ void Corpus::initialize(std::string filePath, std::string lg) {
     ptrFile->initialize(filePath);
     lang = lg;
     
-    try {
-        if (boost::filesystem::exists(ptrFile->getFullPath().c_str())) {
-            if (boost::filesystem::file_size(ptrFile->getFullPath().c_str()) > 0) {
-                std::cout << "Specified corpus " << ptrFile->getFullPath() << " exists! We continue..." << std::endl;
-
-                loadText();
-                wc = Corpus::wordCount();
-            }
-            else
-                throw XenCommon::XenCEption("Specified corpus " + ptrFile->getFullPath() + " has a null size! Exiting.");
-        }
-        else
-            throw XenCommon::XenCEption("Specified corpus " + ptrFile->getFullPath() + " does not exists! Exiting.");
-    } catch (XenCommon::XenCEption &e) {
-        throw;
-    }
+    load(false);
 }
 
 Corpus::~Corpus() {
@@ -89,11 +190,24 @@ boost::shared_ptr<XenFile> Corpus::getXenFile() const {
 }
 
 std::string Corpus::getLine(int line) {
-	return ptrText->operator[]((unsigned long) line);
+    uint64_t start = ptrOffsets->operator[]((unsigned long) line);
+    uint64_t stop = ptrOffsets->operator[]((unsigned long) line + 1) - 1;
+
+	return std::string(&ptrText->operator[](start), (std::size_t)(stop - start));
+}
+
+StringPiece Corpus::getView(int line) const {
+    uint64_t start = ptrOffsets->operator[]((unsigned long) line);
+    uint64_t stop = ptrOffsets->operator[]((unsigned long) line + 1) - 1;
+
+    return StringPiece(&ptrText->operator[](start), (std::size_t)(stop - start));
 }
 
 unsigned int Corpus::getSize() const {
-	return (unsigned int)ptrText->size();
+    if (!ptrOffsets)
+        return 0;
+
+    return (unsigned int)ptrOffsets->size() - 1;
 }
 
 std::string Corpus::getLang() const {
@@ -108,21 +222,294 @@ int Corpus::getWC() const {
 	return wc;
 }
 
+int Corpus::getTokens(int line) const {
+    return ptrToks->operator[]((unsigned long) line);
+}
+
+bool Corpus::isValid(int line) const {
+    return ptrValid->operator[]((unsigned long) line);
+}
+
+boost::shared_ptr<WordCounts> Corpus::getWordCounts() const {
+    return ptrCounts;
+}
+
+boost::shared_ptr<TokenizedText> Corpus::getTokenized() {
+    boost::mutex::scoped_lock lock(*ptrTokMtx);
+
+    if (ptrTokenized)
+        return ptrTokenized;
+
+    boost::shared_ptr<TokenizedText> ptrTok = boost::make_shared<TokenizedText>();
+    boost::unordered_map<uint64_t, uint32_t> typeOf;
+    Tokenizer tokens;
+    Token tok;
+
+    ptrTok->starts.reserve(getSize() + 1);
+    ptrTok->words.reserve((std::size_t)std::max(0, wc));
+
+    for (unsigned int i = 0; i < getSize(); i++) {
+        std::string line = getLine(i);
+
+        ptrTok->starts.push_back(ptrTok->words.size());
+
+        tokens.reset(line);
+        while (tokens.next(tok)) {
+            std::pair<boost::unordered_map<uint64_t, uint32_t>::iterator, bool> ins = typeOf.insert(std::make_pair(tok.hash, (uint32_t)ptrTok->types.size()));
+
+            if (ins.second)
+                ptrTok->types.push_back(tok.hash);
+
+            ptrTok->words.push_back(ins.first->second);
+        }
+    }
+
+    ptrTok->starts.push_back(ptrTok->words.size());
+    ptrTokenized = ptrTok;
+
+    return ptrTokenized;
+}
+
 void Corpus::removeLine(int line) {
     ptrPrint->operator[]((unsigned long) line) = 0;
 }
 
-void Corpus::loadText() {
-    ptrText = boost::make_shared<std::vector<std::string> >(XenIO::read(ptrFile));
-    ptrPrint = boost::make_shared<std::vector<int> >(ptrText->size(), 1);
+bool Corpus::isSlice() const {
+    return shards > 1;
 }
 
-int Corpus::wordCount() {
-	int res = 0;
-    
-	for (unsigned int i = 0; i < ptrText->size(); i++) {
-        res = res + XenCommon::wordCount(ptrText->operator[](i));
+int Corpus::getShard() const {
+    return shard;
+}
+
+int Corpus::getShards() const {
+    return shards;
+}
+
+unsigned int Corpus::getFirstLine() const {
+    return firstLine;
+}
+
+unsigned int Corpus::getFileSize() const {
+    if (!ptrFileToks)
+        return 0;
+
+    return (unsigned int)ptrFileToks->size();
+}
+
+int Corpus::getFileWC() const {
+    return fileWC;
+}
+
+int Corpus::getFileTokens(int line) const {
+    return ptrFileToks->operator[]((unsigned long) line);
+}
+
+std::size_t Corpus::getMemory() const {
+    std::size_t bytes = 0;
+
+    if (ptrText)
+        bytes += ptrText->capacity();
+    if (ptrOffsets)
+        bytes += ptrOffsets->capacity() * sizeof(uint64_t);
+    if (ptrToks)
+        bytes += ptrToks->capacity() * sizeof(int);
+    if (ptrPrint)
+        bytes += ptrPrint->capacity() * sizeof(int);
+    if (ptrFileToks)
+        bytes += ptrFileToks->capacity() * sizeof(int);
+    if (ptrValid)
+        bytes += ptrValid->capacity() / 8;
+
+    return bytes;
+}
+
+void Corpus::load(bool countWords) {
+    try {
+        if (boost::filesystem::exists(ptrFile->getFullPath().c_str())) {
+            if (boost::filesystem::file_size(ptrFile->getFullPath().c_str()) > 0) {
+                std::cout << "Specified corpus " << ptrFile->getFullPath() << " exists! We continue..." << std::endl;
+
+                boost::shared_ptr<RunStats> ptrStats = StaticData::getInstance()->getRunStats();
+                int stage = ptrStats->startStage("corpus:" + ptrFile->getFullPath());
+
+                if (isSlice()) {
+                    loadSlice();
+                    ingest(countWords);
+                }
+                else
+                    loadText(countWords);
+
+                ptrStats->endStage(stage, getSize(), (uint64_t)wc);
+            }
+            else
+                throw XenCommon::XenCEption("Specified corpus " + ptrFile->getFullPath() + " has a null size! Exiting.");
+        }
+        else
+            throw XenCommon::XenCEption("Specified corpus " + ptrFile->getFullPath() + " does not exists! Exiting.");
+    } catch (XenCommon::XenCEption &e) {
+        throw;
     }
-    
-	return res;
+}
+
+void Corpus::loadText(bool countWords) {
+    // Block gzip files are decompressed in parallel, other gzip files while being ingested
+    if (ptrFile->isGZ() && !Bgzf::isBgzf(ptrFile->getFullPath()))
+        loadStream(countWords);
+    else {
+        ptrText = boost::make_shared<std::vector<char> >();
+        XenIO::readBuffer(ptrFile, *ptrText);
+
+        ingest(countWords);
+    }
+
+    firstLine = 0;
+    ptrFileToks = ptrToks;
+    fileWC = wc;
+}
+
+void Corpus::loadSlice() {
+    LineReader reader;
+    std::string line;
+
+    // First pass: token counts of the whole file, for the sample statistics
+    ptrFileToks = boost::make_shared<std::vector<int> >();
+    fileWC = 0;
+
+    reader.open(ptrFile);
+    while (reader.next(line)) {
+        int toks = XenCommon::wordCount(line);
+
+        ptrFileToks->push_back(toks);
+        fileWC += toks;
+    }
+
+    uint64_t size = ptrFileToks->size();
+    uint64_t first = size * (uint64_t)(shard - 1) / (uint64_t)shards;
+    uint64_t last = size * (uint64_t)shard / (uint64_t)shards;
+
+    if (first == last)
+        throw XenCommon::XenCEption("Slice " + XenCommon::toString(shard) + "/" + XenCommon::toString(shards) + " of corpus " + ptrFile->getFullPath() + " is empty! Exiting.");
+
+    std::cout << "Loading lines " << first + 1 << " to " << last << " of " << size << " (slice " << shard << "/" << shards << ")" << std::endl;
+
+    // Second pass: the lines of the slice only, straight from their members for indexed block gzip files
+    LineReader slice;
+
+    ptrText = boost::make_shared<std::vector<char> >();
+    firstLine = (unsigned int)first;
+
+    if (ptrFile->isGZ() && Bgzf::readLines(ptrFile->getFullPath(), first, last, *ptrText))
+        return;
+
+    slice.open(ptrFile);
+    while (slice.getCount() < last && slice.next(line)) {
+        if (slice.getCount() > first) {
+            ptrText->insert(ptrText->end(), line.begin(), line.end());
+            ptrText->push_back('\n');
+        }
+    }
+}
+
+void Corpus::loadStream(bool countWords) {
+    unsigned int threads = (unsigned int)std::max(1, XenOption::getInstance()->getThreads());
+    AsyncReader reader(streamBlock, 2 * threads);
+    std::deque<IngestShard> shards;
+
+    std::cout << "Reading file " + ptrFile->getFullPath() << std::endl;
+
+    ptrText = boost::make_shared<std::vector<char> >();
+
+    try {
+        TaskGroup ingest;
+        TextBlock ptrBlock;
+
+        reader.open(ptrFile);
+
+        // Each block is ingested by the workers while the next one is decompressed
+        while ((ptrBlock = reader.next())) {
+            unsigned int parts = (unsigned int)std::max<uint64_t>(1, std::min<uint64_t>(threads, ptrBlock->size() / minPart));
+            std::vector<uint64_t> bounds = cutLines(*ptrBlock, parts);
+
+            for (unsigned int p = 0; p < parts; p++) {
+                if (bounds[p] == bounds[p + 1])
+                    continue;
+
+                shards.push_back(IngestShard());
+                shards.back().base = ptrText->size();
+                if (countWords)
+                    shards.back().counts = boost::make_shared<WordCounts>();
+
+                ingest.run(boost::bind(taskIngestBlock, ptrBlock, bounds[p], bounds[p + 1], &shards.back()));
+            }
+
+            ptrText->insert(ptrText->end(), ptrBlock->begin(), ptrBlock->end());
+        }
+
+        ingest.wait();
+    } catch (XenCommon::XenCEption &e) {
+        throw;
+    }
+
+    std::cout << "Done reading file " + ptrFile->getFullPath() << std::endl;
+
+    gather(shards, countWords);
+}
+
+void Corpus::ingest(bool countWords) {
+    // Cut the buffer in one range per thread, on line boundaries
+    unsigned int threads = (unsigned int)std::max(1, XenOption::getInstance()->getThreads());
+    std::vector<uint64_t> bounds = cutLines(*ptrText, threads);
+
+    std::deque<IngestShard> shards(threads);
+    TaskGroup ingest;
+
+    for (unsigned int t = 0; t < threads; t++) {
+        shards[t].base = 0;
+        if (countWords)
+            shards[t].counts = boost::make_shared<WordCounts>();
+
+        if (bounds[t] < bounds[t + 1])
+            ingest.run(boost::bind(taskIngest, ptrText.get(), bounds[t], bounds[t + 1], &shards[t]));
+    }
+
+    ingest.wait();
+
+    gather(shards, countWords);
+}
+
+void Corpus::gather(std::deque<IngestShard> &shards, bool countWords) {
+    ptrOffsets = boost::make_shared<std::vector<uint64_t> >();
+    ptrToks = boost::make_shared<std::vector<int> >();
+    ptrValid = boost::make_shared<std::vector<bool> >();
+    ptrCounts.reset();
+    ptrTokenized.reset();
+    wc = 0;
+
+    for (unsigned int t = 0; t < shards.size(); t++) {
+        for (unsigned int i = 0; i < shards[t].offsets.size(); i++)
+            ptrOffsets->push_back(shards[t].base + shards[t].offsets[i]);
+        ptrToks->insert(ptrToks->end(), shards[t].toks.begin(), shards[t].toks.end());
+        ptrValid->insert(ptrValid->end(), shards[t].valid.begin(), shards[t].valid.end());
+
+        for (unsigned int i = 0; i < shards[t].toks.size(); i++)
+            wc += shards[t].toks[i];
+
+        if (countWords) {
+            if (!ptrCounts)
+                ptrCounts = shards[t].counts;
+            else
+                for (WordCounts::iterator it = shards[t].counts->begin(); it != shards[t].counts->end(); ++it) {
+                    WordCounts::iterator found = ptrCounts->find(it->first);
+
+                    if (found != ptrCounts->end())
+                        found->second.count += it->second.count;
+                    else
+                        ptrCounts->insert(*it);
+                }
+        }
+    }
+
+    ptrOffsets->push_back(ptrText->size());
+    ptrPrint = boost::make_shared<std::vector<int> >(ptrToks->size(), 1);
 }
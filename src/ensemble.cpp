@@ -0,0 +1,156 @@
+/**
+ *  @file ensemble.cpp
+ *  @brief Class handling the ensemble of out-of-domain sample LMs used by mean scoring
+ *  @author Anthony Rousseau
+ *  @version 2.0.0
+ *  @date 19 October 2026
+ */
+
+/*  This file is part of the cross-entropy tool for data selection (XenC)
+ *  aimed at speech recognition and statistical machine translation.
+ *
+ *  Copyright 2013-2016, Anthony Rousseau, LIUM, University of Le Mans, France
+ *
+ *  Development of the XenC tool has been partially funded by the
+ *  European Commission under the MateCat project.
+ *
+ *  The XenC tool is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation
+ *
+ *  This library is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "../include/ensemble.h"
+#include "../include/utils/StaticData.h"
+
+void taskCalcXEBatch(boost::shared_ptr<std::vector<int> > ptrLines, boost::shared_ptr<std::vector<std::string> > ptrSents, boost::shared_ptr<std::vector<double> > ptrXE, const std::vector<boost::shared_ptr<XenLMken> > *members) {
+    std::vector<uint64_t> hashes;
+    std::vector<uint64_t> starts;
+    std::vector<TxtStats> stats;
+    std::vector<double> sums(ptrLines->size(), 0.0);
+
+    XenLMken::tokenize(*ptrSents, hashes, starts);
+
+    for (unsigned int m = 0; m < members->size(); m++) {
+        members->operator[](m)->getHashStats(hashes, starts, stats);
+
+        for (unsigned int i = 0; i < stats.size(); i++)
+            sums[i] += PPL::crossEntropy(PPL::statsPPL(stats[i]));
+    }
+
+    for (unsigned int i = 0; i < sums.size(); i++)
+        ptrXE->operator[](ptrLines->operator[](i)) = sums[i] / members->size();
+}
+
+LMEnsemble::LMEnsemble() {
+    ptrXE = boost::make_shared<std::vector<double> >();
+}
+
+LMEnsemble::~LMEnsemble() {
+
+}
+
+void LMEnsemble::initialize(boost::shared_ptr<XenLMken> ptrFirst, boost::shared_ptr<Corpus> ptrSample) {
+    members.assign(1, ptrFirst);
+    samples.assign(1, ptrSample);
+}
+
+void LMEnsemble::addMember(boost::shared_ptr<Corpus> ptrSample, boost::shared_ptr<XenVocab> ptrVoc) {
+    boost::shared_ptr<XenLMken> ptrLM = boost::make_shared<XenLMken>();
+    ptrLM->initialize(ptrSample, ptrVoc);
+
+    members.push_back(ptrLM);
+    samples.push_back(ptrSample);
+}
+
+void LMEnsemble::createLMs() {
+    XenOption* opt = XenOption::getInstance();
+
+    std::cout << "Estimating the " << members.size() << " language models of the mean ensemble..." << std::endl;
+
+    MemoryBudget budget(opt->getMemPc());
+    boost::thread_group builders;
+
+    errors.assign(members.size(), "");
+
+    for (unsigned int m = 0; m < members.size(); m++) {
+        if (!samples[m])
+            continue;
+
+        std::size_t memory = XenLMken::buildMemory(samples[m], budget.getTotal());
+
+        budget.acquire(memory);
+        builders.create_thread(boost::bind(&LMEnsemble::buildMember, this, m, memory, &budget));
+    }
+
+    builders.join_all();
+
+    for (unsigned int m = 0; m < members.size(); m++) {
+        if (errors[m].compare("") != 0)
+            throw XenCommon::XenCEption("Estimation of LM " + members[m]->getFileName() + " failed: " + errors[m]);
+
+        if (!boost::filesystem::exists(members[m]->getFileName()))
+            throw XenCommon::XenCEption("LM file " + members[m]->getFileName() + " does not exists!");
+    }
+
+    std::cout << "Mean ensemble estimation done." << std::endl;
+}
+
+void LMEnsemble::calcXECorpus(boost::shared_ptr<Corpus> ptrCorp, boost::shared_ptr<ScoreStore> ptrStore) {
+    ptrXE = boost::make_shared<std::vector<double> >(ptrCorp->getSize(), 0.0);
+
+    ScoringPass pass("meanxe:" + members[0]->getFileName() + ":" + ptrCorp->getXenFile()->getFullPath(), ptrCorp, ptrStore, ptrXE);
+    std::vector<std::string> names;
+
+    for (unsigned int m = 0; m < members.size(); m++)
+        names.push_back(members[m]->getFileName());
+
+    if (pass.restore(boost::filesystem::path(members[0]->getFileName()).filename().string() + ".mean." + boost::filesystem::path(ptrCorp->getXenFile()->getFullPath()).filename().string() + ".xe", names)) {
+        std::cout << "Sentences mean cross-entropy scores restored from checkpoint." << std::endl;
+        return;
+    }
+
+    for (unsigned int m = 0; m < members.size(); m++)
+        members[m]->loadLM();
+
+    std::cout << "Computing sentences mean cross-entropy scores with " << members.size() << " LMs..." << std::endl;
+
+    pass.run(boost::bind(taskCalcXEBatch, _1, _2, ptrXE, &members));
+
+    std::cout << "Finished computing sentences mean cross-entropy scores." << std::endl;
+}
+
+double LMEnsemble::getXE(int n) {
+    return ptrXE->operator[](n);
+}
+
+unsigned int LMEnsemble::getSize() const {
+    return (unsigned int)members.size();
+}
+
+std::string LMEnsemble::getFileName(unsigned int m) const {
+    return members[m]->getFileName();
+}
+
+boost::shared_ptr<XenLMken> LMEnsemble::getLM(unsigned int m) const {
+    return members[m];
+}
+
+void LMEnsemble::buildMember(unsigned int m, std::size_t memory, MemoryBudget* budget) {
+    try {
+        members[m]->setMemory(memory);
+        members[m]->createLM();
+    } catch (std::exception &e) {
+        errors[m] = e.what();
+    }
+
+    budget->release(memory);
+}
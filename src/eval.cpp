@@ -31,21 +31,47 @@
 #include "../include/eval.h"
 #include "../include/utils/StaticData.h"
 
-void taskEval(int pc, boost::shared_ptr<Corpus> ptrCorp, boost::shared_ptr<XenVocab> ptrVoc, boost::shared_ptr<Corpus> ptrDevCorp, boost::shared_ptr<EvalMap> ptrDist) {
-    std::cout << "Starting eval " + XenCommon::toString(pc) + " percent." << std::endl;
+void taskEvalBuild(boost::shared_ptr<EvalJob> ptrJob, boost::shared_ptr<XenVocab> ptrVoc, boost::shared_ptr<Corpus> ptrDevCorp, MemoryBudget* budget, TaskGroup* scoring) {
+    std::cout << "Starting eval " + XenCommon::toString(ptrJob->pc) + " percent." << std::endl;
+
+    try {
+        ptrJob->ptrLM = boost::make_shared<XenLMken>();
+        ptrJob->ptrLM->initialize(ptrJob->ptrCorp, ptrVoc);
+        ptrJob->ptrLM->setMemory(ptrJob->memory - ptrJob->ptrCorp->getMemory());
+        ptrJob->ptrLM->createLM();
+    } catch (std::exception &e) {
+        ptrJob->error = e.what();
+    }
+
+    // The part lines are held in the budget along with the estimation
+    if (ptrJob->ptrLM)
+        ptrJob->ptrLM->releaseCorpus();
+    ptrJob->ptrCorp.reset();
+
+    budget->release(ptrJob->memory);
+
+    if (ptrJob->error.compare("") == 0 && !boost::filesystem::exists(ptrJob->ptrLM->getFileName()))
+        ptrJob->error = "LM file " + ptrJob->ptrLM->getFileName() + " does not exists!";
+
+    if (ptrJob->error.compare("") == 0)
+        scoring->run(boost::bind(taskEvalScore, ptrJob, ptrDevCorp));
+}
 
-    boost::shared_ptr<XenLMken> ptrLM = boost::make_shared<XenLMken>();
-    ptrLM->initialize(ptrCorp, ptrVoc);
-    ptrLM->createLM();
-    ptrLM->loadLM();
+void taskEvalScore(boost::shared_ptr<EvalJob> ptrJob, boost::shared_ptr<Corpus> ptrDevCorp) {
+    try {
+        ptrJob->ptrLM->loadLM();
 
-    boost::shared_ptr<PPL> ptrPPL = boost::make_shared<PPL>();
-    ptrPPL->initialize(ptrDevCorp, ptrLM);
-    ptrDist->operator[](pc) = ptrPPL->getCorpPPL();
+        boost::shared_ptr<PPL> ptrPPL = boost::make_shared<PPL>();
+        ptrPPL->initialize(ptrDevCorp, ptrJob->ptrLM);
+        ptrJob->ppl = ptrPPL->getCorpPPL();
 
-    std::cout << "Eval " + XenCommon::toString(pc) + " percent done, PPL = " + XenCommon::toString(ptrDist->operator[](pc)) + "." << std::endl;
+        std::cout << "Eval " + XenCommon::toString(ptrJob->pc) + " percent done, PPL = " + XenCommon::toString(ptrJob->ppl) + "." << std::endl;
+    } catch (std::exception &e) {
+        ptrJob->error = e.what();
+    }
 
-    XenIO::delFile(ptrLM->getFileName());
+    XenIO::delFile(ptrJob->ptrLM->getFileName());
+    ptrJob->ptrLM.reset();
 }
 
 Eval::Eval() {
@@ -64,38 +90,80 @@ void Eval::doEval(int high, int low) {
     XenOption* opt = XenOption::getInstance();
     StaticData* sD = StaticData::getInstance();
     
+    // The in-domain corpus is not loaded when the sorted output was already there
+    if (opt->getSVocab()->getFileName().compare("") == 0 && !sD->getSourceCorps()->getPtrInCorp()->getXenFile())
+        sD->getSourceCorps()->getPtrInCorp()->initialize(opt->getInSData(), opt->getSLang(), true);
+    
     if (opt->getSVocab()->getFileName().compare("") == 0) { sD->getVocabs()->getPtrSourceVoc()->initialize(sD->getSourceCorps()->getPtrInCorp()); }
     else { sD->getVocabs()->getPtrSourceVoc()->initialize(opt->getSVocab()); }
+
+    if (!ptrCache) {
+        ptrCache = boost::make_shared<EvalCache>();
+        ptrCache->initialize(sD->getXenResult()->getXenFile(), sD->getDevCorp(), sD->getVocabs()->getPtrSourceVoc());
+    }
     
-    pool threadPool(opt->getThreads());
+    MemoryBudget budget(opt->getMemPc());
+    TaskGroup scoring;
+    boost::thread_group builders;
     
     int pc = low;
     if (pc == 0) { pc = opt->getStep(); }
 
-    std::vector<std::string> parts;
+    std::vector<boost::shared_ptr<EvalJob> > jobs;
 
 	while (pc <= high) {
         EvalMap::iterator found = ptrDist->find(pc);
-        if (found == ptrDist->end()) {
-            std::string partName = sD->getXenResult()->getXenFile()->getDirName() + "/" + sD->getXenResult()->getXenFile()->getPrefix() + "-" + XenCommon::toString(pc) + "pc.gz";
-            XenIO::writeXRpart(sD->getXenResult(), pc, partName);
+        double ppl = 0;
+        if (found == ptrDist->end() && ptrCache->find(pc, ppl)) {
+            ptrDist->operator[](pc) = ppl;
+            std::cout << "Eval " + XenCommon::toString(pc) + " percent reused from cache, PPL = " + XenCommon::toString(ppl) + "." << std::endl;
+        }
+        else if (found == ptrDist->end()) {
+            // Prepared while the previous parts are estimated
+            boost::shared_ptr<EvalJob> ptrJob = boost::make_shared<EvalJob>();
+            ptrJob->pc = pc;
+            ptrJob->partName = sD->getXenResult()->getXenFile()->getDirName() + "/" + sD->getXenResult()->getXenFile()->getPrefix() + "-" + XenCommon::toString(pc) + "pc.gz";
+            ptrJob->ppl = 0;
+            ptrJob->error = "";
+
+            XenIO::writeXRpart(sD->getXenResult(), pc, ptrJob->partName);
 
-            boost::shared_ptr<Corpus> c = boost::make_shared<Corpus>();
-            c->initialize(partName, "xx");
+            ptrJob->ptrCorp = boost::make_shared<Corpus>();
+            ptrJob->ptrCorp->initialize(ptrJob->partName, "xx");
+            ptrJob->memory = XenLMken::buildMemory(ptrJob->ptrCorp, budget.getTotal()) + ptrJob->ptrCorp->getMemory();
 
-            threadPool.schedule(
-                    boost::bind(taskEval, pc, c, sD->getVocabs()->getPtrSourceVoc(), sD->getDevCorp(),
-                                ptrDist));
+            budget.acquire(ptrJob->memory);
+            builders.create_thread(boost::bind(taskEvalBuild, ptrJob, sD->getVocabs()->getPtrSourceVoc(), sD->getDevCorp(), &budget, &scoring));
 
-            parts.push_back(partName);
+            jobs.push_back(ptrJob);
         }
         pc += opt->getStep();
 	}
     
-    threadPool.wait();
+    builders.join_all();
+    scoring.wait();
+
+    // Points estimated before a failure are still cached for the next run
+    std::string error = "";
+
+    for (unsigned int i = 0; i < jobs.size(); i++) {
+        XenIO::delFile(jobs[i]->partName);
+
+        if (jobs[i]->error.compare("") != 0) {
+            if (error.compare("") == 0)
+                error = "Eval " + XenCommon::toString(jobs[i]->pc) + " percent failed: " + jobs[i]->error;
+            continue;
+        }
+
+        ptrDist->operator[](jobs[i]->pc) = jobs[i]->ppl;
+        ptrCache->add(jobs[i]->pc, jobs[i]->ppl);
+    }
+
+    if (!jobs.empty())
+        ptrCache->save();
 
-    for (int i = 0; i < parts.size(); i++)
-        XenIO::delFile(parts[i]);
+    if (error.compare("") != 0)
+        throw XenCommon::XenCEption(error);
 
     std::cout << "Evaluation done." << std::endl;
 }
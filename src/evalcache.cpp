@@ -0,0 +1,181 @@
+/**
+ *  @file evalcache.cpp
+ *  @brief Class handling the content-addressed cache of evaluation perplexities
+ *  @author Anthony Rousseau
+ *  @version 2.0.0
+ *  @date 19 October 2026
+ */
+
+
+/*  This file is part of the cross-entropy tool for data selection (XenC)
+ *  aimed at speech recognition and statistical machine translation.
+ *
+ *  Copyright 2013-2016, Anthony Rousseau, LIUM, University of Le Mans, France
+ *
+ *  Development of the XenC tool has been partially funded by the
+ *  European Commission under the MateCat project.
+ *
+ *  The XenC tool is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation
+ *
+ *  This library is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "../include/evalcache.h"
+#include "../include/checkpoint.h"
+#include "../include/xenoption.h"
+
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/sync/file_lock.hpp>
+#include <boost/interprocess/sync/scoped_lock.hpp>
+
+static const char cacheMagic[8] = { 'X', 'E', 'N', 'C', 'E', 'V', 'C', '1' };
+
+EvalCache::EvalCache() {
+    fileName = "";
+    fingerprint = 0;
+}
+
+EvalCache::~EvalCache() {
+
+}
+
+void EvalCache::initialize(boost::shared_ptr<XenFile> ptrSorted, boost::shared_ptr<Corpus> ptrDevCorp, boost::shared_ptr<XenVocab> ptrVoc) {
+    XenOption* opt = XenOption::getInstance();
+
+    fileName = opt->getEvalCache();
+    if (fileName.compare("") == 0)
+        fileName = ptrSorted->getDirName() + "/xenc.evalcache";
+
+    std::cout << "Computing evaluation fingerprint..." << std::endl;
+
+    // Parts, and so their perplexities, only depend on these contents
+    uint64_t h = Checkpoint::hashFile(ptrSorted->getFullPath(), 0);
+    h = Checkpoint::hashFile(ptrDevCorp->getXenFile()->getFullPath(), h);
+
+    const std::vector<std::string> &words = ptrVoc->getWords();
+    for (unsigned int i = 0; i < words.size(); i++)
+        h = Checkpoint::hashString(words[i], h);
+
+    std::string options = XenCommon::toString(opt->getOrder()) + "g" + (opt->getExclOOVs() ? "x" : "");
+    fingerprint = Checkpoint::hashString(options, h);
+
+    points.clear();
+    load();
+
+    std::cout << "Eval cache " << fileName << ": " << points.size() << " cached points." << std::endl;
+}
+
+bool EvalCache::find(int pc, double &ppl) const {
+    boost::unordered_map<uint64_t, double>::const_iterator it = points.find(getKey(pc));
+
+    if (it == points.end())
+        return false;
+
+    ppl = it->second;
+    return true;
+}
+
+void EvalCache::add(int pc, double ppl) {
+    points[getKey(pc)] = ppl;
+}
+
+void EvalCache::save() {
+    std::string lockName = fileName + ".lock";
+    std::string tmpName = boost::filesystem::unique_path(fileName + ".%%%%-%%%%.tmp").string();
+
+    try {
+        // Concurrent runs merge and rename one at a time, the lock file itself is left in place
+        std::ofstream touch(lockName.c_str(), std::ios::out | std::ios::app);
+
+        if (!touch.is_open())
+            throw XenCommon::XenCEption("Can't open " + lockName + " for writing.");
+
+        touch.close();
+
+        boost::interprocess::file_lock lock(lockName.c_str());
+        boost::interprocess::scoped_lock<boost::interprocess::file_lock> guard(lock);
+
+        // Points written by concurrent runs since initialize() are kept
+        load();
+
+        std::ofstream out(tmpName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+
+        if (!out.is_open())
+            throw XenCommon::XenCEption("Can't open " + tmpName + " for writing.");
+
+        std::vector<EvalPoint> entries;
+        entries.reserve(points.size());
+
+        for (boost::unordered_map<uint64_t, double>::const_iterator it = points.begin(); it != points.end(); ++it) {
+            EvalPoint p;
+            p.key = it->first;
+            p.ppl = it->second;
+            entries.push_back(p);
+        }
+
+        uint64_t count = entries.size();
+
+        out.write(cacheMagic, sizeof(cacheMagic));
+        out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        if (count > 0)
+            out.write(reinterpret_cast<const char*>(&entries[0]), count * sizeof(EvalPoint));
+
+        if (out.bad())
+            throw XenCommon::XenCEption("Error while writing file " + tmpName);
+
+        out.close();
+
+        boost::filesystem::rename(tmpName, fileName);
+    } catch (boost::interprocess::interprocess_exception &e) {
+        throw XenCommon::XenCEption("Can't lock " + lockName + ": " + e.what());
+    } catch (XenCommon::XenCEption &e) {
+        if (boost::filesystem::exists(tmpName))
+            boost::filesystem::remove(tmpName);
+
+        throw;
+    }
+}
+
+uint64_t EvalCache::getKey(int pc) const {
+    return Checkpoint::hashString(XenCommon::toString(pc), fingerprint);
+}
+
+void EvalCache::load() {
+    if (!boost::filesystem::exists(fileName.c_str()))
+        return;
+
+    std::ifstream in(fileName.c_str(), std::ios::in | std::ios::binary);
+
+    char magic[8];
+    uint64_t count = 0;
+
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(&count), sizeof(count));
+
+    // The count is checked against the file size before anything is allocated from it
+    uint64_t size = (uint64_t)boost::filesystem::file_size(fileName);
+
+    if (!in.good() || !std::equal(magic, magic + sizeof(magic), cacheMagic) || count > (size - sizeof(magic) - sizeof(count)) / sizeof(EvalPoint))
+        throw XenCommon::XenCEption("File " + fileName + " is not a valid eval cache.");
+
+    std::vector<EvalPoint> entries(count);
+    if (count > 0)
+        in.read(reinterpret_cast<char*>(&entries[0]), count * sizeof(EvalPoint));
+
+    if (!in.good())
+        throw XenCommon::XenCEption("Eval cache " + fileName + " is truncated.");
+
+    in.close();
+
+    for (unsigned int i = 0; i < entries.size(); i++)
+        points.insert(std::make_pair(entries[i].key, entries[i].ppl));
+}
@@ -0,0 +1,156 @@
+/**
+ *  @file factoredppl.cpp
+ *  @brief Class handling the joint surface and stem cross-entropy computations
+ *  @author Anthony Rousseau
+ *  @version 2.0.0
+ *  @date 19 October 2026
+ */
+
+/*  This file is part of the cross-entropy tool for data selection (XenC)
+ *  aimed at speech recognition and statistical machine translation.
+ *
+ *  Copyright 2013-2016, Anthony Rousseau, LIUM, University of Le Mans, France
+ *
+ *  Development of the XenC tool has been partially funded by the
+ *  European Commission under the MateCat project.
+ *
+ *  The XenC tool is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation
+ *
+ *  This library is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "../include/factoredppl.h"
+#include "../include/utils/StaticData.h"
+
+/**
+ *  @fn static void sumXE (boost::shared_ptr<XenLMken> ptrLM, const std::vector<uint64_t> &hashes, const std::vector<uint64_t> &starts, std::vector<double> &sums)
+ *  @brief Adds the cross-entropies of tokenized sentences given by a LM to their sums
+ *
+ *  @param ptrLM :  the language model
+ *  @param hashes : the vocabulary hashes of the words, sentence after sentence
+ *  @param starts : the position of the first word of each sentence (plus the word count)
+ *  @param sums :   the cross-entropy sums, one per sentence
+ */
+static void sumXE(boost::shared_ptr<XenLMken> ptrLM, const std::vector<uint64_t> &hashes, const std::vector<uint64_t> &starts, std::vector<double> &sums) {
+    std::vector<TxtStats> stats;
+
+    ptrLM->getHashStats(hashes, starts, stats);
+
+    for (unsigned int i = 0; i < stats.size(); i++)
+        sums[i] += PPL::crossEntropy(PPL::statsPPL(stats[i]));
+}
+
+void taskCalcFactoredBatch(boost::shared_ptr<std::vector<int> > ptrLines, boost::shared_ptr<std::vector<std::string> > ptrSents, boost::shared_ptr<std::vector<std::string> > ptrStems, boost::shared_ptr<std::vector<double> > ptrXE, const FactoredLMs* lms) {
+    std::vector<uint64_t> hashes;
+    std::vector<uint64_t> starts;
+    unsigned int size = (unsigned int)ptrLines->size();
+
+    std::vector<double> in(size, 0.0);
+    std::vector<double> out(size, 0.0);
+    std::vector<double> inStem(size, 0.0);
+    std::vector<double> outStem(size, 0.0);
+
+    // Surface lines are tokenized once for all surface LMs
+    XenLMken::tokenize(*ptrSents, hashes, starts);
+    sumXE(lms->ptrInLM, hashes, starts, in);
+    for (unsigned int m = 0; m < lms->outLMs.size(); m++)
+        sumXE(lms->outLMs[m], hashes, starts, out);
+
+    XenLMken::tokenize(*ptrStems, hashes, starts);
+    sumXE(lms->ptrInStemLM, hashes, starts, inStem);
+    sumXE(lms->ptrOutStemLM, hashes, starts, outStem);
+
+    for (unsigned int i = 0; i < size; i++)
+        ptrXE->operator[](ptrLines->operator[](i)) = (in[i] - out[i] / lms->outLMs.size()) + (inStem[i] - outStem[i]);
+}
+
+FactoredPPL::FactoredPPL() {
+    ptrXE = boost::make_shared<std::vector<double> >();
+    misaligned = 0;
+    firstMisaligned = 0;
+}
+
+FactoredPPL::~FactoredPPL() {
+
+}
+
+void FactoredPPL::initialize(boost::shared_ptr<Corpus> ptrCorp, boost::shared_ptr<XenFile> ptrStemFile, const FactoredLMs &lms) {
+    this->ptrCorp = ptrCorp;
+    this->ptrStemFile = ptrStemFile;
+    this->lms = lms;
+    ptrXE = boost::make_shared<std::vector<double> >(ptrCorp->getSize(), 0.0);
+}
+
+void FactoredPPL::calcXECorpus(boost::shared_ptr<ScoreStore> ptrStore) {
+    ScoringPass pass("factoredxe:" + lms.ptrInLM->getFileName() + ":" + ptrCorp->getXenFile()->getFullPath(), ptrCorp, ptrStore, ptrXE);
+    std::vector<std::string> names = getFileNames();
+    std::vector<std::string> files(1, ptrStemFile->getFullPath());
+
+    files.insert(files.end(), names.begin(), names.end());
+
+    if (pass.restore(boost::filesystem::path(lms.ptrInLM->getFileName()).filename().string() + ".factored." + boost::filesystem::path(ptrCorp->getXenFile()->getFullPath()).filename().string() + ".xe", files)) {
+        std::cout << "Sentences surface and stem cross-entropy scores restored from checkpoint." << std::endl;
+        return;
+    }
+
+    lms.ptrInLM->loadLM();
+    for (unsigned int m = 0; m < lms.outLMs.size(); m++)
+        lms.outLMs[m]->loadLM();
+    lms.ptrInStemLM->loadLM();
+    lms.ptrOutStemLM->loadLM();
+
+    std::string stem;
+
+    misaligned = 0;
+    firstMisaligned = 0;
+
+    std::cout << "Computing sentences surface and stem cross-entropy scores with " << names.size() << " LMs..." << std::endl;
+
+    // Stem lines are only read ahead of the scoring within the pass window
+    stems.open(ptrStemFile);
+    pass.run(boost::bind(taskCalcFactoredBatch, _1, _2, _3, ptrXE, &lms), boost::bind(&FactoredPPL::readStem, this, _1, _2), readAhead);
+
+    if (stems.next(stem))
+        throw XenCommon::XenCEption("Stem file " + ptrStemFile->getFullPath() + " has more lines than " + ptrCorp->getXenFile()->getFullPath() + ".");
+
+    if (misaligned > 0)
+        std::cout << "Warning: " << misaligned << " lines of " << ptrStemFile->getFullPath() << " do not have as many words as their surface line (first one is line " << firstMisaligned << ")." << std::endl;
+
+    std::cout << "Finished computing sentences surface and stem cross-entropy scores." << std::endl;
+}
+
+double FactoredPPL::getXE(int n) {
+    return ptrXE->operator[](n);
+}
+
+std::vector<std::string> FactoredPPL::getFileNames() const {
+    std::vector<std::string> names;
+
+    names.push_back(lms.ptrInLM->getFileName());
+    for (unsigned int m = 0; m < lms.outLMs.size(); m++)
+        names.push_back(lms.outLMs[m]->getFileName());
+    names.push_back(lms.ptrInStemLM->getFileName());
+    names.push_back(lms.ptrOutStemLM->getFileName());
+
+    return names;
+}
+
+void FactoredPPL::readStem(unsigned int i, std::string &stem) {
+    if (!stems.next(stem))
+        throw XenCommon::XenCEption("Stem file " + ptrStemFile->getFullPath() + " ends at line " + XenCommon::toString(i) + " but " + ptrCorp->getXenFile()->getFullPath() + " has " + XenCommon::toString(ptrCorp->getSize()) + " lines.");
+
+    if (XenCommon::wordCount(stem) != ptrCorp->getTokens(i)) {
+        if (misaligned == 0)
+            firstMisaligned = i + 1;
+        misaligned++;
+    }
+}
@@ -29,6 +29,11 @@
  */
 
 #include "../include/mode.h"
+#include "../include/utils/StaticData.h"
+
+#include <algorithm>
+
+bool Mode::seeded = false;
 
 Mode::~Mode() {
     
@@ -36,7 +41,7 @@ Mode::~Mode() {
 
 int Mode::findSampleSize(boost::shared_ptr<Corpus> idCorp, boost::shared_ptr<Corpus> oodCorp) {
     int iW = idCorp->getWC();
-	int oW = oodCorp->getWC();
+	int oW = oodCorp->getFileWC();
     
 	double res = (double)iW / (double)oW * 100;
 	int i = (int)(res + 0.5f);
@@ -48,41 +53,143 @@ int Mode::findSampleSize(boost::shared_ptr<Corpus> idCorp, boost::shared_ptr<Cor
 }
 
 Corpus Mode::extractSample(boost::shared_ptr<Corpus> ptrCorp, int sSize, bool mean) {
-	double res = (double)ptrCorp->getWC() * ((double)sSize / 100);
+	double res = (double)ptrCorp->getFileWC() * ((double)sSize / 100);
 	int max = (int)(res + 0.5f);
     
     std::string rnd = "";
+    std::string outFile = "";
     
-    if (mean) {
-        std::srand ((unsigned int)std::time(NULL));
-        rnd = XenCommon::toString0(std::rand() % 10000);
+    // Seeded once: the samples of a mean ensemble are drawn within the same second
+    if (!seeded) {
+        int seed = XenOption::getInstance()->getSeed();
+        std::srand(seed != 0 ? (unsigned int)seed : (unsigned int)std::time(NULL));
+        seeded = true;
     }
     
-    std::string sampleName = ptrCorp->getXenFile()->getPrefix() + rnd + "-sample" + XenCommon::toString(sSize);
-    std::string outFile = sampleName + "." + ptrCorp->getLang();
+    // Each mean sample gets a file of its own
+    do {
+        if (mean)
+            rnd = XenCommon::toString0(std::rand() % 10000);
+        
+        outFile = ptrCorp->getXenFile()->getPrefix() + rnd + "-sample" + XenCommon::toString(sSize) + "." + ptrCorp->getLang();
+    } while (mean && boost::filesystem::exists(outFile.c_str()));
     
     if (!boost::filesystem::exists(outFile.c_str())) {
-        std::srand((unsigned int)std::time(NULL));
+        // Written aside then renamed: the shards of a run may draw the same sample concurrently
+        std::string tmpFile = boost::filesystem::unique_path(outFile + ".%%%%-%%%%.tmp").string();
+        std::ofstream out(tmpFile.c_str(), std::ios::out | std::ios::trunc);
         
-        std::ofstream out(outFile.c_str(), std::ios::out | std::ios::trunc);
+        boost::shared_ptr<RunStats> ptrStats = StaticData::getInstance()->getRunStats();
+        int stage = ptrStats->startStage("sample:" + outFile);
+        uint64_t lines = 0;
+        int count = 0;
         
+        if (!ptrCorp->isSlice()) {
+            while (count < max) {
+                int idx = std::rand() % ptrCorp->getSize();
+                out << ptrCorp->getLine(idx) << std::endl;
+                count += (ptrCorp->getTokens(idx) + 1);
+                lines++;
+            }
+        }
+        else {
+            // Lines are drawn from the whole file, as an unsliced run would
+            std::vector<int> picks;
+            
+            while (count < max) {
+                int idx = std::rand() % ptrCorp->getFileSize();
+                picks.push_back(idx);
+                count += (ptrCorp->getFileTokens(idx) + 1);
+                lines++;
+            }
+            
+            std::vector<int> wanted(picks);
+            std::sort(wanted.begin(), wanted.end());
+            wanted.erase(std::unique(wanted.begin(), wanted.end()), wanted.end());
+            
+            std::vector<std::string> texts(wanted.size());
+            LineReader reader;
+            std::string line;
+            
+            reader.open(ptrCorp->getXenFile());
+            
+            for (unsigned int w = 0; w < wanted.size() && reader.next(line); )
+                if (wanted[w] == (int)reader.getCount() - 1)
+                    texts[w++] = line;
+            
+            for (unsigned int p = 0; p < picks.size(); p++)
+                out << texts[std::lower_bound(wanted.begin(), wanted.end(), picks[p]) - wanted.begin()] << std::endl;
+        }
+        
+        out.close();
+        
+        boost::filesystem::rename(tmpFile, outFile);
+        
+        ptrStats->endStage(stage, lines, count - lines);
+    }
+    else {
+        std::cout << "Sample file " << outFile << " already exists, reusing." << std::endl;
+    }
+    
+	Corpus r;
+    r.initialize(outFile, ptrCorp->getLang());
+    
+	return r;
+}
+
+Corpus Mode::extractFactorSample(boost::shared_ptr<Corpus> ptrCorp, boost::shared_ptr<XenFile> ptrFactor, std::string lg, int sSize) {
+	double res = (double)ptrCorp->getWC() * ((double)sSize / 100);
+	int max = (int)(res + 0.5f);
+    
+    std::string outFile = ptrFactor->getPrefix() + "-sample" + XenCommon::toString(sSize) + "." + lg;
+    
+    if (!seeded) {
+        int seed = XenOption::getInstance()->getSeed();
+        std::srand(seed != 0 ? (unsigned int)seed : (unsigned int)std::time(NULL));
+        seeded = true;
+    }
+    
+    if (!boost::filesystem::exists(outFile.c_str())) {
+        boost::shared_ptr<RunStats> ptrStats = StaticData::getInstance()->getRunStats();
+        int stage = ptrStats->startStage("sample:" + outFile);
+        std::vector<int> picks;
         int count = 0;
         
         while (count < max) {
-            std::string line = ptrCorp->getLine(std::rand() % ptrCorp->getSize());
-            out << line << std::endl;
-            int n = XenCommon::wordCount(line);
-            count += (n + 1);
+            int idx = std::rand() % ptrCorp->getSize();
+            picks.push_back(idx);
+            count += (ptrCorp->getTokens(idx) + 1);
+        }
+        
+        // Picked lines are written in file order, as the factor file is read once
+        std::sort(picks.begin(), picks.end());
+        
+        std::ofstream out(outFile.c_str(), std::ios::out | std::ios::trunc);
+        LineReader factors;
+        std::string line;
+        
+        factors.open(ptrFactor);
+        
+        for (unsigned int p = 0; p < picks.size(); ) {
+            if (!factors.next(line))
+                throw XenCommon::XenCEption("Factor file " + ptrFactor->getFullPath() + " has fewer lines than " + ptrCorp->getXenFile()->getFullPath() + ".");
+            
+            while (p < picks.size() && picks[p] == (int)factors.getCount() - 1) {
+                out << line << std::endl;
+                p++;
+            }
         }
         
         out.close();
+        
+        ptrStats->endStage(stage, picks.size(), count - picks.size());
     }
     else {
         std::cout << "Sample file " << outFile << " already exists, reusing." << std::endl;
     }
     
 	Corpus r;
-    r.initialize(outFile, ptrCorp->getLang());
+    r.initialize(outFile, lg);
     
 	return r;
 }
@@ -43,10 +43,14 @@ int BiXEntropy::launch() {
     StaticData* sD = StaticData::getInstance();
     
     // Init corpus
-    sD->getSourceCorps()->getPtrInCorp()->initialize(opt->getInSData(), opt->getSLang());
-    sD->getSourceCorps()->getPtrOutCorp()->initialize(opt->getOutSData(), opt->getSLang());
-    sD->getTargetCorps()->getPtrInCorp()->initialize(opt->getInTData(), opt->getTLang());
-    sD->getTargetCorps()->getPtrOutCorp()->initialize(opt->getOutTData(), opt->getTLang());
+    sD->getSourceCorps()->getPtrInCorp()->initialize(opt->getInSData(), opt->getSLang(), opt->getSVocab()->getFileName().compare("") == 0);
+    sD->getSourceCorps()->getPtrOutCorp()->initialize(opt->getOutSData(), opt->getSLang(), opt->getSVocab()->getFileName().compare("") == 0 && opt->getFullVocab(), opt->getShardIndex(), opt->getShardCount());
+    sD->getTargetCorps()->getPtrInCorp()->initialize(opt->getInTData(), opt->getTLang(), opt->getTVocab()->getFileName().compare("") == 0);
+    sD->getTargetCorps()->getPtrOutCorp()->initialize(opt->getOutTData(), opt->getTLang(), opt->getTVocab()->getFileName().compare("") == 0 && opt->getFullVocab(), opt->getShardIndex(), opt->getShardCount());
+    
+    // Both out-of-domain sides are checked to be aligned before any scoring
+    boost::shared_ptr<Bitext> ptrOutBitext = boost::make_shared<Bitext>();
+    ptrOutBitext->initialize(sD->getSourceCorps()->getPtrOutCorp(), sD->getTargetCorps()->getPtrOutCorp());
 
     // Init vocabs
     if (opt->getSVocab()->getFileName().compare("") == 0) {
@@ -90,12 +94,15 @@ int BiXEntropy::launch() {
     }
     
     // Init out-of-domain source LM
+    boost::shared_ptr<Corpus> ptrSourceOutLMCorp;
+    
     if (opt->getOutSLM()->getFileName().compare("") == 0) {
         opt->setSampleSize(Mode::findSampleSize(sD->getSourceCorps()->getPtrInCorp(), sD->getSourceCorps()->getPtrOutCorp()));
         
-        boost::shared_ptr<Corpus> ptrOutLMCorp = boost::make_shared<Corpus>(Mode::extractSample(sD->getSourceCorps()->getPtrOutCorp(), opt->getSampleSize(), opt->getMean()));
-        sD->getSourceLMs()->getPtrOutLM()->initialize(ptrOutLMCorp, sD->getVocabs()->getPtrSourceVoc());
-        sD->getSourceLMs()->getPtrOutLM()->createLM();
+        ptrSourceOutLMCorp = boost::make_shared<Corpus>(Mode::extractSample(sD->getSourceCorps()->getPtrOutCorp(), opt->getSampleSize(), opt->getMean()));
+        sD->getSourceLMs()->getPtrOutLM()->initialize(ptrSourceOutLMCorp, sD->getVocabs()->getPtrSourceVoc());
+        if (!opt->getMean())    // Estimated along with the other samples
+            sD->getSourceLMs()->getPtrOutLM()->createLM();
         //sD->getSourceLMs()->getPtrOutLM()->writeLM();
     }
     else {
@@ -104,12 +111,15 @@ int BiXEntropy::launch() {
     }
     
     // Init out-of-domain target LM
+    boost::shared_ptr<Corpus> ptrTargetOutLMCorp;
+    
     if (opt->getOutTLM()->getFileName().compare("") == 0) {
         opt->setSampleSize(Mode::findSampleSize(sD->getTargetCorps()->getPtrInCorp(), sD->getTargetCorps()->getPtrOutCorp()));
         
-        boost::shared_ptr<Corpus> ptrOutLMCorp = boost::make_shared<Corpus>(Mode::extractSample(sD->getTargetCorps()->getPtrOutCorp(), opt->getSampleSize(), opt->getMean()));
-        sD->getTargetLMs()->getPtrOutLM()->initialize(ptrOutLMCorp, sD->getVocabs()->getPtrTargetVoc());
-        sD->getTargetLMs()->getPtrOutLM()->createLM();
+        ptrTargetOutLMCorp = boost::make_shared<Corpus>(Mode::extractSample(sD->getTargetCorps()->getPtrOutCorp(), opt->getSampleSize(), opt->getMean()));
+        sD->getTargetLMs()->getPtrOutLM()->initialize(ptrTargetOutLMCorp, sD->getVocabs()->getPtrTargetVoc());
+        if (!opt->getMean())    // Estimated along with the other samples
+            sD->getTargetLMs()->getPtrOutLM()->createLM();
         //sD->getTargetLMs()->getPtrOutLM()->writeLM();
     }
     else {
@@ -117,46 +127,32 @@ int BiXEntropy::launch() {
         sD->getTargetLMs()->getPtrOutLM()->loadLM();
     }
     
+    // Init Mean LMs if needed
+    if (opt->getMean()) {
+        int sSize = Mode::findSampleSize(sD->getSourceCorps()->getPtrInCorp(), sD->getSourceCorps()->getPtrOutCorp());
+        int tSize = Mode::findSampleSize(sD->getTargetCorps()->getPtrInCorp(), sD->getTargetCorps()->getPtrOutCorp());
+        
+        sD->getSourceEnsemble()->initialize(sD->getSourceLMs()->getPtrOutLM(), ptrSourceOutLMCorp);
+        sD->getTargetEnsemble()->initialize(sD->getTargetLMs()->getPtrOutLM(), ptrTargetOutLMCorp);
+        for (int k = 1; k < opt->getMeanK(); k++) {
+            sD->getSourceEnsemble()->addMember(boost::make_shared<Corpus>(Mode::extractSample(sD->getSourceCorps()->getPtrOutCorp(), sSize, true)), sD->getVocabs()->getPtrSourceVoc());
+            sD->getTargetEnsemble()->addMember(boost::make_shared<Corpus>(Mode::extractSample(sD->getTargetCorps()->getPtrOutCorp(), tSize, true)), sD->getVocabs()->getPtrTargetVoc());
+        }
+        sD->getSourceEnsemble()->createLMs();
+        sD->getTargetEnsemble()->createLMs();
+    }
+    
     // Check for LM estimation OK
     if (!boost::filesystem::exists(sD->getSourceLMs()->getPtrInLM()->getFileName())) { std::cout << "Error: LM file " + sD->getSourceLMs()->getPtrInLM()->getFileName() + " does not exists!" << std::endl; return 1; }
     if (!boost::filesystem::exists(sD->getTargetLMs()->getPtrInLM()->getFileName())) { std::cout << "Error: LM file " + sD->getTargetLMs()->getPtrInLM()->getFileName() + " does not exists!" << std::endl; return 1; }
     if (!boost::filesystem::exists(sD->getSourceLMs()->getPtrOutLM()->getFileName())) { std::cout << "Error: LM file " + sD->getSourceLMs()->getPtrOutLM()->getFileName() + " does not exists!" << std::endl; return 1; }
     if (!boost::filesystem::exists(sD->getTargetLMs()->getPtrOutLM()->getFileName())) { std::cout << "Error: LM file " + sD->getTargetLMs()->getPtrOutLM()->getFileName() + " does not exists!" << std::endl; return 1; }
 
-    // Init Mean LMs if needed
-    if (opt->getMean()) {
-        boost::shared_ptr<Corpus> ptrSourceOutLMCorp2 = boost::make_shared<Corpus>(Mode::extractSample(sD->getSourceCorps()->getPtrOutCorp(), opt->getSampleSize(), opt->getMean()));
-        sD->getMeanSourceLMs()->getPtrOutLM2()->initialize(ptrSourceOutLMCorp2, sD->getVocabs()->getPtrSourceVoc());
-        sD->getMeanSourceLMs()->getPtrOutLM2()->createLM();
-        //sD->getMeanSourceLMs()->getPtrOutLM2()->writeLM();
-        
-        boost::shared_ptr<Corpus> ptrTargetOutLMCorp2 = boost::make_shared<Corpus>(Mode::extractSample(sD->getTargetCorps()->getPtrOutCorp(), opt->getSampleSize(), opt->getMean()));
-        sD->getMeanTargetLMs()->getPtrOutLM2()->initialize(ptrTargetOutLMCorp2, sD->getVocabs()->getPtrTargetVoc());
-        sD->getMeanTargetLMs()->getPtrOutLM2()->createLM();
-        //sD->getMeanTargetLMs()->getPtrOutLM2()->writeLM();
-        
-        boost::shared_ptr<Corpus> ptrSourceOutLMCorp3 = boost::make_shared<Corpus>(Mode::extractSample(sD->getSourceCorps()->getPtrOutCorp(), opt->getSampleSize(), opt->getMean()));
-        sD->getMeanSourceLMs()->getPtrOutLM3()->initialize(ptrSourceOutLMCorp3, sD->getVocabs()->getPtrSourceVoc());
-        sD->getMeanSourceLMs()->getPtrOutLM3()->createLM();
-        //sD->getMeanSourceLMs()->getPtrOutLM3()->writeLM();
-        
-        boost::shared_ptr<Corpus> ptrTargetOutLMCorp3 = boost::make_shared<Corpus>(Mode::extractSample(sD->getTargetCorps()->getPtrOutCorp(), opt->getSampleSize(), opt->getMean()));
-        sD->getMeanTargetLMs()->getPtrOutLM3()->initialize(ptrTargetOutLMCorp3, sD->getVocabs()->getPtrTargetVoc());
-        sD->getMeanTargetLMs()->getPtrOutLM3()->createLM();
-        //sD->getMeanTargetLMs()->getPtrOutLM3()->writeLM();
-        
-        if (!boost::filesystem::exists(sD->getMeanSourceLMs()->getPtrOutLM2()->getFileName())) { std::cout << "Error: LM file " + sD->getMeanSourceLMs()->getPtrOutLM2()->getFileName() + " does not exists!" << std::endl; return 1; }
-        if (!boost::filesystem::exists(sD->getMeanTargetLMs()->getPtrOutLM2()->getFileName())) { std::cout << "Error: LM file " + sD->getMeanTargetLMs()->getPtrOutLM2()->getFileName() + " does not exists!" << std::endl; return 1; }
-        if (!boost::filesystem::exists(sD->getMeanSourceLMs()->getPtrOutLM3()->getFileName())) { std::cout << "Error: LM file " + sD->getMeanSourceLMs()->getPtrOutLM3()->getFileName() + " does not exists!" << std::endl; return 1; }
-        if (!boost::filesystem::exists(sD->getMeanTargetLMs()->getPtrOutLM3()->getFileName())) { std::cout << "Error: LM file " + sD->getMeanTargetLMs()->getPtrOutLM3()->getFileName() + " does not exists!" << std::endl; return 1; }
-    }
-
     // Init all Stem data if needed
     if (opt->getStem()) {
-        sD->getStemSourceCorps()->getPtrInCorp()->initialize(opt->getInSStem(), opt->getSLang());
-        sD->getStemTargetCorps()->getPtrInCorp()->initialize(opt->getInTStem(), opt->getTLang());
-        sD->getStemSourceCorps()->getPtrOutCorp()->initialize(opt->getOutSStem(), opt->getSLang());
-        sD->getStemTargetCorps()->getPtrOutCorp()->initialize(opt->getOutTStem(), opt->getTLang());
+        // The out-of-domain stems are streamed along with the surface corpora, never loaded
+        sD->getStemSourceCorps()->getPtrInCorp()->initialize(opt->getInSStem(), opt->getSLang(), true);
+        sD->getStemTargetCorps()->getPtrInCorp()->initialize(opt->getInTStem(), opt->getTLang(), true);
         
         sD->getStemVocabs()->getPtrSourceVoc()->initialize(sD->getStemSourceCorps()->getPtrInCorp());
         sD->getStemVocabs()->getPtrTargetVoc()->initialize(sD->getStemTargetCorps()->getPtrInCorp());
@@ -169,14 +165,14 @@ int BiXEntropy::launch() {
         sD->getStemTargetLMs()->getPtrInLM()->createLM();
         //sD->getStemTargetLMs()->getPtrInLM()->writeLM();
         
-        opt->setSampleSize(Mode::findSampleSize(sD->getStemSourceCorps()->getPtrInCorp(), sD->getStemSourceCorps()->getPtrOutCorp()));
-        boost::shared_ptr<Corpus> ptrOutSourceStemCorp = boost::make_shared<Corpus>(Mode::extractSample(sD->getStemSourceCorps()->getPtrOutCorp(), opt->getSampleSize(), false));
+        opt->setSampleSize(Mode::findSampleSize(sD->getStemSourceCorps()->getPtrInCorp(), sD->getSourceCorps()->getPtrOutCorp()));
+        boost::shared_ptr<Corpus> ptrOutSourceStemCorp = boost::make_shared<Corpus>(Mode::extractFactorSample(sD->getSourceCorps()->getPtrOutCorp(), opt->getOutSStem(), opt->getSLang(), opt->getSampleSize()));
         sD->getStemSourceLMs()->getPtrOutLM()->initialize(ptrOutSourceStemCorp, sD->getStemVocabs()->getPtrSourceVoc());
         sD->getStemSourceLMs()->getPtrOutLM()->createLM();
         //sD->getStemSourceLMs()->getPtrOutLM()->writeLM();
         
-        opt->setSampleSize(Mode::findSampleSize(sD->getStemTargetCorps()->getPtrInCorp(), sD->getStemTargetCorps()->getPtrOutCorp()));
-        boost::shared_ptr<Corpus> ptrOutTargetStemCorp = boost::make_shared<Corpus>(Mode::extractSample(sD->getStemTargetCorps()->getPtrOutCorp(), opt->getSampleSize(), false));
+        opt->setSampleSize(Mode::findSampleSize(sD->getStemTargetCorps()->getPtrInCorp(), sD->getTargetCorps()->getPtrOutCorp()));
+        boost::shared_ptr<Corpus> ptrOutTargetStemCorp = boost::make_shared<Corpus>(Mode::extractFactorSample(sD->getTargetCorps()->getPtrOutCorp(), opt->getOutTStem(), opt->getTLang(), opt->getSampleSize()));
         sD->getStemTargetLMs()->getPtrOutLM()->initialize(ptrOutTargetStemCorp, sD->getStemVocabs()->getPtrTargetVoc());
         sD->getStemTargetLMs()->getPtrOutLM()->createLM();
         //sD->getStemTargetLMs()->getPtrOutLM()->writeLM();
@@ -187,79 +183,110 @@ int BiXEntropy::launch() {
         if (!boost::filesystem::exists(sD->getStemTargetLMs()->getPtrOutLM()->getFileName())) { std::cout << "Error: LM file " + sD->getStemTargetLMs()->getPtrOutLM()->getFileName() + " does not exists!" << std::endl; return 1; }
     }
     
-    // Init all PPL objects
-    sD->getSourcePPLs()->getPtrInPPL()->initialize(sD->getSourceCorps()->getPtrOutCorp(), sD->getSourceLMs()->getPtrInLM());
-    sD->getSourcePPLs()->getPtrInPPL()->calcPPLCorpus();
-    sD->getSourcePPLs()->getPtrOutPPL()->initialize(sD->getSourceCorps()->getPtrOutCorp(), sD->getSourceLMs()->getPtrOutLM());
-    sD->getSourcePPLs()->getPtrOutPPL()->calcPPLCorpus();
-    sD->getTargetPPLs()->getPtrInPPL()->initialize(sD->getTargetCorps()->getPtrOutCorp(), sD->getTargetLMs()->getPtrInLM());
-    sD->getTargetPPLs()->getPtrInPPL()->calcPPLCorpus();
-    sD->getTargetPPLs()->getPtrOutPPL()->initialize(sD->getTargetCorps()->getPtrOutCorp(), sD->getTargetLMs()->getPtrOutLM());
-    sD->getTargetPPLs()->getPtrOutPPL()->calcPPLCorpus();
+    // Init score table
+    sD->getScHold()->initialize(sD->getSourceCorps()->getPtrOutCorp()->getSize());
     
-    // Same for Mean if needed
-    if (opt->getMean()) {
-        sD->getMeanSourcePPLs()->getPtrOutPPL2()->initialize(sD->getSourceCorps()->getPtrOutCorp(), sD->getMeanSourceLMs()->getPtrOutLM2());
-        sD->getMeanSourcePPLs()->getPtrOutPPL2()->calcPPLCorpus();
-        sD->getMeanSourcePPLs()->getPtrOutPPL3()->initialize(sD->getSourceCorps()->getPtrOutCorp(), sD->getMeanSourceLMs()->getPtrOutLM3());
-        sD->getMeanSourcePPLs()->getPtrOutPPL3()->calcPPLCorpus();
-        sD->getMeanTargetPPLs()->getPtrOutPPL2()->initialize(sD->getTargetCorps()->getPtrOutCorp(), sD->getMeanTargetLMs()->getPtrOutLM2());
-        sD->getMeanTargetPPLs()->getPtrOutPPL2()->calcPPLCorpus();
-        sD->getMeanTargetPPLs()->getPtrOutPPL3()->initialize(sD->getTargetCorps()->getPtrOutCorp(), sD->getMeanTargetLMs()->getPtrOutLM3());
-        sD->getMeanTargetPPLs()->getPtrOutPPL3()->calcPPLCorpus();
+    // Load the score store if needed, only new lines will be scored
+    boost::shared_ptr<ScoreStore> ptrStore;
+    if (opt->getIncremental()) {
+        ptrStore = sD->getScoreStore();
+        ptrStore->initialize(sD->getSourceCorps()->getPtrOutCorp(), sD->getTargetCorps()->getPtrOutCorp());
     }
     
-    // Same for Stem if needed
+    // Init all PPL objects
     if (opt->getStem()) {
-        sD->getStemSourcePPLs()->getPtrInPPL()->initialize(sD->getStemSourceCorps()->getPtrOutCorp(), sD->getStemSourceLMs()->getPtrInLM());
-        sD->getStemSourcePPLs()->getPtrInPPL()->calcPPLCorpus();
-        sD->getStemSourcePPLs()->getPtrOutPPL()->initialize(sD->getStemSourceCorps()->getPtrOutCorp(), sD->getStemSourceLMs()->getPtrOutLM());
-        sD->getStemSourcePPLs()->getPtrOutPPL()->calcPPLCorpus();
-        sD->getStemTargetPPLs()->getPtrInPPL()->initialize(sD->getStemTargetCorps()->getPtrOutCorp(), sD->getStemTargetLMs()->getPtrInLM());
-        sD->getStemTargetPPLs()->getPtrInPPL()->calcPPLCorpus();
-        sD->getStemTargetPPLs()->getPtrOutPPL()->initialize(sD->getStemTargetCorps()->getPtrOutCorp(), sD->getStemTargetLMs()->getPtrOutLM());
-        sD->getStemTargetPPLs()->getPtrOutPPL()->calcPPLCorpus();
+        // Surface and stem factors are scored in one pass over each corpus
+        FactoredLMs sLMs;
+        FactoredLMs tLMs;
+        sLMs.ptrInLM = sD->getSourceLMs()->getPtrInLM();
+        tLMs.ptrInLM = sD->getTargetLMs()->getPtrInLM();
+        if (opt->getMean()) {
+            for (unsigned int m = 0; m < sD->getSourceEnsemble()->getSize(); m++)
+                sLMs.outLMs.push_back(sD->getSourceEnsemble()->getLM(m));
+            for (unsigned int m = 0; m < sD->getTargetEnsemble()->getSize(); m++)
+                tLMs.outLMs.push_back(sD->getTargetEnsemble()->getLM(m));
+        }
+        else {
+            sLMs.outLMs.push_back(sD->getSourceLMs()->getPtrOutLM());
+            tLMs.outLMs.push_back(sD->getTargetLMs()->getPtrOutLM());
+        }
+        sLMs.ptrInStemLM = sD->getStemSourceLMs()->getPtrInLM();
+        sLMs.ptrOutStemLM = sD->getStemSourceLMs()->getPtrOutLM();
+        tLMs.ptrInStemLM = sD->getStemTargetLMs()->getPtrInLM();
+        tLMs.ptrOutStemLM = sD->getStemTargetLMs()->getPtrOutLM();
+        
+        sD->getFactoredSourcePPL()->initialize(sD->getSourceCorps()->getPtrOutCorp(), opt->getOutSStem(), sLMs);
+        sD->getFactoredSourcePPL()->calcXECorpus(ptrStore);
+        sD->getFactoredTargetPPL()->initialize(sD->getTargetCorps()->getPtrOutCorp(), opt->getOutTStem(), tLMs);
+        sD->getFactoredTargetPPL()->calcXECorpus(ptrStore);
+    }
+    else {
+        sD->getSourcePPLs()->getPtrInPPL()->initialize(sD->getSourceCorps()->getPtrOutCorp(), sD->getSourceLMs()->getPtrInLM());
+        sD->getSourcePPLs()->getPtrInPPL()->calcPPLCorpus(ptrStore);
+        sD->getTargetPPLs()->getPtrInPPL()->initialize(sD->getTargetCorps()->getPtrOutCorp(), sD->getTargetLMs()->getPtrInLM());
+        sD->getTargetPPLs()->getPtrInPPL()->calcPPLCorpus(ptrStore);
+        
+        // The out-of-domain LMs are scored within the ensembles for Mean
+        if (opt->getMean()) {
+            sD->getSourceEnsemble()->calcXECorpus(sD->getSourceCorps()->getPtrOutCorp(), ptrStore);
+            sD->getTargetEnsemble()->calcXECorpus(sD->getTargetCorps()->getPtrOutCorp(), ptrStore);
+        }
+        else {
+            sD->getSourcePPLs()->getPtrOutPPL()->initialize(sD->getSourceCorps()->getPtrOutCorp(), sD->getSourceLMs()->getPtrOutLM());
+            sD->getSourcePPLs()->getPtrOutPPL()->calcPPLCorpus(ptrStore);
+            sD->getTargetPPLs()->getPtrOutPPL()->initialize(sD->getTargetCorps()->getPtrOutCorp(), sD->getTargetLMs()->getPtrOutLM());
+            sD->getTargetPPLs()->getPtrOutPPL()->calcPPLCorpus(ptrStore);
+        }
     }
     
     // Init weight file if needed
-    if (opt->getWFile()->getFileName().compare("") != 0)
+    if (opt->getWFile()->getFileName().compare("") != 0) {
         sD->getWeightsFile()->initialize(opt->getWFile());
+        sD->getScHold()->setPtrScWeight(sD->getWeightsFile()->getPtrWeights());
+    }
     
     // Scores computation
-	for (unsigned int i = 0; i < sD->getSourcePPLs()->getPtrInPPL()->getSize(); i++) {
+	for (unsigned int i = 0; i < sD->getSourceCorps()->getPtrOutCorp()->getSize(); i++) {
 		double resS = 0;
 		double resT = 0;
         
-        if (opt->getMean()) {
-            resS = (sD->getSourcePPLs()->getPtrInPPL()->getXE(i) - ((sD->getSourcePPLs()->getPtrOutPPL()->getXE(i) + sD->getMeanSourcePPLs()->getPtrOutPPL2()->getXE(i) + sD->getMeanSourcePPLs()->getPtrOutPPL3()->getXE(i)) / 3));
-            resT = (sD->getTargetPPLs()->getPtrInPPL()->getXE(i) - ((sD->getTargetPPLs()->getPtrOutPPL()->getXE(i) + sD->getMeanTargetPPLs()->getPtrOutPPL2()->getXE(i) + sD->getMeanTargetPPLs()->getPtrOutPPL3()->getXE(i)) / 3));
+        if (opt->getIncremental() && sD->getScoreStore()->isKnown(i)) {
+            sD->getScHold()->getPtrScXenC()->setScore(i, sD->getScoreStore()->getRaw(i));
+            continue;
+        }
+        
+        if (opt->getStem()) {
+            resS = sD->getFactoredSourcePPL()->getXE(i);
+            resT = sD->getFactoredTargetPPL()->getXE(i);
+        }
+        else if (opt->getMean()) {
+            resS = (sD->getSourcePPLs()->getPtrInPPL()->getXE(i) - sD->getSourceEnsemble()->getXE(i));
+            resT = (sD->getTargetPPLs()->getPtrInPPL()->getXE(i) - sD->getTargetEnsemble()->getXE(i));
         }
         else {
             resS = (sD->getSourcePPLs()->getPtrInPPL()->getXE(i) - sD->getSourcePPLs()->getPtrOutPPL()->getXE(i));
             resT = (sD->getTargetPPLs()->getPtrInPPL()->getXE(i) - sD->getTargetPPLs()->getPtrOutPPL()->getXE(i));
         }
-        
-        if (opt->getStem()) {
-            resS += (sD->getStemSourcePPLs()->getPtrInPPL()->getXE(i) - sD->getStemSourcePPLs()->getPtrOutPPL()->getXE(i));
-            resT += (sD->getStemTargetPPLs()->getPtrInPPL()->getXE(i) - sD->getStemTargetPPLs()->getPtrOutPPL()->getXE(i));
-        }
 		
         double res = resS + resT;
         
-        if (opt->getWFile()->getFileName().compare("") != 0)
-            res = res * sD->getWeightsFile()->getWeight(i);
+        if (opt->getIncremental())
+            sD->getScoreStore()->setRaw(i, res);
         
-		sD->getScHold()->getPtrScores()->addScore(res);
+		sD->getScHold()->getPtrScXenC()->setScore(i, res);
 	}
     
-    // Calibration
-	sD->getScHold()->getPtrScores()->calibrate();
+    if (opt->getIncremental())
+        sD->getScoreStore()->update();
+    
+    // Weighting and calibration
+    sD->getScHold()->combine(true, false, true);
     
     if (opt->getInv()) { sD->getScHold()->getPtrScores()->inverse(); }
     
     // Result writing
     std::cout << "NB Scores: " + XenCommon::toString(sD->getScHold()->getPtrScores()->getSize()) + " NB Source corp (unclean): " + XenCommon::toString(sD->getSourceCorps()->getPtrOutCorp()->getSize()) + " NB Target corp (unclean): " + XenCommon::toString(sD->getTargetCorps()->getPtrOutCorp()->getSize()) << std::endl;
-    XenIO::cleanCorpusBi(sD->getSourceCorps()->getPtrOutCorp(), sD->getTargetCorps()->getPtrOutCorp(), sD->getScHold()->getPtrScores());
+    XenIO::cleanCorpusBi(ptrOutBitext, sD->getScHold()->getPtrScores());
     std::cout << "NB Scores: " + XenCommon::toString(sD->getScHold()->getPtrScores()->getSize()) + " NB Source corp (clean): " + XenCommon::toString(sD->getSourceCorps()->getPtrOutCorp()->getSize()) + " NB Target corp (clean): " + XenCommon::toString(sD->getTargetCorps()->getPtrOutCorp()->getSize()) << std::endl;
     XenIO::writeBiOutput(sD->getSourceCorps()->getPtrOutCorp(), sD->getTargetCorps()->getPtrOutCorp(), sD->getScHold()->getPtrScores());
     
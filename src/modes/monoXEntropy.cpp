@@ -43,8 +43,11 @@ int MonoXEntropy::launch() {
     StaticData* sD = StaticData::getInstance();
     
     // Init corpus
-    sD->getSourceCorps()->getPtrInCorp()->initialize(opt->getInSData(), opt->getSLang());
-    sD->getSourceCorps()->getPtrOutCorp()->initialize(opt->getOutSData(), opt->getSLang());
+    sD->getSourceCorps()->getPtrInCorp()->initialize(opt->getInSData(), opt->getSLang(), opt->getSVocab()->getFileName().compare("") == 0);
+    sD->getSourceCorps()->getPtrOutCorp()->initialize(opt->getOutSData(), opt->getSLang(), opt->getSVocab()->getFileName().compare("") == 0 && opt->getFullVocab(), opt->getShardIndex(), opt->getShardCount());
+    
+    // Init score table
+    sD->getScHold()->initialize(sD->getSourceCorps()->getPtrOutCorp()->getSize());
     
     // Init vocabs
     if (opt->getSVocab()->getFileName().compare("") == 0) {
@@ -75,12 +78,15 @@ int MonoXEntropy::launch() {
         }
         
         // Init out-of-domain source LM
+        boost::shared_ptr<Corpus> ptrOutLMCorp;
+        
         if (opt->getOutSLM()->getFileName().compare("") == 0) {
             opt->setSampleSize(Mode::findSampleSize(sD->getSourceCorps()->getPtrInCorp(), sD->getSourceCorps()->getPtrOutCorp()));
             
-            boost::shared_ptr<Corpus> ptrOutLMCorp = boost::make_shared<Corpus>(Mode::extractSample(sD->getSourceCorps()->getPtrOutCorp(), opt->getSampleSize(), opt->getMean()));
+            ptrOutLMCorp = boost::make_shared<Corpus>(Mode::extractSample(sD->getSourceCorps()->getPtrOutCorp(), opt->getSampleSize(), opt->getMean()));
             sD->getSourceLMs()->getPtrOutLM()->initialize(ptrOutLMCorp, sD->getVocabs()->getPtrSourceVoc());
-            sD->getSourceLMs()->getPtrOutLM()->createLM();
+            if (!opt->getMean())    // Estimated along with the other samples
+                sD->getSourceLMs()->getPtrOutLM()->createLM();
             //sD->getSourceLMs()->getPtrOutLM()->writeLM();
         }
         else {
@@ -88,6 +94,16 @@ int MonoXEntropy::launch() {
             sD->getSourceLMs()->getPtrOutLM()->loadLM();
         }
         
+        // Init Mean LMs if needed
+        if (opt->getMean()) {
+            int sSize = Mode::findSampleSize(sD->getSourceCorps()->getPtrInCorp(), sD->getSourceCorps()->getPtrOutCorp());
+            
+            sD->getSourceEnsemble()->initialize(sD->getSourceLMs()->getPtrOutLM(), ptrOutLMCorp);
+            for (int k = 1; k < opt->getMeanK(); k++)
+                sD->getSourceEnsemble()->addMember(boost::make_shared<Corpus>(Mode::extractSample(sD->getSourceCorps()->getPtrOutCorp(), sSize, true)), sD->getVocabs()->getPtrSourceVoc());
+            sD->getSourceEnsemble()->createLMs();
+        }
+        
         // Check for LM estimation OK
         if (!boost::filesystem::exists(sD->getSourceLMs()->getPtrInLM()->getFileName())) {
             std::cout << "Error: LM file " + sD->getSourceLMs()->getPtrInLM()->getFileName() + " does not exists!" << std::endl;
@@ -99,32 +115,10 @@ int MonoXEntropy::launch() {
             return 1;
         }
         
-        // Init Mean LMs if needed
-        if (opt->getMean()) {
-            boost::shared_ptr<Corpus> ptrOutLMCorp2 = boost::make_shared<Corpus>(Mode::extractSample(sD->getSourceCorps()->getPtrOutCorp(), opt->getSampleSize(), opt->getMean()));
-            sD->getMeanSourceLMs()->getPtrOutLM2()->initialize(ptrOutLMCorp2, sD->getVocabs()->getPtrSourceVoc());
-            sD->getMeanSourceLMs()->getPtrOutLM2()->createLM();
-            //sD->getMeanSourceLMs()->getPtrOutLM2()->writeLM();
-            
-            boost::shared_ptr<Corpus> ptrOutLMCorp3 = boost::make_shared<Corpus>(Mode::extractSample(sD->getSourceCorps()->getPtrOutCorp(), opt->getSampleSize(), opt->getMean()));
-            sD->getMeanSourceLMs()->getPtrOutLM3()->initialize(ptrOutLMCorp3, sD->getVocabs()->getPtrSourceVoc());
-            sD->getMeanSourceLMs()->getPtrOutLM3()->createLM();
-            //sD->getMeanSourceLMs()->getPtrOutLM3()->writeLM();
-            
-            if (!boost::filesystem::exists(sD->getMeanSourceLMs()->getPtrOutLM2()->getFileName())) {
-                std::cout << "Error: LM file " + sD->getMeanSourceLMs()->getPtrOutLM2()->getFileName() + " does not exists!" << std::endl;
-                return 1;
-            }
-            if (!boost::filesystem::exists(sD->getMeanSourceLMs()->getPtrOutLM3()->getFileName())) {
-                std::cout << "Error: LM file " + sD->getMeanSourceLMs()->getPtrOutLM3()->getFileName() + " does not exists!" << std::endl;
-                return 1;
-            }
-        }
-
         // Init all Stem data if needed
         if (opt->getStem()) {
-            sD->getStemSourceCorps()->getPtrInCorp()->initialize(opt->getInSStem(), opt->getSLang());
-            sD->getStemSourceCorps()->getPtrOutCorp()->initialize(opt->getOutSStem(), opt->getSLang());
+            // The out-of-domain stems are streamed along with the surface corpus, never loaded
+            sD->getStemSourceCorps()->getPtrInCorp()->initialize(opt->getInSStem(), opt->getSLang(), true);
             
             sD->getStemVocabs()->getPtrSourceVoc()->initialize(sD->getStemSourceCorps()->getPtrInCorp());
             
@@ -132,8 +126,8 @@ int MonoXEntropy::launch() {
             sD->getStemSourceLMs()->getPtrInLM()->createLM();
             //sD->getStemSourceLMs()->getPtrInLM()->writeLM();
             
-            opt->setSampleSize(Mode::findSampleSize(sD->getStemSourceCorps()->getPtrInCorp(), sD->getStemSourceCorps()->getPtrOutCorp()));
-            boost::shared_ptr<Corpus> ptrOutSourceStemCorp = boost::make_shared<Corpus>(Mode::extractSample(sD->getStemSourceCorps()->getPtrOutCorp(), opt->getSampleSize(), false));
+            opt->setSampleSize(Mode::findSampleSize(sD->getStemSourceCorps()->getPtrInCorp(), sD->getSourceCorps()->getPtrOutCorp()));
+            boost::shared_ptr<Corpus> ptrOutSourceStemCorp = boost::make_shared<Corpus>(Mode::extractFactorSample(sD->getSourceCorps()->getPtrOutCorp(), opt->getOutSStem(), opt->getSLang(), opt->getSampleSize()));
             sD->getStemSourceLMs()->getPtrOutLM()->initialize(ptrOutSourceStemCorp, sD->getStemVocabs()->getPtrSourceVoc());
             sD->getStemSourceLMs()->getPtrOutLM()->createLM();
             //sD->getStemSourceLMs()->getPtrOutLM()->writeLM();
@@ -142,56 +136,78 @@ int MonoXEntropy::launch() {
             if (!boost::filesystem::exists(sD->getStemSourceLMs()->getPtrOutLM()->getFileName())) { std::cout << "Error: LM file " + sD->getStemSourceLMs()->getPtrOutLM()->getFileName() + " does not exists!" << std::endl; return 1; }
         }
         
-        // Init all PPL objects
-        sD->getSourcePPLs()->getPtrInPPL()->initialize(sD->getSourceCorps()->getPtrOutCorp(), sD->getSourceLMs()->getPtrInLM());
-        sD->getSourcePPLs()->getPtrInPPL()->calcPPLCorpus();
-        sD->getSourcePPLs()->getPtrOutPPL()->initialize(sD->getSourceCorps()->getPtrOutCorp(), sD->getSourceLMs()->getPtrOutLM());
-        sD->getSourcePPLs()->getPtrOutPPL()->calcPPLCorpus();
-        
-        // Same for Mean if needed
-        if (opt->getMean()) {
-            sD->getMeanSourcePPLs()->getPtrOutPPL2()->initialize(sD->getSourceCorps()->getPtrOutCorp(), sD->getMeanSourceLMs()->getPtrOutLM2());
-            sD->getMeanSourcePPLs()->getPtrOutPPL2()->calcPPLCorpus();
-            sD->getMeanSourcePPLs()->getPtrOutPPL3()->initialize(sD->getSourceCorps()->getPtrOutCorp(), sD->getMeanSourceLMs()->getPtrOutLM3());
-            sD->getMeanSourcePPLs()->getPtrOutPPL3()->calcPPLCorpus();
+        // Load the score store if needed, only new lines will be scored
+        boost::shared_ptr<ScoreStore> ptrStore;
+        if (opt->getIncremental()) {
+            ptrStore = sD->getScoreStore();
+            ptrStore->initialize(sD->getSourceCorps()->getPtrOutCorp(), boost::shared_ptr<Corpus>());
         }
         
-        // Same for Stem if needed
+        // Init all PPL objects
         if (opt->getStem()) {
-            sD->getStemSourcePPLs()->getPtrInPPL()->initialize(sD->getStemSourceCorps()->getPtrOutCorp(), sD->getStemSourceLMs()->getPtrInLM());
-            sD->getStemSourcePPLs()->getPtrInPPL()->calcPPLCorpus();
-            sD->getStemSourcePPLs()->getPtrOutPPL()->initialize(sD->getStemSourceCorps()->getPtrOutCorp(), sD->getStemSourceLMs()->getPtrOutLM());
-            sD->getStemSourcePPLs()->getPtrOutPPL()->calcPPLCorpus();
+            // Surface and stem factors are scored in one pass over the corpus
+            FactoredLMs lms;
+            lms.ptrInLM = sD->getSourceLMs()->getPtrInLM();
+            if (opt->getMean())
+                for (unsigned int m = 0; m < sD->getSourceEnsemble()->getSize(); m++)
+                    lms.outLMs.push_back(sD->getSourceEnsemble()->getLM(m));
+            else
+                lms.outLMs.push_back(sD->getSourceLMs()->getPtrOutLM());
+            lms.ptrInStemLM = sD->getStemSourceLMs()->getPtrInLM();
+            lms.ptrOutStemLM = sD->getStemSourceLMs()->getPtrOutLM();
+            
+            sD->getFactoredSourcePPL()->initialize(sD->getSourceCorps()->getPtrOutCorp(), opt->getOutSStem(), lms);
+            sD->getFactoredSourcePPL()->calcXECorpus(ptrStore);
+        }
+        else {
+            sD->getSourcePPLs()->getPtrInPPL()->initialize(sD->getSourceCorps()->getPtrOutCorp(), sD->getSourceLMs()->getPtrInLM());
+            sD->getSourcePPLs()->getPtrInPPL()->calcPPLCorpus(ptrStore);
+            
+            // The out-of-domain LM is scored within the ensemble for Mean
+            if (opt->getMean())
+                sD->getSourceEnsemble()->calcXECorpus(sD->getSourceCorps()->getPtrOutCorp(), ptrStore);
+            else {
+                sD->getSourcePPLs()->getPtrOutPPL()->initialize(sD->getSourceCorps()->getPtrOutCorp(), sD->getSourceLMs()->getPtrOutLM());
+                sD->getSourcePPLs()->getPtrOutPPL()->calcPPLCorpus(ptrStore);
+            }
         }
         
         // Init weight file if needed
-        if (opt->getWFile()->getFileName().compare("") != 0)
+        if (opt->getWFile()->getFileName().compare("") != 0) {
             sD->getWeightsFile()->initialize(opt->getWFile());
+            sD->getScHold()->setPtrScWeight(sD->getWeightsFile()->getPtrWeights());
+        }
         
         // Scores computation
-        for (unsigned int i = 0; i < sD->getSourcePPLs()->getPtrInPPL()->getSize(); i++) {
+        for (unsigned int i = 0; i < sD->getSourceCorps()->getPtrOutCorp()->getSize(); i++) {
             double res = 0;
             
-            if (opt->getMean())
-                res = (sD->getSourcePPLs()->getPtrInPPL()->getXE(i) - ((sD->getSourcePPLs()->getPtrOutPPL()->getXE(i) + sD->getMeanSourcePPLs()->getPtrOutPPL2()->getXE(i) + sD->getMeanSourcePPLs()->getPtrOutPPL3()->getXE(i)) / 3));
+            if (opt->getIncremental() && sD->getScoreStore()->isKnown(i)) {
+                sD->getScHold()->getPtrScXenC()->setScore(i, sD->getScoreStore()->getRaw(i));
+                continue;
+            }
+            
+            if (opt->getStem())
+                res = sD->getFactoredSourcePPL()->getXE(i);
+            else if (opt->getMean())
+                res = (sD->getSourcePPLs()->getPtrInPPL()->getXE(i) - sD->getSourceEnsemble()->getXE(i));
             else
                 res = (sD->getSourcePPLs()->getPtrInPPL()->getXE(i) - sD->getSourcePPLs()->getPtrOutPPL()->getXE(i));
             
-            if (opt->getStem()) {
-                res += (sD->getStemSourcePPLs()->getPtrInPPL()->getXE(i) - sD->getStemSourcePPLs()->getPtrOutPPL()->getXE(i));
-            }
-            
-            if (opt->getWFile()->getFileName().compare("") != 0)
-                res = res * sD->getWeightsFile()->getWeight(i);
+            if (opt->getIncremental())
+                sD->getScoreStore()->setRaw(i, res);
             
-            sD->getScHold()->getPtrScXenC()->addScore(res);
+            sD->getScHold()->getPtrScXenC()->setScore(i, res);
         }
+        
+        if (opt->getIncremental())
+            sD->getScoreStore()->update();
     }
     
     // Fill score holder for similarity if needed
     if (opt->getSim() || opt->getSimOnly()) {
         for (unsigned int i = 0; i < sD->getSim()->getSize(); i++)
-            sD->getScHold()->getPtrScSimil()->addScore(sD->getSim()->getSim(i));
+            sD->getScHold()->getPtrScSimil()->setScore(i, sD->getSim()->getSim(i));
         
         sD->getScHold()->getPtrScSimil()->inverse();
     }
@@ -200,26 +216,18 @@ int MonoXEntropy::launch() {
     if (opt->getSimOnly()) { // Similarity alone (calibrate or not??? NEEDS TESTING)
         std::cout << "Scoring with similarity only." << std::endl;
         
-        for (unsigned int i = 0; i < sD->getScHold()->getPtrScSimil()->getSize(); i++)
-            sD->getScHold()->getPtrScores()->addScore(sD->getScHold()->getPtrScSimil()->getScore(i));
+        sD->getScHold()->combine(false, true, false);
     }
     else if (opt->getSim()) { // Cross-entropy and similarity combination
         std::cout << "Scoring with cross-entropy and similarity combination." << std::endl;
         
-        sD->getScHold()->getPtrScXenC()->calibrate(); // Needed for combination? Not sure... More tests needed
-        
-        for (unsigned int i = 0; i < sD->getScHold()->getPtrScXenC()->getSize(); i++)
-            sD->getScHold()->getPtrScores()->addScore(sD->getScHold()->getPtrScXenC()->getScore(i) + sD->getScHold()->getPtrScSimil()->getScore(i));
-        
-        sD->getScHold()->getPtrScores()->calibrate();
+        // Cross-entropy calibrated before the addition: needed for combination? Not sure... More tests needed
+        sD->getScHold()->combine(true, true, true);
     }
     else { // Cross-entropy alone
         std::cout << "Scoring with cross-entropy only." << std::endl;
         
-        for (unsigned int i = 0; i < sD->getScHold()->getPtrScXenC()->getSize(); i++)
-            sD->getScHold()->getPtrScores()->addScore(sD->getScHold()->getPtrScXenC()->getScore(i));
-        
-        sD->getScHold()->getPtrScores()->calibrate();
+        sD->getScHold()->combine(true, false, true);
     }
     
     if (opt->getInv()) { sD->getScHold()->getPtrScores()->inverse(); }
@@ -232,12 +240,12 @@ int MonoXEntropy::launch() {
         XenIO::writeMonoOutput(sD->getSourceCorps()->getPtrOutCorp(), sD->getScHold()->getPtrScores());
     }
 	else {
-        boost::shared_ptr<Corpus> ptrOTCorp = boost::make_shared<Corpus>();
-        ptrOTCorp->initialize(opt->getOutTData(), opt->getTLang());
-        std::cout << "NB Scores: " + XenCommon::toString(sD->getScHold()->getPtrScores()->getSize()) + " NB Source corp (unclean): " + XenCommon::toString(sD->getSourceCorps()->getPtrOutCorp()->getSize()) + " NB Target corp (unclean): " + XenCommon::toString(ptrOTCorp->getSize()) << std::endl;
-        XenIO::cleanCorpusBi(sD->getSourceCorps()->getPtrOutCorp(), ptrOTCorp, sD->getScHold()->getPtrScores());
-        std::cout << "NB Scores: " + XenCommon::toString(sD->getScHold()->getPtrScores()->getSize()) + " NB Source corp (clean): " + XenCommon::toString(sD->getSourceCorps()->getPtrOutCorp()->getSize()) + " NB Target corp (clean): " + XenCommon::toString(ptrOTCorp->getSize()) << std::endl;
-        XenIO::writeBiOutput(sD->getSourceCorps()->getPtrOutCorp(), ptrOTCorp, sD->getScHold()->getPtrScores());
+        boost::shared_ptr<Bitext> ptrOutBitext = boost::make_shared<Bitext>();
+        ptrOutBitext->initialize(sD->getSourceCorps()->getPtrOutCorp(), opt->getOutTData(), opt->getTLang());
+        std::cout << "NB Scores: " + XenCommon::toString(sD->getScHold()->getPtrScores()->getSize()) + " NB Source corp (unclean): " + XenCommon::toString(ptrOutBitext->getPtrSource()->getSize()) + " NB Target corp (unclean): " + XenCommon::toString(ptrOutBitext->getPtrTarget()->getSize()) << std::endl;
+        XenIO::cleanCorpusBi(ptrOutBitext, sD->getScHold()->getPtrScores());
+        std::cout << "NB Scores: " + XenCommon::toString(sD->getScHold()->getPtrScores()->getSize()) + " NB Source corp (clean): " + XenCommon::toString(ptrOutBitext->getPtrSource()->getSize()) + " NB Target corp (clean): " + XenCommon::toString(ptrOutBitext->getPtrTarget()->getSize()) << std::endl;
+        XenIO::writeBiOutput(ptrOutBitext->getPtrSource(), ptrOutBitext->getPtrTarget(), sD->getScHold()->getPtrScores());
 	}
 
 	return 0;
@@ -29,6 +29,30 @@
  */
 
 #include "../../include/modes/ptScoring.h"
+#include "../../include/utils/scheduler.h"
+
+/**
+ *  @fn static void taskPTDiffs (boost::shared_ptr<Score> ptrXenC, boost::shared_ptr<Score> ptrLocal, unsigned int first, unsigned int last)
+ *  @brief Sets the source plus target cross-entropy differences of a range of phrase pairs
+ *
+ *  @param ptrXenC :    the pre-sized global cross-entropy column
+ *  @param ptrLocal :   the pre-sized local scores column, null without --local
+ *  @param first :      the first phrase pair of the range
+ *  @param last :       the phrase pair after the range
+ */
+static void taskPTDiffs(boost::shared_ptr<Score> ptrXenC, boost::shared_ptr<Score> ptrLocal, unsigned int first, unsigned int last) {
+    StaticData* sD = StaticData::getInstance();
+    
+    for (unsigned int i = first; i < last; i++) {
+        double resS = (sD->getSourcePPLs()->getPtrInPPL()->getXE(i) - sD->getSourcePPLs()->getPtrOutPPL()->getXE(i));
+        double resT = (sD->getTargetPPLs()->getPtrInPPL()->getXE(i) - sD->getTargetPPLs()->getPtrOutPPL()->getXE(i));
+        double res = resS + resT;
+        
+        ptrXenC->setScore(i, res);
+        if (ptrLocal)
+            ptrLocal->setScore(i, res);
+    }
+}
 
 PTScoring::PTScoring() {
     
@@ -87,54 +111,38 @@ int PTScoring::launch() {
     //---- Global scores ----
     std::cout << "Computing global scores." << std::endl;
     
-    if (opt->getWFile()->getFileName().compare("") != 0)
+    if (opt->getWFile()->getFileName().compare("") != 0) {
         sD->getWeightsFile()->initialize(opt->getWFile());
+        sD->getScHold()->setPtrScWeight(sD->getWeightsFile()->getPtrWeights());
+    }
     
-    for (unsigned int i = 0; i < sD->getSourcePPLs()->getPtrInPPL()->getSize(); i++) {
-		double resS = (sD->getSourcePPLs()->getPtrInPPL()->getXE(i) - sD->getSourcePPLs()->getPtrOutPPL()->getXE(i));
-		double resT = (sD->getTargetPPLs()->getPtrInPPL()->getXE(i) - sD->getTargetPPLs()->getPtrOutPPL()->getXE(i));
-		double res = resS + resT;
-        
-        if (opt->getWFile()->getFileName().compare("") != 0)
-            res = res * sD->getWeightsFile()->getWeight(i);
-        
-		sD->getScHold()->getPtrScores()->addScore(res);
-	}
+    unsigned int size = sD->getSourcePPLs()->getPtrInPPL()->getSize();
+    
+    sD->getScHold()->initialize(size);
+    
+    // Local scores start from the same cross-entropy differences, filled in the same sweep
+    boost::shared_ptr<Score> ptrLocal;
+    if (opt->getLocal()) {
+        ptrLocal = boost::make_shared<Score>();
+        ptrLocal->resize(size, 0);
+    }
+    
+    Scheduler::parallelFor(0, size, Score::grain, boost::bind(&taskPTDiffs, sD->getScHold()->getPtrScXenC(), ptrLocal, _1, _2));
     
-	sD->getScHold()->getPtrScores()->calibrate();
+    sD->getScHold()->combine(true, false, true);
     sD->getScHold()->getPtrScores()->inverse();
     //-----------------------
     
     if (opt->getLocal()) {
         //---- Local scores ----
         std::cout << "Computing local scores." << std::endl;
-        std::vector<SourcePhrase> srcPh = sD->getPTPairs()->getPtrOutPT()->getSrcPhrases();
         
-        int offset = 0;
+        int stage = sD->getRunStats()->startStage("score:local");
         
-        for (unsigned int i = 0; i < srcPh.size(); i++) {
-            SourcePhrase sP = srcPh[i];
-            
-            if (sP.getTargetSize() == 1) {
-                sP.getScoresXE()->addScore((double)0);
-            }
-            else {
-                for (unsigned int j = 0; j < sP.getTargetSize(); j++) {
-                    double resS = (sD->getSourcePPLs()->getPtrInPPL()->getXE(j + offset) - sD->getSourcePPLs()->getPtrOutPPL()->getXE(j + offset));
-                    double resT = (sD->getTargetPPLs()->getPtrInPPL()->getXE(j + offset) - sD->getTargetPPLs()->getPtrOutPPL()->getXE(j + offset));
-                    double res = resS + resT;
-                    sP.getScoresXE()->addScore(res);
-                }
-            }
-            
-            offset += sP.getTargetSize();
-            if (sP.getTargetSize() > 1)
-                sP.getScoresXE()->calibrate();
-            sP.getScoresXE()->inverse();
-            srcPh[i] = sP;
-        }
+        ptrLocal->calibrateGroups(sD->getPTPairs()->getPtrOutPT()->getGroupStarts());
+        ptrLocal->inverse();
         
-        sD->getPTPairs()->getPtrOutPT()->setSrcPhrases(srcPh);
+        sD->getRunStats()->endStage(stage, size, 0);
         //----------------------
     }
     
@@ -145,7 +153,7 @@ int PTScoring::launch() {
         return 1;
     }
     
-    XenIO::writeNewPT(sD->getPTPairs()->getPtrOutPT(), sD->getScHold()->getPtrScores());
+    XenIO::writeNewPT(sD->getPTPairs()->getPtrOutPT(), sD->getScHold()->getPtrScores(), ptrLocal);
     
     return 0;
 }
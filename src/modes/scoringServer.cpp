@@ -0,0 +1,312 @@
+/**
+ *  @file scoringServer.cpp
+ *  @brief Derived class to handle the long-running scoring server
+ *  @author Anthony Rousseau
+ *  @version 2.0.0
+ *  @date 19 October 2026
+ */
+
+/*  This file is part of the cross-entropy tool for data selection (XenC)
+ *  aimed at speech recognition and statistical machine translation.
+ *
+ *  Copyright 2013-2016, Anthony Rousseau, LIUM, University of Le Mans, France
+ *
+ *  Development of the XenC tool has been partially funded by the
+ *  European Commission under the MateCat project.
+ *
+ *  The XenC tool is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation
+ *
+ *  This library is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "../../include/modes/scoringServer.h"
+
+#include <boost/iostreams/device/file_descriptor.hpp>
+#include <boost/iostreams/stream.hpp>
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+ScoringServer::ScoringServer(std::streambuf* out) : outBuf(out) {
+
+}
+
+ScoringServer::~ScoringServer() {
+
+}
+
+int ScoringServer::launch() {
+    XenOption* opt = XenOption::getInstance();
+
+    if (opt->getMean() || opt->getStem() || opt->getSim() || opt->getSimOnly() || opt->getWFile()->getFileName().compare("") != 0)
+        std::cout << "Server mode ignores mean, stem, similarity and weights options." << std::endl;
+
+    prepareSide(true);
+    if (opt->getMode() == 3)
+        prepareSide(false);
+
+    std::cout << "Language models are resident, server ready." << std::endl;
+
+    if (opt->getSocket().compare("") == 0) {
+        std::ostream out(outBuf);
+        serve(std::cin, out);
+    }
+    else {
+        serveSocket(opt->getSocket());
+    }
+
+    std::cout << "Server stopped." << std::endl;
+
+    return 0;
+}
+
+void ScoringServer::prepareSide(bool source) {
+    XenOption* opt = XenOption::getInstance();
+    StaticData* sD = StaticData::getInstance();
+
+    boost::shared_ptr<CorpusPair> ptrCorps = source ? sD->getSourceCorps() : sD->getTargetCorps();
+    boost::shared_ptr<LMPair> ptrLMs = source ? sD->getSourceLMs() : sD->getTargetLMs();
+    boost::shared_ptr<XenVocab> ptrVoc = source ? sD->getVocabs()->getPtrSourceVoc() : sD->getVocabs()->getPtrTargetVoc();
+    boost::shared_ptr<XenFile> ptrInData = source ? opt->getInSData() : opt->getInTData();
+    boost::shared_ptr<XenFile> ptrOutData = source ? opt->getOutSData() : opt->getOutTData();
+    boost::shared_ptr<XenFile> ptrVocFile = source ? opt->getSVocab() : opt->getTVocab();
+    boost::shared_ptr<XenFile> ptrInLMFile = source ? opt->getInSLM() : opt->getInTLM();
+    boost::shared_ptr<XenFile> ptrOutLMFile = source ? opt->getOutSLM() : opt->getOutTLM();
+    std::string lang = source ? opt->getSLang() : opt->getTLang();
+
+    bool needOut = (opt->getMode() != 1);
+    bool estimateIn = (ptrInLMFile->getFileName().compare("") == 0);
+    bool estimateOut = needOut && (ptrOutLMFile->getFileName().compare("") == 0);
+
+    if (estimateIn || estimateOut) {
+        bool countWords = (ptrVocFile->getFileName().compare("") == 0);
+
+        ptrCorps->getPtrInCorp()->initialize(ptrInData, lang, countWords);
+        if (estimateOut || opt->getFullVocab())
+            ptrCorps->getPtrOutCorp()->initialize(ptrOutData, lang, countWords && opt->getFullVocab());
+
+        if (ptrVocFile->getFileName().compare("") == 0) {
+            if (opt->getFullVocab())
+                ptrVoc->initialize(ptrCorps->getPtrInCorp(), ptrCorps->getPtrOutCorp());
+            else
+                ptrVoc->initialize(ptrCorps->getPtrInCorp());
+        }
+        else
+            ptrVoc->initialize(ptrVocFile);
+    }
+
+    prepareLM(ptrLMs->getPtrInLM(), ptrInLMFile, ptrCorps->getPtrInCorp(), ptrVoc);
+
+    if (needOut) {
+        boost::shared_ptr<Corpus> ptrOutLMCorp = boost::make_shared<Corpus>();
+
+        if (estimateOut) {
+            opt->setSampleSize(Mode::findSampleSize(ptrCorps->getPtrInCorp(), ptrCorps->getPtrOutCorp()));
+            ptrOutLMCorp = boost::make_shared<Corpus>(Mode::extractSample(ptrCorps->getPtrOutCorp(), opt->getSampleSize(), false));
+        }
+
+        prepareLM(ptrLMs->getPtrOutLM(), ptrOutLMFile, ptrOutLMCorp, ptrVoc);
+    }
+}
+
+void ScoringServer::prepareLM(boost::shared_ptr<XenLMken> ptrLM, boost::shared_ptr<XenFile> ptrLMFile, boost::shared_ptr<Corpus> ptrCorp, boost::shared_ptr<XenVocab> ptrVoc) {
+    if (ptrLMFile->getFileName().compare("") == 0) {
+        ptrLM->initialize(ptrCorp, ptrVoc);
+        ptrLM->createLM();
+    }
+    else {
+        ptrLM->initialize(ptrLMFile, ptrVoc);
+    }
+
+    if (!boost::filesystem::exists(ptrLM->getFileName()))
+        throw XenCommon::XenCEption("Error: LM file " + ptrLM->getFileName() + " does not exists!");
+
+    std::cout << "Loading resident LM " << ptrLM->getFileName() << std::endl;
+    ptrLM->loadLM();
+}
+
+void ScoringServer::serve(std::istream &in, std::ostream &out) {
+    XenOption* opt = XenOption::getInstance();
+
+    std::vector<std::string> batch;
+    std::string line;
+
+    out.setf(std::ios::fixed | std::ios::showpoint);
+    out.precision(15);
+
+    while (std::getline(in, line)) {
+        if (line.compare("") == 0) {
+            scoreBatch(batch, out);
+            out << std::endl;
+            continue;
+        }
+
+        batch.push_back(line);
+
+        if (batch.size() >= (unsigned int)opt->getBatchSize())
+            scoreBatch(batch, out);
+    }
+
+    scoreBatch(batch, out);
+}
+
+void ScoringServer::scoreBatch(std::vector<std::string> &batch, std::ostream &out) {
+    if (batch.empty())
+        return;
+
+    XenOption* opt = XenOption::getInstance();
+    StaticData* sD = StaticData::getInstance();
+
+    unsigned int size = (unsigned int)batch.size();
+    boost::shared_ptr<std::vector<double> > ptrInS = boost::make_shared<std::vector<double> >(size, 0.0);
+    boost::shared_ptr<std::vector<double> > ptrOutS = boost::make_shared<std::vector<double> >(size, 0.0);
+    boost::shared_ptr<std::vector<double> > ptrInT = boost::make_shared<std::vector<double> >(size, 0.0);
+    boost::shared_ptr<std::vector<double> > ptrOutT = boost::make_shared<std::vector<double> >(size, 0.0);
+    std::vector<bool> rejected(size, false);
+
+    unsigned int chunk = (size + opt->getThreads() - 1) / opt->getThreads();
+
+    TaskGroup scoring;
+
+    // Each task queries its lines in lockstep
+    for (unsigned int first = 0; first < size; first += chunk) {
+        boost::shared_ptr<std::vector<int> > ptrLines = boost::make_shared<std::vector<int> >();
+        boost::shared_ptr<std::vector<std::string> > ptrSrc = boost::make_shared<std::vector<std::string> >();
+        boost::shared_ptr<std::vector<std::string> > ptrTrg = boost::make_shared<std::vector<std::string> >();
+
+        for (unsigned int i = first; i < size && i < first + chunk; i++) {
+            std::string src = batch[i];
+            std::string trg = "";
+
+            if (opt->getMode() == 3) {
+                std::string::size_type tab = batch[i].find('\t');
+
+                // A line without its target sentence is not a pair, it is not scored
+                if (tab == std::string::npos) {
+                    rejected[i] = true;
+                    continue;
+                }
+
+                src = batch[i].substr(0, tab);
+                trg = batch[i].substr(tab + 1);
+            }
+
+            ptrLines->push_back(i);
+            ptrSrc->push_back(src);
+            ptrTrg->push_back(trg);
+        }
+
+        if (opt->getMode() == 3) {
+            scoring.run(boost::bind(taskCalcPPLBatch, ptrLines, ptrTrg, ptrInT, sD->getTargetLMs()->getPtrInLM()));
+            scoring.run(boost::bind(taskCalcPPLBatch, ptrLines, ptrTrg, ptrOutT, sD->getTargetLMs()->getPtrOutLM()));
+        }
+
+        scoring.run(boost::bind(taskCalcPPLBatch, ptrLines, ptrSrc, ptrInS, sD->getSourceLMs()->getPtrInLM()));
+        if (opt->getMode() != 1)
+            scoring.run(boost::bind(taskCalcPPLBatch, ptrLines, ptrSrc, ptrOutS, sD->getSourceLMs()->getPtrOutLM()));
+    }
+
+    scoring.wait();
+
+    unsigned int errors = 0;
+
+    for (unsigned int i = 0; i < size; i++) {
+        if (rejected[i]) {
+            out << "ERROR: no tab-separated target sentence" << '\n';
+            errors++;
+            continue;
+        }
+
+        double res = 0;
+
+        if (opt->getMode() == 1)
+            res = ptrInS->operator[](i);
+        else
+            res = PPL::crossEntropy(ptrInS->operator[](i)) - PPL::crossEntropy(ptrOutS->operator[](i));
+
+        if (opt->getMode() == 3)
+            res += PPL::crossEntropy(ptrInT->operator[](i)) - PPL::crossEntropy(ptrOutT->operator[](i));
+
+        out << XenCommon::toString(res) << '\n';
+    }
+
+    out.flush();
+
+    if (out.bad())
+        throw XenCommon::XenCEption("Something went wrong in output stream...");
+
+    if (errors > 0)
+        std::cerr << "Rejected " << errors << " lines without a target sentence." << std::endl;
+
+    std::cout << "Scored a batch of " << size - errors << " lines." << std::endl;
+
+    batch.clear();
+}
+
+void ScoringServer::serveSocket(std::string path) {
+    struct sockaddr_un addr;
+
+    if (path.length() >= sizeof(addr.sun_path))
+        throw XenCommon::XenCEption("Socket path " + path + " is too long.");
+
+    std::signal(SIGPIPE, SIG_IGN);
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        throw XenCommon::XenCEption("Can't create socket " + path + ": " + std::strerror(errno));
+
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+    ::unlink(path.c_str());
+
+    if (::bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || ::listen(fd, 16) < 0) {
+        std::string err = std::strerror(errno);
+        ::close(fd);
+        throw XenCommon::XenCEption("Can't listen on socket " + path + ": " + err);
+    }
+
+    std::cout << "Listening on socket " << path << std::endl;
+
+    for ( ; ; ) {
+        int client = ::accept(fd, NULL, NULL);
+
+        if (client < 0) {
+            if (errno == EINTR)
+                continue;
+            std::string err = std::strerror(errno);
+            ::close(fd);
+            throw XenCommon::XenCEption("Error while accepting on socket " + path + ": " + err);
+        }
+
+        std::cout << "Client connected." << std::endl;
+
+        try {
+            boost::iostreams::stream<boost::iostreams::file_descriptor_source> in(client, boost::iostreams::never_close_handle);
+            boost::iostreams::stream<boost::iostreams::file_descriptor_sink> out(client, boost::iostreams::never_close_handle);
+            serve(in, out);
+        } catch (XenCommon::XenCEption &e) {
+            std::cerr << e.what() << std::endl;
+        } catch (std::ios_base::failure &e) {
+            std::cerr << e.what() << std::endl;
+        }
+
+        ::close(client);
+
+        std::cout << "Client disconnected." << std::endl;
+    }
+}
@@ -42,8 +42,8 @@ int SimplePPL::launch() {
     XenOption* opt = XenOption::getInstance();
     StaticData* sD = StaticData::getInstance();
     
-    sD->getSourceCorps()->getPtrInCorp()->initialize(opt->getInSData(), opt->getSLang());
-    sD->getSourceCorps()->getPtrOutCorp()->initialize(opt->getOutSData(), opt->getSLang());
+    sD->getSourceCorps()->getPtrInCorp()->initialize(opt->getInSData(), opt->getSLang(), opt->getSVocab()->getFileName().compare("") == 0);
+    sD->getSourceCorps()->getPtrOutCorp()->initialize(opt->getOutSData(), opt->getSLang(), opt->getSVocab()->getFileName().compare("") == 0 && opt->getFullVocab(), opt->getShardIndex(), opt->getShardCount());
     
     if (opt->getSVocab()->getFileName().compare("") == 0) {
         if (opt->getFullVocab())
@@ -69,22 +69,40 @@ int SimplePPL::launch() {
         return 1;
     }
     
+    sD->getScHold()->initialize(sD->getSourceCorps()->getPtrOutCorp()->getSize());
+    
+    boost::shared_ptr<ScoreStore> ptrStore;
+    if (opt->getIncremental()) {
+        ptrStore = sD->getScoreStore();
+        ptrStore->initialize(sD->getSourceCorps()->getPtrOutCorp(), boost::shared_ptr<Corpus>());
+    }
+    
     sD->getSourcePPLs()->getPtrInPPL()->initialize(sD->getSourceCorps()->getPtrOutCorp(), sD->getSourceLMs()->getPtrInLM());
-    sD->getSourcePPLs()->getPtrInPPL()->calcPPLCorpus();
+    sD->getSourcePPLs()->getPtrInPPL()->calcPPLCorpus(ptrStore);
     
-    if (opt->getWFile()->getFileName().compare("") != 0)
+    if (opt->getWFile()->getFileName().compare("") != 0) {
         sD->getWeightsFile()->initialize(opt->getWFile());
+        sD->getScHold()->setPtrScWeight(sD->getWeightsFile()->getPtrWeights());
+    }
     
     for (unsigned int i = 0; i < sD->getSourcePPLs()->getPtrInPPL()->getSize(); i++) {
+        if (opt->getIncremental() && sD->getScoreStore()->isKnown(i)) {
+            sD->getScHold()->getPtrScXenC()->setScore(i, sD->getScoreStore()->getRaw(i));
+            continue;
+        }
+        
         double res = sD->getSourcePPLs()->getPtrInPPL()->getPPL(i);
         
-        if (opt->getWFile()->getFileName().compare("") != 0)
-            res = res * sD->getWeightsFile()->getWeight(i);
+        if (opt->getIncremental())
+            sD->getScoreStore()->setRaw(i, res);
         
-        sD->getScHold()->getPtrScores()->addScore(res);
+        sD->getScHold()->getPtrScXenC()->setScore(i, res);
     }
     
-    sD->getScHold()->getPtrScores()->calibrate();
+    if (opt->getIncremental())
+        sD->getScoreStore()->update();
+    
+    sD->getScHold()->combine(true, false, true);
     if (opt->getInv()) { sD->getScHold()->getPtrScores()->inverse(); }
     
     if (opt->getTLang().compare("") == 0) {
@@ -94,12 +112,12 @@ int SimplePPL::launch() {
         XenIO::writeMonoOutput(sD->getSourceCorps()->getPtrOutCorp(), sD->getScHold()->getPtrScores());
     }
     else {
-        boost::shared_ptr<Corpus> ptrOTCorp = boost::make_shared<Corpus>();
-        ptrOTCorp->initialize(opt->getOutTData(), opt->getTLang());
-        std::cout << "NB Scores: " + XenCommon::toString(sD->getScHold()->getPtrScores()->getSize()) + " NB Source corp (unclean): " + XenCommon::toString(sD->getSourceCorps()->getPtrOutCorp()->getSize()) + " NB Target corp (unclean): " + XenCommon::toString(ptrOTCorp->getSize()) << std::endl;
-        XenIO::cleanCorpusBi(sD->getSourceCorps()->getPtrOutCorp(), ptrOTCorp, sD->getScHold()->getPtrScores());
-        std::cout << "NB Scores: " + XenCommon::toString(sD->getScHold()->getPtrScores()->getSize()) + " NB Source corp (clean): " + XenCommon::toString(sD->getSourceCorps()->getPtrOutCorp()->getSize()) + " NB Target corp (clean): " + XenCommon::toString(ptrOTCorp->getSize()) << std::endl;
-        XenIO::writeBiOutput(sD->getSourceCorps()->getPtrOutCorp(), ptrOTCorp, sD->getScHold()->getPtrScores());
+        boost::shared_ptr<Bitext> ptrOutBitext = boost::make_shared<Bitext>();
+        ptrOutBitext->initialize(sD->getSourceCorps()->getPtrOutCorp(), opt->getOutTData(), opt->getTLang());
+        std::cout << "NB Scores: " + XenCommon::toString(sD->getScHold()->getPtrScores()->getSize()) + " NB Source corp (unclean): " + XenCommon::toString(ptrOutBitext->getPtrSource()->getSize()) + " NB Target corp (unclean): " + XenCommon::toString(ptrOutBitext->getPtrTarget()->getSize()) << std::endl;
+        XenIO::cleanCorpusBi(ptrOutBitext, sD->getScHold()->getPtrScores());
+        std::cout << "NB Scores: " + XenCommon::toString(sD->getScHold()->getPtrScores()->getSize()) + " NB Source corp (clean): " + XenCommon::toString(ptrOutBitext->getPtrSource()->getSize()) + " NB Target corp (clean): " + XenCommon::toString(ptrOutBitext->getPtrTarget()->getSize()) << std::endl;
+        XenIO::writeBiOutput(ptrOutBitext->getPtrSource(), ptrOutBitext->getPtrTarget(), sD->getScHold()->getPtrScores());
     }
     
     return 0;
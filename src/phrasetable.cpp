@@ -33,6 +33,8 @@
 
 PhraseTable::PhraseTable() {
     size = 0;
+    ptrPhPairs = boost::make_shared<vector<string> >();
+    ptrGroupStarts = boost::make_shared<vector<unsigned int> >();
 }
 
 void PhraseTable::initialize(boost::shared_ptr<XenFile> ptrData) {
@@ -101,13 +103,9 @@ std::string PhraseTable::getCounts(int n) {
     return lineSpl[4];
 }
 
-std::vector<SourcePhrase> PhraseTable::getSrcPhrases() {
-    if (ptrSrcPhrases->empty()) { mergePhrasesBySource(); }
-    return *ptrSrcPhrases;
-}
-
-void PhraseTable::setSrcPhrases(vector<SourcePhrase> vSP) {
-    ptrSrcPhrases = boost::make_shared<vector<SourcePhrase> >(vSP);
+const std::vector<unsigned int>& PhraseTable::getGroupStarts() {
+    if (ptrGroupStarts->empty()) { mergePhrasesBySource(); }
+    return *ptrGroupStarts;
 }
 
 unsigned int PhraseTable::getSize() const {
@@ -128,23 +126,20 @@ void PhraseTable::loadTable() {
 void PhraseTable::mergePhrasesBySource() {
     std::cout << "Merging phrases by source." << std::endl;
     
+    ptrGroupStarts->clear();
+    
+    std::string src = "";
+    
     for (unsigned int i = 0; i < ptrPhPairs->size(); i++) {
-        SourcePhrase src(getSource(i));
-
-        unsigned int j = i;
-
-        while (j < ptrPhPairs->size() && getSource(j).compare(src.getSource()) == 0) {
-            src.addTarget(getTarget(j));
-            src.addScores(getScores(j));
-            src.addAlignments(getAlignment(j));
-            src.addCounts(getCounts(j));
-            j++;
-        }
-
-        ptrSrcPhrases->push_back(src);
+        std::string cur = getSource(i);
         
-        i = j - 1;
+        if (i == 0 || cur.compare(src) != 0) {
+            ptrGroupStarts->push_back(i);
+            src = cur;
+        }
     }
     
+    ptrGroupStarts->push_back((unsigned int)ptrPhPairs->size());
+    
     std::cout << "Phrases have been merged by source." << std::endl;
 }
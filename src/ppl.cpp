@@ -29,24 +29,21 @@
  */
 
 #include "../include/ppl.h"
+#include "../include/utils/StaticData.h"
 
-boost::mutex randy;
+static const unsigned int batchSize = 256;     // Phrases per perplexity task
 
 void taskCalcPPL(int numLine, std::string line, boost::shared_ptr<std::vector<double> > ptrPPL, boost::shared_ptr<XenLMken> ptrLM) {
-    XenOption* opt = XenOption::getInstance();
-
-    TxtStats tstats = ptrLM->getSentenceStats(line);
+    ptrPPL->operator[](numLine) = PPL::statsPPL(ptrLM->getSentenceStats(line));
+}
 
-    double prob = 0.0;
+void taskCalcPPLBatch(boost::shared_ptr<std::vector<int> > ptrLines, boost::shared_ptr<std::vector<std::string> > ptrSents, boost::shared_ptr<std::vector<double> > ptrPPL, boost::shared_ptr<XenLMken> ptrLM) {
+    std::vector<TxtStats> stats;
 
-    if (!opt->getExclOOVs())
-        prob = pow(10.0, -(tstats.prob / static_cast<double>(tstats.numwords)));
-    else
-        prob = pow(10.0, -((tstats.prob - tstats.zeroprobs) / static_cast<double>(tstats.numwords - tstats.numoov + tstats.numsentences)));
+    ptrLM->getBatchStats(*ptrSents, stats);
 
-    randy.lock();
-    ptrPPL->operator[](numLine) = prob;
-    randy.unlock();
+    for (unsigned int i = 0; i < stats.size(); i++)
+        ptrPPL->operator[](ptrLines->operator[](i)) = PPL::statsPPL(stats[i]);
 }
 
 PPL::PPL() {
@@ -85,17 +82,16 @@ double PPL::getXE(int n) {
 }
 
 double PPL::getCorpPPL() {
-    XenOption* opt = XenOption::getInstance();
     std::cout << "Computing document perplexity score with LM " << ptrLM->getFileName() << "..." << std::endl;
 
+    boost::shared_ptr<RunStats> ptrStats = StaticData::getInstance()->getRunStats();
+    int stage = ptrStats->startStage("devppl:" + ptrLM->getFileName());
+
     TxtStats tstats = ptrLM->getDocumentStats(ptrCorp);
 
-    double prob = 0.0;
+    ptrStats->endStage(stage, tstats.numsentences, tstats.numwords);
 
-    if (!opt->getExclOOVs())
-        prob = pow(10.0, -(tstats.prob / static_cast<double>(tstats.numwords)));
-    else
-        prob = pow(10.0, -((tstats.prob - tstats.zeroprobs) / static_cast<double>(tstats.numwords - tstats.numoov + tstats.numsentences)));
+    double prob = statsPPL(tstats);
 
     std::cout << "Finished computing document perplexity score with LM " << ptrLM->getFileName() << "." << std::endl;
     
@@ -103,18 +99,22 @@ double PPL::getCorpPPL() {
 }
 
 void PPL::calcPPLCorpus() {
-    XenOption* opt = XenOption::getInstance();
+    calcPPLCorpus(boost::shared_ptr<ScoreStore>());
+}
+
+void PPL::calcPPLCorpus(boost::shared_ptr<ScoreStore> ptrStore) {
+    ScoringPass pass("ppl:" + ptrLM->getFileName() + ":" + ptrCorp->getXenFile()->getFullPath(), ptrCorp, ptrStore, ptrPPL);
+
+    if (pass.restore(boost::filesystem::path(ptrLM->getFileName()).filename().string() + "." + boost::filesystem::path(ptrCorp->getXenFile()->getFullPath()).filename().string() + ".ppl", std::vector<std::string>(1, ptrLM->getFileName()))) {
+        std::cout << "Sentences perplexity scores with LM " << ptrLM->getFileName() << " restored from checkpoint." << std::endl;
+        return;
+    }
 
     ptrLM->loadLM();
     
-    pool threadPool(opt->getThreads());
-    
     std::cout << "Computing sentences perplexity scores with LM " << ptrLM->getFileName() << "..." << std::endl;
     
-    for (unsigned int i = 0; i < ptrCorp->getSize(); i++)
-        threadPool.schedule(boost::bind(taskCalcPPL, i, ptrCorp->getLine(i), ptrPPL, ptrLM));
-    
-    threadPool.wait();
+    pass.run(boost::bind(taskCalcPPLBatch, _1, _2, ptrPPL, ptrLM));
     
     std::cout << "Finished computing sentences perplexity scores with LM " << ptrLM->getFileName() << "." << std::endl;
 }
@@ -124,21 +124,43 @@ void PPL::calcPPLPhraseTable() {
 
     ptrLM->loadLM();
     
-    pool threadPool(opt->getThreads());
+    boost::shared_ptr<RunStats> ptrStats = StaticData::getInstance()->getRunStats();
+    int statStage = ptrStats->startStage("ptppl:" + ptrLM->getFileName() + (source ? ":source" : ":target"));
+    uint64_t tokens = 0;
+    
+    TaskGroup batches;
     
     std::cout << "Computing phrases perplexity scores with LM " << ptrLM->getFileName() << "..." << std::endl;
 
-    for (unsigned int i = 0; i < ptrPT->getSize(); i++)
-        if (source)
-            threadPool.schedule(boost::bind(taskCalcPPL, i, ptrPT->getSource(i), ptrPPL, ptrLM));
-        else
-            threadPool.schedule(boost::bind(taskCalcPPL, i, ptrPT->getTarget(i), ptrPPL, ptrLM));
+    boost::shared_ptr<std::vector<int> > ptrLines = boost::make_shared<std::vector<int> >();
+    boost::shared_ptr<std::vector<std::string> > ptrSents = boost::make_shared<std::vector<std::string> >();
+
+    for (unsigned int i = 0; i < ptrPT->getSize(); i++) {
+        ptrLines->push_back(i);
+        ptrSents->push_back(source ? ptrPT->getSource(i) : ptrPT->getTarget(i));
+        tokens += XenCommon::wordCount(ptrSents->back());
+
+        if (ptrLines->size() == batchSize || i + 1 == ptrPT->getSize()) {
+            batches.run(boost::bind(taskCalcPPLBatch, ptrLines, ptrSents, ptrPPL, ptrLM));
+            ptrLines = boost::make_shared<std::vector<int> >();
+            ptrSents = boost::make_shared<std::vector<std::string> >();
+        }
+    }
     
-    threadPool.wait();
+    batches.wait();
+    
+    ptrStats->endStage(statStage, ptrPT->getSize(), tokens);
     
     std::cout << "Finished computing phrases perplexity scores with LM " << ptrLM->getFileName() << "." << std::endl;
 }
 
+double PPL::statsPPL(const TxtStats &tstats) {
+    if (!XenOption::getInstance()->getExclOOVs())
+        return pow(10.0, -(tstats.prob / static_cast<double>(tstats.numwords)));
+
+    return pow(10.0, -((tstats.prob - tstats.zeroprobs) / static_cast<double>(tstats.numwords - tstats.numoov + tstats.numsentences)));
+}
+
 double PPL::crossEntropy(double ppl) {
 	return std::log(ppl)/std::log(2);
 }
@@ -0,0 +1,179 @@
+/**
+ *  @file runstats.cpp
+ *  @brief Class collecting per-stage timing, throughput and memory statistics
+ *  @author Anthony Rousseau
+ *  @version 2.0.0
+ *  @date 19 October 2026
+ */
+
+/*  This file is part of the cross-entropy tool for data selection (XenC)
+ *  aimed at speech recognition and statistical machine translation.
+ *
+ *  Copyright 2013-2016, Anthony Rousseau, LIUM, University of Le Mans, France
+ *
+ *  Development of the XenC tool has been partially funded by the
+ *  European Commission under the MateCat project.
+ *
+ *  The XenC tool is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation
+ *
+ *  This library is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "../include/runstats.h"
+#include "../include/xenoption.h"
+#include "../include/kenlm/util/usage.hh"
+
+#include <cstdio>
+#include <iomanip>
+
+#include <boost/filesystem.hpp>
+
+RunStats::RunStats() {
+    startWall = util::WallTime();
+    startCPU = util::CPUTime();
+}
+
+RunStats::~RunStats() {
+
+}
+
+int RunStats::startStage(std::string name) {
+    StageStats s;
+    s.name = name;
+    s.startWall = util::WallTime();
+    s.startCPU = util::CPUTime();
+    s.wall = 0.0;
+    s.cpu = 0.0;
+    s.rss = 0;
+    s.lines = 0;
+    s.tokens = 0;
+    s.done = false;
+
+    boost::mutex::scoped_lock lock(mtx);
+
+    stages.push_back(s);
+
+    return (int)stages.size() - 1;
+}
+
+void RunStats::endStage(int id, uint64_t lines, uint64_t tokens) {
+    double wall = util::WallTime();
+    double cpu = util::CPUTime();
+    uint64_t rss = util::RSSMax();
+
+    boost::mutex::scoped_lock lock(mtx);
+
+    StageStats &s = stages[id];
+    s.wall = wall - s.startWall;
+    s.cpu = cpu - s.startCPU;
+    s.rss = rss;
+    s.lines = lines;
+    s.tokens = tokens;
+    s.done = true;
+}
+
+void RunStats::writeReport(std::string fileName, std::string version) {
+    XenOption* opt = XenOption::getInstance();
+
+    double wall = util::WallTime() - startWall;
+    double cpu = util::CPUTime() - startCPU;
+    uint64_t rss = util::RSSMax();
+
+    std::string tmpName = fileName + ".tmp";
+
+    try {
+        boost::mutex::scoped_lock lock(mtx);
+
+        std::ofstream out(tmpName.c_str(), std::ios::out | std::ios::trunc);
+
+        if (!out.is_open())
+            throw XenCommon::XenCEption("Can't open " + tmpName + " for writing.");
+
+        out << std::fixed << std::setprecision(6);
+
+        out << "{" << std::endl;
+        out << "  \"version\": " << escape(version) << "," << std::endl;
+        out << "  \"mode\": " << opt->getMode() << "," << std::endl;
+        out << "  \"threads\": " << opt->getThreads() << "," << std::endl;
+        out << "  \"output\": " << escape(opt->getOutName()) << "," << std::endl;
+        out << "  \"wall_sec\": " << wall << "," << std::endl;
+        out << "  \"cpu_sec\": " << cpu << "," << std::endl;
+        out << "  \"peak_rss_bytes\": " << rss << "," << std::endl;
+        out << "  \"stages\": [";
+
+        bool first = true;
+
+        for (unsigned int i = 0; i < stages.size(); i++) {
+            const StageStats &s = stages[i];
+
+            if (!s.done)
+                continue;
+
+            out << (first ? "" : ",") << std::endl;
+            out << "    {\"name\": " << escape(s.name)
+                << ", \"wall_sec\": " << s.wall
+                << ", \"cpu_sec\": " << s.cpu
+                << ", \"peak_rss_bytes\": " << s.rss
+                << ", \"lines\": " << s.lines
+                << ", \"tokens\": " << s.tokens
+                << ", \"lines_per_sec\": " << rate(s.lines, s.wall)
+                << ", \"tokens_per_sec\": " << rate(s.tokens, s.wall) << "}";
+
+            first = false;
+        }
+
+        out << std::endl << "  ]" << std::endl << "}" << std::endl;
+
+        if (out.bad())
+            throw XenCommon::XenCEption("Error while writing file " + tmpName);
+
+        out.close();
+
+        boost::filesystem::rename(tmpName, fileName);
+    } catch (XenCommon::XenCEption &e) {
+        throw;
+    }
+
+    std::cout << "Run statistics written to " << fileName << std::endl;
+}
+
+std::string RunStats::escape(std::string str) {
+    std::string res = "\"";
+
+    for (unsigned int i = 0; i < str.length(); i++) {
+        char c = str[i];
+
+        if (c == '"' || c == '\\') {
+            res += '\\';
+            res += c;
+        }
+        else if ((unsigned char)c < 0x20) {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", (unsigned int)(unsigned char)c);
+            res += buf;
+        }
+        else
+            res += c;
+    }
+
+    return res + "\"";
+}
+
+std::string RunStats::rate(uint64_t count, double seconds) {
+    if (count == 0 || seconds <= 0.0)
+        return "null";
+
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2) << (double)count / seconds;
+
+    return oss.str();
+}
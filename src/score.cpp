@@ -29,53 +29,207 @@
  */
 
 #include "../include/score.h"
+#include "../include/utils/scheduler.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/**
+ *  @fn static MinMax rangeMinMax (const double* v, unsigned int first, unsigned int last)
+ *  @brief Bounds of a sub-range, 0 always included as calibration expects
+ */
+static MinMax rangeMinMax(const double* v, unsigned int first, unsigned int last) {
+    MinMax res(0, 0);
+    Score::minMax(v + first, last - first, res.first, res.second);
+    return res;
+}
+
+/**
+ *  @fn static void rangeNormalize (double* v, double min, double max, unsigned int first, unsigned int last)
+ *  @brief Normalizes a sub-range
+ */
+static void rangeNormalize(double* v, double min, double max, unsigned int first, unsigned int last) {
+    Score::normalize(v + first, last - first, min, max);
+}
+
+/**
+ *  @fn static void rangeAffine (double* v, double a, double b, unsigned int first, unsigned int last)
+ *  @brief Maps a sub-range to a * v + b
+ */
+static void rangeAffine(double* v, double a, double b, unsigned int first, unsigned int last) {
+    Score::affine(v + first, last - first, a, b);
+}
+
+/**
+ *  @fn static void rangeGroups (double* v, const std::vector<unsigned int>* starts, unsigned int first, unsigned int last)
+ *  @brief Calibrates the groups of a sub-range of groups, each on its own bounds
+ */
+static void rangeGroups(double* v, const std::vector<unsigned int>* starts, unsigned int first, unsigned int last) {
+    for (unsigned int g = first; g < last; g++) {
+        unsigned int begin = (*starts)[g];
+        unsigned int size = (*starts)[g + 1] - begin;
+        
+        if (size == 1) {
+            v[begin] = 0;
+            continue;
+        }
+        
+        double min = 0;
+        double max = 0;
+        
+        Score::minMax(v + begin, size, min, max);
+        Score::normalize(v + begin, size, min, max);
+    }
+}
 
 Score::Score() {
-    ptrScores = boost::make_shared<vector<double> >();
-    ptrPrint = boost::make_shared<vector<int> >();
+    
 }
 
 Score::~Score() {
     
 }
 
+void Score::resize(unsigned int size, double sc) {
+    scores.assign(size, sc);
+    print.clear();
+    print.resize(size, true);
+}
+
 void Score::addScore(double sc) {
-    ptrScores->push_back(sc);
-    ptrPrint->push_back(1);
+    scores.push_back(sc);
+    print.push_back(true);
+}
+
+void Score::setScore(int n, double sc) {
+    scores[n] = sc;
 }
 
 void Score::removeScore(int n) {
-    ptrPrint->operator[](n) = 0;
+    print.reset(n);
 }
 
 double Score::getScore(int n) const {
-    return ptrScores->operator[](n);
+    return scores[n];
 }
 
 bool Score::getPrint(int n) const {
-    return (bool)ptrPrint->operator[](n);
+    return print.test(n);
 }
 
 unsigned int Score::getSize() const {
-    return (unsigned int)ptrScores->size();
+    return (unsigned int)scores.size();
+}
+
+double* Score::getData() {
+    return scores.empty() ? NULL : &scores[0];
 }
 
+
 void Score::calibrate() {
-	double min = 0;
-	double max = 0;
+    unsigned int size = getSize();
+    
+    // Small columns (phrase-table local scores) are not worth the tasks
+    if (size <= grain) {
+        double min = 0;
+        double max = 0;
+        
+        minMax(getData(), size, min, max);
+        normalize(getData(), size, min, max);
+        return;
+    }
     
-	for (std::vector<double>::iterator iter = ptrScores->begin(); iter != ptrScores->end(); ++iter) {
-		if (*iter > max) { max = *iter; }
-		if (*iter < min) { min = *iter; }
-	}
+    MinMax b = Scheduler::parallelReduce<MinMax>(0, size, grain, MinMax(0, 0), boost::bind(&rangeMinMax, getData(), _1, _2), &Score::mergeBounds);
     
-	for (unsigned int i = 0; i < ptrScores->size(); i++) {
-		ptrScores->operator[](i) = ((ptrScores->operator[](i) - min) / (max - min));
-	}
+    Scheduler::parallelFor(0, size, grain, boost::bind(&rangeNormalize, getData(), b.first, b.second, _1, _2));
 }
 
 void Score::inverse() {
-	for (unsigned int i = 0; i < ptrScores->size(); i++) {
-		ptrScores->operator[](i) = (double)(1 - ptrScores->operator[](i));
-	}
+    unsigned int size = getSize();
+    
+    if (size <= grain)
+        affine(getData(), size, -1, 1);
+    else
+        Scheduler::parallelFor(0, size, grain, boost::bind(&rangeAffine, getData(), -1.0, 1.0, _1, _2));
+}
+
+void Score::calibrateGroups(const std::vector<unsigned int> &starts) {
+    if (starts.size() < 2)
+        return;
+    
+    Scheduler::parallelFor(0, (unsigned int)starts.size() - 1, groupGrain, boost::bind(&rangeGroups, getData(), &starts, _1, _2));
+}
+
+MinMax Score::mergeBounds(const MinMax &a, const MinMax &b) {
+    return MinMax(std::min(a.first, b.first), std::max(a.second, b.second));
+}
+
+void Score::minMax(const double* v, unsigned int size, double &min, double &max) {
+    unsigned int i = 0;
+    
+#ifdef __SSE2__
+    if (size >= 4) {
+        // Operands ordered so that a NaN is skipped, as the scalar comparisons do
+        __m128d lo0 = _mm_set1_pd(min);
+        __m128d hi0 = _mm_set1_pd(max);
+        __m128d lo1 = lo0;
+        __m128d hi1 = hi0;
+        
+        for (; i + 4 <= size; i += 4) {
+            __m128d x0 = _mm_loadu_pd(v + i);
+            __m128d x1 = _mm_loadu_pd(v + i + 2);
+            lo0 = _mm_min_pd(x0, lo0);
+            hi0 = _mm_max_pd(x0, hi0);
+            lo1 = _mm_min_pd(x1, lo1);
+            hi1 = _mm_max_pd(x1, hi1);
+        }
+        
+        double lo[2];
+        double hi[2];
+        _mm_storeu_pd(lo, _mm_min_pd(lo0, lo1));
+        _mm_storeu_pd(hi, _mm_max_pd(hi0, hi1));
+        
+        min = std::min(lo[0], lo[1]);
+        max = std::max(hi[0], hi[1]);
+    }
+#endif
+    
+    for (; i < size; i++) {
+        if (v[i] > max) { max = v[i]; }
+        if (v[i] < min) { min = v[i]; }
+    }
 }
+
+void Score::normalize(double* v, unsigned int size, double min, double max) {
+    // Subtract then divide, not an a * v + b form: scores stay bit-exact with the scalar loop
+    double range = max - min;
+    unsigned int i = 0;
+    
+#ifdef __SSE2__
+    __m128d vMin = _mm_set1_pd(min);
+    __m128d vRange = _mm_set1_pd(range);
+    
+    for (; i + 2 <= size; i += 2)
+        _mm_storeu_pd(v + i, _mm_div_pd(_mm_sub_pd(_mm_loadu_pd(v + i), vMin), vRange));
+#endif
+    
+    for (; i < size; i++)
+        v[i] = (v[i] - min) / range;
+}
+
+void Score::affine(double* v, unsigned int size, double a, double b) {
+    unsigned int i = 0;
+    
+#ifdef __SSE2__
+    __m128d vA = _mm_set1_pd(a);
+    __m128d vB = _mm_set1_pd(b);
+    
+    for (; i + 2 <= size; i += 2)
+        _mm_storeu_pd(v + i, _mm_add_pd(_mm_mul_pd(_mm_loadu_pd(v + i), vA), vB));
+#endif
+    
+    for (; i < size; i++)
+        v[i] = v[i] * a + b;
+}
+
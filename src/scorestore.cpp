@@ -0,0 +1,303 @@
+/**
+ *  @file scorestore.cpp
+ *  @brief Class handling the persistent per-line score store for incremental re-scoring
+ *  @author Anthony Rousseau
+ *  @version 2.0.0
+ *  @date 19 October 2026
+ */
+
+/*  This file is part of the cross-entropy tool for data selection (XenC)
+ *  aimed at speech recognition and statistical machine translation.
+ *
+ *  Copyright 2013-2016, Anthony Rousseau, LIUM, University of Le Mans, France
+ *
+ *  Development of the XenC tool has been partially funded by the
+ *  European Commission under the MateCat project.
+ *
+ *  The XenC tool is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation
+ *
+ *  This library is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "../include/scorestore.h"
+#include "../include/utils/StaticData.h"
+#include "../include/kenlm/util/murmur_hash.hh"
+
+#include <algorithm>
+
+#include <boost/unordered_set.hpp>
+
+static const char storeMagic[8] = { 'X', 'E', 'N', 'C', 'S', 'T', 'O', '1' };
+
+/**
+ *  @struct RawLess
+ *  @brief Orders corpus line positions by raw score
+ */
+struct RawLess {
+    const std::vector<double>* raw;     //!< The raw scores of the corpus lines
+
+    bool operator()(unsigned int a, unsigned int b) const { return (*raw)[a] < (*raw)[b]; }
+};
+
+ScoreStore::ScoreStore() {
+    fileName = "";
+    fingerprint = 0;
+}
+
+ScoreStore::~ScoreStore() {
+
+}
+
+void ScoreStore::initialize(boost::shared_ptr<Corpus> ptrSource, boost::shared_ptr<Corpus> ptrTarget) {
+    XenOption* opt = XenOption::getInstance();
+
+    this->ptrSource = ptrSource;
+    this->ptrTarget = ptrTarget;
+
+    fileName = opt->getOutName() + ".store";
+    fingerprint = computeFingerprint();
+
+    load();
+
+    boost::unordered_map<uint64_t, int> rankOf;
+    for (unsigned int r = 0; r < entries.size(); r++)
+        rankOf.insert(std::make_pair(entries[r].hash, (int)r));
+
+    unsigned int size = ptrSource->getSize();
+    unsigned int known = 0;
+
+    lineHash.assign(size, 0);
+    lineRank.assign(size, -1);
+    lineRaw.assign(size, 0.0);
+    order.clear();
+
+    for (unsigned int i = 0; i < size; i++) {
+        std::string line = ptrSource->getLine(i);
+        uint64_t h = util::MurmurHash64A(line.c_str(), line.length(), 0);
+
+        if (ptrTarget) {
+            std::string trg = ptrTarget->getLine(i);
+            h = util::MurmurHash64A(trg.c_str(), trg.length(), h);
+        }
+
+        lineHash[i] = h;
+
+        boost::unordered_map<uint64_t, int>::iterator it = rankOf.find(h);
+        if (it != rankOf.end()) {
+            lineRank[i] = it->second;
+            lineRaw[i] = entries[it->second].raw;
+            known++;
+        }
+    }
+
+    std::cout << "Score store " << fileName << ": " << known << " lines already scored, " << size - known << " lines to score." << std::endl;
+}
+
+bool ScoreStore::isKnown(unsigned int n) const {
+    return lineRank[n] >= 0;
+}
+
+double ScoreStore::getRaw(unsigned int n) const {
+    return lineRaw[n];
+}
+
+void ScoreStore::setRaw(unsigned int n, double raw) {
+    lineRaw[n] = raw;
+}
+
+unsigned int ScoreStore::getSize() const {
+    return (unsigned int)lineHash.size();
+}
+
+bool ScoreStore::indexes(boost::shared_ptr<Corpus> ptrCorp) const {
+    return ptrCorp && (ptrCorp == ptrSource || ptrCorp == ptrTarget);
+}
+
+void ScoreStore::update() {
+    std::cout << "Merging new scores into the score store..." << std::endl;
+
+    // Already scored lines keep their stored order (counting sort on ranks)
+    std::vector<unsigned int> start(entries.size() + 1, 0);
+    std::vector<unsigned int> fresh;
+
+    for (unsigned int i = 0; i < lineRank.size(); i++) {
+        if (lineRank[i] >= 0)
+            start[lineRank[i] + 1]++;
+        else
+            fresh.push_back(i);
+    }
+
+    for (unsigned int r = 1; r < start.size(); r++)
+        start[r] += start[r - 1];
+
+    std::vector<unsigned int> known(start.back());
+    for (unsigned int i = 0; i < lineRank.size(); i++)
+        if (lineRank[i] >= 0)
+            known[start[lineRank[i]]++] = i;
+
+    // Only new lines need sorting, then both sequences are merged
+    RawLess comp;
+    comp.raw = &lineRaw;
+
+    std::stable_sort(fresh.begin(), fresh.end(), comp);
+
+    order.resize(lineRank.size());
+    std::merge(known.begin(), known.end(), fresh.begin(), fresh.end(), order.begin(), comp);
+
+    // Lines no longer in the corpus are dropped from the store
+    boost::unordered_set<uint64_t> seen;
+    std::vector<StoreEntry> merged;
+    merged.reserve(order.size());
+
+    for (unsigned int i = 0; i < order.size(); i++) {
+        if (seen.insert(lineHash[order[i]]).second) {
+            StoreEntry e;
+            e.hash = lineHash[order[i]];
+            e.raw = lineRaw[order[i]];
+            merged.push_back(e);
+        }
+    }
+
+    entries.swap(merged);
+
+    save();
+
+    std::cout << "Score store updated with " << fresh.size() << " new lines (" << entries.size() << " entries)." << std::endl;
+}
+
+std::vector<unsigned int> ScoreStore::getOrder(boost::shared_ptr<Score> ptrScore, bool inv, bool rev) const {
+    std::vector<unsigned int> res(order);
+
+    if (inv)
+        std::reverse(res.begin(), res.end());
+
+    // The sequence is already sorted on the final score, but --inv also reverses
+    // the runs of equal scores: each run is sorted back in position order
+    unsigned int first = 0;
+
+    for (unsigned int i = 1; i <= res.size(); i++) {
+        if (i == res.size() || ptrScore->getScore(res[i]) != ptrScore->getScore(res[first])) {
+            if (i - first > 1)
+                std::sort(res.begin() + first, res.begin() + i);
+            first = i;
+        }
+    }
+
+    if (rev)
+        std::reverse(res.begin(), res.end());
+
+    return res;
+}
+
+uint64_t ScoreStore::computeFingerprint() {
+    XenOption* opt = XenOption::getInstance();
+    StaticData* sD = StaticData::getInstance();
+
+    std::cout << "Computing language models fingerprint..." << std::endl;
+
+    std::vector<std::string> lms;
+
+    lms.push_back(sD->getSourceLMs()->getPtrInLM()->getFileName());
+    if (opt->getMode() != 1) {
+        lms.push_back(sD->getSourceLMs()->getPtrOutLM()->getFileName());
+        if (opt->getMean())
+            for (unsigned int m = 1; m < sD->getSourceEnsemble()->getSize(); m++)
+                lms.push_back(sD->getSourceEnsemble()->getFileName(m));
+        if (opt->getStem()) {
+            lms.push_back(sD->getStemSourceLMs()->getPtrInLM()->getFileName());
+            lms.push_back(sD->getStemSourceLMs()->getPtrOutLM()->getFileName());
+        }
+    }
+    if (opt->getMode() == 3) {
+        lms.push_back(sD->getTargetLMs()->getPtrInLM()->getFileName());
+        lms.push_back(sD->getTargetLMs()->getPtrOutLM()->getFileName());
+        if (opt->getMean())
+            for (unsigned int m = 1; m < sD->getTargetEnsemble()->getSize(); m++)
+                lms.push_back(sD->getTargetEnsemble()->getFileName(m));
+        if (opt->getStem()) {
+            lms.push_back(sD->getStemTargetLMs()->getPtrInLM()->getFileName());
+            lms.push_back(sD->getStemTargetLMs()->getPtrOutLM()->getFileName());
+        }
+    }
+
+    std::string options = XenCommon::toString(opt->getMode()) + (opt->getMean() ? "m" + XenCommon::toString(opt->getMeanK()) : "") + (opt->getStem() ? "s" : "") + (opt->getExclOOVs() ? "x" : "");
+    uint64_t h = util::MurmurHash64A(options.c_str(), options.length(), 0);
+
+    for (unsigned int i = 0; i < lms.size(); i++)
+        h = Checkpoint::hashFile(lms[i], h);
+
+    return h;
+}
+
+void ScoreStore::load() {
+    entries.clear();
+
+    if (!boost::filesystem::exists(fileName.c_str())) {
+        std::cout << "No score store found, all lines will be scored." << std::endl;
+        return;
+    }
+
+    std::ifstream in(fileName.c_str(), std::ios::in | std::ios::binary);
+
+    char magic[8];
+    uint64_t fp = 0;
+    uint64_t count = 0;
+
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(&fp), sizeof(fp));
+    in.read(reinterpret_cast<char*>(&count), sizeof(count));
+
+    if (!in.good() || !std::equal(magic, magic + sizeof(magic), storeMagic))
+        throw XenCommon::XenCEption("File " + fileName + " is not a valid score store.");
+
+    if (fp != fingerprint) {
+        std::cout << "Language models or scoring options changed since last run, all lines will be scored." << std::endl;
+        return;
+    }
+
+    entries.resize(count);
+    if (count > 0)
+        in.read(reinterpret_cast<char*>(&entries[0]), count * sizeof(StoreEntry));
+
+    if (!in.good())
+        throw XenCommon::XenCEption("Score store " + fileName + " is truncated.");
+
+    in.close();
+}
+
+void ScoreStore::save() {
+    std::string tmpName = fileName + ".tmp";
+
+    try {
+        std::ofstream out(tmpName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+
+        if (!out.is_open())
+            throw XenCommon::XenCEption("Can't open " + tmpName + " for writing.");
+
+        uint64_t count = entries.size();
+
+        out.write(storeMagic, sizeof(storeMagic));
+        out.write(reinterpret_cast<const char*>(&fingerprint), sizeof(fingerprint));
+        out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        if (count > 0)
+            out.write(reinterpret_cast<const char*>(&entries[0]), count * sizeof(StoreEntry));
+
+        if (out.bad())
+            throw XenCommon::XenCEption("Error while writing file " + tmpName);
+
+        out.close();
+
+        boost::filesystem::rename(tmpName, fileName);
+    } catch (XenCommon::XenCEption &e) {
+        throw;
+    }
+}
@@ -0,0 +1,146 @@
+/**
+ *  @file scoretable.cpp
+ *  @brief Class holding the named score columns of a run and combining them
+ *  @author Anthony Rousseau
+ *  @version 2.0.0
+ *  @date 19 October 2026
+ */
+
+
+/*  This file is part of the cross-entropy tool for data selection (XenC)
+ *  aimed at speech recognition and statistical machine translation.
+ *
+ *  Copyright 2013-2016, Anthony Rousseau, LIUM, University of Le Mans, France
+ *
+ *  Development of the XenC tool has been partially funded by the
+ *  European Commission under the MateCat project.
+ *
+ *  The XenC tool is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation
+ *
+ *  This library is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "../include/scoretable.h"
+#include "../include/utils/scheduler.h"
+#include "../include/utils/StaticData.h"
+
+/**
+ *  @fn static void rangeNormalize (double* v, MinMax b, unsigned int first, unsigned int last)
+ *  @brief Calibrates a sub-range between given bounds
+ */
+static void rangeNormalize(double* v, MinMax b, unsigned int first, unsigned int last) {
+    Score::normalize(v + first, last - first, b.first, b.second);
+}
+
+ScoreTable::ScoreTable() {
+    for (int c = 0; c < SC_COLUMNS; c++)
+        columns.push_back(boost::make_shared<Score>());
+}
+
+ScoreTable::~ScoreTable() {
+    
+}
+
+void ScoreTable::initialize(unsigned int size) {
+    columns[SC_FINAL]->resize(size, 0);
+    columns[SC_SIMIL]->resize(size, 0);
+    columns[SC_XENC]->resize(size, 0);
+}
+
+boost::shared_ptr<Score> ScoreTable::getColumn(ScoreColumn col) const {
+    return columns[col];
+}
+
+boost::shared_ptr<Score> ScoreTable::getPtrScores() const {
+    return columns[SC_FINAL];
+}
+
+boost::shared_ptr<Score> ScoreTable::getPtrScSimil() const {
+    return columns[SC_SIMIL];
+}
+
+boost::shared_ptr<Score> ScoreTable::getPtrScXenC() const {
+    return columns[SC_XENC];
+}
+
+void ScoreTable::setPtrScWeight(boost::shared_ptr<Score> ptrWeights) {
+    columns[SC_WEIGHT] = ptrWeights;
+}
+
+void ScoreTable::combine(bool xenc, bool simil, bool calib) {
+    unsigned int size = columns[xenc ? SC_XENC : SC_SIMIL]->getSize();
+    unsigned int weights = columns[SC_WEIGHT]->getSize();
+    
+    if (xenc && weights > 0 && weights < size)
+        throw XenCommon::XenCEption("Weights file has " + XenCommon::toString(weights) + " lines for " + XenCommon::toString(size) + " scores.");
+    
+    if (columns[SC_FINAL]->getSize() != size)
+        columns[SC_FINAL]->resize(size, 0);
+    
+    MinMax bounds(0, 0);
+    
+    boost::shared_ptr<RunStats> ptrStats = StaticData::getInstance()->getRunStats();
+    int stage = ptrStats->startStage("score");
+    
+    try {
+        if (xenc)
+            bounds = Scheduler::parallelReduce<MinMax>(0, size, Score::grain, MinMax(0, 0), boost::bind(&ScoreTable::weightRange, this, _1, _2), &Score::mergeBounds);
+        
+        if (simil)
+            bounds = Scheduler::parallelReduce<MinMax>(0, size, Score::grain, MinMax(0, 0), boost::bind(&ScoreTable::similRange, this, xenc, bounds, _1, _2), &Score::mergeBounds);
+        
+        if (calib && size > 0)
+            Scheduler::parallelFor(0, size, Score::grain, boost::bind(&rangeNormalize, columns[SC_FINAL]->getData(), bounds, _1, _2));
+    } catch (XenCommon::XenCEption &e) {
+        throw;
+    }
+    
+    ptrStats->endStage(stage, size, 0);
+}
+
+MinMax ScoreTable::weightRange(unsigned int first, unsigned int last) {
+    double* f = columns[SC_FINAL]->getData();
+    const double* x = columns[SC_XENC]->getData();
+    
+    if (columns[SC_WEIGHT]->getSize() > 0) {
+        const double* w = columns[SC_WEIGHT]->getData();
+        
+        for (unsigned int i = first; i < last; i++)
+            f[i] = x[i] * w[i];
+    }
+    else
+        std::copy(x + first, x + last, f + first);
+    
+    MinMax res(0, 0);
+    Score::minMax(f + first, last - first, res.first, res.second);
+    
+    return res;
+}
+
+MinMax ScoreTable::similRange(bool xenc, MinMax xb, unsigned int first, unsigned int last) {
+    double* f = columns[SC_FINAL]->getData();
+    const double* s = columns[SC_SIMIL]->getData();
+    
+    if (xenc) {
+        Score::normalize(f + first, last - first, xb.first, xb.second);
+        
+        for (unsigned int i = first; i < last; i++)
+            f[i] += s[i];
+    }
+    else
+        std::copy(s + first, s + last, f + first);
+    
+    MinMax res(0, 0);
+    Score::minMax(f + first, last - first, res.first, res.second);
+    
+    return res;
+}
@@ -0,0 +1,141 @@
+/**
+ *  @file scoringpass.cpp
+ *  @brief Class handling the scaffolding shared by the sentence scorers of a corpus
+ *  @author Anthony Rousseau
+ *  @version 2.0.0
+ *  @date 19 October 2026
+ */
+
+
+/*  This file is part of the cross-entropy tool for data selection (XenC)
+ *  aimed at speech recognition and statistical machine translation.
+ *
+ *  Copyright 2013-2016, Anthony Rousseau, LIUM, University of Le Mans, France
+ *
+ *  Development of the XenC tool has been partially funded by the
+ *  European Commission under the MateCat project.
+ *
+ *  The XenC tool is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation
+ *
+ *  This library is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "../include/scoringpass.h"
+#include "../include/utils/StaticData.h"
+
+void taskRunBatch(BatchTask task, boost::shared_ptr<std::vector<int> > ptrLines, boost::shared_ptr<std::vector<std::string> > ptrSents, boost::shared_ptr<std::vector<std::string> > ptrExtras, MemoryBudget* window, std::size_t bytes) {
+    try {
+        task(ptrLines, ptrSents, ptrExtras);
+    } catch (...) {
+        window->release(bytes);
+        throw;
+    }
+
+    window->release(bytes);
+}
+
+ScoringPass::ScoringPass(std::string stage, boost::shared_ptr<Corpus> ptrCorp, boost::shared_ptr<ScoreStore> ptrStore, boost::shared_ptr<std::vector<double> > ptrScores) {
+    this->stage = stage;
+    this->ptrCorp = ptrCorp;
+    this->ptrStore = ptrStore;
+    this->ptrScores = ptrScores;
+
+    // Lines already held by the score store are not scored again
+    skip = ptrStore && ptrStore->indexes(ptrCorp);
+
+    // Scores computed by an interrupted run are reused as is
+    ckpt = XenOption::getInstance()->getCheckpoint() && !skip;
+    dump = "";
+    fp = 0;
+}
+
+ScoringPass::~ScoringPass() {
+
+}
+
+bool ScoringPass::restore(std::string dumpName, const std::vector<std::string> &files) {
+    if (!ckpt)
+        return false;
+
+    boost::shared_ptr<Checkpoint> ptrCkpt = StaticData::getInstance()->getCheckpoint();
+
+    dump = ptrCkpt->getPath(dumpName);
+    fp = ptrCkpt->fileFingerprint(ptrCorp->getXenFile()->getFullPath());
+    for (unsigned int f = 0; f < files.size(); f++)
+        fp = Checkpoint::hashString(XenCommon::toString(ptrCkpt->fileFingerprint(files[f])), fp);
+    fp = Checkpoint::hashString(XenCommon::toString(XenOption::getInstance()->getExclOOVs()), fp);
+
+    return ptrCkpt->isDone(stage, fp) && Checkpoint::loadScores(*ptrScores, dump);
+}
+
+void ScoringPass::run(BatchTask task) {
+    run(task, ExtraReader(), 0);
+}
+
+void ScoringPass::run(BatchTask task, ExtraReader reader, std::size_t readAhead) {
+    boost::shared_ptr<RunStats> ptrStats = StaticData::getInstance()->getRunStats();
+    int statStage = ptrStats->startStage(stage);
+    uint64_t lines = 0;
+    uint64_t tokens = 0;
+
+    // Without an extra reader, the lines are already in memory and nothing is held
+    MemoryBudget window(readAhead);
+    TaskGroup batches;
+    std::string extra;
+
+    boost::shared_ptr<std::vector<int> > ptrLines = boost::make_shared<std::vector<int> >();
+    boost::shared_ptr<std::vector<std::string> > ptrSents = boost::make_shared<std::vector<std::string> >();
+    boost::shared_ptr<std::vector<std::string> > ptrExtras = boost::make_shared<std::vector<std::string> >();
+    std::size_t bytes = 0;
+
+    try {
+        for (unsigned int i = 0; i < ptrCorp->getSize(); i++) {
+            if (reader)
+                reader(i, extra);
+
+            if (!skip || !ptrStore->isKnown(i)) {
+                ptrLines->push_back(i);
+                ptrSents->push_back(ptrCorp->getLine(i));
+                lines++;
+                tokens += ptrCorp->getTokens(i);
+
+                if (reader) {
+                    ptrExtras->push_back(extra);
+                    bytes += extra.length() + ptrSents->back().length();
+                }
+            }
+
+            if (ptrLines->size() == batchSize || (i + 1 == ptrCorp->getSize() && !ptrLines->empty())) {
+                window.acquire(bytes);
+                batches.run(boost::bind(taskRunBatch, task, ptrLines, ptrSents, ptrExtras, &window, bytes));
+                ptrLines = boost::make_shared<std::vector<int> >();
+                ptrSents = boost::make_shared<std::vector<std::string> >();
+                ptrExtras = boost::make_shared<std::vector<std::string> >();
+                bytes = 0;
+            }
+        }
+    } catch (XenCommon::XenCEption &e) {
+        batches.wait();
+        throw;
+    }
+
+    batches.wait();
+
+    ptrStats->endStage(statStage, lines, tokens);
+
+    if (ckpt) {
+        boost::shared_ptr<Checkpoint> ptrCkpt = StaticData::getInstance()->getCheckpoint();
+
+        Checkpoint::dumpScores(*ptrScores, dump);
+        ptrCkpt->markDone(stage, fp, dump);
+    }
+}
@@ -29,22 +29,40 @@
  */
 
 #include "../include/similarity.h"
+#include "../include/utils/StaticData.h"
 
 Similarity::Similarity() {
     
 }
 
 void Similarity::initialize(boost::shared_ptr<Corpus> ptrInCorp, boost::shared_ptr<Corpus> ptrOutCorp, boost::shared_ptr<XenVocab> ptrVocab) {
+    XenOption* opt = XenOption::getInstance();
+    
     ptrVoc = ptrVocab;
     ptrID = ptrInCorp;
     ptrOOD = ptrOutCorp;
     
+    ptrIdTfIdf = boost::make_shared<std::map<std::string, float> >();
+    ptrOodTfIdf = boost::make_shared<std::map<std::string, float> >();
+    ptrWords = boost::make_shared<std::vector<std::string> >();
+    ptrIdTf = boost::make_shared<std::map<std::string, int> >();
+    ptrOodTf = boost::make_shared<std::map<std::string, int> >();
+    ptrVecWords = boost::make_shared<std::vector<std::string> >(opt->getVecSize(), "");
+    ptrIdVecTfIdf = boost::make_shared<std::vector<float> >(opt->getVecSize(), 0.0);
+    ptrOodVecIdf = boost::make_shared<std::vector<float> >(opt->getVecSize(), 0.0);
+    ptrOodSimilarity = boost::make_shared<SimMap>();
+    
+    boost::shared_ptr<RunStats> ptrStats = StaticData::getInstance()->getRunStats();
+    int stage = ptrStats->startStage("sim:" + ptrOutCorp->getXenFile()->getFullPath());
+    
     loadWords();
     computeInDomainTFIDF();
     computeOutOfDomainTFIDF();
     buildIDVector();
     computeOutOfDomainIDF();
     computeSimilarity();
+    
+    ptrStats->endStage(stage, ptrOutCorp->getSize(), ptrOutCorp->getWC());
 }
 
 Similarity::~Similarity() {
@@ -62,10 +80,9 @@ unsigned int Similarity::getSize() const {
 void Similarity::loadWords() {
     std::cout << "Loading vocab words for similarity vector building." << std::endl;
     
-    std::map<std::string, int> tmp = ptrVoc->getXenVocab();
+    const std::vector<std::string> &words = ptrVoc->getWords();
     
-    for (std::map<std::string,int>::iterator it = tmp.begin(); it != tmp.end(); ++it)
-        ptrWords->push_back(it->first);
+    ptrWords->assign(words.begin(), words.end());
     
     std::cout << "Done loading vocab words for similarity vector building." << std::endl;
 }
@@ -73,59 +90,53 @@ void Similarity::loadWords() {
 void Similarity::computeInDomainTFIDF() {
     std::cout << "Computing in-domain TF-IDF." << std::endl;
     
-    std::map<std::string, int> tmpIdIDF;
-    std::map<std::string, int> tmpOodIDF;
-    
-    for (unsigned int i = 0; i < ptrWords->size(); i++) {
-        ptrIdTf->operator[](ptrWords->operator[](i)) = 0;
-        tmpIdIDF[ptrWords->operator[](i)] = 0;
-        tmpOodIDF[ptrWords->operator[](i)] = 0;
-        ptrIdTfIdf->operator[](ptrWords->operator[](i)) = 0.0;
-    }
+    unsigned int nbWords = (unsigned int)ptrWords->size();
+    std::vector<int> tf(nbWords, 0);
+    std::vector<int> tmpIdIDF(nbWords, 0);
+    std::vector<int> tmpOodIDF(nbWords, 0);
+    std::vector<int> lastLine(nbWords, -1);
+    Tokenizer words;
+    Token tok;
     
     for (unsigned int i = 0; i < ptrID->getSize(); i++) {
-        std::vector<std::string> lWords;
         std::string line = ptrID->getLine(i);
         
-        boost::split(lWords, line, boost::is_any_of(" "));
+        words.reset(line);
         
-        for (unsigned int j = 0; j < lWords.size(); j++) {
-            int found = (int)tmpIdIDF.count(lWords[j]);
+        while (words.next(tok)) {
+            int id = ptrVoc->getID(tok.hash);
             
-            if (found == 1) {
-                tmpIdIDF[lWords[j]] = 1;
-                ptrIdTf->operator[](lWords[j]) = ptrIdTf->operator[](lWords[j]) + 1;
+            if (id >= 0) {
+                tmpIdIDF[id] = 1;
+                tf[id] = tf[id] + 1;
             }
         }
     }
 
     for (unsigned int i = 0; i < ptrOOD->getSize(); i++) {
-        std::map<std::string, int> lineIDF;
-        std::vector<std::string> lWords;
         std::string line = ptrOOD->getLine(i);
         
-        boost::split(lWords, line, boost::is_any_of(" "));
-        
-        for (unsigned int j = 0; j < lWords.size(); j++) {
-            lineIDF[lWords[j]] = 0;
-        }
+        words.reset(line);
         
-        for (std::map<std::string, int>::iterator it = lineIDF.begin(); it != lineIDF.end(); ++it) {
-            int found = (int)tmpOodIDF.count(it->first);
+        // Each word counts once per line
+        while (words.next(tok)) {
+            int id = ptrVoc->getID(tok.hash);
             
-            if (found == 1) {
-                tmpOodIDF[it->first] = tmpOodIDF[it->first] + 1;
+            if (id >= 0 && lastLine[id] != (int)i) {
+                lastLine[id] = (int)i;
+                tmpOodIDF[id] = tmpOodIDF[id] + 1;
             }
         }
     }
     
     int nbDocs = ptrOOD->getSize() + 1;
     
-    for (unsigned int i = 0; i < ptrWords->size(); i++) {
+    for (unsigned int i = 0; i < nbWords; i++) {
         float IDF = 0.0;
-        if (tmpIdIDF[ptrWords->operator[](i)] + tmpOodIDF[ptrWords->operator[](i)] != 0)
-            IDF = log((float)nbDocs / (float)(tmpIdIDF[ptrWords->operator[](i)] + tmpOodIDF[ptrWords->operator[](i)]));
-        ptrIdTfIdf->operator[](ptrWords->operator[](i)) = (float)ptrIdTf->operator[](ptrWords->operator[](i)) * (float)IDF;
+        if (tmpIdIDF[i] + tmpOodIDF[i] != 0)
+            IDF = log((float)nbDocs / (float)(tmpIdIDF[i] + tmpOodIDF[i]));
+        ptrIdTf->operator[](ptrWords->operator[](i)) = tf[i];
+        ptrIdTfIdf->operator[](ptrWords->operator[](i)) = (float)tf[i] * (float)IDF;
     }
     
     /** @todo DEBUG, needs more testing */
@@ -133,8 +144,8 @@ void Similarity::computeInDomainTFIDF() {
     
     std::ofstream out(outName.c_str(), std::ios::out | std::ios::trunc);
     
-    for (unsigned int i = 0; i < ptrWords->size(); i++) {
-        out << ptrWords->operator[](i) << '\t' << ptrIdTf->operator[](ptrWords->operator[](i)) << " --- " << tmpIdIDF[ptrWords->operator[](i)] << " --- " << tmpOodIDF[ptrWords->operator[](i)] << " --> " << ptrIdTfIdf->operator[](ptrWords->operator[](i)) << std::endl;
+    for (unsigned int i = 0; i < nbWords; i++) {
+        out << ptrWords->operator[](i) << '\t' << tf[i] << " --- " << tmpIdIDF[i] << " --- " << tmpOodIDF[i] << " --> " << ptrIdTfIdf->operator[](ptrWords->operator[](i)) << std::endl;
     }
     
     out.close();
@@ -145,59 +156,53 @@ void Similarity::computeInDomainTFIDF() {
 void Similarity::computeOutOfDomainTFIDF() {
     std::cout << "Computing out-of-domain TF-IDF." << std::endl;
     
-    std::map<std::string, int> tmpIdIDF;
-    std::map<std::string, int> tmpOodIDF;
-    
-    for (unsigned int i = 0; i < ptrWords->size(); i++) {
-        ptrOodTf->operator[](ptrWords->operator[](i)) = 0;
-        tmpIdIDF[ptrWords->operator[](i)] = 0;
-        tmpOodIDF[ptrWords->operator[](i)] = 0;
-        ptrOodTfIdf->operator[](ptrWords->operator[](i)) = 0.0;
-    }
+    unsigned int nbWords = (unsigned int)ptrWords->size();
+    std::vector<int> tf(nbWords, 0);
+    std::vector<int> tmpOodIDF(nbWords, 0);
+    std::vector<int> tmpIdIDF(nbWords, 0);
+    std::vector<int> lastLine(nbWords, -1);
+    Tokenizer words;
+    Token tok;
     
     for (unsigned int i = 0; i < ptrOOD->getSize(); i++) {
-        std::vector<std::string> lWords;
         std::string line = ptrOOD->getLine(i);
         
-        boost::split(lWords, line, boost::is_any_of(" "));
+        words.reset(line);
         
-        for (unsigned int j = 0; j < lWords.size(); j++) {
-            int found = (int)tmpOodIDF.count(lWords[j]);
+        while (words.next(tok)) {
+            int id = ptrVoc->getID(tok.hash);
             
-            if (found == 1) {
-                tmpOodIDF[lWords[j]] = 1;
-                ptrOodTf->operator[](lWords[j]) = ptrOodTf->operator[](lWords[j]) + 1;
+            if (id >= 0) {
+                tmpOodIDF[id] = 1;
+                tf[id] = tf[id] + 1;
             }
         }
     }
-    
+
     for (unsigned int i = 0; i < ptrID->getSize(); i++) {
-        std::map<std::string, int> lineIDF;
-        std::vector<std::string> lWords;
         std::string line = ptrID->getLine(i);
         
-        boost::split(lWords, line, boost::is_any_of(" "));
-        
-        for (unsigned int j = 0; j < lWords.size(); j++) {
-            lineIDF[lWords[j]] = 0;
-        }
+        words.reset(line);
         
-        for (std::map<std::string, int>::iterator it = lineIDF.begin(); it != lineIDF.end(); ++it) {
-            int found = (int)tmpIdIDF.count(it->first);
+        // Each word counts once per line
+        while (words.next(tok)) {
+            int id = ptrVoc->getID(tok.hash);
             
-            if (found == 1) {
-                tmpIdIDF[it->first] = tmpIdIDF[it->first] + 1;
+            if (id >= 0 && lastLine[id] != (int)i) {
+                lastLine[id] = (int)i;
+                tmpIdIDF[id] = tmpIdIDF[id] + 1;
             }
         }
     }
     
     int nbDocs = ptrID->getSize() + 1;
     
-    for (unsigned int i = 0; i < ptrWords->size(); i++) {
+    for (unsigned int i = 0; i < nbWords; i++) {
         float IDF = 0.0;
-        if (tmpIdIDF[ptrWords->operator[](i)] + tmpOodIDF[ptrWords->operator[](i)] != 0)
-            IDF = log((float)nbDocs / (float)(tmpIdIDF[ptrWords->operator[](i)] + tmpOodIDF[ptrWords->operator[](i)]));
-        ptrOodTfIdf->operator[](ptrWords->operator[](i)) = (float)ptrOodTf->operator[](ptrWords->operator[](i)) * (float)IDF;
+        if (tmpOodIDF[i] + tmpIdIDF[i] != 0)
+            IDF = log((float)nbDocs / (float)(tmpOodIDF[i] + tmpIdIDF[i]));
+        ptrOodTf->operator[](ptrWords->operator[](i)) = tf[i];
+        ptrOodTfIdf->operator[](ptrWords->operator[](i)) = (float)tf[i] * (float)IDF;
     }
     
     /** @todo DEBUG, needs more testing */
@@ -205,8 +210,8 @@ void Similarity::computeOutOfDomainTFIDF() {
     
     std::ofstream out(outName.c_str(), std::ios::out | std::ios::trunc);
     
-    for (unsigned int i = 0; i < ptrWords->size(); i++) {
-        out << ptrWords->operator[](i) << '\t' << ptrOodTf->operator[](ptrWords->operator[](i)) << " --- " << tmpOodIDF[ptrWords->operator[](i)] << " --- " << tmpIdIDF[ptrWords->operator[](i)] << " --> " << ptrOodTfIdf->operator[](ptrWords->operator[](i)) << std::endl;
+    for (unsigned int i = 0; i < nbWords; i++) {
+        out << ptrWords->operator[](i) << '\t' << tf[i] << " --- " << tmpOodIDF[i] << " --- " << tmpIdIDF[i] << " --> " << ptrOodTfIdf->operator[](ptrWords->operator[](i)) << std::endl;
     }
     
     out.close();
@@ -230,7 +235,7 @@ void Similarity::buildIDVector() {
     float idFreqThres = (float)ptrID->getSize() / 300; // Threshold 0,33% of words is the same
     float oodFreqThres = (float)ptrOOD->getSize() / 300; // Threshold 0,33% of words is the same
     
-    for (std::multimap<float, std::string, std::greater<float> >::iterator it = meanTFIDFByScore.begin(); count < opt->getVecSize(); ++it) {
+    for (std::multimap<float, std::string, std::greater<float> >::iterator it = meanTFIDFByScore.begin(); count < opt->getVecSize() && it != meanTFIDFByScore.end(); ++it) {
         count++;
         
         int idTf = ptrIdTf->operator[](it->second);
@@ -263,36 +268,36 @@ void Similarity::computeOutOfDomainIDF() {
     std::cout << "Computing out-of-domain IDF." << std::endl;
     
     int nbDocs = ptrOOD->getSize();
-    std::map<std::string, int> tmpIDF;
+    boost::unordered_map<uint64_t, unsigned int> slots;
+    std::vector<unsigned int> slotOf;
     
-    for (unsigned int i = 0; i < ptrVecWords->size(); i++) {
-        tmpIDF[ptrVecWords->operator[](i)] = 0;
-    }
+    mapVecWords(slots, slotOf);
+    
+    std::vector<int> tmpIDF(slots.size(), 0);
+    std::vector<int> lastLine(slots.size(), -1);
+    Tokenizer words;
+    Token tok;
     
     for (unsigned int i = 0; i < ptrOOD->getSize(); i++) {
-        std::map<std::string, int> lineIDF;
-        std::vector<std::string> lWords;
         std::string line = ptrOOD->getLine(i);
         
-        boost::split(lWords, line, boost::is_any_of(" "));
-        
-        for (unsigned int j = 0; j < lWords.size(); j++) {
-            lineIDF[lWords[j]] = 0;
-        }
+        words.reset(line);
         
-        for (std::map<std::string, int>::iterator it = lineIDF.begin(); it != lineIDF.end(); ++it) {
-            int found = (int)tmpIDF.count(it->first);
+        // Each word counts once per line
+        while (words.next(tok)) {
+            boost::unordered_map<uint64_t, unsigned int>::const_iterator it = slots.find(tok.hash);
             
-            if (found == 1) {
-                tmpIDF[it->first] = tmpIDF[it->first] + 1;
+            if (it != slots.end() && lastLine[it->second] != (int)i) {
+                lastLine[it->second] = (int)i;
+                tmpIDF[it->second] = tmpIDF[it->second] + 1;
             }
         }
     }
     
     for (unsigned int i = 0; i < ptrVecWords->size(); i++) {
         float IDF = 0.0;
-        if (tmpIDF[ptrVecWords->operator[](i)] != 0)
-            IDF = log((float)nbDocs / (float)tmpIDF[ptrVecWords->operator[](i)]);
+        if (tmpIDF[slotOf[i]] != 0)
+            IDF = log((float)nbDocs / (float)tmpIDF[slotOf[i]]);
         ptrOodVecIdf->operator[](i) = IDF;
     }
     
@@ -313,23 +318,27 @@ void Similarity::computeOutOfDomainIDF() {
 void Similarity::computeSimilarity() {
     std::cout << "Computing similarity scores." << std::endl;
 
+    boost::unordered_map<uint64_t, unsigned int> slots;
+    std::vector<unsigned int> slotOf;
+    
+    mapVecWords(slots, slotOf);
+    
+    std::vector<int> tmpTF(slots.size(), 0);
+    Tokenizer words;
+    Token tok;
+
     for (unsigned int i = 0; i < ptrOOD->getSize(); i++) {
-        std::map<std::string, int> tmpTF;
+        std::fill(tmpTF.begin(), tmpTF.end(), 0);
         
-        for (unsigned int j = 0; j < ptrVecWords->size(); j++) {
-            tmpTF[ptrVecWords->operator[](j)] = 0;
-        }
-        
-        std::vector<std::string> lWords;
         std::string line = ptrOOD->getLine(i);
         
-        boost::split(lWords, line, boost::is_any_of(" "));
+        words.reset(line);
         
-        for (unsigned int j = 0; j < lWords.size(); j++) {
-            std::map<std::string, int>::const_iterator mit(tmpTF.find(lWords[j])), mend(tmpTF.end());
+        while (words.next(tok)) {
+            boost::unordered_map<uint64_t, unsigned int>::const_iterator it = slots.find(tok.hash);
             
-            if(mit != mend)
-                tmpTF[lWords[j]] = tmpTF[lWords[j]] + 1;
+            if (it != slots.end())
+                tmpTF[it->second] = tmpTF[it->second] + 1;
         }
         
         float sumAiBi = 0.0;
@@ -337,7 +346,7 @@ void Similarity::computeSimilarity() {
         float sumBiSQ = 0.0;
         
         for (unsigned int j = 0; j < ptrVecWords->size(); j++) {
-            float oodTfIdf = (float)tmpTF[ptrVecWords->operator[](j)] * (float)ptrOodVecIdf->operator[](j);
+            float oodTfIdf = (float)tmpTF[slotOf[j]] * (float)ptrOodVecIdf->operator[](j);
             float idTfIdf = ptrIdVecTfIdf->operator[](j);
             sumAiBi = sumAiBi + (idTfIdf * oodTfIdf);
             sumAiSQ = sumAiSQ + (idTfIdf * idTfIdf);
@@ -355,3 +364,19 @@ void Similarity::computeSimilarity() {
     
     std::cout << "Done computing similarity scores." << std::endl;
 }
+
+void Similarity::mapVecWords(boost::unordered_map<uint64_t, unsigned int> &slots, std::vector<unsigned int> &slotOf) {
+    slots.clear();
+    slotOf.resize(ptrVecWords->size());
+    
+    // The vector may hold a word more than once (empty slots), they share their counts
+    for (unsigned int j = 0; j < ptrVecWords->size(); j++) {
+        uint64_t h = Tokenizer::hash(ptrVecWords->operator[](j));
+        boost::unordered_map<uint64_t, unsigned int>::iterator it = slots.find(h);
+        
+        if (it == slots.end())
+            it = slots.insert(std::make_pair(h, (unsigned int)slots.size())).first;
+        
+        slotOf[j] = it->second;
+    }
+}
@@ -40,22 +40,23 @@ boost::shared_ptr<VocabPair> StaticData::ptrVocabs;
 boost::shared_ptr<PPLPair> StaticData::ptrSourcePPL;
 boost::shared_ptr<PPLPair> StaticData::ptrTargetPPL;
 boost::shared_ptr<PhraseTablePair> StaticData::ptrPTPair;
-boost::shared_ptr<MeanLMPair> StaticData::ptrMeanSourceLM;
-boost::shared_ptr<MeanLMPair> StaticData::ptrMeanTargetLM;
-boost::shared_ptr<MeanPPLPair> StaticData::ptrMeanSourcePPL;
-boost::shared_ptr<MeanPPLPair> StaticData::ptrMeanTargetPPL;
+boost::shared_ptr<LMEnsemble> StaticData::ptrSourceEnsemble;
+boost::shared_ptr<LMEnsemble> StaticData::ptrTargetEnsemble;
 boost::shared_ptr<CorpusPair> StaticData::ptrStemSourceCorp;
 boost::shared_ptr<CorpusPair> StaticData::ptrStemTargetCorp;
 boost::shared_ptr<LMPair> StaticData::ptrStemSourceLM;
 boost::shared_ptr<LMPair> StaticData::ptrStemTargetLM;
 boost::shared_ptr<VocabPair> StaticData::ptrStemVocabs;
-boost::shared_ptr<PPLPair> StaticData::ptrStemSourcePPL;
-boost::shared_ptr<PPLPair> StaticData::ptrStemTargetPPL;
+boost::shared_ptr<FactoredPPL> StaticData::ptrFactoredSourcePPL;
+boost::shared_ptr<FactoredPPL> StaticData::ptrFactoredTargetPPL;
 boost::shared_ptr<Similarity> StaticData::ptrSim;
-boost::shared_ptr<ScoreHolder> StaticData::ptrScHold;
+boost::shared_ptr<ScoreTable> StaticData::ptrScHold;
 boost::shared_ptr<Wfile> StaticData::ptrWeightsFile;
 boost::shared_ptr<XenResult> StaticData::ptrXenResult;
 boost::shared_ptr<Corpus> StaticData::ptrDevCorp;
+boost::shared_ptr<ScoreStore> StaticData::ptrScoreStore;
+boost::shared_ptr<Checkpoint> StaticData::ptrCheckpoint;
+boost::shared_ptr<RunStats> StaticData::ptrRunStats;
 
 StaticData* StaticData::getInstance() {
     if (_instance == NULL)
@@ -78,22 +79,23 @@ StaticData::StaticData() {
     StaticData::ptrSourcePPL = boost::make_shared<PPLPair>();
     StaticData::ptrTargetPPL = boost::make_shared<PPLPair>();
     StaticData::ptrPTPair = boost::make_shared<PhraseTablePair>();
-    StaticData::ptrMeanSourceLM = boost::make_shared<MeanLMPair>();
-    StaticData::ptrMeanTargetLM = boost::make_shared<MeanLMPair>();
-    StaticData::ptrMeanSourcePPL = boost::make_shared<MeanPPLPair>();
-    StaticData::ptrMeanTargetPPL = boost::make_shared<MeanPPLPair>();
+    StaticData::ptrSourceEnsemble = boost::make_shared<LMEnsemble>();
+    StaticData::ptrTargetEnsemble = boost::make_shared<LMEnsemble>();
     StaticData::ptrStemSourceCorp = boost::make_shared<CorpusPair>();
     StaticData::ptrStemTargetCorp = boost::make_shared<CorpusPair>();
-    StaticData::ptrSourceLM = boost::make_shared<LMPair>();
-    StaticData::ptrTargetLM = boost::make_shared<LMPair>();
+    StaticData::ptrStemSourceLM = boost::make_shared<LMPair>();
+    StaticData::ptrStemTargetLM = boost::make_shared<LMPair>();
     StaticData::ptrStemVocabs = boost::make_shared<VocabPair>();
-    StaticData::ptrStemSourcePPL = boost::make_shared<PPLPair>();
-    StaticData::ptrStemTargetPPL = boost::make_shared<PPLPair>();
+    StaticData::ptrFactoredSourcePPL = boost::make_shared<FactoredPPL>();
+    StaticData::ptrFactoredTargetPPL = boost::make_shared<FactoredPPL>();
     StaticData::ptrSim = boost::make_shared<Similarity>();
-    StaticData::ptrScHold = boost::make_shared<ScoreHolder>();
+    StaticData::ptrScHold = boost::make_shared<ScoreTable>();
     StaticData::ptrWeightsFile = boost::make_shared<Wfile>();
     StaticData::ptrXenResult = boost::make_shared<XenResult>();
     StaticData::ptrDevCorp = boost::make_shared<Corpus>();
+    StaticData::ptrScoreStore = boost::make_shared<ScoreStore>();
+    StaticData::ptrCheckpoint = boost::make_shared<Checkpoint>();
+    StaticData::ptrRunStats = boost::make_shared<RunStats>();
 }
 
 StaticData::~StaticData() {
@@ -108,19 +110,20 @@ boost::shared_ptr<VocabPair> StaticData::getVocabs() { return ptrVocabs; }
 boost::shared_ptr<PPLPair> StaticData::getSourcePPLs() { return ptrSourcePPL; }
 boost::shared_ptr<PPLPair> StaticData::getTargetPPLs() { return ptrTargetPPL; }
 boost::shared_ptr<PhraseTablePair> StaticData::getPTPairs() { return ptrPTPair; }
-boost::shared_ptr<MeanLMPair> StaticData::getMeanSourceLMs() { return ptrMeanSourceLM; }
-boost::shared_ptr<MeanLMPair> StaticData::getMeanTargetLMs() { return ptrMeanTargetLM; }
-boost::shared_ptr<MeanPPLPair> StaticData::getMeanSourcePPLs() { return ptrMeanSourcePPL; }
-boost::shared_ptr<MeanPPLPair> StaticData::getMeanTargetPPLs() { return ptrMeanTargetPPL; }
+boost::shared_ptr<LMEnsemble> StaticData::getSourceEnsemble() { return ptrSourceEnsemble; }
+boost::shared_ptr<LMEnsemble> StaticData::getTargetEnsemble() { return ptrTargetEnsemble; }
 boost::shared_ptr<CorpusPair> StaticData::getStemSourceCorps() { return ptrStemSourceCorp; }
 boost::shared_ptr<CorpusPair> StaticData::getStemTargetCorps() { return ptrStemTargetCorp; }
 boost::shared_ptr<LMPair> StaticData::getStemSourceLMs() { return ptrStemSourceLM; }
 boost::shared_ptr<LMPair> StaticData::getStemTargetLMs() { return ptrStemTargetLM; }
 boost::shared_ptr<VocabPair> StaticData::getStemVocabs() { return ptrStemVocabs; }
-boost::shared_ptr<PPLPair> StaticData::getStemSourcePPLs() { return ptrStemSourcePPL; }
-boost::shared_ptr<PPLPair> StaticData::getStemTargetPPLs() { return ptrStemTargetPPL; }
+boost::shared_ptr<FactoredPPL> StaticData::getFactoredSourcePPL() { return ptrFactoredSourcePPL; }
+boost::shared_ptr<FactoredPPL> StaticData::getFactoredTargetPPL() { return ptrFactoredTargetPPL; }
 boost::shared_ptr<Similarity> StaticData::getSim() { return ptrSim; }
-boost::shared_ptr<ScoreHolder> StaticData::getScHold() { return ptrScHold; }
+boost::shared_ptr<ScoreTable> StaticData::getScHold() { return ptrScHold; }
 boost::shared_ptr<Wfile> StaticData::getWeightsFile() { return ptrWeightsFile; }
 boost::shared_ptr<XenResult> StaticData::getXenResult() { return ptrXenResult; }
 boost::shared_ptr<Corpus> StaticData::getDevCorp() { return ptrDevCorp; }
+boost::shared_ptr<ScoreStore> StaticData::getScoreStore() { return ptrScoreStore; }
+boost::shared_ptr<Checkpoint> StaticData::getCheckpoint() { return ptrCheckpoint; }
+boost::shared_ptr<RunStats> StaticData::getRunStats() { return ptrRunStats; }
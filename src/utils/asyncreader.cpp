@@ -0,0 +1,142 @@
+/**
+ *  @file asyncreader.cpp
+ *  @brief Class reading a file in blocks of whole lines from a background thread
+ *  @author Anthony Rousseau
+ *  @version 2.0.0
+ *  @date 19 October 2026
+ */
+
+
+/*  This file is part of the cross-entropy tool for data selection (XenC)
+ *  aimed at speech recognition and statistical machine translation.
+ *
+ *  Copyright 2013-2016, Anthony Rousseau, LIUM, University of Le Mans, France
+ *
+ *  Development of the XenC tool has been partially funded by the
+ *  European Commission under the MateCat project.
+ *
+ *  The XenC tool is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation
+ *
+ *  This library is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "../../include/utils/asyncreader.h"
+
+#include <algorithm>
+#include <fstream>
+
+#include <boost/bind.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+
+AsyncReader::AsyncReader(std::size_t blockSize, std::size_t depth) : queue(depth) {
+    this->blockSize = blockSize;
+    done = true;
+}
+
+AsyncReader::~AsyncReader() {
+    // The reader thread may be blocked on a full queue
+    while (!done)
+        done = !queue.Consume();
+    
+    if (thread.joinable())
+        thread.join();
+}
+
+void AsyncReader::open(boost::shared_ptr<XenFile> ptrFile) {
+    this->ptrFile = ptrFile;
+    error = "";
+    done = false;
+    
+    thread = boost::thread(boost::bind(&AsyncReader::run, this));
+}
+
+TextBlock AsyncReader::next() {
+    if (done)
+        return TextBlock();
+    
+    TextBlock ptrBlock = queue.Consume();
+    
+    if (!ptrBlock) {
+        done = true;
+        thread.join();
+        
+        if (!error.empty())
+            throw XenCommon::XenCEption(error);
+    }
+    
+    return ptrBlock;
+}
+
+void AsyncReader::run() {
+    try {
+        std::ifstream f(ptrFile->getFullPath().c_str(), std::ios_base::in | std::ios_base::binary);
+        
+        if (!f.is_open())
+            throw XenCommon::XenCEption("Error while opening file " + ptrFile->getFullPath());
+        
+        try {
+            boost::iostreams::filtering_istream in;
+            if (ptrFile->isGZ())
+                in.push(boost::iostreams::gzip_decompressor());
+            in.push(f);
+            
+            std::vector<char> carry;
+            bool end = false;
+            
+            while (!end) {
+                // A block starts with the end of the last line of the previous one
+                TextBlock ptrBlock = boost::make_shared<std::vector<char> >();
+                ptrBlock->swap(carry);
+                
+                std::size_t start = ptrBlock->size();
+                ptrBlock->resize(start + blockSize);
+                in.read(&ptrBlock->operator[](start), (std::streamsize)blockSize);
+                ptrBlock->resize(start + (std::size_t)in.gcount());
+                
+                end = !in;
+                
+                if (f.bad())
+                    throw XenCommon::XenCEption("Error while reading file " + ptrFile->getFullPath());
+                
+                if (end) {
+                    if (!ptrBlock->empty() && ptrBlock->back() != '\n')
+                        ptrBlock->push_back('\n');
+                }
+                else {
+                    std::vector<char>::reverse_iterator nl = std::find(ptrBlock->rbegin(), ptrBlock->rend(), '\n');
+                    
+                    // A line longer than a block is carried over whole
+                    if (nl == ptrBlock->rend()) {
+                        carry.swap(*ptrBlock);
+                        continue;
+                    }
+                    
+                    carry.assign(nl.base(), ptrBlock->end());
+                    ptrBlock->erase(nl.base(), ptrBlock->end());
+                }
+                
+                if (!ptrBlock->empty())
+                    queue.Produce(ptrBlock);
+            }
+        }
+        catch(boost::iostreams::gzip_error &e) {
+            std::cout << e.what() << std::endl;
+        }
+    } catch (XenCommon::XenCEption &e) {
+        error = e.what();
+    }
+    
+    // End of the file
+    queue.Produce(TextBlock());
+}
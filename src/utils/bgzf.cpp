@@ -0,0 +1,431 @@
+/**
+ *  @file bgzf.cpp
+ *  @brief Block gzip (BGZF) writing, parallel reading and line index
+ *  @author Anthony Rousseau
+ *  @version 2.0.0
+ *  @date 19 October 2026
+ */
+
+
+/*  This file is part of the cross-entropy tool for data selection (XenC)
+ *  aimed at speech recognition and statistical machine translation.
+ *
+ *  Copyright 2013-2016, Anthony Rousseau, LIUM, University of Le Mans, France
+ *
+ *  Development of the XenC tool has been partially funded by the
+ *  European Commission under the MateCat project.
+ *
+ *  The XenC tool is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation
+ *
+ *  This library is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "../../include/utils/bgzf.h"
+#include "../../include/utils/scheduler.h"
+
+#include <cstring>
+#include <algorithm>
+
+#include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
+
+#include <zlib.h>
+
+static const char indexMagic[8] = { 'X', 'E', 'N', 'C', 'B', 'G', 'Z', 'I' };
+
+static const unsigned char bgzfEOF[28] = {
+    0x1f, 0x8b, 0x08, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0x06, 0x00, 0x42, 0x43,
+    0x02, 0x00, 0x1b, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+static const std::size_t headerSize = 18;   //!< Size of a BGZF member header
+static const std::size_t footerSize = 8;    //!< Size of a member CRC32 and ISIZE
+
+/**
+ *  @struct BgzfMember
+ *  @brief A member of a BGZF file being read
+ */
+struct BgzfMember {
+    std::size_t coff;       //!< Offset of the member in the compressed data
+    std::size_t csize;      //!< Size of the whole member
+    std::size_t uoff;       //!< Offset of its data in the uncompressed text
+    std::size_t usize;      //!< Size of its uncompressed data
+};
+
+static uint32_t readLE32(const unsigned char* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void writeLE32(unsigned char* p, uint32_t v) {
+    p[0] = (unsigned char)(v & 0xff);
+    p[1] = (unsigned char)((v >> 8) & 0xff);
+    p[2] = (unsigned char)((v >> 16) & 0xff);
+    p[3] = (unsigned char)((v >> 24) & 0xff);
+}
+
+/*
+ * Returns the size of the BGZF member starting at p, 0 if it is not one
+ */
+static std::size_t memberSize(const unsigned char* p, std::size_t avail) {
+    if (avail < headerSize || p[0] != 0x1f || p[1] != 0x8b || p[2] != 8 || !(p[3] & 4))
+        return 0;
+    
+    std::size_t xlen = (std::size_t)p[10] | ((std::size_t)p[11] << 8);
+    if (avail < 12 + xlen)
+        return 0;
+    
+    for (std::size_t i = 12; i + 4 <= 12 + xlen; ) {
+        std::size_t slen = (std::size_t)p[i + 2] | ((std::size_t)p[i + 3] << 8);
+        if (p[i] == 'B' && p[i + 1] == 'C' && slen == 2)
+            return ((std::size_t)p[i + 4] | ((std::size_t)p[i + 5] << 8)) + 1;
+        i += 4 + slen;
+    }
+    
+    return 0;
+}
+
+/*
+ * Inflates the members of a BGZF file in [first, last) into their place in out, throwing on a corrupted member
+ */
+static void taskInflate(std::string fileName, const std::vector<unsigned char>* data, const std::vector<BgzfMember>* members, char* out, unsigned int first, unsigned int last) {
+    for (unsigned int m = first; m < last; m++) {
+        const BgzfMember &mb = (*members)[m];
+        const unsigned char* p = &(*data)[mb.coff];
+        std::size_t xlen = (std::size_t)p[10] | ((std::size_t)p[11] << 8);
+        std::size_t start = 12 + xlen;
+        
+        if (mb.usize == 0)
+            continue;
+        
+        z_stream zs;
+        std::memset(&zs, 0, sizeof(zs));
+        
+        if (inflateInit2(&zs, -15) != Z_OK)
+            throw XenCommon::XenCEption("Error while decompressing file " + fileName);
+        
+        zs.next_in = const_cast<Bytef*>(p + start);
+        zs.avail_in = (uInt)(mb.csize - start - footerSize);
+        zs.next_out = reinterpret_cast<Bytef*>(out + mb.uoff);
+        zs.avail_out = (uInt)mb.usize;
+        
+        int ret = inflate(&zs, Z_FINISH);
+        inflateEnd(&zs);
+        
+        if (ret != Z_STREAM_END || zs.avail_out != 0 || crc32(crc32(0L, Z_NULL, 0), reinterpret_cast<Bytef*>(out + mb.uoff), (uInt)mb.usize) != readLE32(p + mb.csize - footerSize))
+            throw XenCommon::XenCEption("Error while decompressing file " + fileName);
+    }
+}
+
+/*
+ * Reads a whole file into data
+ */
+static void readFile(std::string fileName, std::vector<unsigned char> &data) {
+    std::ifstream f(fileName.c_str(), std::ios_base::in | std::ios_base::binary);
+    
+    if (!f.is_open())
+        throw XenCommon::XenCEption("Error while opening file " + fileName);
+    
+    data.resize((std::size_t)boost::filesystem::file_size(fileName.c_str()));
+    
+    if (!data.empty())
+        f.read(reinterpret_cast<char*>(&data[0]), (std::streamsize)data.size());
+    
+    if (f.bad() || f.gcount() != (std::streamsize)data.size())
+        throw XenCommon::XenCEption("Error while reading file " + fileName);
+}
+
+/*
+ * Lists the members of a BGZF file, from their headers and trailers
+ */
+static void listMembers(std::string fileName, const std::vector<unsigned char> &data, std::size_t from, std::size_t to, std::vector<BgzfMember> &members, std::size_t uoff) {
+    members.clear();
+    
+    for (std::size_t pos = from; pos < to; ) {
+        std::size_t size = memberSize(&data[pos], data.size() - pos);
+        
+        if (size < headerSize + footerSize || pos + size > data.size())
+            throw XenCommon::XenCEption("File " + fileName + " is not a valid block gzip file.");
+        
+        BgzfMember mb;
+        mb.coff = pos;
+        mb.csize = size;
+        mb.uoff = uoff;
+        mb.usize = readLE32(&data[pos + size - 4]);
+        members.push_back(mb);
+        
+        uoff += mb.usize;
+        pos += size;
+    }
+}
+
+/*
+ * Inflates listed members into buf, in parallel
+ */
+static void inflateMembers(std::string fileName, const std::vector<unsigned char> &data, const std::vector<BgzfMember> &members, std::vector<char> &buf) {
+    std::size_t base = buf.size();
+    std::size_t total = members.empty() ? 0 : members.back().uoff + members.back().usize - members.front().uoff;
+    
+    buf.resize(base + total);
+    
+    if (total == 0)
+        return;
+    
+    std::vector<BgzfMember> local(members);
+    std::size_t shift = members.front().uoff;
+    for (unsigned int m = 0; m < local.size(); m++)
+        local[m].uoff = local[m].uoff - shift;
+    
+    // A corrupted member is rethrown here by the scheduler
+    Scheduler::parallelFor(0, (unsigned int)local.size(), 16, boost::bind(&taskInflate, fileName, &data, &local, &buf[base], _1, _2));
+}
+
+BgzfSink::BgzfSink(std::string fileName) : ptrState(new BgzfState()) {
+    ptrState->fileName = fileName;
+    ptrState->coff = 0;
+    ptrState->uoff = 0;
+    ptrState->lines = 0;
+    ptrState->closed = false;
+    ptrState->out.open(fileName.c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+    
+    if (!ptrState->out.is_open())
+        throw XenCommon::XenCEption("Can't open " + fileName + " for writing.");
+}
+
+std::streamsize BgzfSink::write(const char* s, std::streamsize n) {
+    BgzfState &st = *ptrState;
+    
+    st.pending.insert(st.pending.end(), s, s + n);
+    
+    // Members end on the last newline they can hold, unless a line is too long
+    std::size_t start = 0;
+    while (st.pending.size() - start > Bgzf::maxMember) {
+        const char* b = &st.pending[start];
+        std::size_t cut = Bgzf::maxMember;
+        
+        for (std::size_t i = Bgzf::maxMember; i > 0; i--) {
+            if (b[i - 1] == '\n') {
+                cut = i;
+                break;
+            }
+        }
+        
+        Bgzf::writeMember(st, b, cut);
+        start += cut;
+    }
+    
+    st.pending.erase(st.pending.begin(), st.pending.begin() + start);
+    
+    return n;
+}
+
+void BgzfSink::close() {
+    BgzfState &st = *ptrState;
+    
+    if (st.closed)
+        return;
+    
+    st.closed = true;
+    
+    if (!st.pending.empty())
+        Bgzf::writeMember(st, &st.pending[0], st.pending.size());
+    st.pending.clear();
+    
+    st.out.write(reinterpret_cast<const char*>(bgzfEOF), sizeof(bgzfEOF));
+    st.coff += sizeof(bgzfEOF);
+    st.out.close();
+    
+    if (st.out.fail())
+        throw XenCommon::XenCEption("Error while writing file " + st.fileName);
+    
+    // The last entry holds the totals of the file
+    BgzfIndexEntry e;
+    e.coff = st.coff;
+    e.uoff = st.uoff;
+    e.line = st.lines;
+    st.index.push_back(e);
+    
+    std::string idxName = Bgzf::getIndexName(st.fileName);
+    std::ofstream idx(idxName.c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+    uint64_t count = st.index.size();
+    
+    idx.write(indexMagic, sizeof(indexMagic));
+    idx.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    idx.write(reinterpret_cast<const char*>(&st.index[0]), count * sizeof(BgzfIndexEntry));
+    idx.close();
+    
+    if (idx.fail())
+        throw XenCommon::XenCEption("Error while writing file " + idxName);
+}
+
+void Bgzf::writeMember(BgzfState &state, const char* data, std::size_t size) {
+    std::vector<unsigned char> block(headerSize + compressBound((uLong)size) + footerSize);
+    
+    z_stream zs;
+    std::memset(&zs, 0, sizeof(zs));
+    
+    int level = Z_DEFAULT_COMPRESSION;
+    std::size_t csize = 0;
+    
+    // Incompressible data is stored, so that every member fits in 64 KiB
+    for (;;) {
+        if (deflateInit2(&zs, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+            throw XenCommon::XenCEption("Can't initialize compression of " + state.fileName);
+        
+        zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+        zs.avail_in = (uInt)size;
+        zs.next_out = &block[headerSize];
+        zs.avail_out = (uInt)(block.size() - headerSize - footerSize);
+        
+        int ret = deflate(&zs, Z_FINISH);
+        csize = headerSize + zs.total_out + footerSize;
+        deflateEnd(&zs);
+        
+        if (ret != Z_STREAM_END)
+            throw XenCommon::XenCEption("Error while compressing " + state.fileName);
+        
+        if (csize <= 65536 || level == 0)
+            break;
+        
+        level = 0;
+    }
+    
+    static const unsigned char header[16] = { 0x1f, 0x8b, 0x08, 0x04, 0, 0, 0, 0, 0, 0xff, 0x06, 0x00, 'B', 'C', 0x02, 0x00 };
+    std::memcpy(&block[0], header, sizeof(header));
+    block[16] = (unsigned char)((csize - 1) & 0xff);
+    block[17] = (unsigned char)(((csize - 1) >> 8) & 0xff);
+    
+    writeLE32(&block[csize - footerSize], (uint32_t)crc32(crc32(0L, Z_NULL, 0), reinterpret_cast<const Bytef*>(data), (uInt)size));
+    writeLE32(&block[csize - 4], (uint32_t)size);
+    
+    BgzfIndexEntry e;
+    e.coff = state.coff;
+    e.uoff = state.uoff;
+    e.line = state.lines;
+    state.index.push_back(e);
+    
+    state.out.write(reinterpret_cast<const char*>(&block[0]), (std::streamsize)csize);
+    
+    state.coff += csize;
+    state.uoff += size;
+    state.lines += std::count(data, data + size, '\n');
+}
+
+bool Bgzf::isBgzf(std::string fileName) {
+    std::ifstream f(fileName.c_str(), std::ios_base::in | std::ios_base::binary);
+    unsigned char p[headerSize];
+    
+    f.read(reinterpret_cast<char*>(p), sizeof(p));
+    
+    return f.gcount() == (std::streamsize)sizeof(p) && memberSize(p, sizeof(p)) > 0;
+}
+
+void Bgzf::read(std::string fileName, std::vector<char> &buf) {
+    std::vector<unsigned char> data;
+    std::vector<BgzfMember> members;
+    
+    buf.clear();
+    
+    try {
+        readFile(fileName, data);
+        listMembers(fileName, data, 0, data.size(), members, 0);
+        inflateMembers(fileName, data, members, buf);
+    } catch (XenCommon::XenCEption &e) {
+        throw;
+    }
+}
+
+bool Bgzf::readLines(std::string fileName, uint64_t first, uint64_t last, std::vector<char> &buf) {
+    std::string idxName = getIndexName(fileName);
+    
+    if (!boost::filesystem::exists(idxName.c_str()))
+        return false;
+    
+    std::ifstream idx(idxName.c_str(), std::ios_base::in | std::ios_base::binary);
+    char magic[8];
+    uint64_t count = 0;
+    
+    idx.read(magic, sizeof(magic));
+    idx.read(reinterpret_cast<char*>(&count), sizeof(count));
+    
+    if (!idx.good() || !std::equal(magic, magic + sizeof(magic), indexMagic) || count == 0)
+        return false;
+    
+    std::vector<BgzfIndexEntry> index(count);
+    idx.read(reinterpret_cast<char*>(&index[0]), count * sizeof(BgzfIndexEntry));
+    
+    // An index older than its file is ignored
+    if (!idx.good() || index.back().coff != boost::filesystem::file_size(fileName.c_str()))
+        return false;
+    
+    if (first >= last || count == 1)
+        return true;
+    
+    // Members from the last one starting before line first, to the first one starting at line last
+    std::size_t lo = 0;
+    while (lo + 1 < count - 1 && index[lo + 1].line < first)
+        lo++;
+    
+    std::size_t hi = lo + 1;
+    while (hi < count - 1 && index[hi].line < last)
+        hi++;
+    
+    std::vector<unsigned char> data;
+    std::vector<BgzfMember> members;
+    std::vector<char> text;
+    
+    try {
+        std::ifstream f(fileName.c_str(), std::ios_base::in | std::ios_base::binary);
+        
+        if (!f.is_open())
+            throw XenCommon::XenCEption("Error while opening file " + fileName);
+        
+        data.resize((std::size_t)(index[hi].coff - index[lo].coff));
+        f.seekg((std::streamoff)index[lo].coff);
+        if (!data.empty())
+            f.read(reinterpret_cast<char*>(&data[0]), (std::streamsize)data.size());
+        
+        if (f.bad() || f.gcount() != (std::streamsize)data.size())
+            throw XenCommon::XenCEption("Error while reading file " + fileName);
+        
+        listMembers(fileName, data, 0, data.size(), members, 0);
+        inflateMembers(fileName, data, members, text);
+    } catch (XenCommon::XenCEption &e) {
+        throw;
+    }
+    
+    // Skips the lines before first, then copies up to line last
+    uint64_t line = index[lo].line;
+    std::size_t pos = 0;
+    
+    while (line < first && pos < text.size()) {
+        const char* nl = static_cast<const char*>(std::memchr(&text[pos], '\n', text.size() - pos));
+        pos = nl ? (std::size_t)(nl - &text[0]) + 1 : text.size();
+        line++;
+    }
+    
+    while (line < last && pos < text.size()) {
+        const char* nl = static_cast<const char*>(std::memchr(&text[pos], '\n', text.size() - pos));
+        std::size_t end = nl ? (std::size_t)(nl - &text[0]) : text.size();
+        
+        buf.insert(buf.end(), text.begin() + pos, text.begin() + end);
+        buf.push_back('\n');
+        
+        pos = nl ? end + 1 : text.size();
+        line++;
+    }
+    
+    return true;
+}
+
+std::string Bgzf::getIndexName(std::string fileName) {
+    return fileName + ".idx";
+}
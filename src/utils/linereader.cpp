@@ -0,0 +1,75 @@
+/**
+ *  @file linereader.cpp
+ *  @brief Class streaming the lines of a plain text or gzipped file
+ *  @author Anthony Rousseau
+ *  @version 2.0.0
+ *  @date 19 October 2026
+ */
+
+/*  This file is part of the cross-entropy tool for data selection (XenC)
+ *  aimed at speech recognition and statistical machine translation.
+ *
+ *  Copyright 2013-2016, Anthony Rousseau, LIUM, University of Le Mans, France
+ *
+ *  Development of the XenC tool has been partially funded by the
+ *  European Commission under the MateCat project.
+ *
+ *  The XenC tool is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation
+ *
+ *  This library is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "../../include/utils/linereader.h"
+
+#include <boost/iostreams/filter/gzip.hpp>
+
+LineReader::LineReader() {
+    count = 0;
+}
+
+LineReader::~LineReader() {
+
+}
+
+void LineReader::open(boost::shared_ptr<XenFile> ptrFile) {
+    this->ptrFile = ptrFile;
+    count = 0;
+
+    file.open(ptrFile->getFullPath().c_str(), std::ios_base::in | std::ios_base::binary);
+
+    if (!file.is_open())
+        throw XenCommon::XenCEption("Error while opening file " + ptrFile->getFullPath());
+
+    if (ptrFile->isGZ())
+        in.push(boost::iostreams::gzip_decompressor());
+    in.push(file);
+}
+
+bool LineReader::next(std::string &line) {
+    try {
+        if (!std::getline(in, line))
+            return false;
+    } catch (boost::iostreams::gzip_error &e) {
+        throw XenCommon::XenCEption("Error while reading file " + ptrFile->getFullPath() + ": " + e.what());
+    }
+
+    if (file.bad())
+        throw XenCommon::XenCEption("Error while reading file " + ptrFile->getFullPath());
+
+    count++;
+
+    return true;
+}
+
+unsigned int LineReader::getCount() const {
+    return count;
+}
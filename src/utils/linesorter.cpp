@@ -0,0 +1,148 @@
+/**
+ *  @file linesorter.cpp
+ *  @brief Class sorting the output lines on their scores, in memory or on disk
+ *  @author Anthony Rousseau
+ *  @version 2.0.0
+ *  @date 19 October 2026
+ */
+
+
+/*  This file is part of the cross-entropy tool for data selection (XenC)
+ *  aimed at speech recognition and statistical machine translation.
+ *
+ *  Copyright 2013-2016, Anthony Rousseau, LIUM, University of Le Mans, France
+ *
+ *  Development of the XenC tool has been partially funded by the
+ *  European Commission under the MateCat project.
+ *
+ *  The XenC tool is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation
+ *
+ *  This library is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "../../include/utils/linesorter.h"
+#include "../../include/kenlm/util/file.hh"
+
+#include <algorithm>
+
+LineSorter::LineSorter(std::size_t budget, std::string temp, bool rev) {
+    // Room for at least four sort buffers of some records
+    this->budget = std::max<std::size_t>(budget, 1 << 16);
+    this->temp = temp;
+    less.rev = rev;
+    cursor = 0;
+    size = 0;
+    
+    util::NormalizeTempPrefix(this->temp);
+}
+
+LineSorter::~LineSorter() {
+    // The chain threads only stop once they have passed their poison block
+    if (ptrIn && ptrChain->Running()) {
+        ptrIn->Poison();
+        ptrChain->Wait(true);
+    }
+    
+    if (ptrOut) {
+        while (*ptrOut)
+            ++(*ptrOut);
+        
+        ptrOut.reset();
+        ptrOutChain->Wait(true);
+    }
+}
+
+void LineSorter::add(double score, unsigned int pos) {
+    SortRecord r;
+    r.score = score;
+    r.pos = pos;
+    size++;
+    
+    if (ptrIn) {
+        *static_cast<SortRecord*>(ptrIn->Get()) = r;
+        ++(*ptrIn);
+        return;
+    }
+    
+    records.push_back(r);
+    
+    if (records.size() * sizeof(SortRecord) > budget)
+        spill();
+}
+
+void LineSorter::finish() {
+    if (!ptrIn) {
+        std::sort(records.begin(), records.end(), less);
+        return;
+    }
+    
+    ptrIn->Poison();
+    ptrChain->Wait(true);
+    
+    // Half the budget merges the runs, the other half carries the merged records
+    ptrOutChain.reset(new util::stream::Chain(util::stream::ChainConfig(sizeof(SortRecord), 2, budget / 2)));
+    ptrSort->Output(*ptrOutChain, budget / 2);
+    ptrOut.reset(new util::stream::Stream(ptrOutChain->Add()));
+    *ptrOutChain >> util::stream::kRecycle;
+}
+
+bool LineSorter::next(double &score, unsigned int &pos) {
+    if (!ptrOut) {
+        if (cursor == records.size())
+            return false;
+        
+        score = records[cursor].score;
+        pos = (unsigned int)records[cursor].pos;
+        cursor++;
+        
+        return true;
+    }
+    
+    if (!*ptrOut)
+        return false;
+    
+    const SortRecord* r = static_cast<const SortRecord*>(ptrOut->Get());
+    score = r->score;
+    pos = (unsigned int)r->pos;
+    ++(*ptrOut);
+    
+    return true;
+}
+
+uint64_t LineSorter::getSize() const {
+    return size;
+}
+
+bool LineSorter::isExternal() const {
+    return ptrSort.get() != NULL;
+}
+
+void LineSorter::spill() {
+    std::cout << "Sort memory of " << budget << " bytes exceeded, sorting on disk in " << temp << std::endl;
+    
+    // Each block of the run chain is sorted and written as one run
+    util::stream::SortConfig config;
+    config.temp_prefix = temp;
+    config.buffer_size = budget / 16;
+    config.total_memory = budget / 2;
+    
+    ptrChain.reset(new util::stream::Chain(util::stream::ChainConfig(sizeof(SortRecord), 2, budget / 2)));
+    ptrIn.reset(new util::stream::Stream(ptrChain->Add()));
+    ptrSort.reset(new util::stream::Sort<SortRecordLess>(*ptrChain, config, less));
+    
+    for (std::size_t i = 0; i < records.size(); i++) {
+        *static_cast<SortRecord*>(ptrIn->Get()) = records[i];
+        ++(*ptrIn);
+    }
+    
+    std::vector<SortRecord>().swap(records);
+}
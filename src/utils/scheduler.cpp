@@ -0,0 +1,328 @@
+/**
+ *  @file scheduler.cpp
+ *  @brief Process-wide work-stealing task scheduler
+ *  @author Anthony Rousseau
+ *  @version 2.0.0
+ *  @date 19 October 2026
+ */
+
+
+/*  This file is part of the cross-entropy tool for data selection (XenC)
+ *  aimed at speech recognition and statistical machine translation.
+ *
+ *  Copyright 2013-2016, Anthony Rousseau, LIUM, University of Le Mans, France
+ *
+ *  Development of the XenC tool has been partially funded by the
+ *  European Commission under the MateCat project.
+ *
+ *  The XenC tool is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation
+ *
+ *  This library is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "../../include/utils/scheduler.h"
+#include "../../include/utils/xennuma.h"
+#include "../../include/xenoption.h"
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+Scheduler* Scheduler::_instance = NULL;
+
+TaskGroup::TaskGroup() {
+    pending = 0;
+    error = "";
+}
+
+TaskGroup::~TaskGroup() {
+    try {
+        wait();
+    } catch (XenCommon::XenCEption &e) {
+        // Only reached when unwinding, the error has been reported by the first wait
+    }
+}
+
+void TaskGroup::run(Task task) {
+    {
+        boost::mutex::scoped_lock lock(mtx);
+        pending++;
+    }
+
+    Scheduler::getInstance()->spawn(task, this);
+}
+
+void TaskGroup::wait() {
+    Scheduler* sched = Scheduler::getInstance();
+    int self = sched->getWorker();
+
+    if (self >= 0) {
+        // A worker keeps running tasks while its group is pending
+        while (!isDone()) {
+            Job job;
+
+            if (sched->findJob(self, job))
+                sched->execute(job);
+            else {
+                boost::mutex::scoped_lock lock(mtx);
+                if (pending > 0)
+                    done.timed_wait(lock, boost::posix_time::milliseconds(1));
+            }
+        }
+    }
+    else {
+        boost::mutex::scoped_lock lock(mtx);
+        while (pending > 0)
+            done.wait(lock);
+    }
+
+    boost::mutex::scoped_lock lock(mtx);
+
+    if (error.compare("") != 0) {
+        std::string err = error;
+        error = "";
+        throw XenCommon::XenCEption(err);
+    }
+}
+
+void TaskGroup::finish(const std::string &err) {
+    boost::mutex::scoped_lock lock(mtx);
+
+    if (err.compare("") != 0 && error.compare("") == 0)
+        error = err;
+
+    if (--pending == 0)
+        done.notify_all();
+}
+
+bool TaskGroup::isDone() {
+    boost::mutex::scoped_lock lock(mtx);
+
+    return pending == 0;
+}
+
+MemoryBudget::MemoryBudget(std::size_t total) {
+    this->total = total;
+    used = 0;
+}
+
+MemoryBudget::~MemoryBudget() {
+
+}
+
+void MemoryBudget::acquire(std::size_t bytes) {
+    boost::mutex::scoped_lock lock(mtx);
+
+    while (used > 0 && used + bytes > total)
+        freed.wait(lock);
+
+    used += bytes;
+}
+
+void MemoryBudget::release(std::size_t bytes) {
+    boost::mutex::scoped_lock lock(mtx);
+
+    used -= std::min(used, bytes);
+    freed.notify_all();
+}
+
+std::size_t MemoryBudget::getTotal() const {
+    return total;
+}
+
+Scheduler* Scheduler::getInstance() {
+    if (_instance == NULL)
+        _instance = new Scheduler((unsigned int)std::max(1, XenOption::getInstance()->getThreads()));
+
+    return _instance;
+}
+
+void Scheduler::deleteInstance() {
+    delete _instance;
+    _instance = NULL;
+}
+
+Scheduler::Scheduler(unsigned int threads) {
+    start(threads);
+}
+
+Scheduler::~Scheduler() {
+    shutdown();
+}
+
+void Scheduler::resize(unsigned int threads) {
+    threads = std::max(1u, threads);
+
+    if (threads == getSize())
+        return;
+
+    shutdown();
+    start(threads);
+}
+
+unsigned int Scheduler::getSize() const {
+    return (unsigned int)ids.size();
+}
+
+int Scheduler::getWorker() const {
+    boost::thread::id me = boost::this_thread::get_id();
+
+    for (unsigned int i = 0; i < ids.size(); i++)
+        if (ids[i] == me)
+            return (int)i;
+
+    return -1;
+}
+
+void Scheduler::parallelFor(unsigned int begin, unsigned int end, unsigned int grain, boost::function<void (unsigned int, unsigned int)> body) {
+    grain = std::max(1u, grain);
+
+    TaskGroup group;
+
+    for (unsigned int first = begin; first < end; first += grain)
+        group.run(boost::bind(body, first, std::min(end, first + grain)));
+
+    group.wait();
+}
+
+void Scheduler::start(unsigned int threads) {
+    queued = 0;
+    stop = false;
+
+    queues.clear();
+    for (unsigned int i = 0; i < threads; i++)
+        queues.push_back(boost::make_shared<WorkerQueue>());
+
+    // Ids are known before any worker looks for a job
+    boost::mutex::scoped_lock lock(mtx);
+
+    for (unsigned int i = 0; i < threads; i++) {
+        workers.push_back(boost::make_shared<boost::thread>(boost::bind(&Scheduler::workerLoop, this, (int)i)));
+        ids.push_back(workers.back()->get_id());
+    }
+}
+
+void Scheduler::shutdown() {
+    {
+        boost::mutex::scoped_lock lock(mtx);
+        stop = true;
+        wake.notify_all();
+    }
+
+    for (unsigned int i = 0; i < workers.size(); i++)
+        workers[i]->join();
+
+    workers.clear();
+    ids.clear();
+}
+
+void Scheduler::spawn(Task task, TaskGroup* group) {
+    Job job;
+    job.task = task;
+    job.group = group;
+
+    int self = getWorker();
+
+    boost::mutex::scoped_lock lock(mtx);
+    queued++;
+
+    if (self >= 0) {
+        boost::mutex::scoped_lock qLock(queues[self]->mtx);
+        queues[self]->jobs.push_back(job);
+    }
+    else
+        injected.push_back(job);
+
+    wake.notify_one();
+}
+
+bool Scheduler::findJob(int self, Job &job) {
+    bool found = false;
+
+    // Newest own task first, it is the most likely to be in cache
+    {
+        boost::mutex::scoped_lock qLock(queues[self]->mtx);
+        if (!queues[self]->jobs.empty()) {
+            job = queues[self]->jobs.back();
+            queues[self]->jobs.pop_back();
+            found = true;
+        }
+    }
+
+    if (!found) {
+        boost::mutex::scoped_lock lock(mtx);
+        if (!injected.empty()) {
+            job = injected.front();
+            injected.pop_front();
+            queued--;
+            return true;
+        }
+    }
+
+    // Then the oldest task of another worker
+    for (unsigned int i = 1; i < queues.size() && !found; i++) {
+        WorkerQueue &victim = *queues[(self + i) % queues.size()];
+        boost::mutex::scoped_lock qLock(victim.mtx);
+
+        if (!victim.jobs.empty()) {
+            job = victim.jobs.front();
+            victim.jobs.pop_front();
+            found = true;
+        }
+    }
+
+    if (found) {
+        boost::mutex::scoped_lock lock(mtx);
+        queued--;
+    }
+
+    return found;
+}
+
+void Scheduler::execute(Job &job) {
+    std::string err = "";
+
+    try {
+        job.task();
+    } catch (std::exception &e) {
+        err = e.what();
+        if (err.compare("") == 0)
+            err = "Unknown error in a scheduled task.";
+    }
+
+    job.group->finish(err);
+}
+
+void Scheduler::workerLoop(int self) {
+    {
+        // Wait for the ids to be published by start()
+        boost::mutex::scoped_lock lock(mtx);
+    }
+
+    if (XenNuma::getReplicate())
+        XenNuma::bindToNode(self % XenNuma::getNodes());
+
+    while (true) {
+        Job job;
+
+        if (findJob(self, job)) {
+            execute(job);
+            continue;
+        }
+
+        boost::mutex::scoped_lock lock(mtx);
+
+        if (stop)
+            return;
+
+        if (queued == 0)
+            wake.wait(lock);
+    }
+}
@@ -0,0 +1,169 @@
+/**
+ *  @file tokenizer.cpp
+ *  @brief Class handling the whitespace tokenization and hashing of text lines
+ *  @author Anthony Rousseau
+ *  @version 2.0.0
+ *  @date 19 October 2026
+ */
+
+/*  This file is part of the cross-entropy tool for data selection (XenC)
+ *  aimed at speech recognition and statistical machine translation.
+ *
+ *  Copyright 2013-2016, Anthony Rousseau, LIUM, University of Le Mans, France
+ *
+ *  Development of the XenC tool has been partially funded by the
+ *  European Commission under the MateCat project.
+ *
+ *  The XenC tool is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation
+ *
+ *  This library is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "../../include/utils/tokenizer.h"
+#include "../../include/kenlm/util/murmur_hash.hh"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+static const std::size_t blockSize = 32;
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+static const std::size_t blockSize = 16;
+#else
+static const std::size_t blockSize = 32;
+#endif
+
+/**
+ *  @fn inline uint32_t scanBlock (const char* p)
+ *  @brief Finds the spaces of a full block
+ *
+ *  @param p :  the block start
+ *  @return the spaces of the block, one bit per byte
+ */
+inline uint32_t scanBlock(const char* p) {
+#if defined(__AVX2__)
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    return (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')));
+#elif defined(__SSE2__)
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')));
+#else
+    uint32_t m = 0;
+    for (std::size_t i = 0; i < blockSize; i++)
+        m |= (uint32_t)(p[i] == ' ') << i;
+    return m;
+#endif
+}
+
+/**
+ *  @fn inline uint32_t scanTail (const char* p, const char* end)
+ *  @brief Finds the spaces of the last, partial block of a line
+ *
+ *  @param p :      the block start
+ *  @param end :    the line end
+ *  @return the spaces of the block, one bit per byte
+ */
+inline uint32_t scanTail(const char* p, const char* end) {
+    uint32_t m = 0;
+    for (uint32_t i = 0; p + i < end; i++)
+        m |= (uint32_t)(p[i] == ' ') << i;
+    return m;
+}
+
+Tokenizer::Tokenizer() {
+    reset(NULL, 0);
+}
+
+Tokenizer::Tokenizer(const std::string &src) {
+    reset(src);
+}
+
+Tokenizer::~Tokenizer() {
+
+}
+
+void Tokenizer::reset(const char* data, std::size_t len) {
+    cur = data;
+    end = data + len;
+    block = data;
+    done = false;
+
+    if (len >= blockSize)
+        mask = scanBlock(block);
+    else
+        mask = scanTail(block, end);
+}
+
+void Tokenizer::reset(const std::string &src) {
+    reset(src.data(), src.length());
+}
+
+bool Tokenizer::next(Token &tok) {
+    if (done)
+        return false;
+
+    const char* sp = nextSpace();
+
+    tok.str = StringPiece(cur, (StringPiece::size_type)(sp - cur));
+    tok.hash = util::MurmurHash64A(cur, (std::size_t)(sp - cur), 0);
+
+    if (sp == end) {
+        done = true;
+    }
+    else {
+        cur = sp + 1;
+        mask &= mask - 1;
+    }
+
+    return true;
+}
+
+uint64_t Tokenizer::hash(const StringPiece &str) {
+    return util::MurmurHash64A(str.data(), str.length(), 0);
+}
+
+void Tokenizer::countWords(const char* data, std::size_t len, WordCounts &counts) {
+    Tokenizer tokens;
+    Token tok;
+
+    tokens.reset(data, len);
+
+    while (tokens.next(tok)) {
+        WordCounts::iterator it = counts.find(tok.hash);
+
+        if (it != counts.end()) {
+            it->second.count++;
+        }
+        else {
+            WordCount wc;
+            wc.word = tok.str.as_string();
+            wc.count = 1;
+            counts.insert(std::make_pair(tok.hash, wc));
+        }
+    }
+}
+
+const char* Tokenizer::nextSpace() {
+    for ( ; ; ) {
+        if (mask != 0)
+            return block + __builtin_ctz(mask);
+
+        if ((std::size_t)(end - block) <= blockSize)
+            return end;
+
+        block += blockSize;
+
+        if ((std::size_t)(end - block) >= blockSize)
+            mask = scanBlock(block);
+        else
+            mask = scanTail(block, end);
+    }
+}
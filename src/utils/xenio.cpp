@@ -29,13 +29,187 @@
  */
 
 #include "../../include/utils/xenio.h"
+#include "../../include/utils/StaticData.h"
+#include "../../include/utils/scheduler.h"
+#include "../../include/utils/linereader.h"
+#include "../../include/utils/linesorter.h"
+#include "../../include/utils/bgzf.h"
+
+#include <algorithm>
+#include <queue>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
+
+/**
+ *  @struct SelectLess
+ *  @brief Orders line positions by score, then by position, as the sorted output does
+ */
+struct SelectLess {
+    const Score* sc;        //!< The scores of the lines
+    bool rev;               //!< Descending order (--rev)
+    
+    bool operator()(unsigned int a, unsigned int b) const {
+        double sa = sc->getScore(a);
+        double sb = sc->getScore(b);
+        
+        if (sa != sb)
+            return rev ? sa > sb : sa < sb;
+        
+        return rev ? a > b : a < b;
+    }
+};
+
+/**
+ *  @struct ShardEntry
+ *  @brief A line of a sorted shard, with its calibrated score
+ */
+struct ShardEntry {
+    double score;           //!< The calibrated score of the line
+    unsigned int pos;       //!< The position of the line in the whole file
+    std::string text;       //!< The text of the line (source, then target if bilingual)
+};
+
+/**
+ *  @struct ShardCursor
+ *  @brief Streams a sorted shard, one run of equal calibrated scores at a time
+ */
+struct ShardCursor {
+    LineReader reader;              //!< The shard file reader
+    std::vector<ShardEntry> run;    //!< The current run of equal scores, ordered by position
+    unsigned int next;              //!< The next line of the run
+    bool pending;                   //!< Indicates the first line of the next run has been read
+    ShardEntry ahead;               //!< The first line of the next run
+};
+
+/**
+ *  @struct PosLess
+ *  @brief Orders the lines of a run by position
+ */
+struct PosLess {
+    bool rev;               //!< Descending order (--rev)
+    
+    bool operator()(const ShardEntry &a, const ShardEntry &b) const { return rev ? a.pos > b.pos : a.pos < b.pos; }
+};
+
+/**
+ *  @struct MergeLess
+ *  @brief Orders the shard cursors of the merge heap on the score, then the position, of their next line
+ */
+struct MergeLess {
+    const std::vector<boost::shared_ptr<ShardCursor> >* cursors;    //!< The shard cursors
+    bool rev;               //!< Descending order (--rev)
+    
+    // The heap pops its greatest element: true when a comes after b in the output
+    bool operator()(unsigned int a, unsigned int b) const {
+        const ShardEntry &ea = (*cursors)[a]->run[(*cursors)[a]->next];
+        const ShardEntry &eb = (*cursors)[b]->run[(*cursors)[b]->next];
+        
+        if (ea.score != eb.score)
+            return rev ? ea.score < eb.score : ea.score > eb.score;
+        
+        return rev ? ea.pos < eb.pos : ea.pos > eb.pos;
+    }
+};
+
+/**
+ *  @fn static bool readShardEntry (ShardCursor &cursor, MinMax bounds, bool inv, ShardEntry &e)
+ *  @brief Reads the next line of a shard and calibrates its raw score with the bounds of all shards
+ *
+ *  @return false at the end of the shard
+ */
+static bool readShardEntry(ShardCursor &cursor, MinMax bounds, bool inv, ShardEntry &e) {
+    std::string line;
+    
+    if (!cursor.reader.next(line))
+        return false;
+    
+    std::string::size_type t1 = line.find('\t');
+    std::string::size_type t2 = t1 == std::string::npos ? std::string::npos : line.find('\t', t1 + 1);
+    
+    if (t2 == std::string::npos)
+        throw XenCommon::XenCEption("Malformed line " + XenCommon::toString(cursor.reader.getCount()) + " in shard.");
+    
+    // Same kernels as the calibration of an unsharded run, so that scores are bit-exact
+    e.score = std::strtod(line.substr(0, t1).c_str(), NULL);
+    e.pos = (unsigned int)std::strtoul(line.substr(t1 + 1, t2 - t1 - 1).c_str(), NULL, 10);
+    e.text = line.substr(t2 + 1);
+    
+    Score::normalize(&e.score, 1, bounds.first, bounds.second);
+    if (inv)
+        Score::affine(&e.score, 1, -1, 1);
+    
+    return true;
+}
+
+/**
+ *  @fn static bool fillShardRun (ShardCursor &cursor, MinMax bounds, bool rev, bool inv)
+ *  @brief Reads the next run of equal scores of a shard
+ *
+ *  @return false at the end of the shard
+ */
+static bool fillShardRun(ShardCursor &cursor, MinMax bounds, bool rev, bool inv) {
+    cursor.run.clear();
+    cursor.next = 0;
+    
+    if (!cursor.pending && !readShardEntry(cursor, bounds, inv, cursor.ahead))
+        return false;
+    
+    cursor.run.push_back(cursor.ahead);
+    cursor.pending = false;
+    
+    ShardEntry e;
+    
+    while (readShardEntry(cursor, bounds, inv, e)) {
+        if (e.score != cursor.run[0].score) {
+            cursor.ahead = e;
+            cursor.pending = true;
+            break;
+        }
+        
+        cursor.run.push_back(e);
+    }
+    
+    // Distinct raw scores may calibrate to the same value: ties are broken on position
+    PosLess less;
+    less.rev = rev;
+    std::sort(cursor.run.begin(), cursor.run.end(), less);
+    
+    return true;
+}
+
+/**
+ *  @fn static void selectChunk (SelectLess less, const boost::dynamic_bitset<>* valid, Selection sel, std::size_t k, std::vector<std::vector<unsigned int> >* parts, unsigned int first, unsigned int last)
+ *  @brief Keeps the (at most k) best candidates of a sub-range of the scores
+ */
+static void selectChunk(SelectLess less, const boost::dynamic_bitset<>* valid, Selection sel, std::size_t k, std::vector<std::vector<unsigned int> >* parts, unsigned int first, unsigned int last) {
+    std::vector<unsigned int> &part = (*parts)[first / Score::grain];
+    
+    for (unsigned int i = first; i < last; i++) {
+        if (!valid->test(i))
+            continue;
+        
+        if (sel.threshold) {
+            double sc = less.sc->getScore(i);
+            
+            if (less.rev ? !(sc >= sel.thr) : !(sc <= sel.thr))
+                continue;
+        }
+        
+        part.push_back(i);
+    }
+    
+    if (part.size() > k) {
+        std::nth_element(part.begin(), part.begin() + k, part.end(), less);
+        part.resize(k);
+    }
+}
 
 void XenIO::cleanCorpusMono(boost::shared_ptr<Corpus> ptrCorp, boost::shared_ptr<Score> ptrScore) {
     std::cout << "Cleaning monolingual output..." << std::endl;
-    boost::regex e("^\\s*$");
     
     for (unsigned int i = 0; i < ptrCorp->getSize(); i++) {
-		if (boost::regex_search(ptrCorp->getLine(i), e, boost::match_default | boost::format_sed)) {
+		if (!ptrCorp->isValid(i)) {
             ptrCorp->removeLine(i);
             ptrScore->removeScore(i);
         }
@@ -44,14 +218,12 @@ void XenIO::cleanCorpusMono(boost::shared_ptr<Corpus> ptrCorp, boost::shared_ptr
     std::cout << "Monolingual output cleaned." << std::endl;
 }
 
-void XenIO::cleanCorpusBi(boost::shared_ptr<Corpus> ptrCorpSource, boost::shared_ptr<Corpus> ptrCorpTarget, boost::shared_ptr<Score> ptrScore) {
+void XenIO::cleanCorpusBi(boost::shared_ptr<Bitext> ptrBitext, boost::shared_ptr<Score> ptrScore) {
     std::cout << "Cleaning bilingual output..." << std::endl;
-    boost::regex e("^\\s*$");
     
-    for (unsigned int i = 0; i < ptrCorpSource->getSize(); i++) {
-        if (boost::regex_search(ptrCorpSource->getLine(i), e, boost::match_default | boost::format_sed) || boost::regex_search(ptrCorpTarget->getLine(i), e, boost::match_default | boost::format_sed)) {
-            ptrCorpSource->removeLine(i);
-            ptrCorpTarget->removeLine(i);
+    for (unsigned int i = 0; i < ptrBitext->getSize(); i++) {
+        if (!ptrBitext->isValid(i)) {
+            ptrBitext->removeLine(i);
             ptrScore->removeScore(i);
         }
     }
@@ -62,25 +234,43 @@ void XenIO::cleanCorpusBi(boost::shared_ptr<Corpus> ptrCorpSource, boost::shared
 void XenIO::writeMonoOutput(boost::shared_ptr<Corpus> ptrCorp, boost::shared_ptr<Score> ptrScore) {
     XenOption* opt = XenOption::getInstance();
     
+    if (opt->getSelect()) {
+        writeSelection(ptrCorp, boost::shared_ptr<Corpus>(), ptrScore);
+        return;
+    }
+    
+    if (opt->getShardCount() > 1) {
+        writeShard(ptrCorp, boost::shared_ptr<Corpus>(), ptrScore);
+        return;
+    }
+    
     std::string scoredName = opt->getOutName() + ".scored.gz";
     std::string sortedName = opt->getOutName() + ".sorted.gz";
     
-    std::multimap<double, std::string> sortMap;
+    boost::shared_ptr<RunStats> ptrStats = StaticData::getInstance()->getRunStats();
+    int stage = ptrStats->startStage("sort:" + sortedName);
     
-    for (unsigned int i = 0; i < ptrCorp->getSize(); i++)
-        if (ptrCorp->getPrint(i) && ptrScore->getPrint(i)) {
-            std::pair<double, std::string> p(ptrScore->getScore(i), ptrCorp->getLine(i));
-            sortMap.insert(p);
-        }
+    // Lines are sorted on (score, position), their text is only fetched when written
+    LineSorter sorter(opt->getSortMem(), opt->getTemp(), opt->getRev());
+    
+    // In incremental mode, the score store already holds the merged order
+    for (unsigned int i = 0; i < ptrCorp->getSize() && !opt->getIncremental(); i++)
+        if (ptrCorp->getPrint(i) && ptrScore->getPrint(i))
+            sorter.add(ptrScore->getScore(i), i);
+    
+    sorter.finish();
+    
+    ptrStats->endStage(stage, sorter.getSize(), 0);
     
     try {
+        stage = ptrStats->startStage("write:" + sortedName);
+        
         if (!opt->getSortOnly()) {
             std::cout << "Writing scored output to " + scoredName << std::endl;
             
             
             boost::iostreams::filtering_ostream out;
-            out.push(boost::iostreams::gzip_compressor());
-            out.push(boost::iostreams::file_sink(scoredName.c_str(), std::ios_base::out | std::ios_base::binary));
+            out.push(BgzfSink(scoredName));
             out.setf(std::ios::fixed | std::ios::showpoint);
             out.precision(15);
             
@@ -102,25 +292,32 @@ void XenIO::writeMonoOutput(boost::shared_ptr<Corpus> ptrCorp, boost::shared_ptr
         std::cout << "Writing sorted output to " + sortedName << std::endl;
         
         boost::iostreams::filtering_ostream out;
-        out.push(boost::iostreams::gzip_compressor());
-        out.push(boost::iostreams::file_sink(sortedName.c_str(), std::ios_base::out | std::ios_base::binary));
+        out.push(BgzfSink(sortedName));
         out.setf(std::ios::fixed | std::ios::showpoint);
         out.precision(15);
         
         if (!out.good())
             throw XenCommon::XenCEption("Something went wrong in output stream...");
         
-        if (opt->getRev()) {
-            for (std::multimap<double, std::string>::reverse_iterator it = sortMap.rbegin(); it != sortMap.rend(); ++it) {
-                out << XenCommon::toString(it->first) << '\t' << it->second << std::endl;
+        if (opt->getIncremental()) {
+            std::vector<unsigned int> order = StaticData::getInstance()->getScoreStore()->getOrder(ptrScore, opt->getInv(), opt->getRev());
+            
+            for (unsigned int i = 0; i < order.size(); i++) {
+                unsigned int n = order[i];
+                
+                if (ptrCorp->getPrint(n) && ptrScore->getPrint(n))
+                    out << XenCommon::toString(ptrScore->getScore(n)) << '\t' << ptrCorp->getLine(n) << std::endl;
                 
                 if (out.bad())
                     throw XenCommon::XenCEption("Something went wrong in output stream...");
             }
         }
         else {
-            for (std::multimap<double, std::string>::iterator it = sortMap.begin(); it != sortMap.end(); ++it) {
-                out << XenCommon::toString(it->first) << '\t' << it->second << std::endl;
+            double sc = 0;
+            unsigned int n = 0;
+            
+            while (sorter.next(sc, n)) {
+                out << XenCommon::toString(sc) << '\t' << ptrCorp->getLine(n) << std::endl;
                 
                 if (out.bad())
                     throw XenCommon::XenCEption("Something went wrong in output stream...");
@@ -129,6 +326,8 @@ void XenIO::writeMonoOutput(boost::shared_ptr<Corpus> ptrCorp, boost::shared_ptr
 
         out.flush();
         out.reset();
+        
+        ptrStats->endStage(stage, ptrCorp->getSize(), 0);
     } catch (XenCommon::XenCEption &e) {
         throw;
     }
@@ -137,24 +336,42 @@ void XenIO::writeMonoOutput(boost::shared_ptr<Corpus> ptrCorp, boost::shared_ptr
 void XenIO::writeBiOutput(boost::shared_ptr<Corpus> ptrCorpSource, boost::shared_ptr<Corpus> ptrCorpTarget, boost::shared_ptr<Score> ptrScore) {
     XenOption* opt = XenOption::getInstance();
     
+    if (opt->getSelect()) {
+        writeSelection(ptrCorpSource, ptrCorpTarget, ptrScore);
+        return;
+    }
+    
+    if (opt->getShardCount() > 1) {
+        writeShard(ptrCorpSource, ptrCorpTarget, ptrScore);
+        return;
+    }
+    
     std::string scoredName = opt->getOutName() + ".scored.gz";
     std::string sortedName = opt->getOutName() + ".sorted.gz";
     
-    std::multimap<double, std::string> sortMap;
+    boost::shared_ptr<RunStats> ptrStats = StaticData::getInstance()->getRunStats();
+    int stage = ptrStats->startStage("sort:" + sortedName);
     
-    for (unsigned int i = 0; i < ptrCorpSource->getSize(); i++)
-        if (ptrCorpSource->getPrint(i) && ptrCorpTarget->getPrint(i) && ptrScore->getPrint(i)) {
-            std::pair<double, std::string> p(ptrScore->getScore(i), ptrCorpSource->getLine(i) + '\t' + ptrCorpTarget->getLine(i));
-            sortMap.insert(p);
-        }
+    // Lines are sorted on (score, position), their text is only fetched when written
+    LineSorter sorter(opt->getSortMem(), opt->getTemp(), opt->getRev());
+    
+    // In incremental mode, the score store already holds the merged order
+    for (unsigned int i = 0; i < ptrCorpSource->getSize() && !opt->getIncremental(); i++)
+        if (ptrCorpSource->getPrint(i) && ptrCorpTarget->getPrint(i) && ptrScore->getPrint(i))
+            sorter.add(ptrScore->getScore(i), i);
+    
+    sorter.finish();
+    
+    ptrStats->endStage(stage, sorter.getSize(), 0);
     
     try {
+        stage = ptrStats->startStage("write:" + sortedName);
+        
         if (!opt->getSortOnly()) {
             std::cout << "Writing scored output to " + scoredName << std::endl;
             
             boost::iostreams::filtering_ostream out;
-            out.push(boost::iostreams::gzip_compressor());
-            out.push(boost::iostreams::file_sink(scoredName.c_str(), std::ios_base::out | std::ios_base::binary));
+            out.push(BgzfSink(scoredName));
             out.setf(std::ios::fixed | std::ios::showpoint);
             out.precision(15);
             
@@ -163,7 +380,7 @@ void XenIO::writeBiOutput(boost::shared_ptr<Corpus> ptrCorpSource, boost::shared
             
             for (unsigned int i = 0; i < ptrCorpSource->getSize(); i++) {
                 if (ptrCorpSource->getPrint(i) && ptrCorpTarget->getPrint(i) && ptrScore->getPrint(i))
-                    out << XenCommon::toString(ptrScore->getScore(i)) << '\t' << ptrCorpSource->getLine(i) << '\t' << ptrCorpTarget->getLine(i) << std::endl;
+                    out << XenCommon::toString(ptrScore->getScore(i)) << '\t' << ptrCorpSource->getView(i) << '\t' << ptrCorpTarget->getView(i) << std::endl;
                 
                 if (out.bad())
                     throw XenCommon::XenCEption("Something went wrong in output stream...");
@@ -176,25 +393,32 @@ void XenIO::writeBiOutput(boost::shared_ptr<Corpus> ptrCorpSource, boost::shared
         std::cout << "Writing sorted output to " + sortedName << std::endl;
         
         boost::iostreams::filtering_ostream out;
-        out.push(boost::iostreams::gzip_compressor());
-        out.push(boost::iostreams::file_sink(sortedName.c_str(), std::ios_base::out | std::ios_base::binary));
+        out.push(BgzfSink(sortedName));
         out.setf(std::ios::fixed | std::ios::showpoint);
         out.precision(15);
         
         if (!out.good())
             throw XenCommon::XenCEption("Something went wrong in output stream...");
         
-        if (opt->getRev()) {
-            for (std::multimap<double, std::string>::reverse_iterator it = sortMap.rbegin(); it != sortMap.rend(); ++it) {
-                out << XenCommon::toString(it->first) << '\t' << it->second << std::endl;
+        if (opt->getIncremental()) {
+            std::vector<unsigned int> order = StaticData::getInstance()->getScoreStore()->getOrder(ptrScore, opt->getInv(), opt->getRev());
+            
+            for (unsigned int i = 0; i < order.size(); i++) {
+                unsigned int n = order[i];
+                
+                if (ptrCorpSource->getPrint(n) && ptrCorpTarget->getPrint(n) && ptrScore->getPrint(n))
+                    out << XenCommon::toString(ptrScore->getScore(n)) << '\t' << ptrCorpSource->getView(n) << '\t' << ptrCorpTarget->getView(n) << std::endl;
                 
                 if (out.bad())
                     throw XenCommon::XenCEption("Something went wrong in output stream...");
             }
         }
         else {
-            for (std::multimap<double, std::string>::iterator it = sortMap.begin(); it != sortMap.end(); ++it) {
-                out << XenCommon::toString(it->first) << '\t' << it->second << std::endl;
+            double sc = 0;
+            unsigned int n = 0;
+            
+            while (sorter.next(sc, n)) {
+                out << XenCommon::toString(sc) << '\t' << ptrCorpSource->getView(n) << '\t' << ptrCorpTarget->getView(n) << std::endl;
                 
                 if (out.bad())
                     throw XenCommon::XenCEption("Something went wrong in output stream...");
@@ -203,26 +427,292 @@ void XenIO::writeBiOutput(boost::shared_ptr<Corpus> ptrCorpSource, boost::shared
         
         out.flush();
         out.reset();
+        
+        ptrStats->endStage(stage, ptrCorpSource->getSize(), 0);
     } catch (XenCommon::XenCEption &e) {
         throw;
     }
 }
 
-void XenIO::writeNewPT(boost::shared_ptr<PhraseTable> ptrPT, boost::shared_ptr<Score> ptrScore) {
+bool XenIO::parseSelection(std::string top, std::string thr, Selection &sel) {
+    sel.top = top.compare("") != 0;
+    sel.percent = sel.top && top[top.size() - 1] == '%';
+    sel.count = 0;
+    sel.threshold = thr.compare("") != 0;
+    sel.thr = 0;
+    
+    try {
+        if (sel.top)
+            sel.count = boost::lexical_cast<double>(sel.percent ? top.substr(0, top.size() - 1) : top);
+        if (sel.threshold)
+            sel.thr = boost::lexical_cast<double>(thr);
+    } catch (boost::bad_lexical_cast &e) {
+        return false;
+    }
+    
+    if (sel.top && (sel.count <= 0 || (sel.percent && sel.count > 100) || (!sel.percent && sel.count != (double)(uint64_t)sel.count)))
+        return false;
+    
+    return true;
+}
+
+std::vector<unsigned int> XenIO::selectLines(boost::shared_ptr<Score> ptrScore, const boost::dynamic_bitset<> &valid) {
+    XenOption* opt = XenOption::getInstance();
+    
+    Selection sel;
+    if (!parseSelection(opt->getSelectTop(), opt->getSelectThreshold(), sel))
+        throw XenCommon::XenCEption("Invalid --select-top or --select-threshold value.");
+    
+    std::size_t nbValid = valid.count();
+    std::size_t k = nbValid;
+    
+    if (sel.top)
+        k = sel.percent ? (std::size_t)((double)nbValid * sel.count / 100) : std::min(nbValid, (std::size_t)sel.count);
+    
+    SelectLess less;
+    less.sc = ptrScore.get();
+    less.rev = opt->getRev();
+    
+    unsigned int size = (unsigned int)valid.size();
+    std::vector<std::vector<unsigned int> > parts((size + Score::grain - 1) / Score::grain);
+    
+    Scheduler::parallelFor(0, size, Score::grain, boost::bind(&selectChunk, less, &valid, sel, k, &parts, _1, _2));
+    
+    std::vector<unsigned int> res;
+    for (unsigned int c = 0; c < parts.size(); c++)
+        res.insert(res.end(), parts[c].begin(), parts[c].end());
+    
+    if (res.size() > k) {
+        std::nth_element(res.begin(), res.begin() + k, res.end(), less);
+        res.resize(k);
+    }
+    
+    if (opt->getSelectSorted())
+        std::sort(res.begin(), res.end(), less);
+    else
+        std::sort(res.begin(), res.end());
+    
+    return res;
+}
+
+void XenIO::writeSelection(boost::shared_ptr<Corpus> ptrCorpSource, boost::shared_ptr<Corpus> ptrCorpTarget, boost::shared_ptr<Score> ptrScore) {
     XenOption* opt = XenOption::getInstance();
-    Score sc2;
     
-    if (opt->getLocal()) {
-        std::vector<SourcePhrase> srcPh = ptrPT->getSrcPhrases();
+    std::string selectedName = opt->getOutName() + ".selected.gz";
+    
+    boost::shared_ptr<RunStats> ptrStats = StaticData::getInstance()->getRunStats();
+    int stage = ptrStats->startStage("select:" + selectedName);
+    
+    boost::dynamic_bitset<> valid(ptrCorpSource->getSize());
+    for (unsigned int i = 0; i < ptrCorpSource->getSize(); i++)
+        valid[i] = ptrCorpSource->getPrint(i) && (!ptrCorpTarget || ptrCorpTarget->getPrint(i)) && ptrScore->getPrint(i);
+    
+    std::vector<unsigned int> sel = selectLines(ptrScore, valid);
+    
+    ptrStats->endStage(stage, sel.size(), 0);
     
-        for (unsigned int i = 0; i < srcPh.size(); i++) {
-            SourcePhrase sP = srcPh[i];
+    std::cout << "Selected " << sel.size() << " lines out of " << valid.count() << "." << std::endl;
+    
+    try {
+        stage = ptrStats->startStage("write:" + selectedName);
         
-            for (unsigned int j = 0; j < sP.getScoresXE()->getSize(); j++) {
-                sc2.addScore(sP.getScoresXE()->getScore(j));
-            }
+        std::cout << "Writing selected output to " + selectedName << std::endl;
+        
+        boost::iostreams::filtering_ostream out;
+        out.push(BgzfSink(selectedName));
+        out.setf(std::ios::fixed | std::ios::showpoint);
+        out.precision(15);
+        
+        if (!out.good())
+            throw XenCommon::XenCEption("Something went wrong in output stream...");
+        
+        for (unsigned int i = 0; i < sel.size(); i++) {
+            unsigned int n = sel[i];
+            
+            out << XenCommon::toString(ptrScore->getScore(n)) << '\t' << ptrCorpSource->getView(n);
+            if (ptrCorpTarget)
+                out << '\t' << ptrCorpTarget->getView(n);
+            out << std::endl;
+            
+            if (out.bad())
+                throw XenCommon::XenCEption("Something went wrong in output stream...");
         }
+        
+        out.flush();
+        out.reset();
+        
+        ptrStats->endStage(stage, sel.size(), 0);
+    } catch (XenCommon::XenCEption &e) {
+        throw;
+    }
+}
+
+std::string XenIO::getShardName(std::string baseName, int shard, int shards) {
+    return baseName + ".shard" + XenCommon::toString(shard) + "of" + XenCommon::toString(shards);
+}
+
+void XenIO::writeShard(boost::shared_ptr<Corpus> ptrCorpSource, boost::shared_ptr<Corpus> ptrCorpTarget, boost::shared_ptr<Score> ptrScore) {
+    XenOption* opt = XenOption::getInstance();
+    
+    std::string shardName = opt->getOutName() + ".sorted.gz";
+    
+    boost::shared_ptr<RunStats> ptrStats = StaticData::getInstance()->getRunStats();
+    int stage = ptrStats->startStage("sort:" + shardName);
+    
+    // Calibration bounds are those of all the raw scores, as computed by an unsharded run
+    boost::shared_ptr<Score> ptrRaw = StaticData::getInstance()->getScHold()->getPtrScXenC();
+    double min = 0;
+    double max = 0;
+    
+    Score::minMax(ptrRaw->getData(), ptrRaw->getSize(), min, max);
+    
+    std::vector<unsigned int> order;
+    
+    for (unsigned int i = 0; i < ptrCorpSource->getSize(); i++)
+        if (ptrCorpSource->getPrint(i) && (!ptrCorpTarget || ptrCorpTarget->getPrint(i)) && ptrScore->getPrint(i))
+            order.push_back(i);
+    
+    // Raw order matching the calibrated output order: --inv reverses it
+    SelectLess less;
+    less.sc = ptrRaw.get();
+    less.rev = opt->getRev() != opt->getInv();
+    
+    std::sort(order.begin(), order.end(), less);
+    
+    ptrStats->endStage(stage, order.size(), 0);
+    
+    try {
+        stage = ptrStats->startStage("write:" + shardName);
+        
+        std::cout << "Writing sorted shard " << opt->getShardIndex() << "/" << opt->getShardCount() << " to " + shardName << std::endl;
+        
+        boost::iostreams::filtering_ostream out;
+        out.push(BgzfSink(shardName));
+        
+        if (!out.good())
+            throw XenCommon::XenCEption("Something went wrong in output stream...");
+        
+        out << "#shard\t" << opt->getShardIndex() << '\t' << opt->getShardCount() << '\t' << XenCommon::toString(min) << '\t' << XenCommon::toString(max) << '\t' << opt->getRev() << '\t' << opt->getInv() << std::endl;
+        
+        unsigned int first = ptrCorpSource->getFirstLine();
+        
+        for (unsigned int i = 0; i < order.size(); i++) {
+            unsigned int n = order[i];
+            
+            out << XenCommon::toString(ptrRaw->getScore(n)) << '\t' << first + n << '\t' << ptrCorpSource->getView(n);
+            if (ptrCorpTarget)
+                out << '\t' << ptrCorpTarget->getView(n);
+            out << std::endl;
+            
+            if (out.bad())
+                throw XenCommon::XenCEption("Something went wrong in output stream...");
+        }
+        
+        out.flush();
+        out.reset();
+        
+        ptrStats->endStage(stage, order.size(), 0);
+    } catch (XenCommon::XenCEption &e) {
+        throw;
+    }
+}
+
+void XenIO::mergeShards(int shards) {
+    XenOption* opt = XenOption::getInstance();
+    
+    std::string sortedName = opt->getOutName() + ".sorted.gz";
+    bool rev = opt->getRev();
+    bool inv = opt->getInv();
+    
+    boost::shared_ptr<RunStats> ptrStats = StaticData::getInstance()->getRunStats();
+    int stage = ptrStats->startStage("merge:" + sortedName);
+    
+    std::vector<boost::shared_ptr<ShardCursor> > cursors;
+    MinMax bounds(0, 0);
+    
+    try {
+        // Headers first: the calibration needs the bounds of all shards
+        for (int s = 1; s <= shards; s++) {
+            std::string shardName = getShardName(opt->getOutName(), s, shards) + ".sorted.gz";
+            
+            if (!boost::filesystem::exists(shardName.c_str()))
+                throw XenCommon::XenCEption("Shard " + shardName + " does not exists! Exiting.");
+            
+            boost::shared_ptr<XenFile> ptrFile = boost::make_shared<XenFile>();
+            ptrFile->initialize(shardName);
+            
+            boost::shared_ptr<ShardCursor> ptrCursor = boost::make_shared<ShardCursor>();
+            ptrCursor->reader.open(ptrFile);
+            ptrCursor->next = 0;
+            ptrCursor->pending = false;
+            
+            std::string header;
+            std::vector<std::string> fields;
+            
+            if (ptrCursor->reader.next(header))
+                boost::split(fields, header, boost::is_any_of("\t"));
+            
+            if (fields.size() != 7 || fields[0].compare("#shard") != 0 || std::atoi(fields[1].c_str()) != s || std::atoi(fields[2].c_str()) != shards)
+                throw XenCommon::XenCEption("File " + shardName + " is not shard " + XenCommon::toString(s) + "/" + XenCommon::toString(shards) + "! Exiting.");
+            
+            if ((std::atoi(fields[5].c_str()) != 0) != rev || (std::atoi(fields[6].c_str()) != 0) != inv)
+                throw XenCommon::XenCEption("Shard " + shardName + " was not scored with the same --rev and --inv options! Exiting.");
+            
+            bounds = Score::mergeBounds(bounds, MinMax(std::strtod(fields[3].c_str(), NULL), std::strtod(fields[4].c_str(), NULL)));
+            
+            cursors.push_back(ptrCursor);
+        }
+        
+        MergeLess less;
+        less.cursors = &cursors;
+        less.rev = rev;
+        
+        std::priority_queue<unsigned int, std::vector<unsigned int>, MergeLess> heap(less);
+        
+        for (unsigned int c = 0; c < cursors.size(); c++)
+            if (fillShardRun(*cursors[c], bounds, rev, inv))
+                heap.push(c);
+        
+        std::cout << "Merging " << shards << " sorted shards to " + sortedName << std::endl;
+        
+        boost::iostreams::filtering_ostream out;
+        out.push(BgzfSink(sortedName));
+        
+        if (!out.good())
+            throw XenCommon::XenCEption("Something went wrong in output stream...");
+        
+        unsigned int lines = 0;
+        
+        while (!heap.empty()) {
+            unsigned int c = heap.top();
+            heap.pop();
+            
+            ShardCursor &cursor = *cursors[c];
+            const ShardEntry &e = cursor.run[cursor.next];
+            
+            out << XenCommon::toString(e.score) << '\t' << e.text << std::endl;
+            lines++;
+            
+            if (out.bad())
+                throw XenCommon::XenCEption("Something went wrong in output stream...");
+            
+            if (++cursor.next < cursor.run.size() || fillShardRun(cursor, bounds, rev, inv))
+                heap.push(c);
+        }
+        
+        out.flush();
+        out.reset();
+        
+        std::cout << "Merged " << lines << " lines from " << shards << " shards." << std::endl;
+        
+        ptrStats->endStage(stage, lines, 0);
+    } catch (XenCommon::XenCEption &e) {
+        throw;
     }
+}
+
+void XenIO::writeNewPT(boost::shared_ptr<PhraseTable> ptrPT, boost::shared_ptr<Score> ptrScore, boost::shared_ptr<Score> ptrLocal) {
+    XenOption* opt = XenOption::getInstance();
     
     try {
         std::cout << "Writing new phrase-table to " + opt->getOutName() << std::endl;
@@ -230,16 +720,15 @@ void XenIO::writeNewPT(boost::shared_ptr<PhraseTable> ptrPT, boost::shared_ptr<S
         std::string oF = opt->getOutName();
         
         boost::iostreams::filtering_ostream out;
-        out.push(boost::iostreams::gzip_compressor());
-        out.push(boost::iostreams::file_sink(oF.c_str(), std::ios_base::out | std::ios_base::binary));
+        out.push(BgzfSink(oF));
         
         if (!out.good())
             throw XenCommon::XenCEption("Can't write to " + opt->getOutName() + ".gz");
 
         for (unsigned int i = 0; i < ptrScore->getSize(); i++) {
             out << ptrPT->getSource(i) << " ||| " << ptrPT->getTarget(i) << " ||| " << ptrPT->getScores(i) << " " << XenCommon::toString(ptrScore->getScore(i));
-            if (opt->getLocal())
-                out << " " << XenCommon::toString(sc2.getScore(i));
+            if (ptrLocal)
+                out << " " << XenCommon::toString(ptrLocal->getScore(i));
             out << " ||| " << ptrPT->getAlignment(i) << " ||| " << ptrPT->getCounts(i) << std::endl;
             
             if (out.bad())
@@ -340,24 +829,26 @@ void XenIO::writeEval(boost::shared_ptr<EvalMap> ptrEvalMap, std::string distNam
     }
 }
 
-void XenIO::writeVocab(std::map<std::string, int> voc, std::string fileName) {
-    vector<std::string> keys;
-    boost::copy(voc | boost::adaptors::map_keys, std::back_inserter(keys));
+void XenIO::writeVocab(const std::vector<std::string> &words, std::string fileName) {
+    // Written aside then renamed: concurrent shards may dump the same vocabulary
+    std::string tmpName = boost::filesystem::unique_path(fileName + ".%%%%-%%%%.tmp").string();
 
     try {
-        std::ofstream out(fileName.c_str(), std::ios::out | std::ios::trunc);
+        std::ofstream out(tmpName.c_str(), std::ios::out | std::ios::trunc);
 
         if (!out.is_open())
-            throw XenCommon::XenCEption("Can't open " + fileName + " for writing.");
+            throw XenCommon::XenCEption("Can't open " + tmpName + " for writing.");
 
-        for (unsigned int i = 0; i < keys.size(); i++) {
-            out << keys[i] << std::endl;
+        for (unsigned int i = 0; i < words.size(); i++) {
+            out << words[i] << std::endl;
 
             if (out.bad())
-                throw XenCommon::XenCEption("Error while writing file " + fileName);
+                throw XenCommon::XenCEption("Error while writing file " + tmpName);
         }
 
         out.close();
+
+        boost::filesystem::rename(tmpName, fileName);
     } catch (XenCommon::XenCEption &e) {
         throw;
     }
@@ -371,8 +862,7 @@ void XenIO::writeXRpart(boost::shared_ptr<XenResult> ptrXR, int pc, std::string
 
     try {
         boost::iostreams::filtering_ostream out;
-        out.push(boost::iostreams::gzip_compressor());
-        out.push(boost::iostreams::file_sink(fileName.c_str(), std::ios_base::out | std::ios_base::binary));
+        out.push(BgzfSink(fileName));
 
         if (!out.good())
             throw XenCommon::XenCEption("Can't open " + fileName + " for writing.");
@@ -467,6 +957,62 @@ std::vector<std::string> XenIO::read(boost::shared_ptr<XenFile> ptrFile) {
     return ret;
 }
 
+void XenIO::readBuffer(boost::shared_ptr<XenFile> ptrFile, std::vector<char> &buf) {
+    std::cout << "Reading file " + ptrFile->getFullPath() << std::endl;
+    
+    buf.clear();
+    
+    try {
+        std::ifstream f(ptrFile->getFullPath().c_str(), std::ios_base::in | std::ios_base::binary);
+        
+        if (!f.is_open())
+            throw XenCommon::XenCEption("Error while opening file " + ptrFile->getFullPath());
+        
+        if (!ptrFile->isGZ()) {
+            buf.resize((std::size_t)boost::filesystem::file_size(ptrFile->getFullPath().c_str()));
+            
+            if (!buf.empty())
+                f.read(&buf[0], (std::streamsize)buf.size());
+            
+            if (f.bad() || f.gcount() != (std::streamsize)buf.size())
+                throw XenCommon::XenCEption("Error while reading file " + ptrFile->getFullPath());
+        }
+        else if (Bgzf::isBgzf(ptrFile->getFullPath())) {
+            Bgzf::read(ptrFile->getFullPath(), buf);
+        }
+        else {
+            try {
+                boost::iostreams::filtering_istream in;
+                in.push(boost::iostreams::gzip_decompressor());
+                in.push(f);
+                
+                std::vector<char> chunk(1 << 20);
+                
+                while (in) {
+                    in.read(&chunk[0], (std::streamsize)chunk.size());
+                    buf.insert(buf.end(), chunk.begin(), chunk.begin() + in.gcount());
+                }
+                
+                if (f.bad())
+                    throw XenCommon::XenCEption("Error while reading file " + ptrFile->getFullPath());
+            }
+            catch(boost::iostreams::gzip_error &e) {
+                std::cout << e.what() << std::endl;
+            }
+        }
+        
+        f.close();
+    }
+    catch (XenCommon::XenCEption &e) {
+        throw;
+    }
+    
+    if (!buf.empty() && buf.back() != '\n')
+        buf.push_back('\n');
+    
+    std::cout << "Done reading file " + ptrFile->getFullPath() << std::endl;
+}
+
 boost::shared_ptr<EvalMap> XenIO::readDist(std::string distFile) {
     boost::shared_ptr<EvalMap> ret = boost::make_shared<EvalMap>();
     
@@ -507,4 +1053,9 @@ void XenIO::delFile(std::string fileName) {
 
     if(boost::filesystem::exists(f))
         boost::filesystem::remove(f);
+
+    boost::filesystem::wpath idx(Bgzf::getIndexName(fileName));
+
+    if(boost::filesystem::exists(idx))
+        boost::filesystem::remove(idx);
 }
@@ -0,0 +1,82 @@
+/**
+ *  @file xennuma.cpp
+ *  @brief Class handling NUMA placement of language models and scoring threads
+ *  @author Anthony Rousseau
+ *  @version 2.0.0
+ *  @date 19 October 2026
+ */
+
+
+/*  This file is part of the cross-entropy tool for data selection (XenC)
+ *  aimed at speech recognition and statistical machine translation.
+ *
+ *  Copyright 2013-2016, Anthony Rousseau, LIUM, University of Le Mans, France
+ *
+ *  Development of the XenC tool has been partially funded by the
+ *  European Commission under the MateCat project.
+ *
+ *  The XenC tool is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation
+ *
+ *  This library is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "../../include/utils/xennuma.h"
+#include "../../include/utils/scheduler.h"
+#include "../../include/xenoption.h"
+
+#ifdef HAVE_NUMA
+#include <numa.h>
+#endif
+
+int XenNuma::getNodes() {
+#ifdef HAVE_NUMA
+    if (XenOption::getInstance()->getNuma().compare("none") == 0 || numa_available() < 0)
+        return 1;
+
+    return numa_max_node() + 1;
+#else
+    return 1;
+#endif
+}
+
+bool XenNuma::getReplicate() {
+    return getNodes() > 1 && XenOption::getInstance()->getNuma().compare("replicate") == 0;
+}
+
+bool XenNuma::getInterleave() {
+    return getNodes() > 1 && XenOption::getInstance()->getNuma().compare("interleave") == 0;
+}
+
+void XenNuma::bindToNode(int node) {
+#ifdef HAVE_NUMA
+    numa_run_on_node(node);
+    numa_set_preferred(node);
+#endif
+}
+
+void XenNuma::setInterleave(bool on) {
+#ifdef HAVE_NUMA
+    if (on)
+        numa_set_interleave_mask(numa_all_nodes_ptr);
+    else
+        numa_set_localalloc();
+#endif
+}
+
+int XenNuma::threadNode() {
+    int worker = Scheduler::getInstance()->getWorker();
+
+    if (worker < 0)
+        return 0;
+
+    return worker % getNodes();
+}
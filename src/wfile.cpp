@@ -31,7 +31,7 @@
 #include "../include/wfile.h"
 
 Wfile::Wfile() {
-    
+    ptrWeights = boost::make_shared<Score>();
 }
 
 void Wfile::initialize(boost::shared_ptr<XenFile> ptrFile) {
@@ -58,34 +58,30 @@ Wfile::~Wfile() {
 }
 
 double Wfile::getWeight(int n) {
-    return ptrWeights->operator[](n);
+    return ptrWeights->getScore(n);
 }
 
 unsigned int Wfile::getSize() const {
-    return (unsigned int)ptrWeights->size();
+    return ptrWeights->getSize();
+}
+
+boost::shared_ptr<Score> Wfile::getPtrWeights() const {
+    return ptrWeights;
 }
 
 void Wfile::loadWeights() {
     std::vector<std::string> tmp = XenIO::read(ptrFile);
     
+    ptrWeights->resize((unsigned int)tmp.size(), 0);
+    
     for (unsigned int i = 0; i < tmp.size(); i++)
-        ptrWeights->push_back(XenCommon::toDouble(tmp[i]));
+        ptrWeights->setScore(i, XenCommon::toDouble(tmp[i]));
 }
 
 void Wfile::calibrate() {
     std::cout << "Starting weights calibration." << std::endl;
     
-	double min = 0;
-	double max = 0;
-    
-	for (std::vector<double>::iterator iter = ptrWeights->begin(); iter != ptrWeights->end(); ++iter) {
-		if (*iter > max) { max = *iter; }
-		if (*iter < min) { min = *iter; }
-	}
-    
-	for (unsigned int i = 0; i < ptrWeights->size(); i++) {
-		ptrWeights->operator[](i) = ((ptrWeights->operator[](i) - min) / (max - min));
-	}
+    ptrWeights->calibrate();
     
     std::cout << "Weights calibration complete." << std::endl;
 }
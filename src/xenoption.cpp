@@ -29,6 +29,29 @@
  */
 
 #include "../include/xenoption.h"
+#include "../include/kenlm/util/usage.hh"
+
+#include <cstdio>
+
+namespace po = boost::program_options;
+
+namespace {
+    class SizeNotify {
+    public:
+        SizeNotify(std::size_t &out) : behind_(out) { }
+
+        void operator()(const std::string &from) {
+            behind_ = util::ParseSize(from);
+        }
+
+    private:
+        std::size_t &behind_;
+    };
+
+    boost::program_options::typed_value <std::string> *SizeOption(std::size_t &to, const char *default_value) {
+        return boost::program_options::value<std::string>()->notifier(SizeNotify(to))->default_value(default_value);
+    }
+}
 
 XenOption* XenOption::_instance = NULL;
 
@@ -51,6 +74,81 @@ void XenOption::deleteInstance() {
     _instance = NULL;
 }
 
+void XenOption::describe(po::options_description &desc, Options &opt) {
+    // Set by XenC itself, not on the command line
+    opt.minblk = 8192;
+    opt.sortblk = 67108864;
+    opt.sampleSize = 0;
+    opt.pc = 0;
+    opt.inToks = 0;
+    opt.outToks = 0;
+    opt.outName = "";
+    opt.name = "";
+    opt.version = false;
+    
+    desc.add_options()
+    ("source,s", po::value<std::string>(&opt.sLang)->required(), "source language (fr, en, ...)")
+    ("target,t", po::value<std::string>(&opt.tLang)->default_value(""), "target language (if relevant)")
+    ("in-stext,i", po::value<std::string>(&opt.inSData)->required(), "in-domain source text filename (plain text or gzipped file)")
+    ("out-stext,o", po::value<std::string>(&opt.outSData)->required(), "out-of-domain source text filename (plain text or gzipped file)")
+    ("mode,m", po::value<int>(&opt.mode)->required()->default_value(2), "filtering mode (1, 2, 3 or 4). Default is 2 (monolingual cross-entropy)")
+    ("eval,e", po::value<bool>(&opt.eval)->zero_tokens()->default_value(false), "add this switch to evaluate a filtered file after computation. Eval is always done on source language")
+    ("best-point,b", po::value<bool>(&opt.bp)->zero_tokens()->default_value(false), "add this switch to determinate the best point of a filtered file (eval option is implicit)")
+    ("dev,d", po::value<std::string>(&opt.dev)->default_value(""), "source language dev file for eval or best point (all modes), if different from in-domain text")
+    ("in-ttext", po::value<std::string>(&opt.inTData)->default_value(""), "in-domain target text filename, if target language (plain text or gzipped file)")
+    ("out-ttext", po::value<std::string>(&opt.outTData)->default_value(""), "out-of-domain target text filename, if target language (plain text or gzipped file)")
+    ("mono", po::value<bool>(&opt.mono)->zero_tokens()->default_value(false), "switch to force monolingual mode (if no target language)")
+    ("stem", po::value<bool>(&opt.stem)->zero_tokens()->default_value(false), "switch to activate stem models computation and scoring from stem files")
+    ("in-sstem", po::value<std::string>(&opt.inSStem)->default_value(""), "in-domain source stem filename (plain text or gzipped file)")
+    ("in-tstem", po::value<std::string>(&opt.inTStem)->default_value(""), "in-domain target stem filename (plain text or gzipped file)")
+    ("out-sstem", po::value<std::string>(&opt.outSStem)->default_value(""), "out-of-domain source stem filename (plain text or gzipped file)")
+    ("out-tstem", po::value<std::string>(&opt.outTStem)->default_value(""), "out-of-domain target stem filename (plain text or gzipped file)")
+    ("in-ptable", po::value<std::string>(&opt.iPTable)->default_value(""), "in-domain phrase table filename used in mode 4 scoring")
+    ("out-ptable", po::value<std::string>(&opt.oPTable)->default_value(""), "out-of-domain phrase table filename used in mode 4 scoring")
+    ("local", po::value<bool>(&opt.local)->zero_tokens()->default_value(false), "add a 7th score (local cross-entropy regarding the source phrase)")
+    ("mean", po::value<bool>(&opt.mean)->zero_tokens()->default_value(false), "mean score from several OOD sample LMs instead of 1 in mode 2 & 3, estimated and scored together (EXPERIMENTAL)")
+    ("mean-k", po::value<int>(&opt.meanK)->default_value(3), "number of OOD sample LMs averaged with --mean. Default is 3")
+    ("sim", po::value<bool>(&opt.sim)->zero_tokens()->default_value(false), "add similarity measures to score computing (EXPERIMENTAL, mode 2 only)")
+    ("sim-only", po::value<bool>(&opt.simOnly)->zero_tokens()->default_value(false), "use only similarity measures (no cross-entropy)")
+    ("vector-size", po::value<int>(&opt.vecSize)->default_value(150), "size of vector for similarity scores, default is 150 (WARNING: the more the slower)")
+    ("step", po::value<int>(&opt.step)->default_value(10), "percentage steps for evaluation. Default is 10 (100%, 90%, ...)")
+    ("s-vocab", po::value<std::string>(&opt.sVocab)->default_value(""), "source language vocab filename for LMs estimation. Default is in-domain source text vocab")
+    ("t-vocab", po::value<std::string>(&opt.tVocab)->default_value(""), "target language vocab filename for LMs estimation. Default is in-domain target text vocab")
+    ("full-vocab", po::value<bool>(&opt.fullVoc)->zero_tokens()->default_value(false), "use in-domain + out-of-domain vocabularies instead of in-domain only")
+    ("vocab-cutoff", po::value<int>(&opt.vocCutoff)->default_value(1), "minimum count of a word to be kept in estimated vocabularies. Default is 1 (all words)")
+    ("in-slm", po::value<std::string>(&opt.inSLM)->default_value(""), "in-domain source language model (LM). Will be estimated if not present")
+    ("out-slm", po::value<std::string>(&opt.outSLM)->default_value(""), "out-of-domain source language model (LM). Will be estimated if not present")
+    ("in-tlm", po::value<std::string>(&opt.inTLM)->default_value(""), "in-domain target language model (LM). Will be estimated if not present")
+    ("out-tlm", po::value<std::string>(&opt.outTLM)->default_value(""), "out-of-domain target language model (LM). Will be estimated if not present")
+    ("order", po::value<int>(&opt.order)->default_value(4), "order for LMs. Default is 4")
+    ("mem", SizeOption(opt.memPC, util::GuessPhysicalMemory() ? "70%" : "1G"), "Percentage of memory usage")
+    ("temp", po::value<std::string>(&opt.temp)->default_value("."), "Directory for temporary files")
+    ("sort-mem", SizeOption(opt.sortMem, "1G"), "Memory of the sorted output before it is sorted on disk in the temporary directory")
+    ("exclude-oovs", po::value<bool>(&opt.exclOOVs)->zero_tokens()->default_value(false), "Exclude OOVs from PPL computation")
+    ("w-file", po::value<std::string>(&opt.wFile)->default_value(""), "filename for weighting the final score (one value per line)")
+    ("log", po::value<bool>(&opt.log)->zero_tokens()->default_value(false), "switch to consider weights in w-file as log values")
+    ("rev", po::value<bool>(&opt.rev)->zero_tokens()->default_value(false), "switch to require descending order sorted output")
+    ("inv", po::value<bool>(&opt.inv)->zero_tokens()->default_value(false), "switch to require inversed calibrated scores (1 - score)")
+    ("threads", po::value<int>(&opt.threads)->default_value(2), "number of threads to run for various operations (eval, sim, ...). Default is 2")
+    ("sorted-only", po::value<bool>(&opt.sortOnly)->zero_tokens()->default_value(false), "switch to save space & time by only outputing the sorted scores file")
+    ("select-top", po::value<std::string>(&opt.selectTop)->default_value(""), "only output the n best lines (or n% with a trailing %) to the selected file, without sorting nor writing the whole corpus")
+    ("select-threshold", po::value<std::string>(&opt.selectThr)->default_value(""), "only output the lines scoring at least as well as this calibrated score to the selected file (can be combined with --select-top)")
+    ("select-sorted", po::value<bool>(&opt.selectSorted)->zero_tokens()->default_value(false), "switch to write the selected lines sorted by score (corpus order otherwise)")
+    ("shard", po::value<std::string>(&opt.shard)->default_value(""), "only score the i-th of N slices of the out-of-domain corpus (i/N, from 1/N to N/N) and write it as a sorted shard (modes 1, 2 and 3)")
+    ("merge-shards", po::value<int>(&opt.mergeShards)->default_value(0), "merge the N sorted shards written with --shard i/N (and the same other options) into the final sorted output")
+    ("seed", po::value<int>(&opt.seed)->default_value(0), "seed of the out-of-domain sample extraction, needed by --shard in modes 2 and 3. Default is 0 (time based)")
+    ("max-evalpc", po::value<int>(&opt.maxEvalPC)->default_value(50), "maximum percentage of corpus to evaluate (means it will evaluate between 0 and n, default is 0-50)")
+    ("eval-cache", po::value<std::string>(&opt.evalCache)->default_value(""), "perplexities cache reused by later evaluations and best points of the same sorted output, dev set, vocab and order. Default is xenc.evalcache next to the sorted output")
+    ("server", po::value<bool>(&opt.server)->zero_tokens()->default_value(false), "switch to run as a long-running scoring server with resident language models (modes 1, 2 and 3)")
+    ("socket", po::value<std::string>(&opt.socket)->default_value(""), "Unix socket path the scoring server listens on (stdin/stdout if not specified)")
+    ("batch-size", po::value<int>(&opt.batchSize)->default_value(10000), "maximum number of lines scored per server batch. Default is 10000")
+    ("checkpoint", po::value<bool>(&opt.checkpoint)->zero_tokens()->default_value(false), "switch to checkpoint vocabularies, LM estimations and perplexity scores, and resume an interrupted run from them")
+    ("incremental", po::value<bool>(&opt.incremental)->zero_tokens()->default_value(false), "switch to only score new or changed out-of-domain lines, reusing the score store of previous runs (modes 1, 2 and 3)")
+    ("numa", po::value<std::string>(&opt.numa)->default_value("none"), "NUMA placement of language models: none, replicate (one copy per node, scoring threads pinned to nodes) or interleave. Needs libnuma. Default is none")
+    ("help,h", "displays this help message")
+    ("version,v", "displays program version");
+}
+
 XenOption::XenOption() {
     
 }
@@ -177,6 +275,10 @@ bool XenOption::getMean() const {
     return opt->mean;
 }
 
+int XenOption::getMeanK() const {
+    return opt->meanK;
+}
+
 bool XenOption::getSim() const {
     return opt->sim;
 }
@@ -237,6 +339,10 @@ std::string XenOption::getTemp() const {
     return opt->temp;
 }
 
+std::size_t XenOption::getSortMem() const {
+    return opt->sortMem;
+}
+
 std::size_t XenOption::getMinBlk() const {
     return opt->minblk;
 }
@@ -305,6 +411,88 @@ int XenOption::getMaxEvalPC() const {
     return opt->maxEvalPC;
 }
 
+std::string XenOption::getEvalCache() const {
+    return opt->evalCache;
+}
+
+bool XenOption::getServer() const {
+    return opt->server;
+}
+
+std::string XenOption::getSocket() const {
+    return opt->socket;
+}
+
+int XenOption::getBatchSize() const {
+    return opt->batchSize;
+}
+
+bool XenOption::getIncremental() const {
+    return opt->incremental;
+}
+
+bool XenOption::getCheckpoint() const {
+    return opt->checkpoint;
+}
+
+int XenOption::getVocCutoff() const {
+    return opt->vocCutoff;
+}
+
+std::string XenOption::getNuma() const {
+    return opt->numa;
+}
+
+bool XenOption::getSelect() const {
+    return opt->selectTop.compare("") != 0 || opt->selectThr.compare("") != 0;
+}
+
+std::string XenOption::getSelectTop() const {
+    return opt->selectTop;
+}
+
+std::string XenOption::getSelectThreshold() const {
+    return opt->selectThr;
+}
+
+bool XenOption::getSelectSorted() const {
+    return opt->selectSorted;
+}
+
+std::string XenOption::getShard() const {
+    return opt->shard;
+}
+
+int XenOption::getShardIndex() const {
+    int index = 0;
+    int count = 0;
+    char end = 0;
+    
+    if (std::sscanf(opt->shard.c_str(), "%d/%d%c", &index, &count, &end) != 2)
+        return 0;
+    
+    return index;
+}
+
+int XenOption::getShardCount() const {
+    int index = 0;
+    int count = 0;
+    char end = 0;
+    
+    if (std::sscanf(opt->shard.c_str(), "%d/%d%c", &index, &count, &end) != 2)
+        return 0;
+    
+    return count;
+}
+
+int XenOption::getMergeShards() const {
+    return opt->mergeShards;
+}
+
+int XenOption::getSeed() const {
+    return opt->seed;
+}
+
 void XenOption::setSampleSize(int size) {
     opt->sampleSize = size;
 }
@@ -30,6 +30,10 @@
 
 #include "../include/xenvocab.h"
 #include "../include/utils/xenio.h"
+#include "../include/utils/StaticData.h"
+#include "../include/utils/scheduler.h"
+
+#include <algorithm>
 
 XenVocab::XenVocab() {
 
@@ -54,36 +58,43 @@ void XenVocab::initialize(boost::shared_ptr<Corpus> ptrCorp) {
 	ptrFile = boost::make_shared<XenFile>();
     ptrFile->initialize(ptrCorp->getXenFile()->getPrefix() + ptrCorp->getLang() + ".vocab");
 
+    uint64_t fp = 0;
+    if (XenOption::getInstance()->getCheckpoint()) {
+        fp = StaticData::getInstance()->getCheckpoint()->fileFingerprint(ptrCorp->getXenFile()->getFullPath());
+        fp = Checkpoint::hashString(XenCommon::toString(XenOption::getInstance()->getVocCutoff()), fp);
+        if (resumeVocab(fp))
+            return;
+    }
+
+    boost::shared_ptr<RunStats> ptrStats = StaticData::getInstance()->getRunStats();
+    int stage = ptrStats->startStage("vocab:" + ptrFile->getFullPath());
+
     makeVocab(ptrCorp);
-    
-	if (boost::filesystem::exists(ptrFile->getFullPath().c_str())) {
-        std::cout << "Using existing vocab " << ptrFile->getFullPath() << std::endl;
-	}
-	else {
-        std::cout << "Dumping vocab " << ptrFile->getFullPath() << std::endl;
-        
-		writeVocab();
-        
-        std::cout << "Vocab file " + ptrFile->getFullPath() + " has been dumped." << std::endl;
-	}
+    dumpVocab(fp);
+
+    ptrStats->endStage(stage, ptrCorp->getSize(), (uint64_t)ptrCorp->getWC());
 }
 
 void XenVocab::initialize(boost::shared_ptr<Corpus> ptrInCorp, boost::shared_ptr<Corpus> ptrOutCorp) {
     ptrFile = boost::make_shared<XenFile>();
     ptrFile->initialize(ptrInCorp->getXenFile()->getPrefix() + "-" + ptrOutCorp->getXenFile()->getPrefix() + ptrInCorp->getLang() + ".vocab");
 
+    uint64_t fp = 0;
+    if (XenOption::getInstance()->getCheckpoint()) {
+        boost::shared_ptr<Checkpoint> ptrCkpt = StaticData::getInstance()->getCheckpoint();
+        fp = Checkpoint::hashString(XenCommon::toString(ptrCkpt->fileFingerprint(ptrOutCorp->getXenFile()->getFullPath())), ptrCkpt->fileFingerprint(ptrInCorp->getXenFile()->getFullPath()));
+        fp = Checkpoint::hashString(XenCommon::toString(XenOption::getInstance()->getVocCutoff()), fp);
+        if (resumeVocab(fp))
+            return;
+    }
+
+    boost::shared_ptr<RunStats> ptrStats = StaticData::getInstance()->getRunStats();
+    int stage = ptrStats->startStage("vocab:" + ptrFile->getFullPath());
+
     makeVocab(ptrInCorp, ptrOutCorp);
-    
-	if (boost::filesystem::exists(ptrFile->getFullPath().c_str())) {
-        std::cout << "Using existing vocab " << ptrFile->getFullPath() << std::endl;
-	}
-	else {
-        std::cout << "Dumping vocab " << ptrFile->getFullPath() << std::endl;
-        
-		writeVocab();
-        
-        std::cout << "Vocab file " + ptrFile->getFullPath() + " has been dumped." << std::endl;
-	}
+    dumpVocab(fp);
+
+    ptrStats->endStage(stage, ptrInCorp->getSize() + ptrOutCorp->getSize(), (uint64_t)ptrInCorp->getWC() + ptrOutCorp->getWC());
 }
 
 void XenVocab::initialize(boost::shared_ptr<XenResult> ptrXenRes) {
@@ -92,18 +103,21 @@ void XenVocab::initialize(boost::shared_ptr<XenResult> ptrXenRes) {
 	ptrFile = boost::make_shared<XenFile>();
     ptrFile->initialize(ptrXenRes->getXenFile()->getPrefix() + opt->getSLang() + ".vocab");
 
+    uint64_t fp = 0;
+    if (opt->getCheckpoint()) {
+        fp = StaticData::getInstance()->getCheckpoint()->fileFingerprint(ptrXenRes->getXenFile()->getFullPath());
+        fp = Checkpoint::hashString(XenCommon::toString(opt->getVocCutoff()), fp);
+        if (resumeVocab(fp))
+            return;
+    }
+
+    boost::shared_ptr<RunStats> ptrStats = StaticData::getInstance()->getRunStats();
+    int stage = ptrStats->startStage("vocab:" + ptrFile->getFullPath());
+
     makeVocab(ptrXenRes);
-    
-	if (boost::filesystem::exists(ptrFile->getFullPath().c_str())) {
-        std::cout << "Using existing vocab " << ptrFile->getFullPath() << std::endl;
-	}
-	else {
-        std::cout << "Dumping vocab " << ptrFile->getFullPath() << std::endl;
-        
-		writeVocab();
-        
-        std::cout << "Vocab file " + ptrFile->getFullPath() + " has been dumped." << std::endl;
-	}
+    dumpVocab(fp);
+
+    ptrStats->endStage(stage, ptrXenRes->getSize(), 0);
 }
 
 XenVocab::~XenVocab() {
@@ -111,74 +125,186 @@ XenVocab::~XenVocab() {
 }
 
 unsigned int XenVocab::getSize() const {
-    return (unsigned int)voc.size();
+    return (unsigned int)words.size();
 }
 
 boost::shared_ptr<XenFile> XenVocab::getXenFile() const {
     return ptrFile;
 }
 
-std::map<std::string, int> XenVocab::getXenVocab() const {
-    return voc;
+const std::vector<std::string>& XenVocab::getWords() const {
+    return words;
+}
+
+uint64_t XenVocab::getCount(unsigned int id) const {
+    return counts[id];
+}
+
+int XenVocab::getID(const std::string &word) const {
+    return getID(Tokenizer::hash(word));
+}
+
+int XenVocab::getID(uint64_t hash) const {
+    boost::unordered_map<uint64_t, int>::const_iterator it = ids.find(hash);
+
+    if (it == ids.end())
+        return -1;
+
+    return it->second;
 }
 
 void XenVocab::writeVocab() {
-    XenIO::writeVocab(voc, ptrFile->getFullPath());
+    XenIO::writeVocab(words, ptrFile->getFullPath());
+}
+
+bool XenVocab::resumeVocab(uint64_t fp) {
+    if (!StaticData::getInstance()->getCheckpoint()->isDone("vocab:" + ptrFile->getFullPath(), fp))
+        return false;
+
+    std::cout << "Vocab " << ptrFile->getFullPath() << " restored from checkpoint." << std::endl;
+    makeVocab(ptrFile);
+
+    return true;
+}
+
+void XenVocab::dumpVocab(uint64_t fp) {
+    // With checkpoints, a vocab file left by an interrupted run may be partial
+    if (boost::filesystem::exists(ptrFile->getFullPath().c_str()) && !XenOption::getInstance()->getCheckpoint()) {
+        std::cout << "Using existing vocab " << ptrFile->getFullPath() << std::endl;
+    }
+    else {
+        std::cout << "Dumping vocab " << ptrFile->getFullPath() << std::endl;
+
+        writeVocab();
+
+        std::cout << "Vocab file " + ptrFile->getFullPath() + " has been dumped." << std::endl;
+
+        if (XenOption::getInstance()->getCheckpoint())
+            StaticData::getInstance()->getCheckpoint()->markDone("vocab:" + ptrFile->getFullPath(), fp, ptrFile->getFullPath());
+    }
+}
+
+/**
+ *  @fn void taskCountWords (boost::function<std::string (int)> getLine, unsigned int begin, unsigned int end, boost::shared_ptr<WordCounts> ptrCounts)
+ *  @brief Counts the space-separated words of a range of lines
+ *
+ *  @param getLine :    accessor to the nth line of the text
+ *  @param begin :      first line of the range
+ *  @param end :        line after the range
+ *  @param ptrCounts :  the word counts of the thread
+ */
+void taskCountWords(boost::function<std::string (int)> getLine, unsigned int begin, unsigned int end, boost::shared_ptr<WordCounts> ptrCounts) {
+    for (unsigned int i = begin; i < end; i++) {
+        std::string line = getLine(i);
+        Tokenizer::countWords(line.data(), line.length(), *ptrCounts);
+    }
 }
 
 void XenVocab::makeVocab(boost::shared_ptr<XenFile> ptrFile) {
     std::vector<std::string> vec = XenIO::read(ptrFile);
 
-    for (unsigned int i = 0; i < vec.size(); i++)
-            voc[vec[i]] = 1;
+    std::vector<boost::shared_ptr<WordCounts> > shards(1, boost::make_shared<WordCounts>());
+
+    for (unsigned int i = 0; i < vec.size(); i++) {
+        WordCount wc;
+        wc.word = vec[i];
+        wc.count = 0;
+        shards[0]->insert(std::make_pair(Tokenizer::hash(vec[i]), wc));
+    }
+
+    buildVocab(shards, 0);
 }
 
 void XenVocab::makeVocab(boost::shared_ptr<Corpus> ptrCorp) {
-    for (unsigned int i = 0; i < ptrCorp->getSize(); i++) {
-        std::vector<std::string> lWords;
-        std::string line = ptrCorp->getLine(i);
-        
-        boost::split(lWords, line, boost::is_any_of(" "));
-        
-        for (unsigned int j = 0; j < lWords.size(); j++) {
-            voc[lWords[j]] = 1;
-        }
-    }
+    std::vector<boost::shared_ptr<WordCounts> > shards;
+
+    corpusWords(ptrCorp, shards);
+    buildVocab(shards, XenOption::getInstance()->getVocCutoff());
 }
 
 void XenVocab::makeVocab(boost::shared_ptr<Corpus> ptrInCorp, boost::shared_ptr<Corpus> ptrOutCorp) {
-    for (unsigned int i = 0; i < ptrInCorp->getSize(); i++) {
-        std::vector<std::string> lWords;
-        std::string line = ptrInCorp->getLine(i);
-        
-        boost::split(lWords, line, boost::is_any_of(" "));
-        
-        for (unsigned int j = 0; j < lWords.size(); j++) {
-            voc[lWords[j]] = 1;
-        }
-    }
-    
-    for (unsigned int i = 0; i < ptrOutCorp->getSize(); i++) {
-        std::vector<std::string> lWords;
-        std::string line = ptrOutCorp->getLine(i);
-        
-        boost::split(lWords, line, boost::is_any_of(" "));
-        
-        for (unsigned int j = 0; j < lWords.size(); j++) {
-            voc[lWords[j]] = 1;
-        }
-    }
+    std::vector<boost::shared_ptr<WordCounts> > shards;
+
+    corpusWords(ptrInCorp, shards);
+    corpusWords(ptrOutCorp, shards);
+    buildVocab(shards, XenOption::getInstance()->getVocCutoff());
 }
 
 void XenVocab::makeVocab(boost::shared_ptr<XenResult> ptrXenRes) {
-    for (unsigned int i = 0; i < ptrXenRes->getSize(); i++) {
-        std::vector<std::string> lWords;
-        std::string line = ptrXenRes->getTextLine(i);
-        
-        boost::split(lWords, line, boost::is_any_of(" "));
-        
-        for (unsigned int j = 0; j < lWords.size(); j++) {
-            voc[lWords[j]] = 1;
-        }
+    std::vector<boost::shared_ptr<WordCounts> > shards;
+
+    countWords(boost::bind(&XenResult::getTextLine, ptrXenRes, _1), ptrXenRes->getSize(), shards);
+    buildVocab(shards, XenOption::getInstance()->getVocCutoff());
+}
+
+void XenVocab::corpusWords(boost::shared_ptr<Corpus> ptrCorp, std::vector<boost::shared_ptr<WordCounts> > &shards) {
+    // Counted during the corpus ingestion when requested, no need for another pass
+    if (ptrCorp->getWordCounts())
+        shards.push_back(ptrCorp->getWordCounts());
+    else
+        countWords(boost::bind(&Corpus::getLine, ptrCorp, _1), ptrCorp->getSize(), shards);
+}
+
+void XenVocab::countWords(boost::function<std::string (int)> getLine, unsigned int size, std::vector<boost::shared_ptr<WordCounts> > &shards) {
+    unsigned int threads = (unsigned int)std::max(1, XenOption::getInstance()->getThreads());
+    unsigned int first = (unsigned int)shards.size();
+
+    for (unsigned int t = 0; t < threads; t++)
+        shards.push_back(boost::make_shared<WordCounts>());
+
+    TaskGroup counts;
+    unsigned int chunk = (size + threads - 1) / threads;
+
+    for (unsigned int t = 0; t < threads && t * chunk < size; t++)
+        counts.run(boost::bind(taskCountWords, getLine, t * chunk, std::min(size, (t + 1) * chunk), shards[first + t]));
+
+    counts.wait();
+}
+
+void XenVocab::buildVocab(std::vector<boost::shared_ptr<WordCounts> > &shards, uint64_t cutoff) {
+    WordCounts merged;
+
+    for (unsigned int t = 0; t < shards.size(); t++) {
+        // Counts still owned by a Corpus are copied, not stolen
+        if (merged.empty() && shards[t].unique())
+            merged.swap(*shards[t]);
+        else if (merged.empty())
+            merged = *shards[t];
+        else
+            for (WordCounts::iterator it = shards[t]->begin(); it != shards[t]->end(); ++it) {
+                WordCounts::iterator found = merged.find(it->first);
+
+                if (found != merged.end())
+                    found->second.count += it->second.count;
+                else
+                    merged.insert(*it);
+            }
+
+        shards[t].reset();
     }
+
+    std::vector<std::pair<std::string, uint64_t> > sorted;
+    sorted.reserve(merged.size());
+
+    for (WordCounts::iterator it = merged.begin(); it != merged.end(); ++it)
+        if (it->second.count >= cutoff)
+            sorted.push_back(std::make_pair(it->second.word, it->second.count));
+
+    std::sort(sorted.begin(), sorted.end());
+
+    words.clear();
+    counts.clear();
+    ids.clear();
+
+    words.reserve(sorted.size());
+    counts.reserve(sorted.size());
+
+    for (unsigned int i = 0; i < sorted.size(); i++) {
+        words.push_back(sorted[i].first);
+        counts.push_back(sorted[i].second);
+        ids.insert(std::make_pair(Tokenizer::hash(sorted[i].first), (int)i));
+    }
+
+    if (merged.size() != words.size())
+        std::cout << "Vocabulary cut-off kept " << words.size() << " out of " << merged.size() << " words." << std::endl;
 }